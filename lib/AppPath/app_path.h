@@ -111,6 +111,18 @@ public:
 
     static std::string gameplayRecordsRootDir(); // Must be writable
 
+    /*!
+     * \brief Get the path to the cache of the decoded textures
+     * \return Path to the textures cache directory, always ends with a slash
+     */
+    static std::string textureCacheDir(); // Must be writable
+
+    /*!
+     * \brief Get the path to the cached list of the installed episodes and battle levels
+     * \return Path to the episodes catalog file
+     */
+    static std::string episodeCatalogFile(); // Must be writable
+
     static std::string userWorldsRootDir(); // Read-Only, appears at writable directory
 
     static std::string userBattleRootDir(); // Read-Only, appears at writable directory
@@ -258,6 +258,16 @@ std::string AppPathManager::gameplayRecordsRootDir() // Writable
     return m_userPath + "gameplay-records/";
 }
 
+std::string AppPathManager::textureCacheDir() // Writable
+{
+    return m_userPath + "cache/textures/";
+}
+
+std::string AppPathManager::episodeCatalogFile() // Writable
+{
+    return m_userPath + "cache/episodes.dat";
+}
+
 std::string AppPathManager::userWorldsRootDir() // Readable
 {
     return m_userPath + "worlds/";
@@ -123,12 +123,21 @@ FIBITMAP *GraphicsHelps::loadImage(const std::string &file, bool convertTo32bit)
 
 FIBITMAP *GraphicsHelps::loadImage(std::vector<char> &raw, bool convertTo32bit)
 {
-    FIMEMORY *imgMEM = FreeImage_OpenMemory(reinterpret_cast<unsigned char *>(raw.data()),
-                                            static_cast<unsigned int>(raw.size()));
+    return loadImage(raw.data(), raw.size(), convertTo32bit);
+}
+
+FIBITMAP *GraphicsHelps::loadImage(const char *data, size_t size, bool convertTo32bit)
+{
+    // FreeImage doesn't write into the memory opened for reading
+    FIMEMORY *imgMEM = FreeImage_OpenMemory(reinterpret_cast<unsigned char *>(const_cast<char *>(data)),
+                                            static_cast<unsigned int>(size));
     FREE_IMAGE_FORMAT formato = FreeImage_GetFileTypeFromMemory(imgMEM);
 
     if(formato  == FIF_UNKNOWN)
+    {
+        FreeImage_CloseMemory(imgMEM);
         return nullptr;
+    }
 
     FIBITMAP *img = FreeImage_LoadFromMemory(formato, imgMEM, 0);
     FreeImage_CloseMemory(imgMEM);
@@ -257,14 +266,19 @@ void GraphicsHelps::mergeWithMask(FIBITMAP *image,
 }
 
 void GraphicsHelps::mergeWithMask(FIBITMAP *image, std::vector<char> &maskRaw, bool maskIsPng)
+{
+    mergeWithMask(image, maskRaw.data(), maskRaw.size(), maskIsPng);
+}
+
+void GraphicsHelps::mergeWithMask(FIBITMAP *image, const char *maskData, size_t maskSize, bool maskIsPng)
 {
     if(!image)
         return;
 
-    if(maskRaw.empty())
+    if(!maskData || maskSize == 0)
         return; //Nothing to do
 
-    FIBITMAP *mask = loadImage(maskRaw, true);
+    FIBITMAP *mask = loadImage(maskData, maskSize, true);
 
     if(!mask)
         return;//Nothing to do
@@ -61,6 +61,14 @@ public:
      */
     static FIBITMAP *loadImage(const std::string &file, bool convertTo32bit = true);
     static FIBITMAP *loadImage(std::vector<char> &raw, bool convertTo32bit = true);
+    /*!
+     * \brief Loads image from a memory block (for example, a mapped file)
+     * \param data Compressed image data, only read
+     * \param size Size of the data
+     * \param convertTo32bit need to convert image into 32bit RGBA
+     * \return FreeImage descriptor to loaded image
+     */
+    static FIBITMAP *loadImage(const char *data, size_t size, bool convertTo32bit = true);
     /*!
      * \brief Loads image from application resources
      * \param file in-resource path to the file
@@ -102,6 +110,7 @@ public:
                               const std::string &pathToMask,
                               const std::string &pathToMaskFallback = std::string());
     static void mergeWithMask(FIBITMAP *image, std::vector<char> &maskRaw, bool maskIsPng = false);
+    static void mergeWithMask(FIBITMAP *image, const char *maskData, size_t maskSize, bool maskIsPng = false);
     static void mergeWithMask(FIBITMAP *image, FIBITMAP *mask);
 
     /*!
@@ -29,6 +29,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <shlwapi.h>
+#include <sys/stat.h>
 
 static std::wstring Str2WStr(const std::string &path)
 {
@@ -137,6 +138,44 @@ bool Files::fileExists(const std::string &path)
 #endif
 }
 
+bool Files::fileInfo(const std::string &path, int64_t *mtime, int64_t *size)
+{
+#ifdef _WIN32
+    // _stat64() has the seconds only, the attributes keep 100-nanosecond ticks since 1601
+    std::wstring wpath = Str2WStr(path);
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if(!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &attr))
+        return false;
+
+    if(mtime)
+    {
+        int64_t ticks = (static_cast<int64_t>(attr.ftLastWriteTime.dwHighDateTime) << 32)
+                        | static_cast<int64_t>(attr.ftLastWriteTime.dwLowDateTime);
+        *mtime = (ticks - INT64_C(116444736000000000)) * 100;
+    }
+    if(size)
+        *size = (static_cast<int64_t>(attr.nFileSizeHigh) << 32) | static_cast<int64_t>(attr.nFileSizeLow);
+#else
+    struct stat st;
+    if(::stat(path.c_str(), &st) != 0)
+        return false;
+
+    if(mtime)
+    {
+        *mtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#if defined(__APPLE__)
+        *mtime += static_cast<int64_t>(st.st_mtimespec.tv_nsec);
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+        *mtime += static_cast<int64_t>(st.st_mtim.tv_nsec);
+#endif
+    }
+    if(size)
+        *size = static_cast<int64_t>(st.st_size);
+#endif
+
+    return true;
+}
+
 bool Files::deleteFile(const std::string &path)
 {
 #ifdef _WIN32
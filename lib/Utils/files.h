@@ -26,11 +26,14 @@
 #define FILES_H
 
 #include <string>
+#include <cstdint>
 
 namespace Files
 {
     FILE *utf8_fopen(const char *filePath, const char *modes);
     bool fileExists(const std::string &path);
+    //Gets the modification time (in nanoseconds, as precise as the platform keeps it) and the size of the file or directory, false if it doesn't exist
+    bool fileInfo(const std::string &path, int64_t *mtime, int64_t *size);
     bool deleteFile(const std::string &path);
     bool copyFile(const std::string &to, const std::string &from, bool override = false);
     bool moveFile(const std::string &to, const std::string &from, bool override = false);
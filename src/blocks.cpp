@@ -30,10 +30,26 @@
 #include "collision.h"
 #include "npc.h"
 #include "npc_id.h"
+#include "npc/npc_active.h"
 #include "player.h"
 #include "sorting.h"
 #include "layers.h"
 #include "compat.h"
+#include "main/trees.h"
+
+//! Update the block at its layer tree after its size or position has been changed
+static void s_blockLocationChanged(Block_t &b)
+{
+    b.LocationInLayer = b.Location;
+
+    if(b.Layer != LAYER_NONE)
+    {
+        b.LocationInLayer.X -= Layer[b.Layer].OffsetX;
+        b.LocationInLayer.Y -= Layer[b.Layer].OffsetY;
+    }
+
+    treeBlockUpdateLayer(b.Layer, &b);
+}
 
 void BlockHit(int A, bool HitDown, int whatPlayer)
 {
@@ -521,6 +537,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
 
@@ -547,6 +564,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
 #if 0 // Completely disable the DEAD the code that spawns the player
@@ -666,6 +684,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             {
                 b.Location.Width -= 0.1;
                 b.Location.X += 0.05;
+                s_blockLocationChanged(b);
                 b.wasShrinkResized = true; // Don't move it!!!
             }
 
@@ -804,6 +823,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         tempPlayer = CheckDead();
@@ -885,6 +905,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -991,6 +1012,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[b.Type];
             b.Location.Width = BlockWidth[b.Type];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -1110,6 +1132,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -1174,6 +1197,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -1236,6 +1260,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -1297,6 +1322,7 @@ void BlockHit(int A, bool HitDown, int whatPlayer)
             b.Type = newBlock;
             b.Location.Height = BlockHeight[newBlock];
             b.Location.Width = BlockWidth[newBlock];
+            s_blockLocationChanged(b);
         }
 
         if(!HitDown)
@@ -1925,7 +1951,7 @@ void UpdateBlocks()
 
         if(ib.ShakeY3 != 0)
         {
-            for(auto B = 1; B <= numNPCs; B++)
+            for(int B : npcActiveQuery())
             {
                 if(NPC[B].Active)
                 {
@@ -2044,7 +2070,6 @@ void UpdateBlocks()
 void PSwitch(bool enabled)
 {
     int A = 0;
-    int B = 0;
     Block_t blankBlock;
 
     if(enabled)
@@ -2092,6 +2117,7 @@ void PSwitch(bool enabled)
                     nb.Kill = false;
                     nb.NPC = NPC[A].Type;
                     syncLayersTrees_Block(numBlock);
+                    blockOrderTouch(numBlock);
                 }
                 NPC[A].Killed = 9;
             }
@@ -2140,6 +2166,7 @@ void PSwitch(bool enabled)
                     numBlock--;
                     syncLayersTrees_Block(A);
                     syncLayersTrees_Block(numBlock + 1);
+                    blockOrderTouch(A);
                 }
             }
         }
@@ -2171,6 +2198,7 @@ void PSwitch(bool enabled)
                     nb.Special = 0;
                     nb.Kill = false;
                     syncLayersTrees_Block(numBlock);
+                    blockOrderTouch(numBlock);
                 }
                 NPC[A].Killed = 9;
             }
@@ -2217,23 +2245,9 @@ void PSwitch(bool enabled)
         ProcEvent(EVENT_PSWITCH_END, true);
     }
 
-    qSortBlocksX(1, numBlock);
-    B = 1;
-
-    for(A = 2; A <= numBlock; A++)
-    {
-        if(Block[A].Location.X > Block[B].Location.X)
-        {
-            qSortBlocksY(B, A - 1);
-            B = A;
-        }
-    }
-
-    qSortBlocksY(B, A - 1);
-    FindSBlocks();
-    FindBlocks();
-    // SO expensive, can't wait to get rid of this.
-    syncLayersTrees_AllBlocks();
+    // only the converted blocks are out of the order, merge them in
+    //   instead of the full re-sort and the re-sync of all block trees
+    blockOrderFinish();
 
     iBlocks = numBlock;
     for(A = 1; A <= numBlock; A++)
@@ -23,6 +23,7 @@
 #define CMD_LINE_SETUP_H
 
 #include <string>
+#include <cstdint>
 
 struct CmdLineSetup_t
 {
@@ -46,6 +47,17 @@ struct CmdLineSetup_t
     int testNumPlayers = 1;
     //! Run a test in battle mode
     bool testBattleMode = false;
+    //! Replay the recording as fast as possible without rendering and sound
+    bool headless = false;
+    //! Run the drawing code of the headless replay with the null renderer
+    bool headlessDraw = false;
+    //! Check all NPCs at the NPC-to-NPC collision scans, don't use the spatial hash
+    bool npcLinearScan = false;
+    //! Rewind the replay once at this frame to check the restored game state (0 to never rewind)
+    int64_t replayRewindAt = 0;
+
+    //! File to write the timeline of the latest level frames into on quit
+    std::string profileTrace;
 
     //! Enable interprocessing communication with the Moondust Editor
     bool interprocess = false;
@@ -28,6 +28,13 @@ extern struct Config_t
 
     //! Record gameplay data
     bool    RecordGameplayData = false;
+    //! Format of the new gameplay recordings
+    enum
+    {
+        RECORD_FORMAT_TEXT = 0,
+        RECORD_FORMAT_BINARY,
+    };
+    int     RecordGameplayFormat = RECORD_FORMAT_BINARY;
     //! Use the native onscreen keyboard instead of the TheXTech one
     bool    use_native_osk = false;
     //! Enable the in-game editor
@@ -66,6 +73,8 @@ extern struct Config_t
     bool    worldMapFastMove = false;
     //! Enter the pause menu after dying while testing a level
     bool    editor_pause_on_death = true;
+    //! Find the blocks for the physics at the layer trees instead of the X-sorted block columns
+    bool    PhysicsUseBlockTrees = true;
 
     /* ---- Effects ----*/
 
@@ -0,0 +1,163 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+
+#include "atlas_packer.h"
+
+
+void AtlasPacker::init(int w, int h)
+{
+    m_w = w;
+    m_h = h;
+    m_shelfTop = 0;
+    m_used = 0;
+    m_usedArea = 0;
+    m_shelves.clear();
+    m_free.clear();
+}
+
+bool AtlasPacker::insert(int w, int h, Rect_t &out)
+{
+    if(w <= 0 || h <= 0 || w > m_w || h > m_h)
+        return false;
+
+    // The released place of the closest size goes first
+    int bestFree = -1;
+    long bestFreeArea = 0;
+
+    for(size_t i = 0; i < m_free.size(); i++)
+    {
+        const Rect_t &f = m_free[i];
+        if(f.w < w || f.h < h)
+            continue;
+
+        long area = long(f.w) * f.h;
+        if(bestFree < 0 || area < bestFreeArea)
+        {
+            bestFree = int(i);
+            bestFreeArea = area;
+        }
+    }
+
+    // Don't waste a big place for a tiny picture, a shelf might be better
+    if(bestFree >= 0 && bestFreeArea <= long(w) * h * 2)
+    {
+        takeFree(bestFree, w, h, out);
+        return true;
+    }
+
+    // The lowest shelf where the picture fits
+    int bestShelf = -1;
+
+    for(size_t i = 0; i < m_shelves.size(); i++)
+    {
+        const Shelf_t &s = m_shelves[i];
+        if(s.h < h || s.usedW + w > m_w)
+            continue;
+
+        if(bestShelf < 0 || s.h < m_shelves[bestShelf].h)
+            bestShelf = int(i);
+    }
+
+    // The shelf much higher than the picture is taken only if no other room left
+    if(bestShelf >= 0 && m_shelves[bestShelf].h > h + h / 2 && m_shelfTop + h <= m_h)
+        bestShelf = -1;
+
+    if(bestShelf < 0)
+    {
+        if(m_shelfTop + h > m_h)
+        {
+            if(bestFree < 0)
+                return false;
+
+            takeFree(bestFree, w, h, out);
+            return true;
+        }
+
+        Shelf_t s;
+        s.y = m_shelfTop;
+        s.h = h;
+        m_shelves.push_back(s);
+        m_shelfTop += h;
+        bestShelf = int(m_shelves.size() - 1);
+    }
+
+    Shelf_t &s = m_shelves[bestShelf];
+    out.x = s.usedW;
+    out.y = s.y;
+    out.w = w;
+    out.h = h;
+    s.usedW += w;
+
+    m_used++;
+    m_usedArea += long(w) * h;
+
+    return true;
+}
+
+void AtlasPacker::takeFree(int i, int w, int h, Rect_t &out)
+{
+    Rect_t place = m_free[i];
+    m_free[i] = m_free.back();
+    m_free.pop_back();
+
+    out = place;
+    out.w = w;
+    out.h = h;
+
+    // The rest of the place stays free
+    if(place.w > w)
+    {
+        Rect_t right = place;
+        right.x += w;
+        right.w -= w;
+        right.h = h;
+        m_free.push_back(right);
+    }
+
+    if(place.h > h)
+    {
+        Rect_t bottom = place;
+        bottom.y += h;
+        bottom.h -= h;
+        m_free.push_back(bottom);
+    }
+
+    m_used++;
+    m_usedArea += long(w) * h;
+}
+
+void AtlasPacker::release(const Rect_t &place)
+{
+    if(m_used <= 0)
+        return;
+
+    m_used--;
+    m_usedArea -= long(place.w) * place.h;
+
+    if(m_used == 0)
+    {
+        init(m_w, m_h);
+        return;
+    }
+
+    m_free.push_back(place);
+}
@@ -0,0 +1,99 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include <vector>
+
+/*!
+ * \brief Shelf packer of the small pictures into one big texture page
+ *
+ * Pictures are put left to right at the horizontal shelves, the new shelf
+ * gets opened below the last one when nothing fits. Released places are kept
+ * at the free list and given to the next picture of a fitting size (the rest
+ * of the place stays free), so the lazy-unloaded and reloaded textures come
+ * back into their old places.
+ * The whole page gets reset once the last picture is released.
+ */
+class AtlasPacker
+{
+public:
+    struct Rect_t
+    {
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+    };
+
+    /*!
+     * \brief Reset the packer for an empty page
+     * \param w Width of the page
+     * \param h Height of the page
+     */
+    void init(int w, int h);
+
+    /*!
+     * \brief Find a place for the picture
+     * \param w Width of the picture
+     * \param h Height of the picture
+     * \param out Place of the picture at the page
+     * \return false if the page has no room for the picture
+     */
+    bool insert(int w, int h, Rect_t &out);
+
+    //! Give the place back, it must be the same as returned by insert()
+    void release(const Rect_t &place);
+
+    //! Is nothing placed at the page
+    bool empty() const
+    {
+        return m_used == 0;
+    }
+
+    //! Area of the page taken by the pictures
+    long usedArea() const
+    {
+        return m_usedArea;
+    }
+
+private:
+    struct Shelf_t
+    {
+        int y = 0;
+        int h = 0;
+        int usedW = 0;
+    };
+
+    int m_w = 0;
+    int m_h = 0;
+    //! Top of the free area below the last shelf
+    int m_shelfTop = 0;
+    int m_used = 0;
+    long m_usedArea = 0;
+    std::vector<Shelf_t> m_shelves;
+    std::vector<Rect_t> m_free;
+
+    void takeFree(int i, int w, int h, Rect_t &out);
+};
+
+#endif // ATLAS_PACKER_H
@@ -39,6 +39,10 @@
 #include <pge_delay.h>
 
 #include <chrono>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <functional>
 
 #include "render_base.h"
 #include "../render.h"
@@ -46,15 +50,24 @@
 #include "globals.h"
 #include "sound.h"
 #include "graphics.h"
+#include "main/asset_pack.h"
+#include "texture_cache.h"
 
-#ifdef USE_SCREENSHOTS_AND_RECS
+#if defined(USE_SCREENSHOTS_AND_RECS) || defined(USE_LAZY_LOAD_THREADS)
 #include <deque>
 #endif
 
+#ifdef USE_LAZY_LOAD_THREADS
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_mutex.h>
+#endif
+
 
 AbstractRender_t* g_render = nullptr;
 
 size_t AbstractRender_t::m_lazyLoadedBytes = 0;
+uint32_t AbstractRender_t::m_lazyFrame = 1;
 int    AbstractRender_t::m_maxTextureWidth = 0;
 int    AbstractRender_t::m_maxTextureHeight = 0;
 
@@ -110,6 +123,11 @@ struct GifRecorder
 
 #endif // USE_SCREENSHOTS_AND_RECS
 
+#ifdef USE_LAZY_LOAD_THREADS
+static void s_lazyDecodeStart();
+static void s_lazyDecodeStop();
+#endif
+
 
 
 
@@ -135,6 +153,14 @@ bool AbstractRender_t::init()
 
 #ifdef USE_SCREENSHOTS_AND_RECS
     m_gif->init(this);
+#endif
+    if(g_videoSettings.textureCache)
+    {
+        TextureCache::init(AppPathManager::textureCacheDir(),
+                           uint64_t(g_videoSettings.textureCacheSize) * 1024 * 1024);
+    }
+#ifdef USE_LAZY_LOAD_THREADS
+    s_lazyDecodeStart();
 #endif
     return true;
 }
@@ -144,6 +170,10 @@ void AbstractRender_t::close()
 #ifdef USE_SCREENSHOTS_AND_RECS
     m_gif->quit();
 #endif
+#ifdef USE_LAZY_LOAD_THREADS
+    s_lazyDecodeStop();
+#endif
+    TextureCache::quit();
 }
 
 StdPicture AbstractRender_t::LoadPicture(const std::string &path,
@@ -326,7 +356,12 @@ StdPicture AbstractRender_t::lazyLoadPicture(const std::string &path,
     if(Files::hasSuffix(path, ".png"))
         useMask = false;
 
-    if(!GraphicsHelps::getImageMetrics(path, &tSize))
+    // the pack keeps the image size, so the file isn't touched at all
+    const AssetPack::Entry_t *packed = AssetPack::find(path);
+
+    if(packed && packed->w > 0 && packed->h > 0)
+        tSize.setSize(packed->w, packed->h);
+    else if(!GraphicsHelps::getImageMetrics(path, &tSize))
     {
         pLogWarning("Error loading of image file:\n"
                     "%s\n"
@@ -340,20 +375,46 @@ StdPicture AbstractRender_t::lazyLoadPicture(const std::string &path,
     target.w = tSize.w();
     target.h = tSize.h();
 
-    dumpFullFile(target.l.raw, path);
+    if(packed)
+    {
+        target.l.rawPacked = packed->data;
+        target.l.rawPackedSize = packed->size;
+    }
+    else
+        dumpFullFile(target.l.raw, path);
 
     //Apply Alpha mask
-    if(useMask && !maskPath.empty() && Files::fileExists(maskPath))
+    const AssetPack::Entry_t *packedMask = useMask ? AssetPack::find(maskPath) : nullptr;
+    const std::string *usedMaskPath = &maskPath;
+
+    if(useMask && !maskPath.empty() && (packedMask || Files::fileExists(maskPath)))
     {
-        dumpFullFile(target.l.rawMask, maskPath);
+        if(packedMask)
+        {
+            target.l.rawMaskPacked = packedMask->data;
+            target.l.rawMaskPackedSize = packedMask->size;
+        }
+        else
+            dumpFullFile(target.l.rawMask, maskPath);
         target.l.isMaskPng = false; //-V1048
     }
     else if(useMask && !maskFallbackPath.empty())
     {
-        dumpFullFile(target.l.rawMask, maskFallbackPath);
+        usedMaskPath = &maskFallbackPath;
+        packedMask = AssetPack::find(maskFallbackPath);
+        if(packedMask)
+        {
+            target.l.rawMaskPacked = packedMask->data;
+            target.l.rawMaskPackedSize = packedMask->size;
+        }
+        else
+            dumpFullFile(target.l.rawMask, maskFallbackPath);
         target.l.isMaskPng = true;
     }
 
+    if(TextureCache::isEnabled())
+        target.l.sourceKey = TextureCache::makeSourceKey(target.l, path, *usedMaskPath);
+
     target.inited = true;
     target.l.lazyLoaded = true;
     target.d.clear();
@@ -369,20 +430,122 @@ void AbstractRender_t::setTransparentColor(StdPicture& target, uint32_t rgb)
     target.l.keyRgb[2] = (rgb >> 16) & 0xFF;
 }
 
-void AbstractRender_t::lazyLoad(StdPicture &target)
+//! Lazy-loaded picture decoded and ready to upload
+struct LazyDecoded_t
 {
-    if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture())
-        return;
+    FIBITMAP *image = nullptr;
+    //! Size of the texture to upload
+    uint32_t w = 0;
+    uint32_t h = 0;
+    uint32_t pitch = 0;
+    //! Size of the picture itself
+    int frame_w = 0;
+    int frame_h = 0;
+    // Scaling data for the StdPictureLoad
+    int w_orig = 0;
+    int h_orig = 0;
+    float w_scale = 1.0f;
+    float h_scale = 1.0f;
+    RGBQUAD upperColor;
+    RGBQUAD lowerColor;
+    size_t bytes = 0;
+    //! Pixels taken from the texture cache, used when there is no image
+    std::vector<uint8_t> pixels;
+};
+
+static void s_colorToCache(uint8_t *dst, const RGBQUAD &c)
+{
+    dst[0] = c.rgbBlue;
+    dst[1] = c.rgbGreen;
+    dst[2] = c.rgbRed;
+    dst[3] = c.rgbReserved;
+}
+
+static void s_colorFromCache(RGBQUAD &c, const uint8_t *src)
+{
+    c.rgbBlue = src[0];
+    c.rgbGreen = src[1];
+    c.rgbRed = src[2];
+    c.rgbReserved = src[3];
+}
+
+//! Take the decoded picture from the texture cache
+static bool s_lazyFromCache(uint64_t key, int maxW, int maxH, LazyDecoded_t &out)
+{
+    TextureCache::Item_t item;
+
+    if(!TextureCache::load(key, maxW, maxH, item))
+        return false;
+
+    out.image = nullptr;
+    out.w = item.w;
+    out.h = item.h;
+    out.pitch = item.pitch;
+    out.frame_w = item.frame_w;
+    out.frame_h = item.frame_h;
+    out.w_orig = item.w_orig;
+    out.h_orig = item.h_orig;
+    out.w_scale = item.w_scale;
+    out.h_scale = item.h_scale;
+    s_colorFromCache(out.upperColor, item.upperColor);
+    s_colorFromCache(out.lowerColor, item.lowerColor);
+    out.bytes = size_t(item.bytes);
+    out.pixels.swap(item.pixels);
+
+    return true;
+}
+
+//! Put the decoded picture into the texture cache
+static void s_lazyToCache(uint64_t key, const LazyDecoded_t &d)
+{
+    TextureCache::Item_t item;
+
+    item.w = d.w;
+    item.h = d.h;
+    item.pitch = d.pitch;
+    item.frame_w = d.frame_w;
+    item.frame_h = d.frame_h;
+    item.w_orig = d.w_orig;
+    item.h_orig = d.h_orig;
+    item.w_scale = d.w_scale;
+    item.h_scale = d.h_scale;
+    s_colorToCache(item.upperColor, d.upperColor);
+    s_colorToCache(item.lowerColor, d.lowerColor);
+    item.bytes = d.bytes;
+
+    TextureCache::store(key, item, reinterpret_cast<const uint8_t *>(FreeImage_GetBits(d.image)));
+}
+
+/*!
+ * \brief Decode the compressed picture and prepare its pixels for the upload
+ *
+ * Touches nothing but its arguments, so it's safe to call from any thread
+ */
+static bool s_lazyDecode(StdPictureLoad &l, const std::string &origPath,
+                         bool scaleDownAll, int maxW, int maxH,
+                         LazyDecoded_t &out)
+{
+    (void)origPath; // used by debug builds only
+
+    uint64_t cacheKey = 0;
+    bool useCache = TextureCache::isEnabled() && l.sourceKey != 0;
+
+    if(useCache)
+    {
+        cacheKey = TextureCache::makeKey(l, scaleDownAll, maxW, maxH);
+        if(s_lazyFromCache(cacheKey, maxW, maxH, out))
+            return true;
+    }
 
-    FIBITMAP *sourceImage = GraphicsHelps::loadImage(target.l.raw);
+    FIBITMAP *sourceImage = GraphicsHelps::loadImage(l.rawData(), l.rawSize());
     if(!sourceImage)
     {
         pLogCritical("Lazy-decompress has failed: invalid image data");
-        return;
+        return false;
     }
 
-    if(!target.l.rawMask.empty())
-        GraphicsHelps::mergeWithMask(sourceImage, target.l.rawMask, target.l.isMaskPng);
+    if(l.hasMask())
+        GraphicsHelps::mergeWithMask(sourceImage, l.rawMaskData(), l.rawMaskSize(), l.isMaskPng);
 
     uint32_t w = static_cast<uint32_t>(FreeImage_GetWidth(sourceImage));
     uint32_t h = static_cast<uint32_t>(FreeImage_GetHeight(sourceImage));
@@ -395,78 +558,71 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
                     "Reason: %s."
                     "Zero image size!");
         //target = g_renderer->getDummyTexture();
-        return;
+        return false;
     }
 
-    m_lazyLoadedBytes += (w * h * 4);
-    if(!target.l.rawMask.empty())
-        m_lazyLoadedBytes += (w * h * 4);
+    out.bytes = (w * h * 4);
+    if(l.hasMask())
+        out.bytes += (w * h * 4);
 
-    RGBQUAD upperColor;
-    FreeImage_GetPixelColor(sourceImage, 0, 0, &upperColor);
-    target.ColorUpper.r = float(upperColor.rgbRed) / 255.0f;
-    target.ColorUpper.b = float(upperColor.rgbBlue) / 255.0f;
-    target.ColorUpper.g = float(upperColor.rgbGreen) / 255.0f;
+    FreeImage_GetPixelColor(sourceImage, 0, 0, &out.upperColor);
+    FreeImage_GetPixelColor(sourceImage, 0, static_cast<unsigned int>(h - 1), &out.lowerColor);
 
-    RGBQUAD lowerColor;
-    FreeImage_GetPixelColor(sourceImage, 0, static_cast<unsigned int>(h - 1), &lowerColor);
-    target.ColorLower.r = float(lowerColor.rgbRed) / 255.0f;
-    target.ColorLower.b = float(lowerColor.rgbBlue) / 255.0f;
-    target.ColorLower.g = float(lowerColor.rgbGreen) / 255.0f;
-
-    if(target.l.colorKey) // Apply transparent color for key pixels
-    {
-        PGE_Pix colSrc = {target.l.keyRgb[0],
-                          target.l.keyRgb[1],
-                          target.l.keyRgb[2], 0xFF};
-        PGE_Pix colDst = {target.l.keyRgb[0],
-                          target.l.keyRgb[1],
-                          target.l.keyRgb[2], 0x00};
+    if(l.colorKey) // Apply transparent color for key pixels
+    {
+        PGE_Pix colSrc = {l.keyRgb[0],
+                          l.keyRgb[1],
+                          l.keyRgb[2], 0xFF};
+        PGE_Pix colDst = {l.keyRgb[0],
+                          l.keyRgb[1],
+                          l.keyRgb[2], 0x00};
         GraphicsHelps::replaceColor(sourceImage, colSrc, colDst);
     }
 
     FreeImage_FlipVertical(sourceImage);
-    target.w = static_cast<int>(w);
-    target.h = static_cast<int>(h);
-    target.frame_w = static_cast<int>(w);
-    target.frame_h = static_cast<int>(h);
-
-    bool shrink2x = g_videoSettings.scaleDownAllTextures;
+    out.frame_w = static_cast<int>(w);
+    out.frame_h = static_cast<int>(h);
+    out.w_orig = l.w_orig;
+    out.h_orig = l.h_orig;
+    out.w_scale = l.w_scale;
+    out.h_scale = l.h_scale;
+
+    bool shrink2x = scaleDownAll;
 #if !defined(VITA)
     if(!shrink2x)
-        shrink2x = GraphicsHelps::validateFor2xScaleDown(sourceImage, StdPictureGetOrigPath(target));
+        shrink2x = GraphicsHelps::validateFor2xScaleDown(sourceImage, origPath);
 #endif
 
     if(shrink2x)
     {
-        target.l.w_orig = int(w);
-        target.l.h_orig = int(h);
+        out.w_orig = int(w);
+        out.h_orig = int(h);
         w /= 2;
         h /= 2;
     }
 
-    bool wLimitExcited = m_maxTextureWidth > 0 && w > Uint32(m_maxTextureWidth);
-    bool hLimitExcited = m_maxTextureHeight > 0 && h > Uint32(m_maxTextureHeight);
+    bool wLimitExcited = maxW > 0 && w > Uint32(maxW);
+    bool hLimitExcited = maxH > 0 && h > Uint32(maxH);
 
     if(wLimitExcited || hLimitExcited || shrink2x)
     {
         if(!shrink2x)
         {
-            target.l.w_orig = int(w);
-            target.l.h_orig = int(h);
+            out.w_orig = int(w);
+            out.h_orig = int(h);
         }
 
         // WORKAROUND: down-scale too big textures
         if(wLimitExcited)
-            w = Uint32(m_maxTextureWidth);
+            w = Uint32(maxW);
         if(hLimitExcited)
-            h = Uint32(m_maxTextureHeight);
+            h = Uint32(maxH);
 
         if(wLimitExcited || hLimitExcited)
         {
             pLogWarning("Texture is too big for a given hardware limit (%dx%d). "
                         "Shrinking texture to %dx%d, quality may be distorted!",
-                        m_maxTextureWidth, m_maxTextureHeight,
+                        maxW, maxH,
                         w, h);
         }
 
@@ -477,16 +633,330 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
             sourceImage = d;
         }
 
-        target.l.w_scale = float(w) / float(target.l.w_orig);
-        target.l.h_scale = float(h) / float(target.l.h_orig);
-        pitch = FreeImage_GetPitch(d);
+        out.w_scale = float(w) / float(out.w_orig);
+        out.h_scale = float(h) / float(out.h_orig);
+        pitch = FreeImage_GetPitch(sourceImage);
     }
 
-    uint8_t *textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(sourceImage));
+    out.image = sourceImage;
+    out.w = w;
+    out.h = h;
+    out.pitch = pitch;
 
-    XRender::loadTexture(target, w, h, textura, pitch);
+    if(useCache)
+        s_lazyToCache(cacheKey, out);
 
-    GraphicsHelps::closeImage(sourceImage);
+    return true;
+}
+
+struct LazyHandleHash_t
+{
+    size_t operator()(const StdPictureHandle &h) const
+    {
+        size_t r = std::hash<const void*>()(h.texture);
+        r ^= std::hash<int>()(h.texture_id) + 0x9e3779b9 + (r << 6) + (r >> 2);
+        r ^= std::hash<int>()(h.atlas_x) + 0x9e3779b9 + (r << 6) + (r >> 2);
+        r ^= std::hash<int>()(h.atlas_y) + 0x9e3779b9 + (r << 6) + (r >> 2);
+        return r;
+    }
+};
+
+struct LazyResident_t
+{
+    //! The latest picture the texture got uploaded for, copies of it share the texture (null if destroyed)
+    StdPicture *owner = nullptr;
+    //! Size of the texture
+    size_t bytes = 0;
+};
+
+//! Textures of the lazy-loaded pictures, tracked by the texture itself as the pictures get copied
+static std::unordered_map<StdPictureHandle, LazyResident_t, LazyHandleHash_t> s_lazyResident;
+static size_t s_lazyResidentBytes = 0;
+//! Textures shared by many pictures (the atlas pages), they are never unloaded
+static size_t s_lazySharedBytes = 0;
+//! Frame of the latest budget check
+static uint32_t s_lazyTrimFrame = 0;
+
+//! Pictures drawn during these last frames are never unloaded (~5 seconds)
+static const uint32_t c_lazyIdleFrames = 325;
+//! Frames between the budget checks while it's exceeded by the recently drawn pictures only
+static const uint32_t c_lazyTrimInterval = 65;
+
+static void s_lazyTrack(StdPicture &target, size_t bytes)
+{
+    LazyResident_t &tracked = s_lazyResident[target.d.handle()];
+    s_lazyResidentBytes -= tracked.bytes;
+    tracked.owner = &target;
+    tracked.bytes = bytes;
+    s_lazyResidentBytes += bytes;
+}
+
+//! Upload the decoded picture into the texture, must be called from the render thread
+static void s_lazyUpload(StdPicture &target, LazyDecoded_t &d)
+{
+    target.ColorUpper.r = float(d.upperColor.rgbRed) / 255.0f;
+    target.ColorUpper.b = float(d.upperColor.rgbBlue) / 255.0f;
+    target.ColorUpper.g = float(d.upperColor.rgbGreen) / 255.0f;
+
+    target.ColorLower.r = float(d.lowerColor.rgbRed) / 255.0f;
+    target.ColorLower.b = float(d.lowerColor.rgbBlue) / 255.0f;
+    target.ColorLower.g = float(d.lowerColor.rgbGreen) / 255.0f;
+
+    target.w = d.frame_w;
+    target.h = d.frame_h;
+    target.frame_w = d.frame_w;
+    target.frame_h = d.frame_h;
+
+    target.l.w_orig = d.w_orig;
+    target.l.h_orig = d.h_orig;
+    target.l.w_scale = d.w_scale;
+    target.l.h_scale = d.h_scale;
+
+    if(d.image)
+    {
+        uint8_t *textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(d.image));
+        XRender::loadTexture(target, d.w, d.h, textura, d.pitch);
+        GraphicsHelps::closeImage(d.image);
+        d.image = nullptr;
+    }
+    else
+    {
+        XRender::loadTexture(target, d.w, d.h, d.pixels.data(), d.pitch);
+        d.pixels.clear();
+        d.pixels.shrink_to_fit();
+    }
+
+    // the atlas pictures take nothing beyond the already counted page
+    if(target.d.hasTexture())
+        s_lazyTrack(target, target.d.atlas_page >= 0 ? 0 : size_t(d.w) * d.h * 4);
+}
+
+
+#ifdef USE_LAZY_LOAD_THREADS
+
+struct LazyDecodeJob_t
+{
+    StdPicture *target = nullptr;
+    uint32_t ticket = 0;
+
+    // Copy of the source data, the picture itself may change while decoding
+    StdPictureLoad l;
+    std::string origPath;
+    bool scaleDownAll = false;
+    int maxW = 0;
+    int maxH = 0;
+
+    bool success = false;
+    LazyDecoded_t out;
+};
+
+static const int c_lazyDecodeMaxThreads = 4;
+
+static SDL_Thread *s_lazyDecodeThreads[c_lazyDecodeMaxThreads] = {};
+static int         s_lazyDecodeThreadsNum = 0;
+static SDL_mutex  *s_lazyDecodeMutex = nullptr;
+static SDL_cond   *s_lazyDecodeCond = nullptr;
+static bool        s_lazyDecodeQuit = false;
+
+//! Jobs waiting for a thread, guarded by the mutex
+static std::deque<LazyDecodeJob_t*>  s_lazyDecodeQueue;
+//! Jobs done by the threads, guarded by the mutex
+static std::vector<LazyDecodeJob_t*> s_lazyDecodeDone;
+//! Size of the done list, to not lock the mutex every time
+static SDL_atomic_t s_lazyDecodeDoneCount;
+
+//! Pictures being decoded and their tickets, used by the render thread only
+static std::unordered_map<StdPicture*, uint32_t> s_lazyDecodePending;
+static uint32_t s_lazyDecodeLastTicket = 0;
+
+static int s_lazyDecodeWorker(void *)
+{
+    SDL_LockMutex(s_lazyDecodeMutex);
+
+    while(true)
+    {
+        while(!s_lazyDecodeQuit && s_lazyDecodeQueue.empty())
+            SDL_CondWait(s_lazyDecodeCond, s_lazyDecodeMutex);
+
+        if(s_lazyDecodeQuit)
+            break;
+
+        LazyDecodeJob_t *job = s_lazyDecodeQueue.front();
+        s_lazyDecodeQueue.pop_front();
+        SDL_UnlockMutex(s_lazyDecodeMutex);
+
+        job->success = s_lazyDecode(job->l, job->origPath,
+                                    job->scaleDownAll, job->maxW, job->maxH,
+                                    job->out);
+
+        SDL_LockMutex(s_lazyDecodeMutex);
+        s_lazyDecodeDone.push_back(job);
+        SDL_AtomicSet(&s_lazyDecodeDoneCount, (int)s_lazyDecodeDone.size());
+    }
+
+    SDL_UnlockMutex(s_lazyDecodeMutex);
+
+    return 0;
+}
+
+static void s_lazyDecodeFree(LazyDecodeJob_t *job)
+{
+    if(job->out.image)
+        GraphicsHelps::closeImage(job->out.image);
+    delete job;
+}
+
+static void s_lazyDecodeStart()
+{
+    if(s_lazyDecodeThreadsNum > 0)
+        return;
+
+    // keep a core for the game itself
+    int threads = SDL_GetCPUCount() - 1;
+    if(threads > c_lazyDecodeMaxThreads)
+        threads = c_lazyDecodeMaxThreads;
+    if(threads < 1)
+        threads = 1;
+
+    s_lazyDecodeMutex = SDL_CreateMutex();
+    s_lazyDecodeCond = SDL_CreateCond();
+    s_lazyDecodeQuit = false;
+    SDL_AtomicSet(&s_lazyDecodeDoneCount, 0);
+
+    if(!s_lazyDecodeMutex || !s_lazyDecodeCond)
+    {
+        pLogWarning("Can't start the texture decoding threads: %s", SDL_GetError());
+        return;
+    }
+
+    for(int i = 0; i < threads; i++)
+    {
+        s_lazyDecodeThreads[i] = SDL_CreateThread(s_lazyDecodeWorker, "texture_decoder", nullptr);
+        if(!s_lazyDecodeThreads[i])
+        {
+            pLogWarning("Can't start the texture decoding thread: %s", SDL_GetError());
+            break;
+        }
+
+        s_lazyDecodeThreadsNum++;
+    }
+
+    pLogDebug("Started %d texture decoding threads", s_lazyDecodeThreadsNum);
+}
+
+static void s_lazyDecodeStop()
+{
+    if(s_lazyDecodeMutex)
+    {
+        SDL_LockMutex(s_lazyDecodeMutex);
+        s_lazyDecodeQuit = true;
+        SDL_CondBroadcast(s_lazyDecodeCond);
+        SDL_UnlockMutex(s_lazyDecodeMutex);
+    }
+
+    for(int i = 0; i < s_lazyDecodeThreadsNum; i++)
+    {
+        SDL_WaitThread(s_lazyDecodeThreads[i], nullptr);
+        s_lazyDecodeThreads[i] = nullptr;
+    }
+
+    s_lazyDecodeThreadsNum = 0;
+
+    for(LazyDecodeJob_t *job : s_lazyDecodeQueue)
+        s_lazyDecodeFree(job);
+    s_lazyDecodeQueue.clear();
+
+    for(LazyDecodeJob_t *job : s_lazyDecodeDone)
+        s_lazyDecodeFree(job);
+    s_lazyDecodeDone.clear();
+
+    s_lazyDecodePending.clear();
+    SDL_AtomicSet(&s_lazyDecodeDoneCount, 0);
+
+    if(s_lazyDecodeCond)
+        SDL_DestroyCond(s_lazyDecodeCond);
+    s_lazyDecodeCond = nullptr;
+
+    if(s_lazyDecodeMutex)
+        SDL_DestroyMutex(s_lazyDecodeMutex);
+    s_lazyDecodeMutex = nullptr;
+}
+
+void AbstractRender_t::lazyCollectDecoded()
+{
+    if(SDL_AtomicGet(&s_lazyDecodeDoneCount) == 0)
+        return;
+
+    std::vector<LazyDecodeJob_t*> done;
+
+    SDL_LockMutex(s_lazyDecodeMutex);
+    done.swap(s_lazyDecodeDone);
+    SDL_AtomicSet(&s_lazyDecodeDoneCount, 0);
+    SDL_UnlockMutex(s_lazyDecodeMutex);
+
+    for(LazyDecodeJob_t *job : done)
+    {
+        auto p = s_lazyDecodePending.find(job->target);
+        bool actual = p != s_lazyDecodePending.end() && p->second == job->ticket;
+
+        if(actual)
+        {
+            s_lazyDecodePending.erase(p);
+
+            StdPicture &target = *job->target;
+
+            // the picture might get unloaded or replaced while decoding
+            if(target.l.asyncTicket == job->ticket)
+            {
+                target.l.asyncTicket = 0;
+
+                if(job->success && target.inited && target.l.lazyLoaded && !target.d.hasTexture())
+                {
+                    m_lazyLoadedBytes += job->out.bytes;
+                    s_lazyUpload(target, job->out);
+                    lazyTouch(target);
+                }
+            }
+        }
+
+        s_lazyDecodeFree(job);
+    }
+}
+
+#endif // USE_LAZY_LOAD_THREADS
+
+
+void AbstractRender_t::lazyLoad(StdPicture &target)
+{
+    if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture())
+        return;
+
+#ifdef USE_LAZY_LOAD_THREADS
+    if(target.l.asyncTicket != 0)
+    {
+        auto p = s_lazyDecodePending.find(&target);
+        if(p != s_lazyDecodePending.end() && p->second == target.l.asyncTicket)
+        {
+            lazyCollectDecoded();
+            // still decoding: skip it for now, it will be drawn at one of the next frames
+            return;
+        }
+
+        // a copy of the picture being decoded somewhere else
+        target.l.asyncTicket = 0;
+    }
+#endif
+
+    LazyDecoded_t d;
+
+    if(!s_lazyDecode(target.l, StdPictureGetOrigPath(target),
+                     g_videoSettings.scaleDownAllTextures, m_maxTextureWidth, m_maxTextureHeight,
+                     d))
+        return;
+
+    m_lazyLoadedBytes += d.bytes;
+    s_lazyUpload(target, d);
+    lazyTouch(target);
 }
 
 void AbstractRender_t::lazyUnLoad(StdPicture &target)
@@ -494,10 +964,47 @@ void AbstractRender_t::lazyUnLoad(StdPicture &target)
     if(!target.inited || !target.l.lazyLoaded || !target.d.hasTexture())
         return;
     XRender::deleteTexture(target, true);
+    lazyForget(target);
 }
 
 void AbstractRender_t::lazyPreLoad(StdPicture &target)
 {
+#ifdef USE_LAZY_LOAD_THREADS
+    if(s_lazyDecodeThreadsNum > 0)
+    {
+        lazyCollectDecoded();
+
+        if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture())
+            return;
+
+        auto p = s_lazyDecodePending.find(&target);
+        if(target.l.asyncTicket != 0 && p != s_lazyDecodePending.end() && p->second == target.l.asyncTicket)
+            return; // already in progress
+
+        if(++s_lazyDecodeLastTicket == 0)
+            s_lazyDecodeLastTicket = 1;
+
+        LazyDecodeJob_t *job = new LazyDecodeJob_t;
+        job->target = &target;
+        job->ticket = s_lazyDecodeLastTicket;
+        job->l = target.l;
+        job->origPath = StdPictureGetOrigPath(target);
+        job->scaleDownAll = g_videoSettings.scaleDownAllTextures;
+        job->maxW = m_maxTextureWidth;
+        job->maxH = m_maxTextureHeight;
+
+        target.l.asyncTicket = job->ticket;
+        s_lazyDecodePending[&target] = job->ticket;
+
+        SDL_LockMutex(s_lazyDecodeMutex);
+        s_lazyDecodeQueue.push_back(job);
+        SDL_CondSignal(s_lazyDecodeCond);
+        SDL_UnlockMutex(s_lazyDecodeMutex);
+
+        return;
+    }
+#endif
+
     if(!target.d.hasTexture() && target.l.lazyLoaded)
         lazyLoad(target);
 }
@@ -507,11 +1014,155 @@ size_t AbstractRender_t::lazyLoadedBytes()
     return m_lazyLoadedBytes;
 }
 
+TextureCache::Counters_t AbstractRender_t::lazyCacheCounters()
+{
+    return TextureCache::counters();
+}
+
 void AbstractRender_t::lazyLoadedBytesReset()
 {
     m_lazyLoadedBytes = 0;
 }
 
+size_t AbstractRender_t::lazyResidentBytes()
+{
+    return s_lazyResidentBytes + s_lazySharedBytes;
+}
+
+//! Are the lazy-loading records still alive? The pictures are destroyed at the exit too
+static bool s_lazyRecordsAlive = true;
+
+//! Declared after all lazy-loading records, so it's destroyed before them
+static struct LazyRecordsGuard_t
+{
+    ~LazyRecordsGuard_t()
+    {
+        s_lazyRecordsAlive = false;
+    }
+} s_lazyRecordsGuard;
+
+//! Forget the background decoding of the picture, its result gets dropped when done
+static void s_lazyDecodeCancel(StdPicture &target)
+{
+#ifdef USE_LAZY_LOAD_THREADS
+    if(target.l.asyncTicket == 0)
+        return;
+
+    auto p = s_lazyDecodePending.find(&target);
+    if(p != s_lazyDecodePending.end() && p->second == target.l.asyncTicket)
+        s_lazyDecodePending.erase(p);
+#endif
+
+    target.l.asyncTicket = 0;
+}
+
+void StdPictureDestroyed(StdPicture &target)
+{
+    if(!s_lazyRecordsAlive)
+        return;
+
+    s_lazyDecodeCancel(target);
+
+    // the texture stays counted until deleted, but it can't be unloaded through this picture anymore
+    if(target.d.hasTexture())
+    {
+        auto it = s_lazyResident.find(target.d.handle());
+        if(it != s_lazyResident.end() && it->second.owner == &target)
+            it->second.owner = nullptr;
+    }
+}
+
+void AbstractRender_t::lazyForget(StdPicture &target)
+{
+    s_lazyDecodeCancel(target);
+
+    if(!target.d.hasTexture())
+        return;
+
+    auto it = s_lazyResident.find(target.d.handle());
+    if(it == s_lazyResident.end())
+        return;
+
+    s_lazyResidentBytes -= it->second.bytes;
+    s_lazyResident.erase(it);
+}
+
+void AbstractRender_t::lazyForgetAll()
+{
+    s_lazyResident.clear();
+    s_lazyResidentBytes = 0;
+    s_lazySharedBytes = 0;
+}
+
+void AbstractRender_t::lazyTrackShared(int64_t bytes)
+{
+    if(bytes < 0 && size_t(-bytes) > s_lazySharedBytes)
+        s_lazySharedBytes = 0;
+    else
+        s_lazySharedBytes = size_t(int64_t(s_lazySharedBytes) + bytes);
+}
+
+void AbstractRender_t::lazyTrimResident()
+{
+    m_lazyFrame++;
+
+    size_t budget = size_t(g_videoSettings.textureMemoryBudget) * 1024 * 1024;
+
+    if(budget == 0 || lazyResidentBytes() <= budget)
+        return;
+
+    if(m_lazyFrame - s_lazyTrimFrame < c_lazyTrimInterval)
+        return;
+
+    s_lazyTrimFrame = m_lazyFrame;
+
+    std::vector<std::pair<uint32_t, StdPicture*>> idle;
+
+    for(auto &r : s_lazyResident)
+    {
+        StdPicture *p = r.second.owner;
+
+        // The texture is alive (it gets forgotten on deletion), but its picture is destroyed
+        // or keeps another texture now, while a copy keeps this one (like the backup of the
+        // replaced default GFX): unloading it through the picture would leave the copy with
+        // the deleted texture
+        if(!p || !(p->d.handle() == r.first))
+            continue;
+
+        // unloading the atlas pictures frees nothing
+        if(!p->inited || !p->l.lazyLoaded || r.second.bytes == 0)
+            continue;
+
+        if(m_lazyFrame - p->l.lastDrawFrame > c_lazyIdleFrames)
+            idle.push_back({p->l.lastDrawFrame, p});
+    }
+
+    std::sort(idle.begin(), idle.end(),
+              [](const std::pair<uint32_t, StdPicture*> &a, const std::pair<uint32_t, StdPicture*> &b)
+              {
+                  return m_lazyFrame - a.first > m_lazyFrame - b.first;
+              });
+
+    // Free a bit more than needed, to not unload at every check
+    size_t target = budget - budget / 10;
+    int unloaded = 0;
+
+    for(auto &i : idle)
+    {
+        if(lazyResidentBytes() <= target)
+            break;
+
+        lazyUnLoad(*i.second);
+        unloaded++;
+    }
+
+    if(unloaded > 0)
+    {
+        pLogDebug("Texture budget: unloaded %d pictures, %u KiB of %u KiB are resident now",
+                  unloaded, unsigned(lazyResidentBytes() / 1024), unsigned(budget / 1024));
+    }
+}
+
 
 #ifdef USE_RENDER_BLOCKING
 bool AbstractRender_t::renderBlocked()
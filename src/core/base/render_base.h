@@ -25,6 +25,7 @@
 #include <string>
 
 #include "std_picture.h"
+#include "texture_cache.h"
 
 #ifndef __EMSCRIPTEN__
 #   define USE_SCREENSHOTS_AND_RECS
@@ -36,6 +37,10 @@ struct GifRecorder;
 #   define USE_RENDER_BLOCKING
 #endif
 
+#ifndef PGE_NO_THREADING
+#   define USE_LAZY_LOAD_THREADS
+#endif
+
 #ifdef __ANDROID__
 #   define RENDER_FULLSCREEN_ALWAYS
 #endif
@@ -65,6 +70,11 @@ class AbstractRender_t
 
     static size_t m_lazyLoadedBytes;
 
+#ifdef USE_LAZY_LOAD_THREADS
+    //! Upload the pictures decoded by the background threads
+    static void lazyCollectDecoded();
+#endif
+
 protected:
     //! Maximum texture width
     static int    m_maxTextureWidth;
@@ -78,6 +88,30 @@ protected:
     static bool m_blockRender;
 #endif
 
+    //! Counter of the repainted frames, used to find the long unused textures
+    static uint32_t m_lazyFrame;
+
+    //! Mark the lazy-loaded picture as drawn at the current frame
+    static inline void lazyTouch(StdPicture &target)
+    {
+        target.l.lastDrawFrame = m_lazyFrame;
+    }
+
+    //! Stop tracking the texture and the background decoding of the picture, must be called when it gets deleted
+    static void lazyForget(StdPicture &target);
+    //! Stop tracking all textures, must be called when all of them get deleted
+    static void lazyForgetAll();
+    //! Count the textures shared by many pictures (like the atlas pages) at the memory budget, negative to uncount
+    static void lazyTrackShared(int64_t bytes);
+
+    /*!
+     * \brief Count the repainted frame and keep the textures within the memory budget
+     *
+     * When the lazy-loaded textures take more than the budget, the ones not drawn
+     * for a while get unloaded, starting from the least recently drawn
+     */
+    static void lazyTrimResident();
+
 public:
     AbstractRender_t();
     virtual ~AbstractRender_t();
@@ -199,10 +233,21 @@ public:
 
     static void lazyLoad(StdPicture &target);
     static void lazyUnLoad(StdPicture &target);
+    /*!
+     * \brief Prepare the texture before it will be drawn
+     * \param target Lazy-loaded picture, must stay at its place until the texture gets loaded
+     *
+     * When the decoding threads are available, the picture gets decoded in background,
+     * and gets uploaded by the next lazyLoad() call once ready. Until then, it's not drawn.
+     */
     static void lazyPreLoad(StdPicture &target);
 
     static size_t lazyLoadedBytes();
     static void lazyLoadedBytesReset();
+    //! Memory taken by the textures of the lazy-loaded pictures and by the shared textures
+    static size_t lazyResidentBytes();
+    //! Counters of the on-disk cache of the decoded textures
+    static TextureCache::Counters_t lazyCacheCounters();
 
     virtual void deleteTexture(StdPicture &tx, bool lazyUnload = false) = 0;
     virtual void clearAllTextures() = 0;
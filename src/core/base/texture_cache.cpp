@@ -0,0 +1,577 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef PGE_NO_THREADING
+#   include <SDL2/SDL_mutex.h>
+#endif
+
+#include <DirManager/dirman.h>
+#include <Logger/logger.h>
+#include <Utils/files.h>
+
+#include "texture_cache.h"
+#include "core/picture_load.h"
+
+/*
+ * Every picture is kept at its own file "<key>.xtc", numbers are in the
+ * native byte order, the cache is never shared between machines:
+ *
+ * FileHeader_t  header
+ * uint8[]       pixels, header.h rows of the header.pitch size
+ *
+ * The "index.dat" file keeps the size and the last use of every picture:
+ *
+ * char[8]       magic "XTCIDX1\0"
+ * uint64        use counter
+ * uint32        count of entries
+ * IndexEntry_t[count]
+ */
+
+namespace TextureCache
+{
+
+//! Change it every time the decoding result changes
+static const uint32_t s_version = 2;
+
+static const char s_fileMagic[8] = {'X', 'T', 'C', 'T', 'E', 'X', '1', '\0'};
+static const char s_indexMagic[8] = {'X', 'T', 'C', 'I', 'D', 'X', '1', '\0'};
+static const char *const s_fileSuffix = ".xtc";
+static const char *const s_indexFile = "index.dat";
+
+//! Side limit of the cached picture when the texture has no limit
+static const uint32_t s_maxSide = 16384;
+
+//! The size gets shrank below this part of the limit when exceeded, to not evict at every store
+static const double s_evictTarget = 0.9;
+
+struct FileHeader_t
+{
+    char     magic[8];
+    uint64_t key;
+    uint32_t w;
+    uint32_t h;
+    uint32_t pitch;
+    int32_t  frame_w;
+    int32_t  frame_h;
+    int32_t  w_orig;
+    int32_t  h_orig;
+    float    w_scale;
+    float    h_scale;
+    uint8_t  upperColor[4];
+    uint8_t  lowerColor[4];
+    uint64_t bytes;
+    uint64_t dataSize;
+};
+
+struct IndexEntry_t
+{
+    uint64_t key;
+    uint64_t size;
+    uint64_t lastUse;
+};
+
+static bool s_enabled = false;
+static std::string s_dir;
+static uint64_t s_maxBytes = 0;
+
+#ifndef PGE_NO_THREADING
+static SDL_mutex *s_mutex = nullptr;
+#endif
+
+// Guarded by the mutex
+//! Size and the last use of every picture at the disk
+static std::unordered_map<uint64_t, IndexEntry_t> s_index;
+//! Pictures being written right now
+static std::unordered_set<uint64_t> s_writing;
+static uint64_t s_useCounter = 0;
+static Counters_t s_counters;
+
+
+static inline void s_lock()
+{
+#ifndef PGE_NO_THREADING
+    SDL_LockMutex(s_mutex);
+#endif
+}
+
+static inline void s_unlock()
+{
+#ifndef PGE_NO_THREADING
+    SDL_UnlockMutex(s_mutex);
+#endif
+}
+
+static std::string s_filePath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 "%s", key, s_fileSuffix);
+    return s_dir + name;
+}
+
+static inline void s_hash(uint64_t &h, const void *data, size_t size)
+{
+    // FNV-1a
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+}
+
+template<class T>
+static inline void s_hashValue(uint64_t &h, const T &value)
+{
+    s_hash(h, &value, sizeof(value));
+}
+
+static bool s_readIndex()
+{
+    FILE *f = Files::utf8_fopen((s_dir + s_indexFile).c_str(), "rb");
+    if(!f)
+        return false;
+
+    char magic[8];
+    uint64_t counter = 0;
+    uint32_t count = 0;
+
+    bool ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+           && std::memcmp(magic, s_indexMagic, sizeof(magic)) == 0
+           && fread(&counter, sizeof(counter), 1, f) == 1
+           && fread(&count, sizeof(count), 1, f) == 1;
+
+    if(ok)
+    {
+        std::vector<IndexEntry_t> entries(count);
+        ok = count == 0 || fread(entries.data(), sizeof(IndexEntry_t), count, f) == count;
+
+        if(ok)
+        {
+            s_useCounter = counter;
+            for(const auto &e : entries)
+                s_index[e.key] = e;
+        }
+    }
+
+    fclose(f);
+
+    return ok;
+}
+
+static void s_writeIndex()
+{
+    FILE *f = Files::utf8_fopen((s_dir + s_indexFile).c_str(), "wb");
+    if(!f)
+    {
+        pLogWarning("TextureCache: Can't write the index at %s", s_dir.c_str());
+        return;
+    }
+
+    uint32_t count = uint32_t(s_index.size());
+
+    fwrite(s_indexMagic, 1, sizeof(s_indexMagic), f);
+    fwrite(&s_useCounter, sizeof(s_useCounter), 1, f);
+    fwrite(&count, sizeof(count), 1, f);
+
+    for(const auto &e : s_index)
+        fwrite(&e.second, sizeof(IndexEntry_t), 1, f);
+
+    fclose(f);
+}
+
+//! Sync the index with the files at the directory
+static void s_scanDir()
+{
+    std::vector<std::string> files;
+    DirMan dir(s_dir);
+    dir.getListOfFiles(files, {s_fileSuffix});
+
+    std::unordered_set<uint64_t> onDisk;
+    onDisk.reserve(files.size());
+
+    for(const std::string &name : files)
+    {
+        uint64_t key = 0;
+        if(std::sscanf(name.c_str(), "%16" SCNx64, &key) != 1)
+            continue;
+
+        onDisk.insert(key);
+
+        if(s_index.find(key) != s_index.end())
+            continue;
+
+        // Written while the index didn't get saved (crash, etc.), take it as the oldest one
+        FILE *f = Files::utf8_fopen((s_dir + name).c_str(), "rb");
+        if(!f)
+            continue;
+
+        fseek(f, 0, SEEK_END);
+        IndexEntry_t e;
+        e.key = key;
+        e.size = uint64_t(ftell(f));
+        e.lastUse = 0;
+        fclose(f);
+
+        s_index[key] = e;
+    }
+
+    for(auto it = s_index.begin(); it != s_index.end();)
+    {
+        if(onDisk.find(it->first) == onDisk.end())
+            it = s_index.erase(it);
+        else
+            ++it;
+    }
+}
+
+//! Remove the least recently used pictures until the cache fits the limit, the mutex must be locked
+static void s_evict()
+{
+    if(s_counters.diskBytes <= s_maxBytes)
+        return;
+
+    std::vector<IndexEntry_t> entries;
+    entries.reserve(s_index.size());
+    for(const auto &e : s_index)
+        entries.push_back(e.second);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const IndexEntry_t &a, const IndexEntry_t &b)
+              {
+                  return a.lastUse < b.lastUse;
+              });
+
+    uint64_t target = uint64_t(double(s_maxBytes) * s_evictTarget);
+
+    for(const auto &e : entries)
+    {
+        if(s_counters.diskBytes <= target)
+            break;
+
+        Files::deleteFile(s_filePath(e.key));
+        s_index.erase(e.key);
+        s_counters.diskBytes -= e.size;
+        s_counters.evicted++;
+    }
+
+    s_counters.files = uint32_t(s_index.size());
+}
+
+void init(const std::string &dir, uint64_t maxBytes)
+{
+    quit();
+
+    s_dir = dir;
+    if(!s_dir.empty() && s_dir.back() != '/')
+        s_dir.push_back('/');
+
+    if(!DirMan::exists(s_dir) && !DirMan::mkAbsPath(s_dir))
+    {
+        pLogWarning("TextureCache: Can't create the directory %s, the cache is disabled", s_dir.c_str());
+        return;
+    }
+
+#ifndef PGE_NO_THREADING
+    s_mutex = SDL_CreateMutex();
+    if(!s_mutex)
+    {
+        pLogWarning("TextureCache: Can't create the mutex, the cache is disabled");
+        return;
+    }
+#endif
+
+    s_maxBytes = maxBytes;
+    s_counters = Counters_t();
+
+    if(!s_readIndex())
+        s_index.clear();
+
+    s_scanDir();
+
+    for(const auto &e : s_index)
+        s_counters.diskBytes += e.second.size;
+    s_counters.files = uint32_t(s_index.size());
+
+    s_evict();
+    s_counters.evicted = 0;
+
+    s_enabled = true;
+
+    pLogDebug("TextureCache: %u pictures, %" PRIu64 " of %" PRIu64 " bytes at %s",
+              s_counters.files, s_counters.diskBytes, s_maxBytes, s_dir.c_str());
+}
+
+void quit()
+{
+    if(!s_enabled)
+        return;
+
+    s_lock();
+    s_writeIndex();
+    pLogDebug("TextureCache: %u hits, %u misses, %u stored, %u evicted",
+              s_counters.hits, s_counters.misses, s_counters.stored, s_counters.evicted);
+    s_enabled = false;
+    s_index.clear();
+    s_unlock();
+
+#ifndef PGE_NO_THREADING
+    SDL_DestroyMutex(s_mutex);
+    s_mutex = nullptr;
+#endif
+}
+
+bool isEnabled()
+{
+    return s_enabled;
+}
+
+static void s_hashSource(uint64_t &h, const std::string &path, const char *data, size_t size)
+{
+    int64_t mtime = 0, fileSize = 0;
+
+    s_hashValue(h, uint64_t(path.size()));
+    s_hash(h, path.data(), path.size());
+
+    if(!path.empty() && Files::fileInfo(path, &mtime, &fileSize))
+    {
+        s_hashValue(h, mtime);
+        s_hashValue(h, fileSize);
+    }
+    else
+    {
+        s_hashValue(h, uint64_t(size));
+        s_hash(h, data, size);
+    }
+}
+
+uint64_t makeSourceKey(const StdPictureLoad &l, const std::string &path, const std::string &maskPath)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    s_hashSource(h, path, l.rawData(), l.rawSize());
+
+    if(l.hasMask())
+        s_hashSource(h, maskPath, l.rawMaskData(), l.rawMaskSize());
+    else
+        s_hashValue(h, uint64_t(0));
+
+    // zero is reserved for the unknown source
+    return h ? h : 1;
+}
+
+uint64_t makeKey(const StdPictureLoad &l, bool scaleDownAll, int maxW, int maxH)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    s_hashValue(h, s_version);
+    s_hashValue(h, l.sourceKey);
+    s_hashValue(h, uint8_t(l.isMaskPng));
+    s_hashValue(h, uint8_t(l.colorKey));
+    s_hash(h, l.keyRgb, sizeof(l.keyRgb));
+    s_hashValue(h, uint8_t(scaleDownAll));
+    s_hashValue(h, int32_t(maxW));
+    s_hashValue(h, int32_t(maxH));
+
+    return h;
+}
+
+//! Is the header sane enough to trust its sizes?
+static bool s_headerValid(const FileHeader_t &head, int maxW, int maxH)
+{
+    uint32_t limW = maxW > 0 ? uint32_t(maxW) : s_maxSide;
+    uint32_t limH = maxH > 0 ? uint32_t(maxH) : s_maxSide;
+
+    return head.w > 0 && head.h > 0
+        && head.w <= limW && head.h <= limH
+        && head.pitch >= head.w * 4
+        && head.pitch <= head.w * 4 + 64
+        && head.frame_w > 0 && head.frame_h > 0
+        && head.dataSize == uint64_t(head.pitch) * head.h;
+}
+
+bool load(uint64_t key, int maxW, int maxH, Item_t &out)
+{
+    if(!s_enabled)
+        return false;
+
+    s_lock();
+    auto it = s_index.find(key);
+    bool found = it != s_index.end();
+    if(found)
+        it->second.lastUse = ++s_useCounter;
+    else
+        s_counters.misses++;
+    s_unlock();
+
+    if(!found)
+        return false;
+
+    FILE *f = Files::utf8_fopen(s_filePath(key).c_str(), "rb");
+
+    FileHeader_t head;
+    bool ok = f && fread(&head, sizeof(head), 1, f) == 1
+            && std::memcmp(head.magic, s_fileMagic, sizeof(s_fileMagic)) == 0
+            && head.key == key
+            && s_headerValid(head, maxW, maxH);
+
+    if(ok)
+    {
+        out.pixels.resize(size_t(head.dataSize));
+        ok = fread(out.pixels.data(), 1, out.pixels.size(), f) == out.pixels.size();
+    }
+
+    if(f)
+        fclose(f);
+
+    s_lock();
+
+    if(!ok)
+    {
+        // Broken, insane or removed meanwhile
+        it = s_index.find(key);
+        if(it != s_index.end())
+        {
+            s_counters.diskBytes -= it->second.size;
+            s_index.erase(it);
+            s_counters.files = uint32_t(s_index.size());
+        }
+
+        s_counters.misses++;
+        s_unlock();
+
+        Files::deleteFile(s_filePath(key));
+        out.pixels.clear();
+        return false;
+    }
+
+    s_counters.hits++;
+    s_unlock();
+
+    out.w = head.w;
+    out.h = head.h;
+    out.pitch = head.pitch;
+    out.frame_w = head.frame_w;
+    out.frame_h = head.frame_h;
+    out.w_orig = head.w_orig;
+    out.h_orig = head.h_orig;
+    out.w_scale = head.w_scale;
+    out.h_scale = head.h_scale;
+    std::memcpy(out.upperColor, head.upperColor, sizeof(out.upperColor));
+    std::memcpy(out.lowerColor, head.lowerColor, sizeof(out.lowerColor));
+    out.bytes = head.bytes;
+
+    return true;
+}
+
+void store(uint64_t key, const Item_t &item, const uint8_t *pixels)
+{
+    if(!s_enabled)
+        return;
+
+    FileHeader_t head;
+    std::memset(&head, 0, sizeof(head));
+    std::memcpy(head.magic, s_fileMagic, sizeof(s_fileMagic));
+    head.key = key;
+    head.w = item.w;
+    head.h = item.h;
+    head.pitch = item.pitch;
+    head.frame_w = item.frame_w;
+    head.frame_h = item.frame_h;
+    head.w_orig = item.w_orig;
+    head.h_orig = item.h_orig;
+    head.w_scale = item.w_scale;
+    head.h_scale = item.h_scale;
+    std::memcpy(head.upperColor, item.upperColor, sizeof(head.upperColor));
+    std::memcpy(head.lowerColor, item.lowerColor, sizeof(head.lowerColor));
+    head.bytes = item.bytes;
+    head.dataSize = uint64_t(item.pitch) * item.h;
+
+    uint64_t fileSize = sizeof(head) + head.dataSize;
+
+    // Never keep a picture that takes a big part of the cache alone
+    if(fileSize > s_maxBytes / 4)
+        return;
+
+    s_lock();
+    bool skip = s_index.find(key) != s_index.end() || s_writing.find(key) != s_writing.end();
+    if(!skip)
+        s_writing.insert(key);
+    s_unlock();
+
+    if(skip)
+        return;
+
+    std::string path = s_filePath(key);
+    FILE *f = Files::utf8_fopen(path.c_str(), "wb");
+
+    bool ok = f && fwrite(&head, sizeof(head), 1, f) == 1
+            && fwrite(pixels, 1, size_t(head.dataSize), f) == size_t(head.dataSize);
+
+    if(f)
+        ok &= fclose(f) == 0;
+
+    if(!ok)
+    {
+        pLogWarning("TextureCache: Can't write the picture %s", path.c_str());
+        Files::deleteFile(path);
+    }
+
+    s_lock();
+    s_writing.erase(key);
+
+    if(ok)
+    {
+        IndexEntry_t e;
+        e.key = key;
+        e.size = fileSize;
+        e.lastUse = ++s_useCounter;
+        s_index[key] = e;
+
+        s_counters.stored++;
+        s_counters.diskBytes += fileSize;
+        s_counters.files = uint32_t(s_index.size());
+
+        s_evict();
+    }
+
+    s_unlock();
+}
+
+Counters_t counters()
+{
+    if(!s_enabled)
+        return Counters_t();
+
+    s_lock();
+    Counters_t ret = s_counters;
+    s_unlock();
+
+    return ret;
+}
+
+} // namespace TextureCache
@@ -0,0 +1,132 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module keeps the decoded lazy-loaded pictures on the disk, ready
+// to be uploaded into the texture, so the next runs don't decode them again
+
+#pragma once
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct StdPictureLoad;
+
+namespace TextureCache
+{
+
+//! Decoded picture as it's kept at the cache
+struct Item_t
+{
+    //! Size of the texture to upload
+    uint32_t w = 0;
+    uint32_t h = 0;
+    uint32_t pitch = 0;
+    //! Size of the picture itself
+    int32_t frame_w = 0;
+    int32_t frame_h = 0;
+    // Scaling data for the StdPictureLoad
+    int32_t w_orig = 0;
+    int32_t h_orig = 0;
+    float w_scale = 1.0f;
+    float h_scale = 1.0f;
+    //! Colors of the top-left and bottom-left pixels as BGRA
+    uint8_t upperColor[4] = {};
+    uint8_t lowerColor[4] = {};
+    //! Memory taken by the picture, as counted by lazyLoadedBytes()
+    uint64_t bytes = 0;
+    //! Pixels of the texture (h rows of the pitch size)
+    std::vector<uint8_t> pixels;
+};
+
+struct Counters_t
+{
+    //! Pictures taken from the cache
+    uint32_t hits = 0;
+    //! Pictures not found at the cache
+    uint32_t misses = 0;
+    //! Pictures written into the cache
+    uint32_t stored = 0;
+    //! Pictures removed to fit the size limit
+    uint32_t evicted = 0;
+    //! Count and total size of the cache files
+    uint32_t files = 0;
+    uint64_t diskBytes = 0;
+};
+
+/*!
+ * \brief Open the cache directory and read its index
+ * \param dir Cache directory, gets created if not exists
+ * \param maxBytes Limit of the cache size, the least recently used pictures get removed over it
+ */
+void init(const std::string &dir, uint64_t maxBytes);
+
+//! Write the index and close the cache
+void quit();
+
+bool isEnabled();
+
+/*!
+ * \brief Make the key of the source files of the picture
+ * \param l Compressed picture
+ * \param path Path to the front image
+ * \param maskPath Path to the mask image, used if the picture has a mask
+ * \return Hash of the paths, modification times and sizes of the files
+ *
+ * Files absent at the disk (taken from the asset pack only) are keyed by their content
+ */
+uint64_t makeSourceKey(const StdPictureLoad &l, const std::string &path, const std::string &maskPath);
+
+/*!
+ * \brief Make the key of the decoded picture
+ * \param l Compressed picture and its loading settings, with the source key filled
+ * \param scaleDownAll Is the 2x down-scale of all textures enabled
+ * \param maxW Texture width limit
+ * \param maxH Texture height limit
+ * \return Hash of the source key and of all settings that affect the decoding result
+ */
+uint64_t makeKey(const StdPictureLoad &l, bool scaleDownAll, int maxW, int maxH);
+
+/*!
+ * \brief Read the decoded picture, thread-safe
+ * \param key Key of the picture
+ * \param maxW Texture width limit, 0 if none
+ * \param maxH Texture height limit, 0 if none
+ * \param out Picture to fill
+ * \return true if the picture has been found and is valid, invalid ones get removed
+ */
+bool load(uint64_t key, int maxW, int maxH, Item_t &out);
+
+/*!
+ * \brief Write the decoded picture, thread-safe
+ * \param key Key of the picture
+ * \param item Picture header, its pixels vector is ignored
+ * \param pixels Pixels of the texture, item.h rows of the item.pitch size
+ */
+void store(uint64_t key, const Item_t &item, const uint8_t *pixels);
+
+Counters_t counters();
+
+} // namespace TextureCache
+
+#endif // TEXTURE_CACHE_H
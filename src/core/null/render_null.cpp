@@ -0,0 +1,438 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_stdinc.h>
+#include <SDL2/SDL_opengl.h>
+#include <cstring>
+
+#include <Logger/logger.h>
+#include <Utils/maths.h>
+
+#include "render_null.h"
+#include "video.h"
+#include "frame_timer.h"
+
+#ifndef UNUSED
+#define UNUSED(x) (void)x
+#endif
+
+
+RenderNull::RenderNull() :
+    AbstractRender_t()
+{}
+
+RenderNull::~RenderNull()
+{
+    if(m_isWorking)
+        RenderNull::close();
+}
+
+unsigned int RenderNull::SDL_InitFlags()
+{
+    return 0;
+}
+
+bool RenderNull::isWorking()
+{
+    return m_isWorking;
+}
+
+bool RenderNull::initRender(const CmdLineSetup_t &setup)
+{
+    UNUSED(setup);
+
+    pLogDebug("Using the null render: nothing will be drawn");
+
+    if(!AbstractRender_t::init())
+        return false;
+
+    g_videoSettings.renderModeObtained = RENDER_NULL;
+
+    // No texture size limits
+    m_maxTextureWidth = 0;
+    m_maxTextureHeight = 0;
+
+    resetViewport();
+
+    m_isWorking = true;
+
+    return true;
+}
+
+void RenderNull::close()
+{
+    RenderNull::clearAllTextures();
+    AbstractRender_t::close();
+
+    if(m_totalFrames > 0)
+    {
+        double frames = double(m_totalFrames);
+        double screenArea = double(ScaleWidth) * double(ScaleHeight);
+
+        pLogInfo("Null render: %llu frames, %.1f draw calls per frame (max %d), "
+                 "%.1f texture binds per frame, %.2f overdraw",
+                 (unsigned long long)m_totalFrames,
+                 double(m_totalDrawCalls) / frames, m_maxDrawCalls,
+                 double(m_totalTextureBinds) / frames,
+                 screenArea > 0.0 ? double(m_totalDrawnPixels) / frames / screenArea : 0.0);
+    }
+
+    m_isWorking = false;
+}
+
+void RenderNull::repaint()
+{
+#ifdef USE_RENDER_BLOCKING
+    if(m_blockRender)
+        return;
+#endif
+
+    g_stats.renderDrawCalls = m_drawCalls;
+    g_stats.renderTextureBinds = m_textureBinds;
+    g_stats.renderDrawnPixels = m_drawnPixels;
+
+    m_totalFrames++;
+    m_totalDrawCalls += m_drawCalls;
+    m_totalTextureBinds += m_textureBinds;
+    m_totalDrawnPixels += uint64_t(m_drawnPixels);
+    if(m_drawCalls > m_maxDrawCalls)
+        m_maxDrawCalls = m_drawCalls;
+
+    m_drawCalls = 0;
+    m_textureBinds = 0;
+    m_drawnPixels = 0;
+    // The next frame starts from the scratch, as the real renders do after the present
+    m_boundTexture = -1;
+
+    lazyTrimResident();
+}
+
+void RenderNull::updateViewport()
+{
+    m_viewport_offset_x = 0;
+    m_viewport_offset_y = 0;
+    m_viewport_offset_x_cur = 0;
+    m_viewport_offset_y_cur = 0;
+    m_viewport_offset_ignore = false;
+
+    m_viewport_x = 0;
+    m_viewport_y = 0;
+    m_viewport_w = ScaleWidth;
+    m_viewport_h = ScaleHeight;
+}
+
+void RenderNull::resetViewport()
+{
+    updateViewport();
+}
+
+void RenderNull::setViewport(int x, int y, int w, int h)
+{
+    m_viewport_x = x;
+    m_viewport_y = y;
+    m_viewport_w = w;
+    m_viewport_h = h;
+}
+
+void RenderNull::offsetViewport(int x, int y)
+{
+    if(m_viewport_offset_x != x || m_viewport_offset_y != y)
+    {
+        m_viewport_offset_x_cur = x;
+        m_viewport_offset_y_cur = y;
+        m_viewport_offset_x = m_viewport_offset_ignore ? 0 : m_viewport_offset_x_cur;
+        m_viewport_offset_y = m_viewport_offset_ignore ? 0 : m_viewport_offset_y_cur;
+    }
+}
+
+void RenderNull::offsetViewportIgnore(bool en)
+{
+    if(m_viewport_offset_ignore != en)
+    {
+        m_viewport_offset_x = en ? 0 : m_viewport_offset_x_cur;
+        m_viewport_offset_y = en ? 0 : m_viewport_offset_y_cur;
+    }
+    m_viewport_offset_ignore = en;
+}
+
+void RenderNull::mapToScreen(int x, int y, int *dx, int *dy)
+{
+    // The window is never scaled
+    *dx = x;
+    *dy = y;
+}
+
+void RenderNull::mapFromScreen(int scr_x, int scr_y, int *window_x, int *window_y)
+{
+    *window_x = scr_x;
+    *window_y = scr_y;
+}
+
+void RenderNull::setTargetTexture()
+{}
+
+void RenderNull::setTargetScreen()
+{}
+
+void RenderNull::loadTexture(StdPicture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels, uint32_t pitch)
+{
+    UNUSED(RGBApixels);
+    UNUSED(pitch);
+
+    target.d.nOfColors = GL_RGBA;
+    target.d.format = GL_BGRA;
+    target.d.texture_id = ++m_lastTextureId;
+
+    m_textureCount++;
+    m_textureBytes += uint64_t(width) * height * 4;
+
+    target.inited = true;
+}
+
+void RenderNull::deleteTexture(StdPicture &tx, bool lazyUnload)
+{
+    lazyForget(tx);
+
+    if(!tx.inited || !tx.d.texture_id)
+    {
+        if(!lazyUnload)
+            tx.inited = false;
+        return;
+    }
+
+    if(m_textureCount > 0)
+    {
+        m_textureCount--;
+        uint64_t bytes = uint64_t(tx.w) * tx.h * 4;
+        m_textureBytes = m_textureBytes > bytes ? m_textureBytes - bytes : 0;
+    }
+
+    tx.d.texture_id = 0;
+
+    if(!lazyUnload)
+        tx.resetAll();
+
+    tx.d.format = 0;
+    tx.d.nOfColors = 0;
+
+    tx.resetColors();
+}
+
+void RenderNull::clearAllTextures()
+{
+    m_textureCount = 0;
+    m_textureBytes = 0;
+    lazyForgetAll();
+}
+
+void RenderNull::clearBuffer()
+{}
+
+void RenderNull::countDraw(GLint texture, int x, int y, int w, int h)
+{
+    m_drawCalls++;
+
+    if(m_boundTexture != texture)
+    {
+        m_textureBinds++;
+        m_boundTexture = texture;
+    }
+
+    // Only the part inside of the viewport gets drawn
+    int left = SDL_max(x, 0);
+    int top = SDL_max(y, 0);
+    int right = SDL_min(x + w, m_viewport_w);
+    int bottom = SDL_min(y + h, m_viewport_h);
+
+    if(right > left && bottom > top)
+        m_drawnPixels += int64_t(right - left) * (bottom - top);
+}
+
+bool RenderNull::prepareTexture(StdPicture &tx)
+{
+    if(!tx.inited)
+        return false;
+
+    if(!tx.d.hasTexture() && tx.l.lazyLoaded)
+        lazyLoad(tx);
+
+    lazyTouch(tx);
+
+    if(!tx.d.hasTexture())
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return false;
+    }
+
+    return true;
+}
+
+void RenderNull::renderRect(int x, int y, int w, int h, float red, float green, float blue, float alpha, bool filled)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+    UNUSED(filled);
+
+    countDraw(0, x + m_viewport_offset_x, y + m_viewport_offset_y, w, h);
+}
+
+void RenderNull::renderRectBR(int _left, int _top, int _right, int _bottom, float red, float green, float blue, float alpha)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    countDraw(0, _left + m_viewport_offset_x, _top + m_viewport_offset_y, _right - _left, _bottom - _top);
+}
+
+void RenderNull::renderCircle(int cx, int cy, int radius, float red, float green, float blue, float alpha, bool filled)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+    UNUSED(filled);
+
+    if(radius <= 0)
+        return; // Nothing to draw
+
+    // Counted by the bounding square
+    countDraw(0, cx - radius + m_viewport_offset_x, cy - radius + m_viewport_offset_y, radius * 2, radius * 2);
+}
+
+void RenderNull::renderCircleHole(int cx, int cy, int radius, float red, float green, float blue, float alpha)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    if(radius <= 0)
+        return; // Nothing to draw
+
+    countDraw(0, cx - radius + m_viewport_offset_x, cy - radius + m_viewport_offset_y, radius * 2, radius * 2);
+}
+
+void RenderNull::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, double hDstD,
+                                      StdPicture &tx,
+                                      int xSrc, int ySrc,
+                                      int wSrc, int hSrc,
+                                      double rotateAngle, FPoint_t *center, unsigned int flip,
+                                      float red, float green, float blue, float alpha)
+{
+    UNUSED(xSrc); UNUSED(ySrc); UNUSED(wSrc); UNUSED(hSrc);
+    UNUSED(rotateAngle); UNUSED(center); UNUSED(flip);
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    if(!prepareTexture(tx))
+        return;
+
+    countDraw(tx.d.texture_id,
+              Maths::iRound(xDstD) + m_viewport_offset_x,
+              Maths::iRound(yDstD) + m_viewport_offset_y,
+              Maths::iRound(wDstD),
+              Maths::iRound(hDstD));
+}
+
+void RenderNull::renderTextureScale(double xDst, double yDst, double wDst, double hDst,
+                                    StdPicture &tx,
+                                    float red, float green, float blue, float alpha)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    if(!prepareTexture(tx))
+        return;
+
+    countDraw(tx.d.texture_id,
+              Maths::iRound(xDst) + m_viewport_offset_x,
+              Maths::iRound(yDst) + m_viewport_offset_y,
+              int(wDst),
+              int(hDst));
+}
+
+void RenderNull::renderTexture(double xDstD, double yDstD, double wDstD, double hDstD,
+                               StdPicture &tx,
+                               int xSrc, int ySrc,
+                               float red, float green, float blue, float alpha)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    if(!prepareTexture(tx))
+        return;
+
+    int wDst = Maths::iRound(wDstD);
+    int hDst = Maths::iRound(hDstD);
+
+    // Don't go more than size of texture
+    if(xSrc + wDst > tx.w)
+        wDst = SDL_max(tx.w - xSrc, 0);
+
+    if(ySrc + hDst > tx.h)
+        hDst = SDL_max(tx.h - ySrc, 0);
+
+    countDraw(tx.d.texture_id,
+              Maths::iRound(xDstD) + m_viewport_offset_x,
+              Maths::iRound(yDstD) + m_viewport_offset_y,
+              wDst, hDst);
+}
+
+void RenderNull::renderTextureFL(double xDstD, double yDstD, double wDstD, double hDstD,
+                                 StdPicture &tx,
+                                 int xSrc, int ySrc,
+                                 double rotateAngle, FPoint_t *center, unsigned int flip,
+                                 float red, float green, float blue, float alpha)
+{
+    UNUSED(rotateAngle); UNUSED(center); UNUSED(flip);
+
+    renderTexture(xDstD, yDstD, wDstD, hDstD, tx, xSrc, ySrc, red, green, blue, alpha);
+}
+
+void RenderNull::renderTexture(float xDst, float yDst,
+                               StdPicture &tx,
+                               float red, float green, float blue, float alpha)
+{
+    UNUSED(red); UNUSED(green); UNUSED(blue); UNUSED(alpha);
+
+    if(!prepareTexture(tx))
+        return;
+
+    // Like the SDL render, this one ignores the viewport offset
+    countDraw(tx.d.texture_id, Maths::iRound(xDst), Maths::iRound(yDst), tx.w, tx.h);
+}
+
+void RenderNull::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
+{
+    UNUSED(x);
+    UNUSED(y);
+    std::memset(pixels, 0, size_t(w * 3 + (w % 4)) * h);
+}
+
+void RenderNull::getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels)
+{
+    UNUSED(x);
+    UNUSED(y);
+    std::memset(pixels, 0, size_t(w) * h * 4);
+}
+
+int RenderNull::getPixelDataSize(const StdPicture &tx)
+{
+    if(!tx.d.texture_id)
+        return 0;
+    return (tx.w * tx.h * 4);
+}
+
+void RenderNull::getPixelData(const StdPicture &tx, unsigned char *pixelData)
+{
+    // The pixels aren't kept
+    int size = getPixelDataSize(tx);
+    if(size > 0)
+        std::memset(pixelData, 0, size_t(size));
+}
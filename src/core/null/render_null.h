@@ -0,0 +1,200 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef RENDERNULL_T_H
+#define RENDERNULL_T_H
+
+#include <stdint.h>
+
+#include "../base/render_base.h"
+#include "cmd_line_setup.h"
+
+
+/*!
+ * \brief Render that draws nothing and never touches the GPU
+ *
+ * All draw calls are accepted and counted into the g_stats: the draw calls,
+ * the texture binds and the covered area. Textures are decoded as usual, but
+ * only get an ID. Used for benchmarks and for headless machines without a display.
+ */
+class RenderNull final : public AbstractRender_t
+{
+    bool m_isWorking = false;
+
+    //! Last given texture ID, 0 is "no texture"
+    GLint m_lastTextureId = 0;
+    //! Count of the alive textures and their memory as it would be at the GPU
+    int      m_textureCount = 0;
+    uint64_t m_textureBytes = 0;
+
+    //! Texture used by the last draw call, 0 for the primitives
+    GLint m_boundTexture = -1;
+
+    // Counters of the current frame
+    int     m_drawCalls = 0;
+    int     m_textureBinds = 0;
+    int64_t m_drawnPixels = 0;
+
+    // Totals since the start, reported on close
+    uint64_t m_totalFrames = 0;
+    uint64_t m_totalDrawCalls = 0;
+    uint64_t m_totalTextureBinds = 0;
+    uint64_t m_totalDrawnPixels = 0;
+    int      m_maxDrawCalls = 0;
+
+    // Offset to shake screen
+    int m_viewport_offset_x = 0;
+    int m_viewport_offset_y = 0;
+    // Keep zero viewport offset while this flag is on
+    bool m_viewport_offset_ignore = false;
+    // Carried set value for viewport offset (used to preserve values while ignore option is on)
+    int m_viewport_offset_x_cur = 0;
+    int m_viewport_offset_y_cur = 0;
+
+    int m_viewport_x = 0;
+    int m_viewport_y = 0;
+    int m_viewport_w = 0;
+    int m_viewport_h = 0;
+
+    //! Count the draw call of the given texture (0 for primitives) and of the given on-screen rectangle
+    void countDraw(GLint texture, int x, int y, int w, int h);
+
+    //! Make sure the texture is ready to draw, the same as the other renders do
+    bool prepareTexture(StdPicture &tx);
+
+public:
+    RenderNull();
+    ~RenderNull() override;
+
+
+    unsigned int SDL_InitFlags() override;
+
+    bool isWorking() override;
+
+    bool initRender(const CmdLineSetup_t &setup);
+
+    /*!
+     * \brief Close the renderer
+     */
+    void close() override;
+
+    /*!
+     * \brief Finish the frame: publish its counters into the g_stats
+     */
+    void repaint() override;
+
+    void updateViewport() override;
+
+    void resetViewport() override;
+
+    void setViewport(int x, int y, int w, int h) override;
+
+    void offsetViewport(int x, int y) override; // for screen-shaking
+
+    void offsetViewportIgnore(bool en) override;
+
+    void mapToScreen(int x, int y, int *dx, int *dy) override;
+
+    void mapFromScreen(int x, int y, int *dx, int *dy) override;
+
+    void setTargetTexture() override;
+
+    void setTargetScreen() override;
+
+
+    void loadTexture(StdPicture &target,
+                     uint32_t width,
+                     uint32_t height,
+                     uint8_t *RGBApixels,
+                     uint32_t pitch) override;
+
+    void deleteTexture(StdPicture &tx, bool lazyUnload = false) override;
+    void clearAllTextures() override;
+
+    void clearBuffer() override;
+
+
+
+    // Draw primitives
+
+    void renderRect(int x, int y, int w, int h,
+                    float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f,
+                    bool filled = true) override;
+
+    void renderRectBR(int _left, int _top, int _right,
+                      int _bottom, float red, float green, float blue, float alpha) override;
+
+    void renderCircle(int cx, int cy,
+                      int radius,
+                      float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f,
+                      bool filled = true) override;
+
+    void renderCircleHole(int cx, int cy,
+                          int radius,
+                          float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+
+
+
+    // Draw texture
+
+    void renderTextureScaleEx(double xDst, double yDst, double wDst, double hDst,
+                              StdPicture &tx,
+                              int xSrc, int ySrc,
+                              int wSrc, int hSrc,
+                              double rotateAngle =.0, FPoint_t *center = nullptr, unsigned int flip = X_FLIP_NONE,
+                              float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+    void renderTextureScale(double xDst, double yDst, double wDst, double hDst,
+                            StdPicture &tx,
+                            float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+    void renderTexture(double xDst, double yDst, double wDst, double hDst,
+                       StdPicture &tx,
+                       int xSrc, int ySrc,
+                       float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+    void renderTextureFL(double xDst, double yDst, double wDst, double hDst,
+                         StdPicture &tx,
+                         int xSrc, int ySrc,
+                         double rotateAngle =.0, FPoint_t *center = nullptr, unsigned int flip = X_FLIP_NONE,
+                         float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+    void renderTexture(float xDst, float yDst, StdPicture &tx,
+                       float red = 1.f, float green = 1.f, float blue = 1.f, float alpha = 1.f) override;
+
+
+
+
+    // Retrieve raw pixel data, always black
+
+    void getScreenPixels(int x, int y, int w, int h, unsigned char *pixels) override;
+
+    void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels) override;
+
+    int  getPixelDataSize(const StdPicture &tx) override;
+
+    void getPixelData(const StdPicture &tx, unsigned char *pixelData) override;
+
+};
+
+
+#endif // RENDERNULL_T_H
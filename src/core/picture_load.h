@@ -23,6 +23,7 @@
 #define STD_PICTURE_LOAD_H
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 
 /*!
@@ -41,6 +42,17 @@ struct StdPictureLoad
     //! Was mask restored from the PNG at default graphics?
     bool isMaskPng = false;
 
+    // Compressed data at the mapped asset pack, used instead of the raw ones when set
+    //! Front image at the pack
+    const char *rawPacked = nullptr;
+    size_t      rawPackedSize = 0;
+    //! Mask image at the pack
+    const char *rawMaskPacked = nullptr;
+    size_t      rawMaskPackedSize = 0;
+
+    //! Key of the source files at the texture cache (0 if unknown, then it's not cached)
+    uint64_t sourceKey = 0;
+
     // Original size (if texture got scaled while loading)
     //! Original width
     int w_orig = 0;
@@ -57,6 +69,37 @@ struct StdPictureLoad
     bool     colorKey = false;
     uint8_t  keyRgb[3] = {0 /*R*/, 0 /*G*/, 0 /*B*/};
 
+    //! Ticket of the background decoding in progress (0 if none)
+    uint32_t asyncTicket = 0;
+
+    //! Frame of the latest draw of the lazy-loaded texture
+    uint32_t lastDrawFrame = 0;
+
+    inline const char *rawData() const
+    {
+        return rawPacked ? rawPacked : raw.data();
+    }
+
+    inline size_t rawSize() const
+    {
+        return rawPacked ? rawPackedSize : raw.size();
+    }
+
+    inline const char *rawMaskData() const
+    {
+        return rawMaskPacked ? rawMaskPacked : rawMask.data();
+    }
+
+    inline size_t rawMaskSize() const
+    {
+        return rawMaskPacked ? rawMaskPackedSize : rawMask.size();
+    }
+
+    inline bool hasMask() const
+    {
+        return rawMaskSize() > 0;
+    }
+
     /*!
      * \brief Clear all held data
      *
@@ -66,8 +109,13 @@ struct StdPictureLoad
     {
         raw.clear();
         rawMask.clear();
+        rawPacked = nullptr;
+        rawPackedSize = 0;
+        rawMaskPacked = nullptr;
+        rawMaskPackedSize = 0;
         lazyLoaded = false;
         isMaskPng = false;
+        sourceKey = 0;
         w_orig = 0;
         h_orig = 0;
         w_scale = 1.f;
@@ -76,6 +124,8 @@ struct StdPictureLoad
         keyRgb[0] = 0;
         keyRgb[1] = 0;
         keyRgb[2] = 0;
+        asyncTicket = 0;
+        lastDrawFrame = 0;
     }
 };
 
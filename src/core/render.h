@@ -227,6 +227,16 @@ SDL_FORCE_INLINE void lazyLoadedBytesReset()
     AbstractRender_t::lazyLoadedBytesReset();
 }
 
+SDL_FORCE_INLINE size_t lazyResidentBytes()
+{
+    return AbstractRender_t::lazyResidentBytes();
+}
+
+SDL_FORCE_INLINE TextureCache::Counters_t lazyCacheCounters()
+{
+    return AbstractRender_t::lazyCacheCounters();
+}
+
 
 
 E_INLINE void deleteTexture(StdPicture &tx, bool lazyUnload = false) TAIL
@@ -30,6 +30,24 @@ typedef unsigned int    GLuint;
 
 struct SDL_Texture;
 
+/*!
+ * \brief Identity of the texture, the same for all copies of the picture that share it
+ */
+struct StdPictureHandle
+{
+    const SDL_Texture *texture = nullptr;
+    GLint        texture_id = 0;
+    //! Place at the atlas page, the page texture is shared by many pictures
+    int          atlas_x = 0;
+    int          atlas_y = 0;
+
+    inline bool operator==(const StdPictureHandle &o) const
+    {
+        return texture == o.texture && texture_id == o.texture_id
+            && atlas_x == o.atlas_x && atlas_y == o.atlas_y;
+    }
+};
+
 /*!
  * \brief Platform specific picture data. Fields should not be used directly
  */
@@ -37,12 +55,23 @@ struct StdPictureData
 {
 // Compatible backend is only can use these internals
     friend class RenderSDL;
+    friend class RenderNull;
 
     //! Texture instance pointer for SDL Render
     SDL_Texture *texture = nullptr;
     //! texture ID for OpenGL and other render engines
     GLint        texture_id = 0;
 
+    //! Index of the atlas page that keeps the picture, -1 if the texture is its own
+    int          atlas_page = -1;
+    //! Generation of the atlas page, the page index gets reused after the pages are cleared
+    uint32_t     atlas_gen = 0;
+    //! Place of the picture at the atlas page (with the padding)
+    int          atlas_x = 0;
+    int          atlas_y = 0;
+    int          atlas_w = 0;
+    int          atlas_h = 0;
+
     //! Texture format at OpenGL-renderer
     GLenum      format = 0;
     //! Number of colors
@@ -55,12 +84,27 @@ struct StdPictureData
 
     inline bool hasTexture()
     {
-        return texture != nullptr;
+        return texture != nullptr || texture_id != 0;
+    }
+
+    inline StdPictureHandle handle() const
+    {
+        StdPictureHandle h;
+        h.texture = texture;
+        h.texture_id = texture_id;
+        if(atlas_page >= 0)
+        {
+            h.atlas_x = atlas_x;
+            h.atlas_y = atlas_y;
+        }
+        return h;
     }
 
     inline void clear()
     {
         texture = nullptr;
+        texture_id = 0;
+        atlas_page = -1;
     }
 };
 
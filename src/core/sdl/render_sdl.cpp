@@ -22,12 +22,15 @@
 #include <SDL2/SDL_render.h>
 #include <SDL2/SDL_opengl.h>
 
+#include <algorithm>
+
 #include <FreeImageLite.h>
 #include <Logger/logger.h>
 #include <Utils/maths.h>
 
 #include "render_sdl.h"
 #include "video.h"
+#include "frame_timer.h"
 #include "../window.h"
 
 #include <SDL2/SDL_assert.h>
@@ -45,6 +48,17 @@
 #define SDL_RenderCopyExF SDL_RenderCopyEx
 #endif
 
+#ifdef XTECH_SDL_BATCHING
+//! Size of the atlas page, gets reduced to the texture size limit
+static const int c_atlasPageSize = 2048;
+//! Count of the atlas pages, the pictures over them get their own textures
+static const size_t c_atlasMaxPages = 8;
+//! Transparent gap between the pictures at the page
+static const int c_atlasPadding = 1;
+//! Quads per one SDL_RenderGeometry() call
+static const size_t c_batchMaxQuads = 2048;
+#endif
+
 
 
 RenderSDL::RenderSDL() :
@@ -117,6 +131,50 @@ bool RenderSDL::initRender(const CmdLineSetup_t &setup, SDL_Window *window)
     m_maxTextureWidth = ri.max_texture_width;
     m_maxTextureHeight = ri.max_texture_height;
 
+#ifdef XTECH_SDL_BATCHING
+    // The software render copies the plain rectangles faster than it draws the geometry
+    m_useAtlas = (g_videoSettings.renderModeObtained != RENDER_SOFTWARE);
+
+    m_atlasPageSize = c_atlasPageSize;
+    if(m_maxTextureWidth > 0)
+        m_atlasPageSize = SDL_min(m_atlasPageSize, m_maxTextureWidth);
+    if(m_maxTextureHeight > 0)
+        m_atlasPageSize = SDL_min(m_atlasPageSize, m_maxTextureHeight);
+    if(m_atlasPageSize < c_atlasPageSize / 2)
+        m_useAtlas = false;
+
+    // The same layout as the surfaces made at the loadTexture()
+    m_atlasFormat = SDL_MasksToPixelFormatEnum(32,
+                                               FI_RGBA_RED_MASK,
+                                               FI_RGBA_GREEN_MASK,
+                                               FI_RGBA_BLUE_MASK,
+                                               FI_RGBA_ALPHA_MASK);
+    if(m_atlasFormat == SDL_PIXELFORMAT_UNKNOWN)
+        m_useAtlas = false;
+
+    m_useBatching = m_useAtlas;
+
+    if(m_useAtlas)
+    {
+        m_batchVertices.reserve(c_batchMaxQuads * 4);
+        m_batchIndices.resize(c_batchMaxQuads * 6);
+
+        for(size_t q = 0; q < c_batchMaxQuads; q++)
+        {
+            int *i = &m_batchIndices[q * 6];
+            int v = static_cast<int>(q * 4);
+            i[0] = v;
+            i[1] = v + 1;
+            i[2] = v + 2;
+            i[3] = v;
+            i[4] = v + 2;
+            i[5] = v + 3;
+        }
+
+        pLogDebug("Render SDL: Small textures are packed into %dx%d atlas pages", m_atlasPageSize, m_atlasPageSize);
+    }
+#endif
+
     m_tBuffer = SDL_CreateTexture(m_gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, ScaleWidth, ScaleHeight);
     if(!m_tBuffer)
     {
@@ -166,6 +224,7 @@ void RenderSDL::repaint()
     int w, h, off_x, off_y, wDst, hDst;
     float scale_x, scale_y;
 
+    batchFlush();
     setTargetScreen();
 
 #ifdef USE_SCREENSHOTS_AND_RECS
@@ -213,8 +272,17 @@ void RenderSDL::repaint()
     SDL_RenderCopyEx(m_gRenderer, m_tBuffer, &sourceRect, &destRect, 0.0, nullptr, SDL_FLIP_NONE);
 
     Controls::RenderTouchControls();
+    batchFlush();
 
     SDL_RenderPresent(m_gRenderer);
+
+    g_stats.renderDrawCalls = m_drawCalls;
+    g_stats.renderTextureBinds = m_textureBinds;
+    m_drawCalls = 0;
+    m_textureBinds = 0;
+    m_lastTexture = nullptr;
+
+    lazyTrimResident();
 }
 
 void RenderSDL::updateViewport()
@@ -276,6 +344,8 @@ void RenderSDL::updateViewport()
 
 void RenderSDL::resetViewport()
 {
+    batchFlush();
+
     // FIXME: Clarify the version of SDL2 with the buggy viewport
 //#if SDL_COMPILEDVERSION < SDL_VERSIONNUM(2, 0, 22)
     // set to an alt viewport as a workaround for SDL bug (doesn't allow resizing viewport without changing position)
@@ -291,6 +361,8 @@ void RenderSDL::setViewport(int x, int y, int w, int h)
 {
     SDL_Rect topLeftViewport;
 
+    batchFlush();
+
     // FIXME: Clarify the version of SDL2 with the buggy viewport
 //#if SDL_COMPILEDVERSION < SDL_VERSIONNUM(2, 0, 22)
     // set to an alt viewport as a workaround for SDL bug (doesn't allow resizing viewport without changing position)
@@ -344,6 +416,7 @@ void RenderSDL::setTargetTexture()
 {
     if(m_recentTarget == m_tBuffer)
         return;
+    batchFlush();
     SDL_SetRenderTarget(m_gRenderer, m_tBuffer);
     m_recentTarget = m_tBuffer;
 }
@@ -352,6 +425,7 @@ void RenderSDL::setTargetScreen()
 {
     if(m_recentTarget == nullptr)
         return;
+    batchFlush();
     SDL_SetRenderTarget(m_gRenderer, nullptr);
     m_recentTarget = nullptr;
 }
@@ -361,9 +435,17 @@ void RenderSDL::loadTexture(StdPicture &target, uint32_t width, uint32_t height,
     SDL_Surface *surface;
     SDL_Texture *texture = nullptr;
 
+    // The quads of the batch may use the place that gets reused
+    batchFlush();
+
     target.d.nOfColors = GL_RGBA;
     target.d.format = GL_BGRA;
 
+#ifdef XTECH_SDL_BATCHING
+    if(m_useAtlas && atlasInsert(target, width, height, RGBApixels, pitch))
+        return;
+#endif
+
     surface = SDL_CreateRGBSurfaceFrom(RGBApixels,
                                        static_cast<int>(width),
                                        static_cast<int>(height),
@@ -394,6 +476,8 @@ void RenderSDL::loadTexture(StdPicture &target, uint32_t width, uint32_t height,
 
 void RenderSDL::deleteTexture(StdPicture &tx, bool lazyUnload)
 {
+    lazyForget(tx);
+
     if(!tx.inited || !tx.d.texture)
     {
         if(!lazyUnload)
@@ -401,20 +485,32 @@ void RenderSDL::deleteTexture(StdPicture &tx, bool lazyUnload)
         return;
     }
 
-    auto corpseIt = m_textureBank.find(tx.d.texture);
-    if(corpseIt == m_textureBank.end())
+    batchFlush();
+
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0)
+        atlasRelease(tx);
+    else
+#endif
     {
-        SDL_DestroyTexture(tx.d.texture);
-        tx.d.texture = nullptr;
-        if(!lazyUnload)
-            tx.inited = false;
-        return;
+        auto corpseIt = m_textureBank.find(tx.d.texture);
+        if(corpseIt == m_textureBank.end())
+        {
+            SDL_DestroyTexture(tx.d.texture);
+            tx.d.texture = nullptr;
+            if(!lazyUnload)
+                tx.inited = false;
+            return;
+        }
+
+        SDL_Texture *corpse = *corpseIt;
+        if(corpse)
+            SDL_DestroyTexture(corpse);
+        m_textureBank.erase(corpse);
     }
 
-    SDL_Texture *corpse = *corpseIt;
-    if(corpse)
-        SDL_DestroyTexture(corpse);
-    m_textureBank.erase(corpse);
+    if(m_lastTexture == tx.d.texture)
+        m_lastTexture = nullptr;
 
     tx.d.texture = nullptr;
 
@@ -429,9 +525,20 @@ void RenderSDL::deleteTexture(StdPicture &tx, bool lazyUnload)
 
 void RenderSDL::clearAllTextures()
 {
+    batchFlush();
+
     for(SDL_Texture *tx : m_textureBank)
         SDL_DestroyTexture(tx);
     m_textureBank.clear();
+
+#ifdef XTECH_SDL_BATCHING
+    for(AtlasPage_t &page : m_atlasPages)
+        SDL_DestroyTexture(page.texture);
+    m_atlasPages.clear();
+#endif
+
+    m_lastTexture = nullptr;
+    lazyForgetAll();
 }
 
 void RenderSDL::clearBuffer()
@@ -439,6 +546,7 @@ void RenderSDL::clearBuffer()
 #ifdef USE_RENDER_BLOCKING
     SDL_assert(!m_blockRender);
 #endif
+    batchFlush();
     SDL_SetRenderDrawColor(m_gRenderer, 0, 0, 0, 255);
     SDL_RenderClear(m_gRenderer);
 }
@@ -448,6 +556,8 @@ void RenderSDL::renderRect(int x, int y, int w, int h, float red, float green, f
 #ifdef USE_RENDER_BLOCKING
     SDL_assert(!m_blockRender);
 #endif
+    batchFlush();
+
     SDL_Rect aRect = {x + m_viewport_offset_x,
                       y + m_viewport_offset_y,
                       w, h};
@@ -469,6 +579,8 @@ void RenderSDL::renderRectBR(int _left, int _top, int _right, int _bottom, float
 #ifdef USE_RENDER_BLOCKING
     SDL_assert(!m_blockRender);
 #endif
+    batchFlush();
+
     SDL_Rect aRect = {_left + m_viewport_offset_x,
                       _top + m_viewport_offset_y,
                       _right - _left, _bottom - _top};
@@ -491,6 +603,8 @@ void RenderSDL::renderCircle(int cx, int cy, int radius, float red, float green,
     if(radius <= 0)
         return; // Nothing to draw
 
+    batchFlush();
+
     SDL_SetRenderDrawColor(m_gRenderer,
                                static_cast<unsigned char>(255.f * red),
                                static_cast<unsigned char>(255.f * green),
@@ -533,6 +647,8 @@ void RenderSDL::renderCircleHole(int cx, int cy, int radius, float red, float gr
     if(radius <= 0)
         return; // Nothing to draw
 
+    batchFlush();
+
     SDL_SetRenderDrawColor(m_gRenderer,
                                static_cast<unsigned char>(255.f * red),
                                static_cast<unsigned char>(255.f * green),
@@ -582,27 +698,306 @@ void RenderSDL::renderCircleHole(int cx, int cy, int radius, float red, float gr
 
 
 
-static SDL_INLINE void txColorMod(StdPictureData &tx, float red, float green, float blue, float alpha)
+static SDL_INLINE void txColorMod(SDL_Texture *texture, uint8_t *cachedColor, const uint8_t modColor[4])
+{
+    if(SDL_memcmp(cachedColor, modColor, 3) != 0)
+    {
+        SDL_SetTextureColorMod(texture, modColor[0], modColor[1], modColor[2]);
+        cachedColor[0] = modColor[0];
+        cachedColor[1] = modColor[1];
+        cachedColor[2] = modColor[2];
+    }
+
+    if(cachedColor[3] != modColor[3])
+    {
+        SDL_SetTextureAlphaMod(texture, modColor[3]);
+        cachedColor[3] = modColor[3];
+    }
+}
+
+#ifdef XTECH_SDL_BATCHING
+/*!
+ * \brief Clip the source rectangle by the atlas picture, as SDL_RenderCopy() does by the texture
+ * \return false if nothing left to draw
+ */
+static bool s_atlasClip(const StdPictureData &d, SDL_Rect &sourceRect)
+{
+    int w = d.atlas_w - c_atlasPadding;
+    int h = d.atlas_h - c_atlasPadding;
+
+    int left = SDL_max(sourceRect.x, 0);
+    int top = SDL_max(sourceRect.y, 0);
+    int right = SDL_min(sourceRect.x + sourceRect.w, w);
+    int bottom = SDL_min(sourceRect.y + sourceRect.h, h);
+
+    if(right <= left || bottom <= top)
+        return false;
+
+    sourceRect = {left, top, right - left, bottom - top};
+    return true;
+}
+#endif
+
+bool RenderSDL::prepareCopy(StdPicture &tx, SDL_Rect &sourceRect, float red, float green, float blue, float alpha)
 {
     uint8_t modColor[4] = {static_cast<unsigned char>(255.f * red),
                            static_cast<unsigned char>(255.f * green),
                            static_cast<unsigned char>(255.f * blue),
                            static_cast<unsigned char>(255.f * alpha)};
 
-    if(SDL_memcmp(tx.modColor, modColor, 3) != 0)
+    batchFlush();
+
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0)
+    {
+        if(!s_atlasClip(tx.d, sourceRect))
+            return false;
+
+        sourceRect.x += tx.d.atlas_x;
+        sourceRect.y += tx.d.atlas_y;
+        txColorMod(tx.d.texture, m_atlasPages[tx.d.atlas_page].modColor, modColor);
+    }
+    else
+#endif
+    {
+        txColorMod(tx.d.texture, tx.d.modColor, modColor);
+    }
+
+    m_drawCalls++;
+    if(m_lastTexture != tx.d.texture)
+    {
+        m_textureBinds++;
+        m_lastTexture = tx.d.texture;
+    }
+
+    return true;
+}
+
+void RenderSDL::batchFlush()
+{
+#ifdef XTECH_SDL_BATCHING
+    if(m_batchPage < 0)
+        return;
+
+    AtlasPage_t &page = m_atlasPages[m_batchPage];
+    int vertices = static_cast<int>(m_batchVertices.size());
+
+    // The colors of vertices do the modulation
+    const uint8_t noModColor[4] = {255, 255, 255, 255};
+    txColorMod(page.texture, page.modColor, noModColor);
+
+    if(SDL_RenderGeometry(m_gRenderer, page.texture,
+                          m_batchVertices.data(), vertices,
+                          m_batchIndices.data(), vertices / 4 * 6) < 0)
+    {
+        pLogWarning("Render SDL: Failed to draw the batch (%s), the batching gets disabled", SDL_GetError());
+        m_useBatching = false;
+
+        // Draw the same quads one by one
+        float size = static_cast<float>(m_atlasPageSize);
+
+        for(int i = 0; i < vertices; i += 4)
+        {
+            const SDL_Vertex *q = &m_batchVertices[i];
+            float u0 = q[0].tex_coord.x, v0 = q[0].tex_coord.y;
+            float u1 = q[2].tex_coord.x, v1 = q[2].tex_coord.y;
+            int flip = SDL_FLIP_NONE;
+
+            if(u0 > u1)
+            {
+                std::swap(u0, u1);
+                flip |= SDL_FLIP_HORIZONTAL;
+            }
+
+            if(v0 > v1)
+            {
+                std::swap(v0, v1);
+                flip |= SDL_FLIP_VERTICAL;
+            }
+
+            SDL_Rect sourceRect = {Maths::iRound(u0 * size), Maths::iRound(v0 * size),
+                                   Maths::iRound((u1 - u0) * size), Maths::iRound((v1 - v0) * size)};
+            SDL_FRect destRect = {q[0].position.x, q[0].position.y,
+                                  q[2].position.x - q[0].position.x, q[2].position.y - q[0].position.y};
+            const uint8_t modColor[4] = {q[0].color.r, q[0].color.g, q[0].color.b, q[0].color.a};
+
+            txColorMod(page.texture, page.modColor, modColor);
+            SDL_RenderCopyExF(m_gRenderer, page.texture, &sourceRect, &destRect,
+                              0.0, nullptr, static_cast<SDL_RendererFlip>(flip));
+        }
+    }
+
+    m_drawCalls++;
+    if(m_lastTexture != page.texture)
+    {
+        m_textureBinds++;
+        m_lastTexture = page.texture;
+    }
+
+    m_batchVertices.clear();
+    m_batchPage = -1;
+#endif
+}
+
+#ifdef XTECH_SDL_BATCHING
+bool RenderSDL::atlasInsert(StdPicture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels, uint32_t pitch)
+{
+    // Big pictures don't fit well and take their own textures anyway
+    if(width == 0 || height == 0
+       || width > static_cast<uint32_t>(m_atlasPageSize / 4)
+       || height > static_cast<uint32_t>(m_atlasPageSize / 2))
+        return false;
+
+    int w = static_cast<int>(width) + c_atlasPadding;
+    int h = static_cast<int>(height) + c_atlasPadding;
+
+    AtlasPacker::Rect_t place;
+    size_t pageIdx = 0;
+    bool newPage = false;
+
+    for(; pageIdx < m_atlasPages.size(); pageIdx++)
     {
-        SDL_SetTextureColorMod(tx.texture, modColor[0], modColor[1], modColor[2]);
-        tx.modColor[0] = modColor[0];
-        tx.modColor[1] = modColor[1];
-        tx.modColor[2] = modColor[2];
+        if(m_atlasPages[pageIdx].packer.insert(w, h, place))
+            break;
     }
 
-    if(tx.modColor[3] != modColor[3])
+    if(pageIdx == m_atlasPages.size())
     {
-        SDL_SetTextureAlphaMod(tx.texture, modColor[3]);
-        tx.modColor[3] = modColor[3];
+        if(m_atlasPages.size() >= c_atlasMaxPages)
+            return false;
+
+        AtlasPage_t page;
+        page.texture = SDL_CreateTexture(m_gRenderer, m_atlasFormat, SDL_TEXTUREACCESS_STATIC,
+                                         m_atlasPageSize, m_atlasPageSize);
+        if(!page.texture)
+        {
+            pLogWarning("Render SDL: Failed to create the atlas page, the atlas gets disabled (%s)", SDL_GetError());
+            m_useAtlas = false;
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+        page.generation = ++m_atlasGeneration;
+        newPage = true;
+
+        // The gaps between the pictures must be transparent
+        std::vector<uint8_t> blank(static_cast<size_t>(m_atlasPageSize) * m_atlasPageSize * 4, 0);
+        SDL_UpdateTexture(page.texture, nullptr, blank.data(), m_atlasPageSize * 4);
+
+        page.packer.init(m_atlasPageSize, m_atlasPageSize);
+        page.packer.insert(w, h, place);
+        m_atlasPages.push_back(page);
+        lazyTrackShared(int64_t(m_atlasPageSize) * m_atlasPageSize * 4);
+
+        pLogDebug("Render SDL: Created the atlas page %d", static_cast<int>(pageIdx));
     }
+
+    AtlasPage_t &page = m_atlasPages[pageIdx];
+    SDL_Rect dst = {place.x, place.y, static_cast<int>(width), static_cast<int>(height)};
+
+    // The released places keep the texels of their old pictures, the padding must be transparent again
+    if(!newPage)
+    {
+        SDL_Rect right = {place.x + dst.w, place.y, place.w - dst.w, place.h};
+        SDL_Rect bottom = {place.x, place.y + dst.h, dst.w, place.h - dst.h};
+        std::vector<uint8_t> blank(static_cast<size_t>(SDL_max(right.w * right.h, bottom.w * bottom.h)) * 4, 0);
+
+        if(right.w > 0 && right.h > 0)
+            SDL_UpdateTexture(page.texture, &right, blank.data(), right.w * 4);
+        if(bottom.w > 0 && bottom.h > 0)
+            SDL_UpdateTexture(page.texture, &bottom, blank.data(), bottom.w * 4);
+    }
+
+    if(SDL_UpdateTexture(page.texture, &dst, RGBApixels, static_cast<int>(pitch)) != 0)
+    {
+        page.packer.release(place);
+        return false;
+    }
+
+    target.d.texture = page.texture;
+    target.d.atlas_page = static_cast<int>(pageIdx);
+    target.d.atlas_gen = page.generation;
+    target.d.atlas_x = place.x;
+    target.d.atlas_y = place.y;
+    target.d.atlas_w = place.w;
+    target.d.atlas_h = place.h;
+
+    target.inited = true;
+
+    return true;
+}
+
+void RenderSDL::atlasRelease(StdPicture &tx)
+{
+    AtlasPacker::Rect_t place;
+    place.x = tx.d.atlas_x;
+    place.y = tx.d.atlas_y;
+    place.w = tx.d.atlas_w;
+    place.h = tx.d.atlas_h;
+
+    // The pages are gone after the clearAllTextures(), and their indices are taken by the new ones
+    if(static_cast<size_t>(tx.d.atlas_page) < m_atlasPages.size()
+       && m_atlasPages[tx.d.atlas_page].generation == tx.d.atlas_gen)
+        m_atlasPages[tx.d.atlas_page].packer.release(place);
+
+    tx.d.atlas_page = -1;
+}
+
+void RenderSDL::batchQuad(StdPicture &tx, const SDL_FRect &destRect, const SDL_Rect &sourceRect, unsigned int flip,
+                          float red, float green, float blue, float alpha)
+{
+    SDL_Rect src = sourceRect;
+    if(!s_atlasClip(tx.d, src))
+        return;
+
+    if(m_batchPage != tx.d.atlas_page || m_batchVertices.size() >= c_batchMaxQuads * 4)
+    {
+        batchFlush();
+        m_batchPage = tx.d.atlas_page;
+    }
+
+    const float scale = 1.f / m_atlasPageSize;
+
+    float u0 = (tx.d.atlas_x + src.x) * scale;
+    float v0 = (tx.d.atlas_y + src.y) * scale;
+    float u1 = (tx.d.atlas_x + src.x + src.w) * scale;
+    float v1 = (tx.d.atlas_y + src.y + src.h) * scale;
+
+    if(flip & SDL_FLIP_HORIZONTAL)
+        std::swap(u0, u1);
+    if(flip & SDL_FLIP_VERTICAL)
+        std::swap(v0, v1);
+
+    SDL_Color color = {static_cast<unsigned char>(255.f * red),
+                       static_cast<unsigned char>(255.f * green),
+                       static_cast<unsigned char>(255.f * blue),
+                       static_cast<unsigned char>(255.f * alpha)};
+
+    float x0 = destRect.x;
+    float y0 = destRect.y;
+    float x1 = destRect.x + destRect.w;
+    float y1 = destRect.y + destRect.h;
+
+    SDL_Vertex v;
+    v.color = color;
+
+    v.position = {x0, y0};
+    v.tex_coord = {u0, v0};
+    m_batchVertices.push_back(v);
+
+    v.position = {x1, y0};
+    v.tex_coord = {u1, v0};
+    m_batchVertices.push_back(v);
+
+    v.position = {x1, y1};
+    v.tex_coord = {u1, v1};
+    m_batchVertices.push_back(v);
+
+    v.position = {x0, y1};
+    v.tex_coord = {u0, v1};
+    m_batchVertices.push_back(v);
 }
+#endif // XTECH_SDL_BATCHING
 
 void RenderSDL::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, double hDstD,
                                        StdPicture &tx,
@@ -620,6 +1015,8 @@ void RenderSDL::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, d
     if(!tx.d.texture && tx.l.lazyLoaded)
         lazyLoad(tx);
 
+    lazyTouch(tx);
+
     if(!tx.d.texture)
     {
         D_pLogWarningNA("Attempt to render an empty texture!");
@@ -670,7 +1067,17 @@ void RenderSDL::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, d
         sourceRect = {int(tx.l.w_scale * xSrc), int(tx.l.h_scale * ySrc),
                       int(tx.l.w_scale * wSrc), int(tx.l.h_scale * hSrc)};
 
-    txColorMod(tx.d, red, green, blue, alpha);
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0 && m_useBatching && rotateAngle == 0.0)
+    {
+        batchQuad(tx, destRect, sourceRect, flip, red, green, blue, alpha);
+        return;
+    }
+#endif
+
+    if(!prepareCopy(tx, sourceRect, red, green, blue, alpha))
+        return;
+
     SDL_RenderCopyExF(m_gRenderer, tx.d.texture, &sourceRect, &destRect,
                       rotateAngle, centerD, static_cast<SDL_RendererFlip>(flip));
 }
@@ -690,6 +1097,8 @@ void RenderSDL::renderTextureScale(double xDst, double yDst, double wDst, double
     if(!tx.d.texture && tx.l.lazyLoaded)
         lazyLoad(tx);
 
+    lazyTouch(tx);
+
     if(!tx.d.texture)
     {
         D_pLogWarningNA("Attempt to render an empty texture!");
@@ -714,7 +1123,17 @@ void RenderSDL::renderTextureScale(double xDst, double yDst, double wDst, double
     else
         sourceRect = {0, 0, tx.l.w_orig, tx.l.h_orig};
 
-    txColorMod(tx.d, red, green, blue, alpha);
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0 && m_useBatching)
+    {
+        batchQuad(tx, destRect, sourceRect, flip, red, green, blue, alpha);
+        return;
+    }
+#endif
+
+    if(!prepareCopy(tx, sourceRect, red, green, blue, alpha))
+        return;
+
     SDL_RenderCopyExF(m_gRenderer, tx.d.texture, &sourceRect, &destRect,
                       0.0, nullptr, static_cast<SDL_RendererFlip>(flip));
 }
@@ -733,6 +1152,8 @@ void RenderSDL::renderTexture(double xDstD, double yDstD, double wDstD, double h
     if(!tx.d.texture && tx.l.lazyLoaded)
         lazyLoad(tx);
 
+    lazyTouch(tx);
+
     if(!tx.d.texture)
     {
         D_pLogWarningNA("Attempt to render an empty texture!");
@@ -781,7 +1202,17 @@ void RenderSDL::renderTexture(double xDstD, double yDstD, double wDstD, double h
         sourceRect = {int(tx.l.w_scale * xSrc), int(tx.l.h_scale * ySrc),
                       int(tx.l.w_scale * wDst), int(tx.l.h_scale * hDst)};
 
-    txColorMod(tx.d, red, green, blue, alpha);
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0 && m_useBatching)
+    {
+        batchQuad(tx, destRect, sourceRect, SDL_FLIP_NONE, red, green, blue, alpha);
+        return;
+    }
+#endif
+
+    if(!prepareCopy(tx, sourceRect, red, green, blue, alpha))
+        return;
+
     SDL_RenderCopyF(m_gRenderer, tx.d.texture, &sourceRect, &destRect);
 }
 
@@ -800,6 +1231,8 @@ void RenderSDL::renderTextureFL(double xDstD, double yDstD, double wDstD, double
     if(!tx.d.texture && tx.l.lazyLoaded)
         lazyLoad(tx);
 
+    lazyTouch(tx);
+
     if(!tx.d.texture)
     {
         D_pLogWarningNA("Attempt to render an empty texture!");
@@ -852,7 +1285,17 @@ void RenderSDL::renderTextureFL(double xDstD, double yDstD, double wDstD, double
         sourceRect = {int(tx.l.w_scale * xSrc), int(tx.l.h_scale * ySrc),
                       int(tx.l.w_scale * wDst), int(tx.l.h_scale * hDst)};
 
-    txColorMod(tx.d, red, green, blue, alpha);
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0 && m_useBatching && rotateAngle == 0.0)
+    {
+        batchQuad(tx, destRect, sourceRect, flip, red, green, blue, alpha);
+        return;
+    }
+#endif
+
+    if(!prepareCopy(tx, sourceRect, red, green, blue, alpha))
+        return;
+
     SDL_RenderCopyExF(m_gRenderer, tx.d.texture, &sourceRect, &destRect,
                       rotateAngle, centerD, static_cast<SDL_RendererFlip>(flip));
 }
@@ -872,6 +1315,8 @@ void RenderSDL::renderTexture(float xDst, float yDst,
     if(!tx.d.texture && tx.l.lazyLoaded)
         lazyLoad(tx);
 
+    lazyTouch(tx);
+
     if(!tx.d.texture)
     {
         D_pLogWarningNA("Attempt to render an empty texture!");
@@ -890,13 +1335,25 @@ void RenderSDL::renderTexture(float xDst, float yDst,
     else
         sourceRect = {0, 0, tx.l.w_orig, tx.l.h_orig};
 
-    txColorMod(tx.d, red, green, blue, alpha);
+#ifdef XTECH_SDL_BATCHING
+    if(tx.d.atlas_page >= 0 && m_useBatching)
+    {
+        batchQuad(tx, destRect, sourceRect, flip, red, green, blue, alpha);
+        return;
+    }
+#endif
+
+    if(!prepareCopy(tx, sourceRect, red, green, blue, alpha))
+        return;
+
     SDL_RenderCopyExF(m_gRenderer, tx.d.texture, &sourceRect, &destRect,
                       0.0, nullptr, static_cast<SDL_RendererFlip>(flip));
 }
 
 void RenderSDL::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
 {
+    batchFlush();
+
     SDL_Rect rect;
     rect.x = x;
     rect.y = y;
@@ -911,6 +1368,8 @@ void RenderSDL::getScreenPixels(int x, int y, int w, int h, unsigned char *pixel
 
 void RenderSDL::getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels)
 {
+    batchFlush();
+
     SDL_Rect rect;
     rect.x = x;
     rect.y = y;
@@ -938,6 +1397,12 @@ void RenderSDL::getPixelData(const StdPicture &tx, unsigned char *pixelData)
     if(!tx.d.texture)
         return;
 
+#ifdef XTECH_SDL_BATCHING
+    // The atlas page is shared by many pictures and can't be locked
+    if(tx.d.atlas_page >= 0)
+        return;
+#endif
+
     SDL_SetTextureBlendMode(tx.d.texture, SDL_BLENDMODE_BLEND);
     SDL_QueryTexture(tx.d.texture, nullptr, &a, &w, &h);
     SDL_LockTexture(tx.d.texture, nullptr, &pixels, &pitch);
@@ -23,10 +23,19 @@
 #define RENDERSDL_T_H
 
 #include <set>
+#include <vector>
+#include <SDL2/SDL_version.h>
+#include <SDL2/SDL_render.h>
 
 #include "../base/render_base.h"
+#include "../base/atlas_packer.h"
 #include "cmd_line_setup.h"
 
+// The batched drawing of the atlas pages needs the SDL_RenderGeometry()
+#if SDL_COMPILEDVERSION >= SDL_VERSIONNUM(2, 0, 18)
+#   define XTECH_SDL_BATCHING
+#endif
+
 
 struct SDL_Renderer;
 struct SDL_Texture;
@@ -65,6 +74,69 @@ class RenderSDL final : public AbstractRender_t
     int m_viewport_w = 0;
     int m_viewport_h = 0;
 
+    // SDL draw calls and texture switches at this frame
+    int m_drawCalls = 0;
+    int m_textureBinds = 0;
+    SDL_Texture *m_lastTexture = nullptr;
+
+#ifdef XTECH_SDL_BATCHING
+    struct AtlasPage_t
+    {
+        SDL_Texture *texture = nullptr;
+        AtlasPacker packer;
+        //! Unique number of the page, kept by its pictures
+        uint32_t generation = 0;
+        //! Cached color modifier of the page texture
+        uint8_t modColor[4] = {255, 255, 255, 255};
+    };
+
+    //! Are the small textures packed into the atlas pages
+    bool m_useAtlas = false;
+    //! Are the atlas pictures drawn by batches (off if the render can't draw the geometry)
+    bool m_useBatching = false;
+    int m_atlasPageSize = 0;
+    Uint32 m_atlasFormat = 0;
+    std::vector<AtlasPage_t> m_atlasPages;
+    //! The latest generation of the atlas pages
+    uint32_t m_atlasGeneration = 0;
+
+    //! Atlas page of the quads at the batch, -1 if the batch is empty
+    int m_batchPage = -1;
+    std::vector<SDL_Vertex> m_batchVertices;
+    //! Two triangles per quad, the same for all batches
+    std::vector<int> m_batchIndices;
+
+    /*!
+     * rief Put the picture into the atlas page
+     * 
+eturn false if the picture should get its own texture
+     */
+    bool atlasInsert(StdPicture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels, uint32_t pitch);
+
+    //! Free the place of the picture at its atlas page
+    void atlasRelease(StdPicture &tx);
+
+    //! Add the textured quad of the atlas picture into the batch
+    void batchQuad(StdPicture &tx, const SDL_FRect &destRect, const SDL_Rect &sourceRect, unsigned int flip,
+                   float red, float green, float blue, float alpha);
+#endif
+
+    /*!
+     * rief Draw all quads of the batch
+     *
+     * Must be called before any other drawing or a change of the render state,
+     * does nothing if the batching isn't supported
+     */
+    void batchFlush();
+
+    /*!
+     * \brief Prepare the texture of the picture for the SDL_RenderCopy() call
+     * \param tx Picture to draw
+     * \param sourceRect Part of the picture, gets moved to the place of the atlas picture
+     * \return false if there is nothing to draw
+     */
+    bool prepareCopy(StdPicture &tx, SDL_Rect &sourceRect, float red, float green, float blue, float alpha);
+
 public:
     RenderSDL();
     ~RenderSDL() override;
@@ -27,6 +27,7 @@
 #include "main/game_info.h"
 #include "window_sdl.h"
 #include "../render.h"
+#include "video.h"
 
 //! Path to game resources assets (by default it's ~/.PGE_Project/thextech/)
 extern std::string AppPath;
@@ -62,12 +63,17 @@ bool WindowSDL::initSDL(const CmdLineSetup_t &setup, uint32_t windowInitFlags)
     SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 5);
 #endif
 
+    // Nothing will be shown or heard: use the off-screen video driver and don't open audio
+    if(setup.headless || setup.renderType == RENDER_NULL)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
     Uint32 sdlInitFlags = 0;
     // Prepare flags for SDL initialization
 #ifndef __EMSCRIPTEN__
     sdlInitFlags |= SDL_INIT_TIMER;
 #endif
-    sdlInitFlags |= SDL_INIT_AUDIO;
+    if(!setup.headless)
+        sdlInitFlags |= SDL_INIT_AUDIO;
     sdlInitFlags |= SDL_INIT_VIDEO;
     sdlInitFlags |= SDL_INIT_EVENTS;
     sdlInitFlags |= SDL_INIT_JOYSTICK;
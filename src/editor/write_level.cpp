@@ -25,6 +25,7 @@
 #include "sound.h"
 #include "npc_id.h"
 #include "npc_special_data.h"
+#include "npc/npc_hot.h"
 #include <PGE_File_Formats/file_formats.h>
 #include "Logger/logger.h"
 
@@ -89,6 +90,7 @@ void SaveLevel(const std::string& FilePath, int format, int version)   // saves
     syncLayersTrees_AllBlocks();
     syncLayers_AllBGOs();
     syncLayers_AllNPCs();
+    npcHotSyncAll();
 
     // NPCyFix
     // Split filepath
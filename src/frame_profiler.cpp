@@ -0,0 +1,237 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_timer.h>
+
+#include <cstdio>
+#include <cinttypes>
+
+#include <Logger/logger.h>
+#include <Utils/files.h>
+
+#include "frame_profiler.h"
+
+
+namespace FrameProfiler
+{
+
+static const char *const s_stageNames[STAGE_COUNT] =
+{
+    "LAY", "NPC", "BLK", "EFF", "PLR", "GFX", "SND", "EVT"
+};
+
+static const char *const s_stageFunctions[STAGE_COUNT] =
+{
+    "UpdateLayers", "UpdateNPCs", "UpdateBlocks", "UpdateEffects",
+    "UpdatePlayer", "UpdateGraphics", "UpdateSound", "UpdateEvents"
+};
+
+static FrameSample_t s_history[c_historySize];
+//! Index of the next frame to write
+static int s_historyNext = 0;
+static int s_historyCount = 0;
+static int64_t s_frameCounter = 0;
+
+static uint64_t s_origin = 0;
+static uint64_t s_frequency = 0;
+
+static bool s_frameOpen = false;
+static FrameSample_t s_current;
+static uint64_t s_frameStart = 0;
+//! End of the last finished stage of the current frame
+static uint64_t s_frameLast = 0;
+
+static int s_stage = -1;
+static uint64_t s_stageStart = 0;
+
+
+static inline uint64_t s_now()
+{
+    return SDL_GetPerformanceCounter();
+}
+
+static inline uint32_t s_toNs(uint64_t ticks)
+{
+    return (uint32_t)((double)ticks * 1e9 / (double)s_frequency);
+}
+
+const char *stageName(Stage stage)
+{
+    return (stage >= 0 && stage < STAGE_COUNT) ? s_stageNames[stage] : "";
+}
+
+const char *stageFunction(Stage stage)
+{
+    return (stage >= 0 && stage < STAGE_COUNT) ? s_stageFunctions[stage] : "";
+}
+
+void frameBegin()
+{
+    if(s_frameOpen)
+        frameEnd();
+
+    uint64_t now = s_now();
+
+    if(s_frequency == 0)
+    {
+        s_frequency = SDL_GetPerformanceFrequency();
+        s_origin = now;
+    }
+
+    s_current = FrameSample_t();
+    s_current.frame = s_frameCounter++;
+    s_current.start = (uint64_t)((double)(now - s_origin) * 1e9 / (double)s_frequency);
+
+    s_frameStart = now;
+    s_frameLast = now;
+    s_frameOpen = true;
+}
+
+void stageEnd()
+{
+    if(s_stage < 0 || !s_frameOpen)
+    {
+        s_stage = -1;
+        return;
+    }
+
+    uint64_t now = s_now();
+
+    if(s_current.stageTime[s_stage] == 0)
+        s_current.stageStart[s_stage] = s_toNs(s_stageStart - s_frameStart);
+
+    s_current.stageTime[s_stage] += s_toNs(now - s_stageStart);
+
+    s_frameLast = now;
+    s_stage = -1;
+}
+
+void stageBegin(Stage stage)
+{
+    stageEnd();
+
+    if(!s_frameOpen)
+        return;
+
+    s_stage = stage;
+    s_stageStart = s_now();
+}
+
+void frameEnd()
+{
+    if(!s_frameOpen)
+        return;
+
+    stageEnd();
+
+    // the time after the last stage of an interrupted frame is not its work
+    s_current.total = s_toNs(s_frameLast - s_frameStart);
+
+    s_history[s_historyNext] = s_current;
+    s_historyNext = (s_historyNext + 1) % c_historySize;
+    if(s_historyCount < c_historySize)
+        s_historyCount++;
+
+    s_frameOpen = false;
+}
+
+int historyCount()
+{
+    return s_historyCount;
+}
+
+const FrameSample_t &historyAt(int age)
+{
+    int i = s_historyNext - 1 - age;
+    while(i < 0)
+        i += c_historySize;
+    return s_history[i];
+}
+
+int summary(int frames, double avg[STAGE_COUNT + 1], double max[STAGE_COUNT + 1])
+{
+    for(int s = 0; s <= STAGE_COUNT; s++)
+        avg[s] = max[s] = 0.0;
+
+    if(frames > s_historyCount)
+        frames = s_historyCount;
+
+    for(int f = 0; f < frames; f++)
+    {
+        const FrameSample_t &fs = historyAt(f);
+
+        for(int s = 0; s <= STAGE_COUNT; s++)
+        {
+            double ms = (s == STAGE_COUNT ? fs.total : fs.stageTime[s]) / 1e6;
+            avg[s] += ms;
+            if(ms > max[s])
+                max[s] = ms;
+        }
+    }
+
+    if(frames > 0)
+    {
+        for(int s = 0; s <= STAGE_COUNT; s++)
+            avg[s] /= frames;
+    }
+
+    return frames;
+}
+
+bool exportTrace(const std::string &path)
+{
+    FILE *f = Files::utf8_fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        pLogWarning("Can't write the frame timeline into %s", path.c_str());
+        return false;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"GameLoop\"}}");
+
+    // the oldest frame goes first
+    for(int age = s_historyCount - 1; age >= 0; age--)
+    {
+        const FrameSample_t &fs = historyAt(age);
+
+        fprintf(f, ",\n{\"name\": \"Frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                   "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %" PRId64 "}}",
+                fs.start / 1e3, fs.total / 1e3, fs.frame);
+
+        for(int s = 0; s < STAGE_COUNT; s++)
+        {
+            if(fs.stageTime[s] == 0)
+                continue;
+
+            fprintf(f, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f}",
+                    s_stageFunctions[s], (fs.start + fs.stageStart[s]) / 1e3, fs.stageTime[s] / 1e3);
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    pLogDebug("Written %d frames of the timeline into %s", s_historyCount, path.c_str());
+
+    return true;
+}
+
+} // namespace FrameProfiler
@@ -0,0 +1,97 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module measures the time spent by every stage of the level loop,
+// keeps the last frames at a ring buffer and exports them as a timeline
+
+#pragma once
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <string>
+#include <cstdint>
+
+namespace FrameProfiler
+{
+
+enum Stage
+{
+    STAGE_LAYERS = 0,
+    STAGE_NPCS,
+    STAGE_BLOCKS,
+    STAGE_EFFECTS,
+    STAGE_PLAYER,
+    STAGE_GRAPHICS,
+    STAGE_SOUND,
+    STAGE_EVENTS,
+    STAGE_COUNT
+};
+
+//! Count of the frames kept at the ring buffer
+const int c_historySize = 1024;
+
+//! Time of one frame in the nanoseconds
+struct FrameSample_t
+{
+    int64_t  frame = 0;
+    //! Since the first profiled frame
+    uint64_t start = 0;
+    //! From the frame begin to the end of its last stage
+    uint32_t total = 0;
+    //! Since the frame start
+    uint32_t stageStart[STAGE_COUNT] = {};
+    //! Sum of all runs of the stage during the frame
+    uint32_t stageTime[STAGE_COUNT] = {};
+};
+
+//! Short name of the stage for the overlay
+const char *stageName(Stage stage);
+//! Name of the function of the stage for the timeline
+const char *stageFunction(Stage stage);
+
+//! Start the new frame, ends the previous one if it wasn't
+void frameBegin();
+//! End the current frame and put it into the ring buffer
+void frameEnd();
+//! End the current stage (if any) and start the given one
+void stageBegin(Stage stage);
+//! End the current stage
+void stageEnd();
+
+//! Count of the frames at the ring buffer
+int historyCount();
+//! Get the frame from the ring buffer, 0 is the latest one
+const FrameSample_t &historyAt(int age);
+
+/*!
+ * \brief Average and max time of the latest frames
+ * \param frames Count of the latest frames to take
+ * \param avg Averages of the stages and the whole frame (at the index STAGE_COUNT), in milliseconds
+ * \param max Max of the stages and the whole frame, in milliseconds
+ * \return Count of the frames taken
+ */
+int summary(int frames, double avg[STAGE_COUNT + 1], double max[STAGE_COUNT + 1]);
+
+//! Write all frames of the ring buffer as the Chrome trace-event JSON
+bool exportTrace(const std::string &path);
+
+} // namespace FrameProfiler
+
+#endif // FRAME_PROFILER_H
@@ -25,6 +25,7 @@
 #include "pge_delay.h"
 
 #include "frame_timer.h"
+#include "frame_profiler.h"
 #include "globals.h"
 #include "graphics.h"
 #include "core/render.h"
@@ -56,10 +57,15 @@ void PerformanceStats_t::reset()
    checkedScenes = 0;
    checkedPaths = 0;
    checkedLevels = 0;
+}
 
+void PerformanceStats_t::resetPhysics()
+{
    physScannedBlocks = 0;
    physScannedBGOs = 0;
    physScannedNPCs = 0;
+   activeNPCs = 0;
+   activeSectionNPCs = 0;
 }
 
 void PerformanceStats_t::print()
@@ -82,7 +88,7 @@ void PerformanceStats_t::print()
     }
     else
     {
-        XRender::renderRect(42, 6, 745, 72, 0.0f,0.0f, 0.0f, 0.3f, true);
+        XRender::renderRect(42, 6, 745, 144, 0.0f,0.0f, 0.0f, 0.3f, true);
         SuperPrint(fmt::sprintf_ne("DRAW: B=%05d Z=%04d G=%04d N=%04d, E=%03d",
                                    renderedBlocks, renderedSzBlocks, renderedBGOs, renderedNPCs, renderedEffects,
                                    (renderedBlocks + renderedSzBlocks + renderedBGOs + renderedNPCs + renderedEffects)),
@@ -94,17 +100,35 @@ void PerformanceStats_t::print()
                    3, 45, 44, 0.5f, 1.f, 1.f);
         SuperPrint(fmt::sprintf_ne("CHEK: SUMM=%d", (checkedBlocks + checkedSzBlocks+ checkedBGOs + checkedNPCs + checkedEffects)),
                    3, 45, 62, 0.5f, 1.f, 1.f);
-        // WIP
-//        SuperPrint(fmt::sprintf_ne("PHYS: B%03d G%03d N%03d, S:%03d",
-//                                   physScannedBlocks, physScannedBGOs, physScannedNPCs,
-//                                   (physScannedBlocks + physScannedBGOs + physScannedNPCs)),
-//                   3, 45, 44);
+        SuperPrint(fmt::sprintf_ne("PHYS: B=%05d G=%04d N=%04d, SUMM=%d",
+                                   physScannedBlocks, physScannedBGOs, physScannedNPCs,
+                                   (physScannedBlocks + physScannedBGOs + physScannedNPCs)),
+                   3, 45, 80, 0.5f, 1.f, 1.f);
+
+        double avg[FrameProfiler::STAGE_COUNT + 1];
+        double max[FrameProfiler::STAGE_COUNT + 1];
+        // about a second of the latest frames
+        FrameProfiler::summary(64, avg, max);
+
+        const double budget = 1000.0 / 64.1025;
+        bool over = max[FrameProfiler::STAGE_COUNT] > budget;
+        SuperPrint(fmt::sprintf_ne("TIME: AVG=%05.2f MAX=%05.2f OF %05.2f MS",
+                                   avg[FrameProfiler::STAGE_COUNT], max[FrameProfiler::STAGE_COUNT], budget),
+                   3, 45, 98, over ? 1.f : 0.5f, over ? 0.5f : 1.f, over ? 0.5f : 1.f);
+
+        std::string stages;
+        for(int i = 0; i < FrameProfiler::STAGE_COUNT; i++)
+            stages += fmt::sprintf_ne("%s=%04.1f ", FrameProfiler::stageName((FrameProfiler::Stage)i), avg[i]);
+        SuperPrint(stages, 3, 45, 116, 0.5f, 1.f, 1.f);
+        SuperPrint(fmt::sprintf_ne("ACTV: NPC=%04d SECT=%04d OF %04d",
+                                   activeNPCs, activeSectionNPCs, numNPCs),
+                   3, 45, 134, 0.5f, 1.f, 1.f);
     }
 
     if(GameMenu)
     {
         SuperPrint(fmt::sprintf_ne("MENU-MODE: %d", MenuMode),
-                   3, 45, 70, 0.5f, 1.f, 1.f);
+                   3, 45, 152, 0.5f, 1.f, 1.f);
     }
 
     XRender::offsetViewportIgnore(false);
@@ -417,7 +441,8 @@ void runFrameLoop(LoopCall_t doLoopCallbackPre,
                 break;
         }
 
-        PGE_Delay(1);
+        if(!headlessMode)
+            PGE_Delay(1);
         if(!GameIsActive)
             break;// Break on quit
     }
@@ -23,6 +23,7 @@
 #define FRAME_TIMER_H
 
 #include <functional>
+#include <cstdint>
 
 struct PerformanceStats_t
 {
@@ -55,9 +56,20 @@ struct PerformanceStats_t
     int physScannedBGOs = 0;
     int physScannedNPCs = 0;
 
+    // Size of the active NPCs list built by UpdateNPCs, in total and at the section of the first player
+    int activeNPCs = 0;
+    int activeSectionNPCs = 0;
+
+    // What the render got asked to do at the last frame, the drawn pixels are counted by the null render only
+    int renderDrawCalls = 0;
+    int renderTextureBinds = 0;
+    int64_t renderDrawnPixels = 0;
+
     bool enabled = false;
 
     void reset();
+    //! Physics counters are collected before the rendering, so they are reset separately
+    void resetPhysics();
     void print();
 };
 
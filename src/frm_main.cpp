@@ -42,6 +42,9 @@ typedef EventsSDL EventsUsed;
 #   define USE_CORE_EVENTS_SDL
 #endif
 
+#include "core/null/render_null.h"
+#include "video.h"
+
 #include "frm_main.h"
 
 
@@ -58,12 +61,15 @@ bool FrmMain::initSystem(const CmdLineSetup_t &setup)
 
     // Build interfaces
     WindowUsed *window = new WindowUsed();
-    RenderUsed *render = new RenderUsed();
+    // The null render is used without the display and replaces any other
+    RenderNull *renderNull = (setup.renderType == RENDER_NULL) ? new RenderNull() : nullptr;
+    RenderUsed *render = renderNull ? nullptr : new RenderUsed();
+    AbstractRender_t *renderBase = renderNull ? static_cast<AbstractRender_t*>(renderNull) : render;
     MsgBoxUsed *msgbox = new MsgBoxUsed();
     EventsUsed *events = new EventsUsed();
 
     m_window.reset(window);
-    m_render.reset(render);
+    m_render.reset(renderBase);
     m_msgbox.reset(msgbox);
     m_events.reset(events);
 
@@ -76,7 +82,7 @@ bool FrmMain::initSystem(const CmdLineSetup_t &setup)
     // Initializing window
 
 #ifdef USE_CORE_WINDOW_SDL
-    res = window->initSDL(setup, render->SDL_InitFlags());
+    res = window->initSDL(setup, renderBase->SDL_InitFlags());
 #else
 #error "FIXME: Implement supported window initialization here"
 #endif
@@ -103,7 +109,10 @@ bool FrmMain::initSystem(const CmdLineSetup_t &setup)
     pLogDebug("Init renderer settings...");
 
 #if defined(USE_CORE_WINDOW_SDL) && defined(USE_CORE_RENDER_SDL)
-    res = render->initRender(setup, window->getWindow());
+    if(renderNull)
+        res = renderNull->initRender(setup);
+    else
+        res = render->initRender(setup, window->getWindow());
 #else
 #error "FIXME: Implement supported render initialization here"
 #endif
@@ -65,6 +65,9 @@
 #include "main/menu_main.h"
 #include "main/game_info.h"
 #include "main/record.h"
+#include "main/asset_pack.h"
+#include "main/episode_catalog.h"
+#include "main/trees.h"
 #include "core/render.h"
 #include "core/window.h"
 #include "core/events.h"
@@ -95,6 +98,8 @@ static int loadingThread(void *waiter_ptr)
 //    Load GFX 'load the graphics form
 //    GFX.load(); // load the graphics form // Moved to before sound load
     SizableBlocks();
+    AssetPack::open(AppPath + AssetPack::c_defaultFileName, AppPath);
+    EpisodeCatalog::init(AppPathManager::episodeCatalogFile());
     LoadGFX(); // load the graphics from file
     SetupVars(); //Setup Variables
 
@@ -128,6 +133,10 @@ int GameMain(const CmdLineSetup_t &setup)
     FrameSkip = setup.frameSkip;
     noSound = setup.noSound;
     neverPause = setup.neverPause;
+    headlessMode = setup.headless;
+    headlessDraw = setup.headless && setup.headlessDraw;
+    treeNPCSetLinearScan(setup.npcLinearScan);
+    Record::SetReplayRewindAt(setup.replayRewindAt);
 
     CompatSetEnforcedLevel(setup.compatibilityLevel);
 
@@ -578,7 +587,8 @@ int GameMain(const CmdLineSetup_t &setup)
             }
 
             // Update graphics before loop begin (to process inital lazy-unpacking of used sprites)
-            GraphicsLazyPreLoad();
+            if(!headlessMode)
+                GraphicsLazyPreLoad();
             resetFrameTimer();
             // Clear the speed-runner timer
             speedRun_resetTotal();
@@ -848,7 +858,8 @@ int GameMain(const CmdLineSetup_t &setup)
 //'--------------------------------------------
 
             // Update graphics before loop begin (to process inital lazy-unpacking of used sprites)
-            GraphicsLazyPreLoad();
+            if(!headlessMode)
+                GraphicsLazyPreLoad();
             resetFrameTimer();
 
             speedRun_triggerEnter();
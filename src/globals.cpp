@@ -509,6 +509,8 @@ bool noUpdate = false;
 //double gameTime = 0.0;
 bool noSound = false;
 bool neverPause = false;
+bool headlessMode = false;
+bool headlessDraw = false;
 //double tempTime = 0.0;
 bool BattleMode = false;
 int BattleWinner = 0;
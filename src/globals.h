@@ -2096,6 +2096,10 @@ extern bool noUpdate;
 //Public noSound As Boolean
 extern bool noSound;
 extern bool neverPause;
+//! Simulation-only mode: no drawing, no sound, no frame rate limit (used by the replay validation)
+extern bool headlessMode;
+//! Run the drawing code in the headless mode anyway (the drawn frames must simulate the same as the skipped ones)
+extern bool headlessDraw;
 //Public tempTime As Double
 //extern double tempTime;
 //Dim ScrollDelay As Integer [in main.cpp]
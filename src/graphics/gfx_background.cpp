@@ -24,6 +24,45 @@
 #include "../core/render.h"
 
 
+/*!
+ * \brief Find the visible part of the horizontally repeated background picture
+ * \param S Section
+ * \param Z Screen
+ * \param A Background picture
+ * \param parallax How fast the layer moves with the camera
+ * \param last [in,out] Index of the last repetition, gets reduced to the last visible one
+ * \return Index of the first visible repetition
+ *
+ * The repetition B is placed at level[S].X + B * Width - (camera) * parallax, so the visible
+ * ones are computed from the camera instead of checking all of them over the section width.
+ * The range is one repetition wider at both sides against the rounding errors, the exact
+ * check is still done by the vScreenCollision().
+ */
+static int s_firstVisibleTile(int S, int Z, int A, double parallax, int &last)
+{
+    double width = GFXBackground2Width[A];
+
+    // The whole section is drawn for the screen 0
+    if(Z == 0 || width <= 0)
+        return 0;
+
+    double x0 = level[S].X - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * parallax;
+    double left = -vScreenX[Z];
+    double right = -vScreenX[Z] + vScreen[Z].Width;
+
+    double first = std::floor((left - width - x0) / width);
+    double lastVisible = std::ceil((right - x0) / width);
+
+    if(lastVisible < last)
+        last = static_cast<int>(lastVisible);
+
+    if(first > last)
+        return last + 1; // Nothing visible
+
+    return first > 0 ? static_cast<int>(first) : 0;
+}
+
+
 void DrawBackground(int S, int Z)
 {
     int A = 0;
@@ -39,7 +78,8 @@ void DrawBackground(int S, int Z)
     if(Background2[S] == 1)
     {
         int tempVar = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar; B++)
+        int firstVar = s_firstVisibleTile(S, Z, A, 0.5, tempVar);
+        for(B = firstVar; B <= tempVar; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A];
@@ -56,7 +96,8 @@ void DrawBackground(int S, int Z)
     if(Background2[S] == 1 || Background2[S] == 2 || Background2[S] == 22)
     {
         int tempVar2 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar2; B++)
+        int firstVar2 = s_firstVisibleTile(S, Z, A, 0.75, tempVar2);
+        for(B = firstVar2; B <= tempVar2; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A] - ScreenH + 100;
@@ -73,7 +114,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar3 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar3; B++)
+        int firstVar3 = s_firstVisibleTile(S, Z, A, 0.75, tempVar3);
+        for(B = firstVar3; B <= tempVar3; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -98,7 +140,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar4 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar4; B++)
+        int firstVar4 = s_firstVisibleTile(S, Z, A, 0.5, tempVar4);
+        for(B = firstVar4; B <= tempVar4; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A];
@@ -116,7 +159,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar5 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar5; B++)
+        int firstVar5 = s_firstVisibleTile(S, Z, A, 0.5, tempVar5);
+        for(B = firstVar5; B <= tempVar5; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -165,7 +209,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar7 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar7; B++)
+        int firstVar7 = s_firstVisibleTile(S, Z, A, 0.5, tempVar7);
+        for(B = firstVar7; B <= tempVar7; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -190,7 +235,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar8 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar8; B++)
+        int firstVar8 = s_firstVisibleTile(S, Z, A, 0.5, tempVar8);
+        for(B = firstVar8; B <= tempVar8; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -215,7 +261,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar9 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar9; B++)
+        int firstVar9 = s_firstVisibleTile(S, Z, A, 0.5, tempVar9);
+        for(B = firstVar9; B <= tempVar9; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Y - 32;
@@ -233,7 +280,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar10 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar10; B++)
+        int firstVar10 = s_firstVisibleTile(S, Z, A, 0.75, tempVar10);
+        for(B = firstVar10; B <= tempVar10; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -258,7 +306,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar11 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar11; B++)
+        int firstVar11 = s_firstVisibleTile(S, Z, A, 0.5, tempVar11);
+        for(B = firstVar11; B <= tempVar11; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A];
@@ -276,7 +325,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar12 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar12; B++)
+        int firstVar12 = s_firstVisibleTile(S, Z, A, 0.5, tempVar12);
+        for(B = firstVar12; B <= tempVar12; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -301,7 +351,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar13 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar13; B++)
+        int firstVar13 = s_firstVisibleTile(S, Z, A, 0.5, tempVar13);
+        for(B = firstVar13; B <= tempVar13; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -326,7 +377,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar14 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar14; B++)
+        int firstVar14 = s_firstVisibleTile(S, Z, A, 0.5, tempVar14);
+        for(B = firstVar14; B <= tempVar14; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -351,7 +403,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar15 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar15; B++)
+        int firstVar15 = s_firstVisibleTile(S, Z, A, 0.5, tempVar15);
+        for(B = firstVar15; B <= tempVar15; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -376,7 +429,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar16 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar16; B++)
+        int firstVar16 = s_firstVisibleTile(S, Z, A, 0.5, tempVar16);
+        for(B = firstVar16; B <= tempVar16; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -401,7 +455,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar17 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar17; B++)
+        int firstVar17 = s_firstVisibleTile(S, Z, A, 0.5, tempVar17);
+        for(B = firstVar17; B <= tempVar17; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -426,7 +481,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar18 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar18; B++)
+        int firstVar18 = s_firstVisibleTile(S, Z, A, 0.5, tempVar18);
+        for(B = firstVar18; B <= tempVar18; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Y - 32;
@@ -444,7 +500,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar19 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar19; B++)
+        int firstVar19 = s_firstVisibleTile(S, Z, A, 0.5, tempVar19);
+        for(B = firstVar19; B <= tempVar19; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A] / 4.0)
@@ -470,7 +527,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar20 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar20; B++)
+        int firstVar20 = s_firstVisibleTile(S, Z, A, 0.5, tempVar20);
+        for(B = firstVar20; B <= tempVar20; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -495,7 +553,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar21 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar21; B++)
+        int firstVar21 = s_firstVisibleTile(S, Z, A, 0.5, tempVar21);
+        for(B = firstVar21; B <= tempVar21; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -520,7 +579,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar22 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar22; B++)
+        int firstVar22 = s_firstVisibleTile(S, Z, A, 0.5, tempVar22);
+        for(B = firstVar22; B <= tempVar22; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -545,7 +605,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar23 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar23; B++)
+        int firstVar23 = s_firstVisibleTile(S, Z, A, 0.5, tempVar23);
+        for(B = firstVar23; B <= tempVar23; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A] / 4.0;
@@ -563,7 +624,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar24 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar24; B++)
+        int firstVar24 = s_firstVisibleTile(S, Z, A, 0.5, tempVar24);
+        for(B = firstVar24; B <= tempVar24; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -588,7 +650,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar25 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar25; B++)
+        int firstVar25 = s_firstVisibleTile(S, Z, A, 0.5, tempVar25);
+        for(B = firstVar25; B <= tempVar25; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Y - 32; // Height - GFXBackground2height(a)
@@ -631,7 +694,8 @@ void DrawBackground(int S, int Z)
     if(Background2[S] == 26)
     {
         int tempVar27 = int(std::ceil((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5)) + 1;
-        for(B = 0; B <= tempVar27; B++)
+        int firstVar27 = s_firstVisibleTile(S, Z, A, 0.5, tempVar27);
+        for(B = firstVar27; B <= tempVar27; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Y - 32; // Height - GFXBackground2height(a)
@@ -654,7 +718,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar28 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar28; B++)
+        int firstVar28 = s_firstVisibleTile(S, Z, A, 0.5, tempVar28);
+        for(B = firstVar28; B <= tempVar28; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -679,7 +744,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar29 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 3;
-        for(B = 0; B <= tempVar29; B++)
+        int firstVar29 = s_firstVisibleTile(S, Z, A, 0.5, tempVar29);
+        for(B = firstVar29; B <= tempVar29; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -704,7 +770,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar30 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar30; B++)
+        int firstVar30 = s_firstVisibleTile(S, Z, A, 0.5, tempVar30);
+        for(B = firstVar30; B <= tempVar30; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A] / 4.0)
@@ -730,7 +797,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar31 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar31; B++)
+        int firstVar31 = s_firstVisibleTile(S, Z, A, 0.5, tempVar31);
+        for(B = firstVar31; B <= tempVar31; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A] / 4.0)
@@ -759,7 +827,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar32 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar32; B++)
+        int firstVar32 = s_firstVisibleTile(S, Z, A, 0.5, tempVar32);
+        for(B = firstVar32; B <= tempVar32; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -784,7 +853,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar33 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar33; B++)
+        int firstVar33 = s_firstVisibleTile(S, Z, A, 0.5, tempVar33);
+        for(B = firstVar33; B <= tempVar33; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -809,7 +879,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar34 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar34; B++)
+        int firstVar34 = s_firstVisibleTile(S, Z, A, 0.5, tempVar34);
+        for(B = firstVar34; B <= tempVar34; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -834,7 +905,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar35 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar35; B++)
+        int firstVar35 = s_firstVisibleTile(S, Z, A, 0.5, tempVar35);
+        for(B = firstVar35; B <= tempVar35; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -859,7 +931,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar36 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar36; B++)
+        int firstVar36 = s_firstVisibleTile(S, Z, A, 0.5, tempVar36);
+        for(B = firstVar36; B <= tempVar36; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A];
@@ -877,7 +950,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar37 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar37; B++)
+        int firstVar37 = s_firstVisibleTile(S, Z, A, 0.75, tempVar37);
+        for(B = firstVar37; B <= tempVar37; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A] - ScreenH + 100;
@@ -894,7 +968,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar38 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar38; B++)
+        int firstVar38 = s_firstVisibleTile(S, Z, A, 0.75, tempVar38);
+        for(B = firstVar38; B <= tempVar38; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -919,7 +994,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar39 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar39; B++)
+        int firstVar39 = s_firstVisibleTile(S, Z, A, 0.5, tempVar39);
+        for(B = firstVar39; B <= tempVar39; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Height - GFXBackground2Height[A];
@@ -937,7 +1013,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar40 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar40; B++)
+        int firstVar40 = s_firstVisibleTile(S, Z, A, 0.5, tempVar40);
+        for(B = firstVar40; B <= tempVar40; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             tempLocation.Y = level[S].Y - 20; // Height - GFXBackground2height(a)
@@ -955,7 +1032,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar41 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar41; B++)
+        int firstVar41 = s_firstVisibleTile(S, Z, A, 0.5, tempVar41);
+        for(B = firstVar41; B <= tempVar41; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -997,7 +1075,8 @@ void DrawBackground(int S, int Z)
         tempLocation.Width = GFXBackground2Width[A];
 
         int tempVar42 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar42; B++)
+        int firstVar42 = s_firstVisibleTile(S, Z, A, 0.5, tempVar42);
+        for(B = firstVar42; B <= tempVar42; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1007,7 +1086,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar43 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.6))) + 1;
-        for(B = 0; B <= tempVar43; B++)
+        int firstVar43 = s_firstVisibleTile(S, Z, A, 0.6, tempVar43);
+        for(B = firstVar43; B <= tempVar43; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.6);
             if(vScreenCollision(Z, tempLocation))
@@ -1017,7 +1097,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar44 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.7))) + 1;
-        for(B = 0; B <= tempVar44; B++)
+        int firstVar44 = s_firstVisibleTile(S, Z, A, 0.7, tempVar44);
+        for(B = firstVar44; B <= tempVar44; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.7);
             if(vScreenCollision(Z, tempLocation))
@@ -1027,7 +1108,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar45 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.8))) + 1;
-        for(B = 0; B <= tempVar45; B++)
+        int firstVar45 = s_firstVisibleTile(S, Z, A, 0.8, tempVar45);
+        for(B = firstVar45; B <= tempVar45; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.8);
             if(vScreenCollision(Z, tempLocation))
@@ -1037,7 +1119,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar46 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.9))) + 1;
-        for(B = 0; B <= tempVar46; B++)
+        int firstVar46 = s_firstVisibleTile(S, Z, A, 0.9, tempVar46);
+        for(B = firstVar46; B <= tempVar46; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.9);
             if(vScreenCollision(Z, tempLocation))
@@ -1047,7 +1130,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar47 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.85))) + 1;
-        for(B = 0; B <= tempVar47; B++)
+        int firstVar47 = s_firstVisibleTile(S, Z, A, 0.85, tempVar47);
+        for(B = firstVar47; B <= tempVar47; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.85);
             if(vScreenCollision(Z, tempLocation))
@@ -1057,7 +1141,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar48 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.8))) + 1;
-        for(B = 0; B <= tempVar48; B++)
+        int firstVar48 = s_firstVisibleTile(S, Z, A, 0.8, tempVar48);
+        for(B = firstVar48; B <= tempVar48; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.8);
             if(vScreenCollision(Z, tempLocation))
@@ -1067,7 +1152,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar49 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar49; B++)
+        int firstVar49 = s_firstVisibleTile(S, Z, A, 0.75, tempVar49);
+        for(B = firstVar49; B <= tempVar49; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(vScreenCollision(Z, tempLocation))
@@ -1077,7 +1163,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar50 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.7))) + 1;
-        for(B = 0; B <= tempVar50; B++)
+        int firstVar50 = s_firstVisibleTile(S, Z, A, 0.7, tempVar50);
+        for(B = firstVar50; B <= tempVar50; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.7);
             if(vScreenCollision(Z, tempLocation))
@@ -1087,7 +1174,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar51 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar51; B++)
+        int firstVar51 = s_firstVisibleTile(S, Z, A, 0.75, tempVar51);
+        for(B = firstVar51; B <= tempVar51; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(vScreenCollision(Z, tempLocation))
@@ -1097,7 +1185,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar52 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.8))) + 1;
-        for(B = 0; B <= tempVar52; B++)
+        int firstVar52 = s_firstVisibleTile(S, Z, A, 0.8, tempVar52);
+        for(B = firstVar52; B <= tempVar52; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.8);
             if(vScreenCollision(Z, tempLocation))
@@ -1107,7 +1196,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar53 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.85))) + 1;
-        for(B = 0; B <= tempVar53; B++)
+        int firstVar53 = s_firstVisibleTile(S, Z, A, 0.85, tempVar53);
+        for(B = firstVar53; B <= tempVar53; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.85);
             if(vScreenCollision(Z, tempLocation))
@@ -1117,7 +1207,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar54 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.9))) + 1;
-        for(B = 0; B <= tempVar54; B++)
+        int firstVar54 = s_firstVisibleTile(S, Z, A, 0.9, tempVar54);
+        for(B = firstVar54; B <= tempVar54; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.9);
             if(vScreenCollision(Z, tempLocation))
@@ -1127,7 +1218,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar55 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.8))) + 1;
-        for(B = 0; B <= tempVar55; B++)
+        int firstVar55 = s_firstVisibleTile(S, Z, A, 0.8, tempVar55);
+        for(B = firstVar55; B <= tempVar55; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.8);
             if(vScreenCollision(Z, tempLocation))
@@ -1137,7 +1229,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar56 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.7))) + 1;
-        for(B = 0; B <= tempVar56; B++)
+        int firstVar56 = s_firstVisibleTile(S, Z, A, 0.7, tempVar56);
+        for(B = firstVar56; B <= tempVar56; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.7);
             if(vScreenCollision(Z, tempLocation))
@@ -1147,7 +1240,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar57 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.6))) + 1;
-        for(B = 0; B <= tempVar57; B++)
+        int firstVar57 = s_firstVisibleTile(S, Z, A, 0.6, tempVar57);
+        for(B = firstVar57; B <= tempVar57; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.6);
             if(vScreenCollision(Z, tempLocation))
@@ -1162,7 +1256,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar58 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar58; B++)
+        int firstVar58 = s_firstVisibleTile(S, Z, A, 0.5, tempVar58);
+        for(B = firstVar58; B <= tempVar58; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1186,7 +1281,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar59 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar59; B++)
+        int firstVar59 = s_firstVisibleTile(S, Z, A, 0.5, tempVar59);
+        for(B = firstVar59; B <= tempVar59; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             double frameH = vb6Round(GFXBackground2Height[A] / 4.0);
@@ -1219,7 +1315,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar60 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar60; B++)
+        int firstVar60 = s_firstVisibleTile(S, Z, A, 0.5, tempVar60);
+        for(B = firstVar60; B <= tempVar60; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1243,7 +1340,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar61 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar61; B++)
+        int firstVar61 = s_firstVisibleTile(S, Z, A, 0.5, tempVar61);
+        for(B = firstVar61; B <= tempVar61; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1266,7 +1364,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar62 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar62; B++)
+        int firstVar62 = s_firstVisibleTile(S, Z, A, 0.5, tempVar62);
+        for(B = firstVar62; B <= tempVar62; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1290,7 +1389,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar63 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar63; B++)
+        int firstVar63 = s_firstVisibleTile(S, Z, A, 0.5, tempVar63);
+        for(B = firstVar63; B <= tempVar63; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1314,7 +1414,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar64 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar64; B++)
+        int firstVar64 = s_firstVisibleTile(S, Z, A, 0.5, tempVar64);
+        for(B = firstVar64; B <= tempVar64; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1338,7 +1439,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar65 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar65; B++)
+        int firstVar65 = s_firstVisibleTile(S, Z, A, 0.5, tempVar65);
+        for(B = firstVar65; B <= tempVar65; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1372,7 +1474,8 @@ void DrawBackground(int S, int Z)
         tempLocation.Width = GFXBackground2Width[A];
 
         int tempVar66 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar66; B++)
+        int firstVar66 = s_firstVisibleTile(S, Z, A, 0.5, tempVar66);
+        for(B = firstVar66; B <= tempVar66; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1382,7 +1485,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar67 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.9))) + 1;
-        for(B = 0; B <= tempVar67; B++)
+        int firstVar67 = s_firstVisibleTile(S, Z, A, 0.9, tempVar67);
+        for(B = firstVar67; B <= tempVar67; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.9);
             if(vScreenCollision(Z, tempLocation))
@@ -1392,7 +1496,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar68 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.89))) + 1;
-        for(B = 0; B <= tempVar68; B++)
+        int firstVar68 = s_firstVisibleTile(S, Z, A, 0.89, tempVar68);
+        for(B = firstVar68; B <= tempVar68; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.89);
             if(vScreenCollision(Z, tempLocation))
@@ -1402,7 +1507,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar69 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.88))) + 1;
-        for(B = 0; B <= tempVar69; B++)
+        int firstVar69 = s_firstVisibleTile(S, Z, A, 0.88, tempVar69);
+        for(B = firstVar69; B <= tempVar69; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.88);
             if(vScreenCollision(Z, tempLocation))
@@ -1412,7 +1518,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar70 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.87))) + 1;
-        for(B = 0; B <= tempVar70; B++)
+        int firstVar70 = s_firstVisibleTile(S, Z, A, 0.87, tempVar70);
+        for(B = firstVar70; B <= tempVar70; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.87);
             if(vScreenCollision(Z, tempLocation))
@@ -1422,7 +1529,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar71 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.86))) + 1;
-        for(B = 0; B <= tempVar71; B++)
+        int firstVar71 = s_firstVisibleTile(S, Z, A, 0.86, tempVar71);
+        for(B = firstVar71; B <= tempVar71; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.86);
             if(vScreenCollision(Z, tempLocation))
@@ -1432,7 +1540,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar72 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.85))) + 1;
-        for(B = 0; B <= tempVar72; B++)
+        int firstVar72 = s_firstVisibleTile(S, Z, A, 0.85, tempVar72);
+        for(B = firstVar72; B <= tempVar72; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.85);
             if(vScreenCollision(Z, tempLocation))
@@ -1442,7 +1551,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar73 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.84))) + 1;
-        for(B = 0; B <= tempVar73; B++)
+        int firstVar73 = s_firstVisibleTile(S, Z, A, 0.84, tempVar73);
+        for(B = firstVar73; B <= tempVar73; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.84);
             if(vScreenCollision(Z, tempLocation))
@@ -1452,7 +1562,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar74 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.83))) + 1;
-        for(B = 0; B <= tempVar74; B++)
+        int firstVar74 = s_firstVisibleTile(S, Z, A, 0.83, tempVar74);
+        for(B = firstVar74; B <= tempVar74; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.83);
             if(vScreenCollision(Z, tempLocation))
@@ -1476,7 +1587,8 @@ void DrawBackground(int S, int Z)
         tempLocation.Width = GFXBackground2Width[A];
 
         int tempVar75 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar75; B++)
+        int firstVar75 = s_firstVisibleTile(S, Z, A, 0.5, tempVar75);
+        for(B = firstVar75; B <= tempVar75; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1486,7 +1598,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar76 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.65))) + 1;
-        for(B = 0; B <= tempVar76; B++)
+        int firstVar76 = s_firstVisibleTile(S, Z, A, 0.65, tempVar76);
+        for(B = firstVar76; B <= tempVar76; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.65);
             if(vScreenCollision(Z, tempLocation))
@@ -1496,7 +1609,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar77 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.6))) + 1;
-        for(B = 0; B <= tempVar77; B++)
+        int firstVar77 = s_firstVisibleTile(S, Z, A, 0.6, tempVar77);
+        for(B = firstVar77; B <= tempVar77; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.6);
             if(vScreenCollision(Z, tempLocation))
@@ -1521,7 +1635,8 @@ void DrawBackground(int S, int Z)
         tempLocation.Width = GFXBackground2Width[A];
 
         int tempVar78 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.75))) + 1;
-        for(B = 0; B <= tempVar78; B++)
+        int firstVar78 = s_firstVisibleTile(S, Z, A, 0.75, tempVar78);
+        for(B = firstVar78; B <= tempVar78; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.75);
             if(vScreenCollision(Z, tempLocation))
@@ -1531,7 +1646,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar79 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar79; B++)
+        int firstVar79 = s_firstVisibleTile(S, Z, A, 0.5, tempVar79);
+        for(B = firstVar79; B <= tempVar79; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1555,7 +1671,8 @@ void DrawBackground(int S, int Z)
         tempLocation.Width = GFXBackground2Width[A];
 
         int tempVar80 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar80; B++)
+        int firstVar80 = s_firstVisibleTile(S, Z, A, 0.5, tempVar80);
+        for(B = firstVar80; B <= tempVar80; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1565,7 +1682,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar81 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.9))) + 1;
-        for(B = 0; B <= tempVar81; B++)
+        int firstVar81 = s_firstVisibleTile(S, Z, A, 0.9, tempVar81);
+        for(B = firstVar81; B <= tempVar81; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.9);
             if(vScreenCollision(Z, tempLocation))
@@ -1575,7 +1693,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar82 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.89))) + 1;
-        for(B = 0; B <= tempVar82; B++)
+        int firstVar82 = s_firstVisibleTile(S, Z, A, 0.89, tempVar82);
+        for(B = firstVar82; B <= tempVar82; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.89);
             if(vScreenCollision(Z, tempLocation))
@@ -1585,7 +1704,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar83 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.88))) + 1;
-        for(B = 0; B <= tempVar83; B++)
+        int firstVar83 = s_firstVisibleTile(S, Z, A, 0.88, tempVar83);
+        for(B = firstVar83; B <= tempVar83; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.88);
             if(vScreenCollision(Z, tempLocation))
@@ -1595,7 +1715,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar84 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.87))) + 1;
-        for(B = 0; B <= tempVar84; B++)
+        int firstVar84 = s_firstVisibleTile(S, Z, A, 0.87, tempVar84);
+        for(B = firstVar84; B <= tempVar84; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.87);
             if(vScreenCollision(Z, tempLocation))
@@ -1605,7 +1726,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar85 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.86))) + 1;
-        for(B = 0; B <= tempVar85; B++)
+        int firstVar85 = s_firstVisibleTile(S, Z, A, 0.86, tempVar85);
+        for(B = firstVar85; B <= tempVar85; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.86);
             if(vScreenCollision(Z, tempLocation))
@@ -1615,7 +1737,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar86 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.85))) + 1;
-        for(B = 0; B <= tempVar86; B++)
+        int firstVar86 = s_firstVisibleTile(S, Z, A, 0.85, tempVar86);
+        for(B = firstVar86; B <= tempVar86; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.85);
             if(vScreenCollision(Z, tempLocation))
@@ -1625,7 +1748,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar87 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.84))) + 1;
-        for(B = 0; B <= tempVar87; B++)
+        int firstVar87 = s_firstVisibleTile(S, Z, A, 0.84, tempVar87);
+        for(B = firstVar87; B <= tempVar87; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.84);
             if(vScreenCollision(Z, tempLocation))
@@ -1635,7 +1759,8 @@ void DrawBackground(int S, int Z)
         }
 
         int tempVar88 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.83))) + 1;
-        for(B = 0; B <= tempVar88; B++)
+        int firstVar88 = s_firstVisibleTile(S, Z, A, 0.83, tempVar88);
+        for(B = firstVar88; B <= tempVar88; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.83);
             if(vScreenCollision(Z, tempLocation))
@@ -1649,7 +1774,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar89 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar89; B++)
+        int firstVar89 = s_firstVisibleTile(S, Z, A, 0.5, tempVar89);
+        for(B = firstVar89; B <= tempVar89; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1673,7 +1799,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar90 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar90; B++)
+        int firstVar90 = s_firstVisibleTile(S, Z, A, 0.5, tempVar90);
+        for(B = firstVar90; B <= tempVar90; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1698,7 +1825,8 @@ void DrawBackground(int S, int Z)
     {
 
         int tempVar91 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar91; B++)
+        int firstVar91 = s_firstVisibleTile(S, Z, A, 0.5, tempVar91);
+        for(B = firstVar91; B <= tempVar91; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A] / 4.0)
@@ -1735,7 +1863,8 @@ void DrawBackground(int S, int Z)
 
 
         int tempVar92 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.65))) + 1;
-        for(B = 0; B <= tempVar92; B++)
+        int firstVar92 = s_firstVisibleTile(S, Z, A, 0.65, tempVar92);
+        for(B = firstVar92; B <= tempVar92; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.65);
             if(vScreenCollision(Z, tempLocation))
@@ -1746,7 +1875,8 @@ void DrawBackground(int S, int Z)
 
 
         int tempVar93 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.6))) + 1;
-        for(B = 0; B <= tempVar93; B++)
+        int firstVar93 = s_firstVisibleTile(S, Z, A, 0.6, tempVar93);
+        for(B = firstVar93; B <= tempVar93; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.6);
             if(vScreenCollision(Z, tempLocation))
@@ -1757,7 +1887,8 @@ void DrawBackground(int S, int Z)
 
 
         int tempVar94 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.55))) + 1;
-        for(B = 0; B <= tempVar94; B++)
+        int firstVar94 = s_firstVisibleTile(S, Z, A, 0.55, tempVar94);
+        for(B = firstVar94; B <= tempVar94; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.55);
             if(vScreenCollision(Z, tempLocation))
@@ -1768,7 +1899,8 @@ void DrawBackground(int S, int Z)
 
 
         int tempVar95 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar95; B++)
+        int firstVar95 = s_firstVisibleTile(S, Z, A, 0.5, tempVar95);
+        for(B = firstVar95; B <= tempVar95; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(vScreenCollision(Z, tempLocation))
@@ -1782,7 +1914,8 @@ void DrawBackground(int S, int Z)
     if(Background2[S] == 57)
     {
         int tempVar96 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 2;
-        for(B = 0; B <= tempVar96; B++)
+        int firstVar96 = s_firstVisibleTile(S, Z, A, 0.5, tempVar96);
+        for(B = firstVar96; B <= tempVar96; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A])
@@ -1811,7 +1944,8 @@ void DrawBackground(int S, int Z)
     if(Background2[S] == 58)
     {
         int tempVar97 = static_cast<int>(floor(static_cast<double>((level[S].Width - level[S].X) / GFXBackground2Width[A] * 0.5))) + 1;
-        for(B = 0; B <= tempVar97; B++)
+        int firstVar97 = s_firstVisibleTile(S, Z, A, 0.5, tempVar97);
+        for(B = firstVar97; B <= tempVar97; B++)
         {
             tempLocation.X = level[S].X + ((B * GFXBackground2Width[A]) - (vScreenX[Z] + vScreen[Z].Left + level[S].X) * 0.5);
             if(level[S].Height - level[S].Y > GFXBackground2Height[A] / 4.0)
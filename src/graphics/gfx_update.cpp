@@ -31,6 +31,8 @@
 #include "../main/menu_main.h"
 #include "../main/speedrunner.h"
 #include "../main/trees.h"
+#include "../npc/npc_hot.h"
+#include "../npc/npc_active.h"
 #include "../main/screen_pause.h"
 #include "../main/screen_connect.h"
 #include "../main/screen_quickreconnect.h"
@@ -157,6 +159,7 @@ void GraphicsLazyPreLoad()
 {
     // TODO: check if this is needed at caller
     SetupScreens();
+    npcHotSyncAll();
 
     int numScreens = 1;
 
@@ -267,13 +270,242 @@ void GraphicsLazyPreLoad()
 
         for(int A = 1; A <= numNPCs; A++)
         {
-            auto &n = NPC[A];
-            if(vScreenCollision(Z, n.Location) && IF_INRANGE(n.Type, 0, maxNPCType))
-                XRender::lazyPreLoad(GFXNPC[n.Type]);
+            int type = g_npcHot.type[A];
+            if(npcHotCollision(Z, A) && IF_INRANGE(type, 0, maxNPCType))
+                XRender::lazyPreLoad(GFXNPC[type]);
         }
     }
 }
 
+/* ================= Headless NPC activation ================= */
+// The drawn frames activate the NPCs inside of their draw loops. The headless frames
+// don't draw, so they apply the same rules here, in the order of the draw loops, to
+// simulate like the drawn frames do. The normal frame skip keeps its reduced loop.
+
+//! Drawn behind the blocks
+static inline bool s_npcBehindBlocks(int A)
+{
+    const NPC_t &n = NPC[A];
+    return (((n.Effect == 208 || NPCIsAVine[n.Type] ||
+              n.Type == 209 || n.Type == 159 || n.Type == 245 ||
+              n.Type == 8 || n.Type == 93 || n.Type == 74 ||
+              n.Type == 256 || n.Type == 257 || n.Type == 51 ||
+              n.Type == 52 || n.Effect == 1 || n.Effect == 3 ||
+              n.Effect == 4 || (n.Type == 45 && n.Special == 0.0)) &&
+              (n.standingOnPlayer == 0 && (!n.Generator || LevelEditor))) ||
+              n.Type == 179 || n.Type == 270) &&
+           n.Effect != 2 && (!n.Generator || LevelEditor);
+}
+
+//! Drawn behind the other NPCs
+static inline bool s_npcBehindNPCs(int A)
+{
+    const NPC_t &n = NPC[A];
+    return n.Effect == 0 && n.HoldingPlayer == 0 &&
+           (n.standingOnPlayer > 0 || n.Type == 56 || n.Type == 22 || n.Type == 49 ||
+            n.Type == 91 || n.Type == 160 || n.Type == 282 || NPCIsACoin[n.Type]) &&
+           (!n.Generator || LevelEditor);
+}
+
+//! The frozen NPCs
+static inline bool s_npcIce(int A)
+{
+    const NPC_t &n = NPC[A];
+    return n.Type == 263 && n.Effect == 0 && n.HoldingPlayer == 0;
+}
+
+//! Drawn in front of the blocks
+static inline bool s_npcInFront(int A)
+{
+    const NPC_t &n = NPC[A];
+    return n.Effect == 0 &&
+           !(n.HoldingPlayer > 0 || NPCIsAVine[n.Type] || n.Type == 209 || n.Type == 282 ||
+             n.Type == 270 || n.Type == 160 || n.Type == 159 || n.Type == 8 || n.Type == 245 ||
+             n.Type == 93 || n.Type == 51 || n.Type == 52 || n.Type == 74 || n.Type == 256 ||
+             n.Type == 257 || n.Type == 56 || n.Type == 22 || n.Type == 49 || n.Type == 91) &&
+           !(n.Type == 45 && n.Special == 0) && n.standingOnPlayer == 0 &&
+           !NPCForeground[n.Type] && (!n.Generator || LevelEditor) &&
+           n.Type != 179 && n.Type != 263 && !NPCIsACoin[n.Type];
+}
+
+//! Drawn in front of everything
+static inline bool s_npcForeground(int A)
+{
+    const NPC_t &n = NPC[A];
+    return n.Effect == 0 && NPCForeground[n.Type] && n.HoldingPlayer == 0 &&
+           (!n.Generator || LevelEditor) && !NPCIsACoin[n.Type];
+}
+
+//! Blinking after being dropped from the container
+static inline bool s_npcDropped(int A)
+{
+    return NPC[A].Effect == 2 && std::fmod(NPC[A].Effect2, 3) != 0.0;
+}
+
+//! Is the NPC or its graphics (which may be wider) visible at the screen
+static inline bool s_npcGfxOnScreen(int Z, int A)
+{
+    if(g_npcHot.flags[A] & NPC_HOT_HIDDEN)
+        return false;
+
+    if(npcHotCollision(Z, A))
+        return true;
+
+    const NPC_t &n = NPC[A];
+    auto gfxLoc = newLoc(n.Location.X - (NPCWidthGFX[n.Type] - n.Location.Width) / 2.0,
+                         n.Location.Y,
+                         static_cast<double>(NPCWidthGFX[n.Type]),
+                         static_cast<double>(NPCHeight[n.Type]));
+
+    return vScreenCollision(Z, gfxLoc);
+}
+
+static inline void s_npcSeen(int Z, int A, bool activate, bool longLife = false)
+{
+    auto &n = NPC[A];
+
+    if(activate)
+    {
+        if(!n.Active)
+            n.JustActivated = Z;
+
+        n.TimeLeft = Physics.NPCTimeOffScreen;
+        if(longLife)
+            n.TimeLeft = Physics.NPCTimeOffScreen * 20;
+
+        n.Active = true;
+        npcActiveAdd(A);
+    }
+
+    n.Reset[1] = false;
+    n.Reset[2] = false;
+}
+
+static inline void s_npcNotSeen(int Z, int A, int numScreens)
+{
+    auto &n = NPC[A];
+
+    n.Reset[Z] = true;
+    if(numScreens == 1)
+        n.Reset[2] = true;
+    if(SingleCoop == 1)
+        n.Reset[2] = true;
+    else if(SingleCoop == 2)
+        n.Reset[1] = true;
+}
+
+static inline bool s_npcLongLife(int type)
+{
+    return NPCIsYoshi[type] || NPCIsBoot[type] || type == 9 || type == 14 || type == 22 || type == 90 ||
+           type == 153 || type == 169 || type == 170 || type == 182 || type == 183 || type == 184 ||
+           type == 185 || type == 186 || type == 187 || type == 188 || type == 195 || type == 104;
+}
+
+//! Activate the NPCs seen by the vScreen Z, in the order of the draw loops
+static void s_activateNPCs(int Z, int numScreens)
+{
+    int A;
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcBehindBlocks(A))
+            continue;
+
+        if(npcHotOnScreen(Z, A))
+            s_npcSeen(Z, A, NPC[A].Reset[Z] || NPC[A].Active);
+        else
+            s_npcNotSeen(Z, A, numScreens);
+    }
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcBehindNPCs(A))
+            continue;
+
+        if(s_npcGfxOnScreen(Z, A))
+            s_npcSeen(Z, A, NPC[A].Reset[Z] || NPC[A].Active);
+        else
+            s_npcNotSeen(Z, A, numScreens);
+    }
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcIce(A))
+            continue;
+
+        if(s_npcGfxOnScreen(Z, A))
+            s_npcSeen(Z, A, NPC[A].Reset[Z] || NPC[A].Active);
+        else
+            s_npcNotSeen(Z, A, numScreens);
+    }
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcInFront(A))
+            continue;
+
+        if(npcHotOnScreen(Z, A))
+        {
+            // the slot gets the last NPC, which is activated in place of the killed one
+            if(NPC[A].Type == 0)
+            {
+                NPC[A].Killed = 9;
+                KillNPC(A, 9);
+            }
+
+            s_npcSeen(Z, A, (NPC[A].Reset[1] && NPC[A].Reset[2]) || NPC[A].Active || NPC[A].Type == 57,
+                      s_npcLongLife(NPC[A].Type));
+        }
+        else
+            s_npcNotSeen(Z, A, numScreens);
+    }
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcForeground(A))
+            continue;
+
+        if(npcHotOnScreen(Z, A))
+            s_npcSeen(Z, A, (NPC[A].Reset[1] && NPC[A].Reset[2]) || NPC[A].Active);
+        else
+            s_npcNotSeen(Z, A, numScreens);
+    }
+
+    if(LevelEditor)
+        return;
+
+    // NPC Generators
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if((g_npcHot.flags[A] & NPC_HOT_GENERATOR) && npcHotOnScreen(Z, A))
+            NPC[A].GeneratorActive = true;
+    }
+
+    if(GameMenu || GameOutro)
+        return;
+
+    for(A = 1; A <= numNPCs; A++)
+    {
+        if(!s_npcDropped(A))
+            continue;
+
+        if(npcHotCollision(Z, A))
+        {
+            if(NPC[A].Reset[Z] || NPC[A].Active)
+            {
+                NPC[A].TimeLeft = Physics.NPCTimeOffScreen;
+                NPC[A].Active = true;
+                npcActiveAdd(A);
+            }
+
+            NPC[A].Reset[1] = false;
+            NPC[A].Reset[2] = false;
+        }
+        else
+            NPC[A].Reset[Z] = true;
+    }
+}
+
 // This draws the graphic to the screen when in a level/game menu/outro/level editor
 void UpdateGraphics(bool skipRepaint)
 {
@@ -298,9 +530,10 @@ void UpdateGraphics(bool skipRepaint)
     // frame skip code
     cycleNextInc();
 
-    if(FrameSkip && !TakeScreen)
+    // the headless mode never draws, but the camera and the NPC activation logic must still run
+    if((FrameSkip && !TakeScreen) || (headlessMode && !headlessDraw))
     {
-        if(frameSkipNeeded()) // Don't draw this frame
+        if(frameSkipNeeded() || (headlessMode && !headlessDraw)) // Don't draw this frame
         {
             numScreens = 1;
             if(!LevelEditor)
@@ -337,40 +570,51 @@ void UpdateGraphics(bool skipRepaint)
                     }
                 }
 
-                for(A = 1; A <= numNPCs; A++)
+                // the headless frames stand for the drawn ones, the skipped frames only keep the NPCs alive
+                if(headlessMode && !headlessDraw)
+                    s_activateNPCs(Z, numScreens);
+                else
                 {
-                    if(vScreenCollision(Z, NPC[A].Location) && !NPC[A].Hidden)
+                    for(A = 1; A <= numNPCs; A++)
                     {
-                        if(NPC[A].Reset[Z] || NPC[A].Active)
+                        if(npcHotOnScreen(Z, A))
                         {
-                            if(!NPC[A].Active)
+                            if(NPC[A].Reset[Z] || NPC[A].Active)
                             {
-                                NPC[A].JustActivated = Z;
+                                if(!NPC[A].Active)
+                                {
+                                    NPC[A].JustActivated = Z;
 //                                if(nPlay.Online == true)
 //                                {
 //                                    Netplay::sendData "2a" + std::to_string(A) + "|" + (nPlay.MySlot + 1) + LB;
 //                                    NPC[A].JustActivated = nPlay.MySlot + 1;
 //                                }
-                            }
-                            NPC[A].TimeLeft = Physics.NPCTimeOffScreen;
+                                }
+                                NPC[A].TimeLeft = Physics.NPCTimeOffScreen;
 //                            if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                timeStr += "2b" + std::to_string(A) + LB;
-                            NPC[A].Active = true;
+                                NPC[A].Active = true;
+                                npcActiveAdd(A);
+                            }
+                            NPC[A].Reset[1] = false;
+                            NPC[A].Reset[2] = false;
+                        }
+                        else
+                        {
+                            NPC[A].Reset[Z] = true;
+                            if(numScreens == 1)
+                                NPC[A].Reset[2] = true;
+                            if(SingleCoop == 1)
+                                NPC[A].Reset[2] = true;
+                            else if(SingleCoop == 2)
+                                NPC[A].Reset[1] = true;
                         }
-                        NPC[A].Reset[1] = false;
-                        NPC[A].Reset[2] = false;
-                    }
-                    else
-                    {
-                        NPC[A].Reset[Z] = true;
-                        if(numScreens == 1)
-                            NPC[A].Reset[2] = true;
-                        if(SingleCoop == 1)
-                            NPC[A].Reset[2] = true;
-                        else if(SingleCoop == 2)
-                            NPC[A].Reset[1] = true;
                     }
                 }
+
+                // keep the number of random calls consistent with the drawn frames
+                if(headlessMode)
+                    s_shakeScreen.update();
             }
             return;
         }
@@ -941,7 +1185,7 @@ void UpdateGraphics(bool skipRepaint)
             {
                 if(NPC[A].Effect != 2 && (!NPC[A].Generator || LevelEditor))
                 {
-                    if(vScreenCollision(Z, NPC[A].Location) && !NPC[A].Hidden)
+                    if(npcHotOnScreen(Z, A))
                     {
                         if(NPC[A].Active)
                         {
@@ -998,6 +1242,7 @@ void UpdateGraphics(bool skipRepaint)
 //                            if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                timeStr += "2b" + std::to_string(A) + LB;
                             NPC[A].Active = true;
+                            npcActiveAdd(A);
                         }
                         NPC[A].Reset[1] = false;
                         NPC[A].Reset[2] = false;
@@ -1492,7 +1737,7 @@ void UpdateGraphics(bool skipRepaint)
                                           static_cast<double>(NPCHeight[NPC[A].Type]));
 
                     // If Not NPCIsACoin(.Type) Then
-                    if((vScreenCollision(Z, NPC[A].Location) || vScreenCollision(Z, npcALoc)) && !NPC[A].Hidden)
+                    if((npcHotCollision(Z, A) || vScreenCollision(Z, npcALoc)) && !(g_npcHot.flags[A] & NPC_HOT_HIDDEN))
                     {
                         if(NPC[A].Active)
                         {
@@ -1523,6 +1768,7 @@ void UpdateGraphics(bool skipRepaint)
 //                                if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                    timeStr += "2b" + std::to_string(A) + LB;
                             NPC[A].Active = true;
+                            npcActiveAdd(A);
                         }
 
                         NPC[A].Reset[1] = false;
@@ -1554,7 +1800,7 @@ void UpdateGraphics(bool skipRepaint)
                                       static_cast<double>(NPCWidthGFX[NPC[A].Type]),
                                       static_cast<double>(NPCHeight[NPC[A].Type]));
 
-                if((vScreenCollision(Z, NPC[A].Location) || vScreenCollision(Z, npcALoc)) && !NPC[A].Hidden)
+                if((npcHotCollision(Z, A) || vScreenCollision(Z, npcALoc)) && !(g_npcHot.flags[A] & NPC_HOT_HIDDEN))
                 {
                     g_stats.renderedNPCs++;
                     DrawFrozenNPC(Z, A);
@@ -1574,6 +1820,7 @@ void UpdateGraphics(bool skipRepaint)
 //                        if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                            timeStr += "2b" + std::to_string(A) + LB;
                         NPC[A].Active = true;
+                        npcActiveAdd(A);
                     }
                     NPC[A].Reset[1] = false;
                     NPC[A].Reset[2] = false;
@@ -1609,7 +1856,7 @@ void UpdateGraphics(bool skipRepaint)
                 {
                     if(!NPCIsACoin[NPC[A].Type])
                     {
-                        if(vScreenCollision(Z, NPC[A].Location) && !NPC[A].Hidden)
+                        if(npcHotOnScreen(Z, A))
                         {
                             if(NPC[A].Type == 0)
                             {
@@ -1777,6 +2024,7 @@ void UpdateGraphics(bool skipRepaint)
 //                                if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                    timeStr += "2b" + std::to_string(A) + LB;
                                 NPC[A].Active = true;
+                                npcActiveAdd(A);
                             }
                             NPC[A].Reset[1] = false;
                             NPC[A].Reset[2] = false;
@@ -1987,7 +2235,7 @@ void UpdateGraphics(bool skipRepaint)
                 {
                     if(!NPCIsACoin[NPC[A].Type])
                     {
-                        if(vScreenCollision(Z, NPC[A].Location) && !NPC[A].Hidden)
+                        if(npcHotOnScreen(Z, A))
                         {
                             if(NPC[A].Active)
                             {
@@ -2016,6 +2264,7 @@ void UpdateGraphics(bool skipRepaint)
 //                                if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                    timeStr += "2b" + std::to_string(A) + LB;
                                 NPC[A].Active = true;
+                                npcActiveAdd(A);
                             }
                             NPC[A].Reset[1] = false;
                             NPC[A].Reset[2] = false;
@@ -2111,9 +2360,9 @@ void UpdateGraphics(bool skipRepaint)
             for(A = 1; A <= numNPCs; A++)
             {
                 g_stats.checkedNPCs++;
-                if(NPC[A].Generator)
+                if(g_npcHot.flags[A] & NPC_HOT_GENERATOR)
                 {
-                    if(vScreenCollision(Z, NPC[A].Location) && !NPC[A].Hidden)
+                    if(npcHotOnScreen(Z, A))
                         NPC[A].GeneratorActive = true;
                 }
             }
@@ -2193,7 +2442,7 @@ void UpdateGraphics(bool skipRepaint)
                     {
                         if(std::fmod(NPC[A].Effect2, 3) != 0.0)
                         {
-                            if(vScreenCollision(Z, NPC[A].Location))
+                            if(npcHotCollision(Z, A))
                             {
                                 if(NPC[A].Active)
                                 {
@@ -2214,6 +2463,7 @@ void UpdateGraphics(bool skipRepaint)
 //                                    if(nPlay.Online == true && nPlay.NPCWaitCount >= 10 && nPlay.Mode == 0)
 //                                        timeStr += "2b" + std::to_string(A) + LB;
                                     NPC[A].Active = true;
+                                    npcActiveAdd(A);
                                 }
 
                                 NPC[A].Reset[1] = false;
@@ -36,6 +36,8 @@
 #include "editor.h"
 #include "blocks.h"
 #include "main/trees.h"
+#include "npc/npc_active.h"
+#include "npc/npc_hot.h"
 
 int numLayers = 0;
 RangeArr<Layer_t, 0, maxLayers> Layer;
@@ -105,6 +107,7 @@ bool SwapLayers(layerindex_t index_1, layerindex_t index_2)
         return false;
 
     std::swap(Layer[index_1], Layer[index_2]);
+    treeBlockSwapLayers(index_1, index_2);
 
     // repoint all of Layer 1's objects to index 2
     for(int A : Layer[index_1].NPCs)
@@ -389,12 +392,14 @@ void ShowLayer(layerindex_t L, bool NoEffect)
                 }
             }
             NPC[A].Hidden = false;
+            npcHotUpdate(A);
             NPC[A].GeneratorActive = true;
             NPC[A].Reset[1] = true;
             NPC[A].Reset[2] = true;
             if(!NPC[A].Generator)
             {
                 NPC[A].Active = true;
+                npcActiveAdd(A);
                 NPC[A].TimeLeft = 1;
             }
             CheckSectionNPC(A);
@@ -483,6 +488,7 @@ void HideLayer(layerindex_t L, bool NoEffect)
                 }
             }
             NPC[A].Hidden = true;
+            npcHotUpdate(A);
             if(!NPC[A].Generator)
             {
                 Deactivate(A);
@@ -1340,11 +1346,59 @@ void UpdateLayers()
 
 void syncLayersTrees_AllBlocks()
 {
-    // treeLevelCleanBlockLayers();
+    treeLevelCleanBlockLayers();
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].blocks.clear();
+
+    // the blocks are visited in the ascending order, so the layers get them already sorted
     for(int block = 1; block <= numBlock; block++)
     {
-        syncLayersTrees_Block(block);
+        int layer = Block[block].Layer;
+        Block[block].LocationInLayer = Block[block].Location;
+
+        if(layer != LAYER_NONE)
+        {
+            Block[block].LocationInLayer.X = Block[block].Location.X - Layer[layer].OffsetX;
+            Block[block].LocationInLayer.Y = Block[block].Location.Y - Layer[layer].OffsetY;
+            treeBlockAddLayer(layer, &Block[block]);
+            Layer[layer].blocks.append(block);
+        }
+        else
+            treeBlockAddLayer(-1, &Block[block]);
+    }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].blocks.finishAppend();
+}
+
+void syncLayersTrees_BlocksFrom(int first)
+{
+    if(first < 1)
+        first = 1;
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].blocks.eraseFrom(first);
+
+    // the trees move every re-added slot to the tree of its new layer
+    for(int block = first; block <= numBlock; block++)
+    {
+        int layer = Block[block].Layer;
+        Block[block].LocationInLayer = Block[block].Location;
+
+        if(layer != LAYER_NONE)
+        {
+            Block[block].LocationInLayer.X = Block[block].Location.X - Layer[layer].OffsetX;
+            Block[block].LocationInLayer.Y = Block[block].Location.Y - Layer[layer].OffsetY;
+            treeBlockAddLayer(layer, &Block[block]);
+            Layer[layer].blocks.append(block);
+        }
+        else
+            treeBlockAddLayer(-1, &Block[block]);
     }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].blocks.finishAppend();
 }
 
 void syncLayersTrees_Block(int block)
@@ -1352,10 +1406,7 @@ void syncLayersTrees_Block(int block)
     for(int layer = 0; layer <= numLayers; layer++)
     {
         if(layer != Block[block].Layer)
-        {
             Layer[layer].blocks.erase(block);
-            // treeBlockRemoveLayer(layer, &Block[block]);
-        }
     }
     int layer = Block[block].Layer;
     if(block <= numBlock)
@@ -1365,25 +1416,25 @@ void syncLayersTrees_Block(int block)
             Block[block].LocationInLayer = Block[block].Location;
             Block[block].LocationInLayer.X = Block[block].Location.X - Layer[layer].OffsetX;
             Block[block].LocationInLayer.Y = Block[block].Location.Y - Layer[layer].OffsetY;
-            // treeBlockAddLayer(layer, &Block[block]);
+            treeBlockAddLayer(layer, &Block[block]);
             Layer[layer].blocks.insert(block);
         }
         else
         {
             Block[block].LocationInLayer = Block[block].Location;
-            // treeBlockAddLayer(-1, &Block[block]);
+            treeBlockAddLayer(-1, &Block[block]);
         }
     }
     else
     {
         if(layer != LAYER_NONE)
         {
-            // treeBlockRemoveLayer(layer, &Block[block]);
+            treeBlockRemoveLayer(layer, &Block[block]);
             Layer[layer].blocks.erase(block);
         }
         else
         {
-            // treeBlockRemoveLayer(-1, &Block[block]);
+            treeBlockRemoveLayer(-1, &Block[block]);
         }
     }
 }
@@ -1397,10 +1448,17 @@ void syncLayersTrees_Block_SetHidden(int block) // set block hidden based on lay
 
 void syncLayers_AllNPCs()
 {
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].NPCs.clear();
+
     for(int npc = 1; npc <= numNPCs; npc++)
     {
-        syncLayers_NPC(npc);
+        if(NPC[npc].Layer != LAYER_NONE)
+            Layer[NPC[npc].Layer].NPCs.append(npc);
     }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].NPCs.finishAppend();
 }
 
 void syncLayers_NPC(int npc)
@@ -1412,14 +1470,25 @@ void syncLayers_NPC(int npc)
         else
             Layer[layer].NPCs.erase(npc);
     }
+
+    // every spawned NPC passes here once it's set up
+    if(npc <= numNPCs)
+        npcHotUpdate(npc);
 }
 
 void syncLayers_AllBGOs()
 {
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].BGOs.clear();
+
     for(int bgo = 1; bgo <= numBackground + numLocked; bgo++)
     {
-        syncLayers_BGO(bgo);
+        if(Background[bgo].Layer != LAYER_NONE)
+            Layer[Background[bgo].Layer].BGOs.append(bgo);
     }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].BGOs.finishAppend();
 }
 
 void syncLayers_BGO(int bgo)
@@ -1433,6 +1502,21 @@ void syncLayers_BGO(int bgo)
     }
 }
 
+void syncLayers_AllWarps()
+{
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].warps.clear();
+
+    for(int warp = 1; warp <= numWarps; warp++)
+    {
+        if(Warp[warp].Layer != LAYER_NONE)
+            Layer[Warp[warp].Layer].warps.append(warp);
+    }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].warps.finishAppend();
+}
+
 void syncLayers_Warp(int warp)
 {
     for(int layer = 0; layer <= numLayers; layer++)
@@ -1444,6 +1528,21 @@ void syncLayers_Warp(int warp)
     }
 }
 
+void syncLayers_AllWaters()
+{
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].waters.clear();
+
+    for(int water = 1; water <= numWater; water++)
+    {
+        if(Water[water].Layer != LAYER_NONE)
+            Layer[Water[water].Layer].waters.append(water);
+    }
+
+    for(int layer = 0; layer <= maxLayers; layer++)
+        Layer[layer].waters.finishAppend();
+}
+
 void syncLayers_Water(int water)
 {
     for(int layer = 0; layer <= numLayers; layer++)
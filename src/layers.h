@@ -24,8 +24,8 @@
 
 #include <string>
 #include <vector>
-#include <set>
 #include "range_arr.hpp"
+#include "sorted_int_set.hpp"
 #include "location.h"
 #include "global_constants.h"
 #include "control_types.h"
@@ -48,11 +48,11 @@ struct Layer_t
     float SpeedY = 0.0f;
 //End Type
 // NEW: track the objects belonging to the layer
-    std::set<int> blocks;
-    std::set<int> BGOs;
-    std::set<int> NPCs;
-    std::set<int> warps;
-    std::set<int> waters;
+    SortedIntSet blocks;
+    SortedIntSet BGOs;
+    SortedIntSet NPCs;
+    SortedIntSet warps;
+    SortedIntSet waters;
 // NEW: track the layer offset so we don't need to update the block/BGO trees
     double OffsetX = 0.f;
     double OffsetY = 0.f;
@@ -248,6 +248,8 @@ void UpdateEvents();
 // call these any time the layer of an object changes
 void syncLayersTrees_AllBlocks();
 void syncLayersTrees_Block(int block);
+//! Resync the block slots from the given one up to the numBlock after the blocks were reordered in place
+void syncLayersTrees_BlocksFrom(int first);
 void syncLayersTrees_Block_SetHidden(int block); // set block hidden based on layer
 
 void syncLayers_AllNPCs();
@@ -256,8 +258,10 @@ void syncLayers_NPC(int npc);
 void syncLayers_AllBGOs();
 void syncLayers_BGO(int bgo);
 
+void syncLayers_AllWarps();
 void syncLayers_Warp(int warp);
 
+void syncLayers_AllWaters();
 void syncLayers_Water(int water);
 
 #endif // LAYERS_H
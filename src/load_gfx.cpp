@@ -19,6 +19,9 @@
  */
 
 #include <SDL2/SDL_timer.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_cpuinfo.h>
 
 #include "globals.h"
 #include "global_dirs.h"
@@ -83,8 +86,33 @@ static std::string getGfxDir()
     return AppPath + "graphics/";
 }
 
+//! Custom GFX sprite found for a slot, its file is read by loadCGFXFlush()
+struct CGFXLoad_t
+{
+    std::string origPath;
+    std::string imgPath;
+    std::string maskPath;
+    bool useMask = false;
+    int *width = nullptr;
+    int *height = nullptr;
+    bool *isCustom = nullptr;
+    StdPicture *texture = nullptr;
+    bool world = false;
+    //! Filled by the loading threads
+    StdPicture result;
+};
+
+static std::vector<CGFXLoad_t> s_cgfxQueue;
+static std::set<std::string> s_cgfxQueuedPaths;
+#ifndef PGE_NO_THREADING
+static SDL_atomic_t s_cgfxNext;
+#endif
+
+//! Max count of the threads reading the custom GFX files
+static const int c_cgfxMaxThreads = 4;
+
 /*!
- * \brief Load the custom GFX sprite
+ * \brief Find the custom GFX sprite and queue it for the loading
  * \param origPath Path to original texture
  * \param fName file name for custommization target
  * \param width Reference to width field (optional)
@@ -93,6 +121,8 @@ static std::string getGfxDir()
  * \param texture Target texture to load
  * \param world Is a world map
  * \param skipMask Don't even try to load a masked GIF sprite
+ *
+ * Only the directory listings get checked here, the files get read by the loadCGFXFlush()
  */
 static void loadCGFX(const std::string &origPath,
                      const std::string &fName,
@@ -101,22 +131,6 @@ static void loadCGFX(const std::string &origPath,
                      bool skipMask = false)
 {
     bool alreadyLoaded = false;
-
-    std::string loadedPath;
-    bool success = false;
-    StdPicture newTexture;
-
-    GFXBackup_t backup;
-    backup.remote_width = width;
-    backup.remote_height = height;
-    backup.remote_isCustom = &isCustom;
-    backup.remote_texture = &texture;
-    if(width)
-        backup.width = *width;
-    if(height)
-        backup.height = *height;
-    backup.texture = texture;
-
     bool isGif = false;
 
     // look for the image file: png in custom, gif in custom, png in episode, gif in episode
@@ -145,9 +159,18 @@ static void loadCGFX(const std::string &origPath,
     else
         alreadyLoaded = g_customLevelCGFXPathsCache.find(imgToUse) != g_customLevelCGFXPathsCache.end();
 
-    if(alreadyLoaded)
+    if(alreadyLoaded || s_cgfxQueuedPaths.find(imgToUse) != s_cgfxQueuedPaths.end())
         return; // This texture is already loaded
 
+    CGFXLoad_t e;
+    e.origPath = origPath;
+    e.imgPath = imgToUse;
+    e.width = width;
+    e.height = height;
+    e.isCustom = &isCustom;
+    e.texture = &texture;
+    e.world = world;
+
     if(isGif && !skipMask)
     {
         // look for the mask file: custom, episode, fallback
@@ -160,40 +183,110 @@ static void loadCGFX(const std::string &origPath,
 #ifdef DEBUG_BUILD
         pLogDebug("Trying to load custom GFX: %s with mask %s", imgToUse.c_str(), maskToUse.c_str());
 #endif
-        newTexture = XRender::lazyLoadPicture(imgToUse, maskToUse, origPath);
-        success = newTexture.inited;
-        loadedPath = imgToUse;
+        e.useMask = true;
+        e.maskPath = maskToUse;
     }
-    else
-    {
 #ifdef DEBUG_BUILD
+    else
         pLogDebug("Trying to load custom GFX: %s", imgToUse.c_str());
 #endif
-        newTexture = XRender::lazyLoadPicture(imgToUse);
-        success = newTexture.inited;
-        loadedPath = imgToUse;
+
+    s_cgfxQueuedPaths.insert(imgToUse);
+    s_cgfxQueue.push_back(std::move(e));
+}
+
+static void s_cgfxRead(CGFXLoad_t &e)
+{
+    if(e.useMask)
+        e.result = XRender::lazyLoadPicture(e.imgPath, e.maskPath, e.origPath);
+    else
+        e.result = XRender::lazyLoadPicture(e.imgPath);
+}
+
+#ifndef PGE_NO_THREADING
+static int s_cgfxReadWorker(void *)
+{
+    while(true)
+    {
+        int i = SDL_AtomicAdd(&s_cgfxNext, 1);
+        if(i >= (int)s_cgfxQueue.size())
+            break;
+        s_cgfxRead(s_cgfxQueue[i]);
     }
 
-    if(success)
+    return 0;
+}
+#endif
+
+//! Read all queued custom GFX files and apply them to their slots
+static void loadCGFXFlush()
+{
+    if(s_cgfxQueue.empty())
+        return;
+
+#ifndef PGE_NO_THREADING
+    // the reading is mostly waiting for the storage, so it's done in parallel
+    SDL_Thread *threads[c_cgfxMaxThreads - 1] = {};
+    int numThreads = SDL_min(SDL_GetCPUCount(), c_cgfxMaxThreads) - 1;
+    if(numThreads > (int)s_cgfxQueue.size() - 1)
+        numThreads = (int)s_cgfxQueue.size() - 1;
+
+    SDL_AtomicSet(&s_cgfxNext, 0);
+
+    for(int i = 0; i < numThreads; i++)
+        threads[i] = SDL_CreateThread(s_cgfxReadWorker, "cgfx_reader", nullptr);
+
+    // this thread takes its part too, so everything gets read even if the threads haven't started
+    s_cgfxReadWorker(nullptr);
+
+    for(int i = 0; i < numThreads; i++)
     {
-        pLogDebug("Loaded custom GFX: %s", loadedPath.c_str());
-        isCustom = true;
-        texture = newTexture;
-        if(width)
-            *width = newTexture.w;
-        if(height)
-            *height = newTexture.h;
-        if(world)
+        if(threads[i])
+            SDL_WaitThread(threads[i], nullptr);
+    }
+#else
+    for(auto &e : s_cgfxQueue)
+        s_cgfxRead(e);
+#endif
+
+    // the slots are changed by this thread only, in the order of finding
+    for(auto &e : s_cgfxQueue)
+    {
+        if(!e.result.inited)
+            continue;
+
+        GFXBackup_t backup;
+        backup.remote_width = e.width;
+        backup.remote_height = e.height;
+        backup.remote_isCustom = e.isCustom;
+        backup.remote_texture = e.texture;
+        if(e.width)
+            backup.width = *e.width;
+        if(e.height)
+            backup.height = *e.height;
+        backup.texture = *e.texture;
+
+        pLogDebug("Loaded custom GFX: %s", e.imgPath.c_str());
+        *e.isCustom = true;
+        *e.texture = e.result;
+        if(e.width)
+            *e.width = e.result.w;
+        if(e.height)
+            *e.height = e.result.h;
+        if(e.world)
         {
             g_defaultWorldGfxBackup.push_back(backup);
-            g_customWorldCGFXPathsCache.insert(loadedPath);
+            g_customWorldCGFXPathsCache.insert(e.imgPath);
         }
         else
         {
             g_defaultLevelGfxBackup.push_back(backup);
-            g_customLevelCGFXPathsCache.insert(loadedPath);
+            g_customLevelCGFXPathsCache.insert(e.imgPath);
         }
     }
+
+    s_cgfxQueue.clear();
+    s_cgfxQueuedPaths.clear();
 }
 
 static void restoreLevelBackupTextures()
@@ -641,12 +734,6 @@ void LoadCustomGFX()
         loadCGFX(GfxRoot + fmt::format_ne("effect/effect-{0}.png", A),
                  fmt::format_ne("effect-{0}", A),
                  &GFXEffectWidth[A], &GFXEffectHeight[A], GFXEffectCustom[A], GFXEffectBMP[A]);
-
-        if(GFXEffectCustom[A])
-        {
-            EffectWidth[A] = GFXEffectWidth[A];
-            EffectHeight[A] = GFXEffectHeight[A] / EffectDefaults.EffectFrames[A];
-        }
     }
 
     for(int A = 1; A < maxBackgroundType; ++A)
@@ -682,6 +769,17 @@ void LoadCustomGFX()
     }
 
     loadCustomUIAssets();
+
+    loadCGFXFlush();
+
+    for(int A = 1; A < maxEffectType; ++A)
+    {
+        if(GFXEffectCustom[A])
+        {
+            EffectWidth[A] = GFXEffectWidth[A];
+            EffectHeight[A] = GFXEffectHeight[A] / EffectDefaults.EffectFrames[A];
+        }
+    }
 }
 
 
@@ -742,6 +840,8 @@ void LoadWorldCustomGFX()
                  fmt::format_ne("path-{0}", A),
                  &GFXPathWidth[A], &GFXPathHeight[A], GFXPathCustom[A], GFXPathBMP[A], true);
     }
+
+    loadCGFXFlush();
 }
 
 void UnloadWorldCustomGFX()
@@ -28,6 +28,15 @@
 #include "main/presetup.h"
 #include "main/game_info.h"
 #include "main/speedrunner.h"
+#include "main/record.h"
+#include "main/replay_batch.h"
+#include "main/block_index_bench.h"
+#include "main/block_order_bench.h"
+#ifdef THEXTECH_ENABLE_AUDIO_FX
+#include "main/audio_fx_bench.h"
+#endif
+#include "main/asset_pack.h"
+#include "frame_profiler.h"
 #include "compat.h"
 #include "controls.h"
 #include <AppPath/app_path.h>
@@ -181,7 +190,8 @@ int main(int argc, char**argv)
         TCLAP::ValueArg<std::string> renderType("r", "render", "Sets the graphics mode:\n"
                                                 "  sw - software render (fallback)\n"
                                                 "  hw - hardware accelerated render [Default]\n"
-                                                "  vsync - hardware accelerated with the v-sync enabled",
+                                                "  vsync - hardware accelerated with the v-sync enabled\n"
+                                                "  null - draws nothing, only counts the draw calls (benchmarks and CI)",
                                                 false, "",
                                                 "render type",
                                                 cmd);
@@ -272,6 +282,108 @@ int main(int argc, char**argv)
 
         TCLAP::SwitchArg switchVerboseLog(std::string(), "verbose", "Enable log output into the terminal", false);
 
+        TCLAP::SwitchArg switchHeadless(std::string(), "headless",
+                                        "Replay the given recording file as fast as possible with no rendering, "
+                                        "no sound, and no frame rate limit, then quit. "
+                                        "The exit code is 0 when the run did not diverge, 3 on a minor divergence, and 4 on a major divergence or failure.", false);
+
+        TCLAP::SwitchArg switchHeadlessDraw(std::string(), "headless-draw",
+                                            "Run the drawing code at every frame of the --headless replay (nothing gets shown), "
+                                            "to check that the drawn frames simulate the same as the skipped ones", false);
+
+        TCLAP::SwitchArg switchNPCLinearScan(std::string(), "npc-linear-scan",
+                                             "Check every NPC at the NPC-to-NPC collision scans instead of the ones near by the spatial hash, "
+                                             "to check that the hash finds everything the original scans did", false);
+
+        TCLAP::ValueArg<unsigned int> replayRewindAt(std::string(), "replay-rewind-at",
+                                                     "Rewind the replayed binary recording once at the given frame to its previous seek point, "
+                                                     "restoring the game state from the snapshot, and replay the rest again from there, "
+                                                     "to check that the restored state replays the same",
+                                                     false, 0u,
+                                                     "frame number");
+
+        TCLAP::ValueArg<std::string> replayExportText(std::string(), "replay-export-text",
+                                                      "Convert the given binary replay file (*.rec) into the text format, write it into this path, then quit",
+                                                      false, "",
+                                                      "file path",
+                                                      cmd);
+
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+        TCLAP::ValueArg<std::string> replayBatch(std::string(), "replay-batch",
+                                                 "Validate every *.rec file of the given directory: each replay runs in its own "
+                                                 "headless process, many of them at once. The JSON summary is written into the "
+                                                 "standard output or into the --replay-summary file.",
+                                                 false, "",
+                                                 "directory path",
+                                                 cmd);
+        TCLAP::ValueArg<std::string> replayLevels(std::string(), "replay-levels",
+                                                  "Directory to look up the replayed levels at by their file names (for example, test/levels)",
+                                                  false, "",
+                                                  "directory path",
+                                                  cmd);
+        TCLAP::ValueArg<std::string> replaySummary(std::string(), "replay-summary",
+                                                   "File to write the JSON summary of the --replay-batch run into",
+                                                   false, "",
+                                                   "file path",
+                                                   cmd);
+        TCLAP::ValueArg<unsigned int> replayJobs(std::string(), "replay-jobs",
+                                                 "Count of replays to run simultaneously by the --replay-batch, 0 to use all CPU cores [Default]",
+                                                 false, 0u,
+                                                 "number",
+                                                 cmd);
+        TCLAP::SwitchArg replayCompareDrawn(std::string(), "replay-compare-drawn",
+                                            "Run every replay of the --replay-batch twice, with and without the --headless-draw, "
+                                            "and report the replays whose drawn run ends differently",
+                                            cmd, false);
+        TCLAP::SwitchArg replayCompareLinear(std::string(), "replay-compare-linear",
+                                             "Run every replay of the --replay-batch twice, with and without the --npc-linear-scan, "
+                                             "and report the replays whose run with the linear scan ends differently",
+                                             cmd, false);
+        TCLAP::ValueArg<unsigned int> replayCompareRewind(std::string(), "replay-compare-rewind",
+                                                          "Run every replay of the --replay-batch twice, with and without the --replay-rewind-at of the given frame, "
+                                                          "and report the replays whose rewound run ends differently",
+                                                          false, 0u,
+                                                          "frame number",
+                                                          cmd);
+#endif
+
+        TCLAP::ValueArg<std::string> benchBlockIndex(std::string(), "bench-block-index",
+                                                     "Measure the block index costs (the loose quadtree against the flat grid) "
+                                                     "on the blocks of every level of the given directory (for example, test/levels), then quit",
+                                                     false, "",
+                                                     "directory path",
+                                                     cmd);
+
+        TCLAP::ValueArg<unsigned int> benchBlockOrder(std::string(), "bench-block-order",
+                                                      "Measure the cost of restoring the block order after a P-Switch "
+                                                      "(the full re-sort against the incremental merge) on a synthetic level of the given count of blocks, then quit",
+                                                      false, 20000u,
+                                                      "blocks",
+                                                      cmd);
+
+#ifdef THEXTECH_ENABLE_AUDIO_FX
+        TCLAP::ValueArg<unsigned int> benchAudioFx(std::string(), "bench-audio-fx",
+                                                   "Measure the samples per second of the reverb and SPC echo effects "
+                                                   "on the given count of seconds of the synthetic audio with every available SIMD backend, then quit",
+                                                   false, 10u,
+                                                   "seconds",
+                                                   cmd);
+#endif
+
+        TCLAP::ValueArg<std::string> buildAssetPack(std::string(), "build-asset-pack",
+                                                    "Pack the \"graphics\" and \"sound\" directories of the assets root into a single file, then quit. "
+                                                    "The game uses the pack if it's placed at the assets root as the \"assets.xtpack\"",
+                                                    false, "",
+                                                    "file path",
+                                                    cmd);
+
+        TCLAP::ValueArg<std::string> profileTrace(std::string(), "profile-trace",
+                                                  "Write the timings of the latest level frames into this file on quit "
+                                                  "(Chrome trace-event JSON, can be opened by chrome://tracing or Perfetto)",
+                                                  false, "",
+                                                  "file path",
+                                                  cmd);
+
         TCLAP::UnlabeledMultiArg<std::string> inputFileNames("levelpath", "Path to level file or replay data to run the test", false, std::string(), "path to file");
 
         cmd.add(&switchFrameSkip);
@@ -290,6 +402,10 @@ int main(int argc, char**argv)
         cmd.add(&switchVerboseLog);
         cmd.add(&switchSpeedRunSemiTransparent);
         cmd.add(&switchDisplayControls);
+        cmd.add(&switchHeadless);
+        cmd.add(&switchHeadlessDraw);
+        cmd.add(&switchNPCLinearScan);
+        cmd.add(&replayRewindAt);
         cmd.add(&inputFileNames);
 
         cmd.parse(argc, argv);
@@ -310,6 +426,41 @@ int main(int argc, char**argv)
             AppPath = AppPathManager::assetsRoot();
         }
 
+        if(benchBlockIndex.isSet())
+            return BlockIndexBench::run(benchBlockIndex.getValue());
+
+        if(benchBlockOrder.isSet())
+            return BlockOrderBench::run(benchBlockOrder.getValue());
+
+#ifdef THEXTECH_ENABLE_AUDIO_FX
+        if(benchAudioFx.isSet())
+            return AudioFxBench::run(benchAudioFx.getValue());
+#endif
+
+        if(buildAssetPack.isSet())
+            return AssetPack::build(AppPath, buildAssetPack.getValue()) ? 0 : 1;
+
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+        if(replayBatch.isSet())
+        {
+            ReplayBatchSetup_t batch;
+            batch.executable = argv[0];
+            batch.recordsDir = replayBatch.getValue();
+            batch.levelsDir = replayLevels.getValue();
+            batch.summaryPath = replaySummary.getValue();
+            batch.assetsRoot = customAssetsPath.getValue();
+            batch.userDirectory = customUserDirectory.getValue();
+            batch.jobs = int(replayJobs.getValue());
+            if(replayCompareDrawn.getValue())
+                batch.compareArgs += " --headless-draw";
+            if(replayCompareLinear.getValue())
+                batch.compareArgs += " --npc-linear-scan";
+            if(replayCompareRewind.getValue() > 0)
+                batch.compareArgs += " --replay-rewind-at " + std::to_string(replayCompareRewind.getValue());
+            return ReplayBatch::run(batch);
+        }
+#endif
+
         OpenConfig_preSetup();
 
 
@@ -338,6 +489,8 @@ int main(int argc, char**argv)
                 setup.renderType = RENDER_ACCELERATED_VSYNC;
             else if(rt == "hw")
                 setup.renderType = RENDER_ACCELERATED;
+            else if(rt == "null")
+                setup.renderType = RENDER_NULL;
             else
             {
                 std::cerr << "Error: Invalid value for the --render argument: " << rt << std::endl;
@@ -457,6 +610,45 @@ int main(int argc, char**argv)
             setup.testShowFPS = true;
             setup.neverPause = true;
         }
+
+        if(replayExportText.isSet())
+        {
+            if(setup.testReplay.empty())
+            {
+                std::cerr << "Error: The --replay-export-text requires a replay file (*.rec) to convert" << std::endl;
+                std::cerr.flush();
+                return 2;
+            }
+
+            return Record::ExportReplayText(setup.testReplay, replayExportText.getValue()) ? 0 : 1;
+        }
+
+        setup.headless = switchHeadless.getValue();
+        setup.headlessDraw = switchHeadlessDraw.getValue();
+        setup.npcLinearScan = switchNPCLinearScan.getValue();
+        setup.replayRewindAt = int64_t(replayRewindAt.getValue());
+        setup.profileTrace = profileTrace.getValue();
+
+        if(setup.headless)
+        {
+            if(setup.testReplay.empty())
+            {
+                std::cerr << "Error: The --headless mode requires a replay file (*.rec) to run" << std::endl;
+                std::cerr.flush();
+                return 2;
+            }
+
+            // Nothing gets shown or heard, the simulation must run at the full speed
+            setup.noSound = true;
+            setup.frameSkip = false;
+            setup.neverPause = true;
+            setup.allowBgInput = false;
+            setup.renderType = RENDER_NULL;
+            setup.testShowFPS = false;
+            setup.testMaxFPS = true;
+            setup.speedRunnerMode = 0;
+            setup.showControllerState = false;
+        }
     }
     catch(TCLAP::ArgException &e)   // catch any exceptions
     {
@@ -499,14 +691,35 @@ int main(int argc, char**argv)
 
     int ret = GameMain(setup);
 
+    if(setup.headless && ret == 0)
+    {
+        switch(Record::LastReplayStatus())
+        {
+        case Record::ReplayStatus::Passed:
+            break;
+        case Record::ReplayStatus::DivergedMinor:
+            ret = 3;
+            break;
+        default:
+            ret = 4;
+            break;
+        }
+    }
+
 #ifdef ENABLE_XTECH_LUA
     if(!xtech_lua_quit())
         return 1;
 #endif
 
+    if(!setup.profileTrace.empty())
+        FrameProfiler::exportTrace(setup.profileTrace);
+
     Controls::Quit();
 
     frmMain.freeSystem();
 
+    // the textures may point into the pack until the renderer is gone
+    AssetPack::close();
+
     return ret;
 }
@@ -0,0 +1,410 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include <DirManager/dirman.h>
+#include <Graphics/graphics_funcs.h>
+#include <Logger/logger.h>
+#include <Utils/files.h>
+
+#include "asset_pack.h"
+
+// the FileMapper isn't built for Vita
+#ifndef VITA
+#   include <FileMapper/file_mapper.h>
+#   define ASSET_PACK_MAPPED
+#endif
+
+/*
+ * Layout of the pack, all numbers are little-endian:
+ *
+ * char[8]   magic "XTPACK2\0"
+ * uint32    count of entries
+ * uint32    size of the path strings block
+ * entry[count]:
+ *     uint64    offset of the data from the pack begin
+ *     uint32    size of the data
+ *     uint32    offset of the path at the strings block
+ *     uint16    length of the path
+ *     uint16    (reserved)
+ *     int32     width of the image (0 if not an image)
+ *     int32     height of the image (0 if not an image)
+ *     uint32    (reserved)
+ *     int64     modification time of the source file
+ * char[]    path strings block, paths are relative to the assets root
+ * data, every file is aligned to 16 bytes
+ *
+ * Entries whose source file exists at the assets root with another size or
+ * modification time are stale and ignored, the file is read from the disk then
+ */
+
+namespace AssetPack
+{
+
+const char *const c_defaultFileName = "assets.xtpack";
+
+static const char s_magic[8] = {'X', 'T', 'P', 'A', 'C', 'K', '2', '\0'};
+static const size_t s_headerSize = 16;
+static const size_t s_entrySize = 40;
+static const size_t s_dataAlign = 16;
+
+#ifdef ASSET_PACK_MAPPED
+static FileMapper s_file;
+#endif
+static bool s_isOpen = false;
+static std::string s_root;
+static std::unordered_map<std::string, Entry_t> s_index;
+
+
+static inline uint32_t s_getU32(const unsigned char *p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static inline uint64_t s_getU64(const unsigned char *p)
+{
+    return uint64_t(s_getU32(p)) | (uint64_t(s_getU32(p + 4)) << 32);
+}
+
+static inline void s_putU16(std::vector<unsigned char> &out, uint16_t v)
+{
+    out.push_back(v & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+}
+
+static inline void s_putU32(std::vector<unsigned char> &out, uint32_t v)
+{
+    s_putU16(out, v & 0xFFFF);
+    s_putU16(out, (v >> 16) & 0xFFFF);
+}
+
+static inline void s_putU64(std::vector<unsigned char> &out, uint64_t v)
+{
+    s_putU32(out, uint32_t(v & 0xFFFFFFFF));
+    s_putU32(out, uint32_t(v >> 32));
+}
+
+static std::string s_withSlash(const std::string &dir)
+{
+    std::string ret = dir;
+    if(!ret.empty() && ret.back() != '/')
+        ret.push_back('/');
+    return ret;
+}
+
+bool open(const std::string &path, const std::string &root)
+{
+    close();
+
+    if(!Files::fileExists(path))
+        return false;
+
+#ifndef ASSET_PACK_MAPPED
+    (void)root;
+    pLogWarning("The asset pack %s is ignored: not supported at this platform", path.c_str());
+    return false;
+#else
+
+    if(!s_file.open_file(path))
+    {
+        pLogWarning("Can't map the asset pack %s: %s", path.c_str(), s_file.error().c_str());
+        return false;
+    }
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(s_file.data());
+    uint64_t size = s_file.size();
+
+    if(size < s_headerSize || std::memcmp(data, s_magic, sizeof(s_magic)) != 0)
+    {
+        pLogWarning("The asset pack %s is invalid or has an outdated format, rebuild it", path.c_str());
+        s_file.close_file();
+        return false;
+    }
+
+    uint32_t count = s_getU32(data + 8);
+    uint32_t stringsSize = s_getU32(data + 12);
+    uint64_t stringsBegin = s_headerSize + uint64_t(count) * s_entrySize;
+
+    if(stringsBegin + stringsSize > size)
+    {
+        pLogWarning("The asset pack %s is truncated", path.c_str());
+        s_file.close_file();
+        return false;
+    }
+
+    const char *strings = reinterpret_cast<const char *>(data + stringsBegin);
+    std::string rootDir = s_withSlash(root);
+    uint32_t stale = 0;
+
+    s_index.reserve(count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const unsigned char *e = data + s_headerSize + i * s_entrySize;
+
+        uint64_t offset = s_getU64(e);
+        uint32_t dataSize = s_getU32(e + 8);
+        uint32_t pathOffset = s_getU32(e + 12);
+        uint32_t pathLen = uint32_t(e[16]) | (uint32_t(e[17]) << 8);
+
+        if(offset + dataSize > size || uint64_t(pathOffset) + pathLen > stringsSize)
+        {
+            pLogWarning("The asset pack %s has a broken entry %u", path.c_str(), i);
+            continue;
+        }
+
+        std::string relPath(strings + pathOffset, pathLen);
+        int64_t packedMtime = int64_t(s_getU64(e + 32));
+        int64_t srcMtime = 0, srcSize = 0;
+
+        // the source file got changed after the pack was built
+        if(Files::fileInfo(rootDir + relPath, &srcMtime, &srcSize)
+           && (srcMtime != packedMtime || srcSize != int64_t(dataSize)))
+        {
+            stale++;
+            continue;
+        }
+
+        Entry_t entry;
+        entry.data = reinterpret_cast<const char *>(data + offset);
+        entry.size = dataSize;
+        entry.w = int(s_getU32(e + 20));
+        entry.h = int(s_getU32(e + 24));
+
+        s_index.emplace(std::move(relPath), entry);
+    }
+
+    s_root = rootDir;
+    s_isOpen = true;
+
+    pLogDebug("Opened the asset pack %s with %u files", path.c_str(), count);
+
+    if(stale > 0)
+        pLogWarning("The asset pack %s has %u stale files, they are read from the disk, rebuild the pack", path.c_str(), stale);
+
+    return true;
+#endif // ASSET_PACK_MAPPED
+}
+
+void close()
+{
+    if(!s_isOpen)
+        return;
+
+    s_index.clear();
+#ifdef ASSET_PACK_MAPPED
+    s_file.close_file();
+#endif
+    s_isOpen = false;
+}
+
+bool isOpen()
+{
+    return s_isOpen;
+}
+
+const Entry_t *find(const std::string &path)
+{
+    if(!s_isOpen || path.size() <= s_root.size() || path.compare(0, s_root.size(), s_root) != 0)
+        return nullptr;
+
+    auto i = s_index.find(path.substr(s_root.size()));
+    if(i == s_index.end())
+        return nullptr;
+
+    return &i->second;
+}
+
+
+struct PackFile_t
+{
+    std::string path;
+    std::string relPath;
+    int w = 0;
+    int h = 0;
+    uint32_t size = 0;
+    int64_t mtime = 0;
+};
+
+static void s_listDir(const std::string &root, const std::string &sub, std::vector<PackFile_t> &files)
+{
+    DirMan dir(root + sub);
+    if(!dir.exists() || !dir.beginWalking())
+        return;
+
+    std::string dirRoot = s_withSlash(dir.absolutePath());
+    std::string curPath;
+    std::vector<std::string> list;
+
+    while(dir.fetchListFromWalker(curPath, list))
+    {
+        std::string curDir = s_withSlash(curPath);
+        std::string rel = s_withSlash(sub);
+
+        if(curDir.compare(0, dirRoot.size(), dirRoot) == 0)
+            rel += curDir.substr(dirRoot.size());
+
+        for(const std::string &f : list)
+        {
+            PackFile_t pf;
+            pf.path = curDir + f;
+            pf.relPath = rel + f;
+            files.push_back(pf);
+        }
+    }
+}
+
+static bool s_isImage(const std::string &path)
+{
+    return Files::hasSuffix(path, ".png") || Files::hasSuffix(path, ".gif")
+        || Files::hasSuffix(path, ".bmp") || Files::hasSuffix(path, ".jpg");
+}
+
+bool build(const std::string &root, const std::string &outPath)
+{
+    std::string rootDir = s_withSlash(root);
+    std::vector<PackFile_t> files;
+
+    s_listDir(rootDir, "graphics", files);
+    s_listDir(rootDir, "sound", files);
+
+    if(files.empty())
+    {
+        fprintf(stderr, "Error: Nothing to pack at %s\n", rootDir.c_str());
+        return false;
+    }
+
+    std::sort(files.begin(), files.end(),
+              [](const PackFile_t &a, const PackFile_t &b)
+              {
+                  return a.relPath < b.relPath;
+              });
+
+    std::vector<unsigned char> strings;
+
+    for(auto &f : files)
+    {
+        int64_t fileSize = 0;
+        if(!Files::fileInfo(f.path, &f.mtime, &fileSize))
+        {
+            fprintf(stderr, "Error: Can't read %s\n", f.path.c_str());
+            return false;
+        }
+
+        f.size = uint32_t(fileSize);
+
+        if(s_isImage(f.path))
+        {
+            PGE_Size s;
+            if(GraphicsHelps::getImageMetrics(f.path, &s))
+            {
+                f.w = s.w();
+                f.h = s.h();
+            }
+        }
+    }
+
+    std::vector<unsigned char> head;
+    head.insert(head.end(), s_magic, s_magic + sizeof(s_magic));
+    s_putU32(head, uint32_t(files.size()));
+    s_putU32(head, 0); // the strings size, filled below
+
+    uint64_t stringsSize = 0;
+    for(const auto &f : files)
+        stringsSize += f.relPath.size();
+
+    uint64_t offset = s_headerSize + files.size() * s_entrySize + stringsSize;
+
+    for(const auto &f : files)
+    {
+        offset = (offset + s_dataAlign - 1) / s_dataAlign * s_dataAlign;
+
+        s_putU64(head, offset);
+        s_putU32(head, f.size);
+        s_putU32(head, uint32_t(strings.size()));
+        s_putU16(head, uint16_t(f.relPath.size()));
+        s_putU16(head, 0);
+        s_putU32(head, uint32_t(f.w));
+        s_putU32(head, uint32_t(f.h));
+        s_putU32(head, 0);
+        s_putU64(head, uint64_t(f.mtime));
+
+        strings.insert(strings.end(), f.relPath.begin(), f.relPath.end());
+        offset += f.size;
+    }
+
+    head[12] = strings.size() & 0xFF;
+    head[13] = (strings.size() >> 8) & 0xFF;
+    head[14] = (strings.size() >> 16) & 0xFF;
+    head[15] = (strings.size() >> 24) & 0xFF;
+
+    FILE *out = Files::utf8_fopen(outPath.c_str(), "wb");
+    if(!out)
+    {
+        fprintf(stderr, "Error: Can't write the asset pack %s\n", outPath.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(head.data(), 1, head.size(), out) == head.size();
+    ok &= fwrite(strings.data(), 1, strings.size(), out) == strings.size();
+
+    uint64_t written = head.size() + strings.size();
+    std::vector<char> buffer;
+    const char zeros[s_dataAlign] = {};
+
+    for(const auto &f : files)
+    {
+        if(!ok)
+            break;
+
+        size_t pad = size_t((s_dataAlign - written % s_dataAlign) % s_dataAlign);
+        ok &= fwrite(zeros, 1, pad, out) == pad;
+        written += pad;
+
+        FILE *in = Files::utf8_fopen(f.path.c_str(), "rb");
+        buffer.resize(f.size);
+        ok &= in && fread(buffer.data(), 1, f.size, in) == f.size;
+        if(in)
+            fclose(in);
+
+        ok &= fwrite(buffer.data(), 1, f.size, out) == f.size;
+        written += f.size;
+    }
+
+    fclose(out);
+
+    if(!ok)
+    {
+        fprintf(stderr, "Error: Failed to write the asset pack %s\n", outPath.c_str());
+        return false;
+    }
+
+    printf("Packed %d files of %s into %s\n", (int)files.size(), rootDir.c_str(), outPath.c_str());
+    fflush(stdout);
+
+    return true;
+}
+
+} // namespace AssetPack
@@ -0,0 +1,79 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module keeps the default graphics and sounds packed into a single
+// memory-mapped file, so they are read without copying into the memory
+
+#pragma once
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <string>
+#include <cstddef>
+
+namespace AssetPack
+{
+
+//! File name of the pack at the assets root
+extern const char *const c_defaultFileName;
+
+struct Entry_t
+{
+    //! Content of the file at the mapped memory
+    const char *data = nullptr;
+    size_t size = 0;
+    //! Size of the image (0 if not an image)
+    int w = 0;
+    int h = 0;
+};
+
+/*!
+ * \brief Map the pack file
+ * \param path Path to the pack file
+ * \param root Assets root, the paths of the pack are relative to it
+ * \return true if the pack has been opened
+ *
+ * Files changed at the assets root since the pack was built are ignored at the pack
+ */
+bool open(const std::string &path, const std::string &root);
+
+//! Unmap the pack, all pointers to its data become invalid
+void close();
+
+bool isOpen();
+
+/*!
+ * \brief Find the file at the pack
+ * \param path Absolute path of the file at the assets root
+ * \return Entry of the file or nullptr if the pack has no such file
+ */
+const Entry_t *find(const std::string &path);
+
+/*!
+ * \brief Pack the "graphics" and "sound" directories of the assets root into one file
+ * \param root Assets root
+ * \param outPath Path of the pack to write
+ * \return true on success
+ */
+bool build(const std::string &root, const std::string &outPath);
+
+} // namespace AssetPack
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,236 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_audio.h>
+#include <SDL2/SDL_timer.h>
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "audio_fx_bench.h"
+#include "sound/fx/reverb.h"
+#include "sound/fx/spc_echo.h"
+#include "sound/fx/fx_simd.h"
+
+
+namespace AudioFxBench
+{
+
+//! The same as the default mixer setup
+static const int c_sampleRate = 44100;
+static const int c_channels = 2;
+static const int c_chunkFrames = 2048;
+//! Max difference of the backend output from the scalar one
+static const float c_tolerance = 1e-4f;
+
+typedef void (*EffectCB)(int chan, void *stream, int len, void *context);
+
+struct BenchFormat_t
+{
+    uint16_t format;
+    const char *name;
+    int sampleSize;
+};
+
+static const BenchFormat_t s_formats[] =
+{
+    {AUDIO_F32SYS, "f32", 4},
+    {AUDIO_S16SYS, "s16", 2}
+};
+
+static void makeInput(std::vector<float> &out, int frames)
+{
+    out.resize(size_t(frames) * c_channels);
+
+    uint32_t seed = 1;
+    const double pi = 3.14159265358979323846;
+
+    // two tones and a bit of noise, so the effects don't run on silence or denormals
+    for(int i = 0; i < frames; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        float noise = float((seed >> 8) & 0xFFFF) / 65536.0f - 0.5f;
+        double t = double(i) / c_sampleRate;
+
+        out[i * 2 + 0] = float(0.4 * std::sin(2 * pi * 220.0 * t)) + 0.1f * noise;
+        out[i * 2 + 1] = float(0.3 * std::sin(2 * pi * 330.0 * t)) - 0.1f * noise;
+    }
+}
+
+static void convertChunk(const float *in, uint8_t *out, int samples, uint16_t format)
+{
+    if(format == AUDIO_F32SYS)
+    {
+        std::memcpy(out, in, size_t(samples) * sizeof(float));
+        return;
+    }
+
+    int16_t *o = reinterpret_cast<int16_t *>(out);
+    for(int i = 0; i < samples; i++)
+        o[i] = int16_t(in[i] * 32767.0f);
+}
+
+static float sampleAt(const uint8_t *in, int i, uint16_t format)
+{
+    if(format == AUDIO_F32SYS)
+    {
+        float f;
+        std::memcpy(&f, in + i * sizeof(float), sizeof(float));
+        return f;
+    }
+
+    int16_t s;
+    std::memcpy(&s, in + i * sizeof(int16_t), sizeof(int16_t));
+    return float(s) / 32767.0f;
+}
+
+/*!
+ * \brief Run the effect over the given count of frames
+ * \param output First second of the output to compare the backends with
+ * \return Seconds spent at the effect callback
+ */
+static double runEffect(EffectCB effect, void *context, const BenchFormat_t &fmt,
+                        const std::vector<float> &input, int totalFrames,
+                        std::vector<float> &output)
+{
+    const int inputFrames = int(input.size() / c_channels);
+    std::vector<uint8_t> chunk(size_t(c_chunkFrames) * c_channels * fmt.sampleSize);
+    uint64_t ticks = 0;
+
+    output.clear();
+
+    for(int done = 0; done < totalFrames; done += c_chunkFrames)
+    {
+        int at = done % inputFrames;
+        int frames = SDL_min(c_chunkFrames, inputFrames - at);
+        int samples = frames * c_channels;
+
+        convertChunk(input.data() + at * c_channels, chunk.data(), samples, fmt.format);
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        effect(0, chunk.data(), samples * fmt.sampleSize, context);
+        ticks += SDL_GetPerformanceCounter() - start;
+
+        if(done < c_sampleRate)
+        {
+            for(int i = 0; i < samples; i++)
+                output.push_back(sampleAt(chunk.data(), i, fmt.format));
+        }
+    }
+
+    return double(ticks) / double(SDL_GetPerformanceFrequency());
+}
+
+static float maxDifference(const std::vector<float> &a, const std::vector<float> &b)
+{
+    float ret = 0.0f;
+    size_t n = SDL_min(a.size(), b.size());
+
+    for(size_t i = 0; i < n; i++)
+        ret = SDL_max(ret, std::fabs(a[i] - b[i]));
+
+    return ret;
+}
+
+int run(unsigned int seconds)
+{
+    if(seconds == 0)
+    {
+        fprintf(stderr, "Error: The length of the processed audio must be at least one second\n");
+        return 2;
+    }
+
+    const int totalFrames = int(seconds) * c_sampleRate;
+    const FxSimdBackend initialBackend = fxSimdBackend();
+
+    std::vector<float> input;
+    makeInput(input, c_sampleRate);
+
+    printf("Best backend: %s, %u seconds of %d Hz stereo audio per run\n",
+           fxSimdBackendName(fxSimdBestBackend()), seconds, c_sampleRate);
+    printf("%-8s %-6s %-8s %14s %12s %12s\n",
+           "effect", "format", "backend", "samples/sec", "realtime", "max diff");
+
+    int ret = 0;
+
+    for(int e = 0; e < 2; e++)
+    {
+        const bool isReverb = (e == 0);
+
+        for(const BenchFormat_t &fmt : s_formats)
+        {
+            std::vector<float> reference, output;
+
+            for(int b = FX_SIMD_SCALAR; b < FX_SIMD_COUNT; b++)
+            {
+                FxSimdBackend backend = FxSimdBackend(b);
+                if(!fxSimdSetBackend(backend))
+                    continue;
+
+                double time;
+
+                if(isReverb)
+                {
+                    FxReverb *fx = reverbEffectInit(c_sampleRate, fmt.format, c_channels);
+                    ReverbSetup setup;
+                    reverbUpdateSetup(fx, setup);
+                    time = runEffect(reverbEffect, fx, fmt, input, totalFrames, output);
+                    reverbEffectFree(fx);
+                }
+                else
+                {
+                    SpcEcho *fx = echoEffectInit(c_sampleRate, fmt.format, c_channels);
+                    time = runEffect(spcEchoEffect, fx, fmt, input, totalFrames, output);
+                    echoEffectFree(fx);
+                }
+
+                float diff = 0.0f;
+                if(backend == FX_SIMD_SCALAR)
+                    reference = output;
+                else
+                    diff = maxDifference(reference, output);
+
+                double samples = double(totalFrames) * c_channels;
+
+                printf("%-8s %-6s %-8s %14.0f %11.1fx %12g\n",
+                       isReverb ? "reverb" : "spc-echo", fmt.name, fxSimdBackendName(backend),
+                       time > 0.0 ? samples / time : 0.0,
+                       time > 0.0 ? double(seconds) / time : 0.0,
+                       double(diff));
+
+                if(diff > c_tolerance)
+                {
+                    fprintf(stderr, "Error: The %s backend of the %s differs from the scalar one by %g\n",
+                            fxSimdBackendName(backend), isReverb ? "reverb" : "spc-echo", double(diff));
+                    ret = 1;
+                }
+            }
+        }
+    }
+
+    fxSimdSetBackend(initialBackend);
+    fflush(stdout);
+
+    return ret;
+}
+
+} // namespace AudioFxBench
@@ -0,0 +1,40 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module measures the throughput of the reverb and SPC echo effects
+// with every SIMD backend available at this build and this CPU
+
+#pragma once
+#ifndef AUDIO_FX_BENCH_H
+#define AUDIO_FX_BENCH_H
+
+namespace AudioFxBench
+{
+
+/*!
+ * \brief Feed the synthetic audio through the effects and print the samples per second
+ * \param seconds Length of the audio processed by every effect and backend
+ * \return 0 on success, 1 if the backends have produced different results, 2 on failure to start
+ */
+int run(unsigned int seconds);
+
+} // namespace AudioFxBench
+
+#endif // AUDIO_FX_BENCH_H
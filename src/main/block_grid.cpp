@@ -0,0 +1,295 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include <SDL2/SDL_assert.h>
+
+#include "block_grid.h"
+
+
+//! Blocks are 32x32 mostly, so a cell keeps about 4 of them
+static const double s_cellSize = 64.0;
+static const int    s_bucketsBits = 14;
+static const int    s_buckets = 1 << s_bucketsBits;
+//! Items covering more cells than this are kept at the large items list
+static const int    s_maxCells = 16;
+
+static inline int s_cell(double c)
+{
+    return (int)std::floor(c / s_cellSize);
+}
+
+static void s_erase(std::vector<int> &vec, int id)
+{
+    auto i = std::find(vec.begin(), vec.end(), id);
+    if(i != vec.end())
+    {
+        *i = vec.back();
+        vec.pop_back();
+    }
+}
+
+
+BlockGrid::BlockGrid() :
+    m_buckets(s_buckets)
+{}
+
+std::vector<int> &BlockGrid::bucketAt(int layer, int x, int y)
+{
+    unsigned h = unsigned(x) * 73856093u ^ unsigned(y) * 19349663u ^ unsigned(layer) * 83492791u;
+    return m_buckets[h & (s_buckets - 1)];
+}
+
+BlockGrid::Layer_t &BlockGrid::layerAt(int layer)
+{
+    if(layer >= (int)m_layers.size())
+        m_layers.resize(layer + 1);
+
+    return m_layers[layer];
+}
+
+void BlockGrid::list(int id)
+{
+    Entry_t &e = m_items[id];
+
+    if(e.large)
+    {
+        layerAt(e.layer).large.push_back(id);
+        return;
+    }
+
+    for(int y = e.y1; y <= e.y2; y++)
+    {
+        for(int x = e.x1; x <= e.x2; x++)
+            bucketAt(e.layer, x, y).push_back(id);
+    }
+}
+
+void BlockGrid::unlist(int id)
+{
+    Entry_t &e = m_items[id];
+
+    if(e.large)
+    {
+        s_erase(layerAt(e.layer).large, id);
+        return;
+    }
+
+    for(int y = e.y1; y <= e.y2; y++)
+    {
+        for(int x = e.x1; x <= e.x2; x++)
+            s_erase(bucketAt(e.layer, x, y), id);
+    }
+}
+
+void BlockGrid::addToLayer(int id)
+{
+    Entry_t &e = m_items[id];
+    std::vector<int> &items = layerAt(e.layer).items;
+
+    e.layerPos = (int)items.size();
+    items.push_back(id);
+}
+
+void BlockGrid::removeFromLayer(int id)
+{
+    Entry_t &e = m_items[id];
+    std::vector<int> &items = layerAt(e.layer).items;
+
+    // move the last item into the freed place
+    int last = items.back();
+    items[e.layerPos] = last;
+    m_items[last].layerPos = e.layerPos;
+    items.pop_back();
+
+    e.layerPos = -1;
+}
+
+void BlockGrid::insert(int id, int layer, double x, double y, double w, double h)
+{
+    SDL_assert(id >= 0 && layer >= 0);
+
+    if(id >= (int)m_items.size())
+    {
+        m_items.resize(id + 1);
+        m_seen.resize(id + 1, 0);
+    }
+
+    Entry_t &e = m_items[id];
+
+    int x1 = s_cell(x);
+    int y1 = s_cell(y);
+    int x2 = s_cell(x + w);
+    int y2 = s_cell(y + h);
+
+    // NaN or infinite boxes are falling into the large list too
+    bool large = !(std::isfinite(x) && std::isfinite(y) && w >= 0 && h >= 0
+                   && w < s_cellSize * s_maxCells && h < s_cellSize * s_maxCells
+                   && (int64_t)(x2 - x1 + 1) * (y2 - y1 + 1) <= s_maxCells);
+
+    bool sameCells = e.layer == layer && e.large == large
+                     && (large || (e.x1 == x1 && e.y1 == y1 && e.x2 == x2 && e.y2 == y2));
+
+    if(!sameCells)
+    {
+        bool sameLayer = e.layer == layer;
+
+        if(e.layer >= 0)
+        {
+            unlist(id);
+            if(!sameLayer)
+                removeFromLayer(id);
+        }
+
+        e.layer = layer;
+        e.large = large;
+        e.x1 = x1;
+        e.y1 = y1;
+        e.x2 = x2;
+        e.y2 = y2;
+
+        list(id);
+        if(!sameLayer)
+            addToLayer(id);
+    }
+
+    e.left = x;
+    e.top = y;
+    e.right = x + w;
+    e.bottom = y + h;
+}
+
+void BlockGrid::remove(int id)
+{
+    if(!contains(id))
+        return;
+
+    unlist(id);
+    removeFromLayer(id);
+    m_items[id].layer = -1;
+}
+
+bool BlockGrid::contains(int id) const
+{
+    return id >= 0 && id < (int)m_items.size() && m_items[id].layer >= 0;
+}
+
+void BlockGrid::clear()
+{
+    for(auto &b : m_buckets)
+        b.clear();
+
+    m_layers.clear();
+    m_items.clear();
+    m_seen.clear();
+    m_stamp = 0;
+}
+
+void BlockGrid::swapLayers(int layer_1, int layer_2)
+{
+    if(layer_1 == layer_2)
+        return;
+
+    layerAt(std::max(layer_1, layer_2));
+
+    // the layer is a part of the cell hash, so the items are re-listed
+    for(int id : m_layers[layer_1].items)
+        unlist(id);
+    for(int id : m_layers[layer_2].items)
+        unlist(id);
+
+    std::swap(m_layers[layer_1], m_layers[layer_2]);
+
+    for(int id : m_layers[layer_1].items)
+    {
+        m_items[id].layer = layer_1;
+        list(id);
+    }
+
+    for(int id : m_layers[layer_2].items)
+    {
+        m_items[id].layer = layer_2;
+        list(id);
+    }
+}
+
+int BlockGrid::layerSize(int layer) const
+{
+    if(layer < 0 || layer >= (int)m_layers.size())
+        return 0;
+    return (int)m_layers[layer].items.size();
+}
+
+void BlockGrid::query(int layer, double left, double top, double right, double bottom, std::vector<int> &out)
+{
+    if(layerSize(layer) == 0)
+        return;
+
+    if(++m_stamp == 0)
+    {
+        // the stamp has wrapped around, forget all old ones
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        m_stamp = 1;
+    }
+
+    auto check = [&](int id)
+    {
+        const Entry_t &e = m_items[id];
+
+        if(e.layer != layer || m_seen[id] == m_stamp)
+            return;
+
+        m_seen[id] = m_stamp;
+
+        if(e.right <= left || right <= e.left || e.bottom <= top || bottom <= e.top)
+            return;
+
+        out.push_back(id);
+    };
+
+    int x1 = s_cell(left);
+    int y1 = s_cell(top);
+    int x2 = s_cell(right);
+    int y2 = s_cell(bottom);
+
+    if(!(std::isfinite(left) && std::isfinite(top) && std::isfinite(right) && std::isfinite(bottom))
+       || (int64_t)(x2 - x1 + 1) * (y2 - y1 + 1) > layerSize(layer))
+    {
+        // visiting the cells is more expensive than checking every item of the layer
+        for(int id : m_layers[layer].items)
+            check(id);
+
+        return;
+    }
+
+    for(int y = y1; y <= y2; y++)
+    {
+        for(int x = x1; x <= x2; x++)
+        {
+            for(int id : bucketAt(layer, x, y))
+                check(id);
+        }
+    }
+
+    for(int id : m_layers[layer].large)
+        check(id);
+}
@@ -0,0 +1,105 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module is a flat alternative to the loose quadtree for the level blocks:
+// a uniform grid of all layers hashed into a fixed count of buckets, every
+// bucket is a plain array of item IDs, and the items are kept at the array
+// indexed by their IDs, so there are no per-node allocations at all
+
+#pragma once
+#ifndef BLOCK_GRID_H
+#define BLOCK_GRID_H
+
+#include <vector>
+#include <cstdint>
+
+class BlockGrid
+{
+public:
+    BlockGrid();
+
+    /*!
+     * \brief Add the item or update its layer and bounding box
+     * \param id Non-negative item ID, should be small as items are stored by it
+     * \param layer Layer the item belongs to, the coordinates are relative to it
+     */
+    void insert(int id, int layer, double x, double y, double w, double h);
+    //! Remove the item, does nothing if it's not listed
+    void remove(int id);
+    //! Is the item listed?
+    bool contains(int id) const;
+    //! Remove all items
+    void clear();
+    //! Move all items of the one layer into another and vice versa
+    void swapLayers(int layer_1, int layer_2);
+
+    //! Count of items at the layer
+    int layerSize(int layer) const;
+
+    /*!
+     * \brief Append IDs of the layer items intersecting the region into the output
+     *
+     * The region is in the coordinates of the layer, edges are exclusive like the
+     * loose quadtree ones. Every item is returned once, in no particular order
+     * (it's not the order of the loose quadtree either).
+     */
+    void query(int layer, double left, double top, double right, double bottom, std::vector<int> &out);
+
+private:
+    struct Entry_t
+    {
+        int layer = -1;
+        //! Position at the item list of the layer
+        int layerPos = -1;
+        bool large = false;
+        int x1 = 0;
+        int y1 = 0;
+        int x2 = 0;
+        int y2 = 0;
+        double left = 0.0;
+        double top = 0.0;
+        double right = 0.0;
+        double bottom = 0.0;
+    };
+
+    struct Layer_t
+    {
+        //! All items of the layer, scanned when the queried region covers too many cells
+        std::vector<int> items;
+        //! Items spanning too many cells, checked by every query of the layer
+        std::vector<int> large;
+    };
+
+    std::vector<int> &bucketAt(int layer, int x, int y);
+    Layer_t &layerAt(int layer);
+    void list(int id);
+    void unlist(int id);
+    void addToLayer(int id);
+    void removeFromLayer(int id);
+
+    std::vector<Entry_t> m_items;
+    std::vector<std::vector<int>> m_buckets;
+    std::vector<Layer_t> m_layers;
+    //! Query stamps of the items to return them only once
+    std::vector<uint32_t> m_seen;
+    uint32_t m_stamp = 0;
+};
+
+#endif // BLOCK_GRID_H
@@ -0,0 +1,337 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_timer.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include <DirManager/dirman.h>
+#include <PGE_File_Formats/file_formats.h>
+
+#include "block_index_bench.h"
+#include "block_grid.h"
+#include "QuadTree/LooseQuadtree.h"
+
+
+namespace BlockIndexBench
+{
+
+//! Rounds of every operation to average the time over
+static const int c_rounds = 8;
+//! Size of the screen queries, the same as the default vScreen
+static const double c_screenW = 800.0;
+static const double c_screenH = 600.0;
+//! Margin of the physics queries, the same as the treeBlockQueryPhys() one
+static const double c_physMargin = 32.0;
+
+struct BenchBlock_t
+{
+    double x = 0.0;
+    double y = 0.0;
+    double w = 0.0;
+    double h = 0.0;
+    int layer = 0;
+};
+
+class BenchExtractor
+{
+public:
+    static void ExtractBoundingBox(const BenchBlock_t *object, loose_quadtree::BoundingBox<double> *bbox)
+    {
+        bbox->left      = object->x;
+        bbox->top       = object->y;
+        bbox->width     = object->w;
+        bbox->height    = object->h;
+    }
+};
+
+typedef loose_quadtree::LooseQuadtree<double, BenchBlock_t, BenchExtractor> BenchTree;
+
+struct BenchRegion_t
+{
+    double left, top, right, bottom;
+};
+
+struct BenchResult_t
+{
+    double insert = 0.0;
+    double update = 0.0;
+    double physQuery = 0.0;
+    double screenQuery = 0.0;
+    //! Total count of the found blocks to compare the indices with
+    size_t found = 0;
+};
+
+
+static inline double nsSince(uint64_t start, size_t ops)
+{
+    double s = double(SDL_GetPerformanceCounter() - start) / double(SDL_GetPerformanceFrequency());
+    return ops ? s * 1e9 / double(ops) : 0.0;
+}
+
+static BenchResult_t benchQuadtree(std::vector<BenchBlock_t> &blocks, int numLayers,
+                                   const std::vector<BenchRegion_t> &phys,
+                                   const std::vector<BenchRegion_t> &screens)
+{
+    BenchResult_t ret;
+    std::vector<std::unique_ptr<BenchTree>> trees(numLayers);
+    std::vector<void*> out;
+
+    for(int r = 0; r < c_rounds; r++)
+    {
+        for(auto &t : trees)
+            t.reset(new BenchTree());
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        for(auto &b : blocks)
+            trees[b.layer]->Insert(&b);
+        ret.insert += nsSince(start, blocks.size()) / c_rounds;
+
+        auto query = [&](const BenchRegion_t &q)
+        {
+            out.clear();
+            for(auto &t : trees)
+            {
+                auto it = t->QueryIntersectsRegion(loose_quadtree::BoundingBox<double>(q.left, q.top,
+                                                                                    q.right - q.left,
+                                                                                    q.bottom - q.top));
+                while(!it.EndOfQuery())
+                {
+                    out.push_back(it.GetCurrent());
+                    it.Next();
+                }
+            }
+            // as the treeBlockQuery() does for the SORTMODE_ID
+            std::sort(out.begin(), out.end());
+            return out.size();
+        };
+
+        size_t found = 0;
+
+        start = SDL_GetPerformanceCounter();
+        for(const auto &q : phys)
+            found += query(q);
+        ret.physQuery += nsSince(start, phys.size()) / c_rounds;
+
+        start = SDL_GetPerformanceCounter();
+        for(const auto &q : screens)
+            found += query(q);
+        ret.screenQuery += nsSince(start, screens.size()) / c_rounds;
+
+        ret.found = found;
+
+        // bumped blocks: up by a few pixels and back
+        start = SDL_GetPerformanceCounter();
+        for(auto &b : blocks)
+        {
+            b.y -= 12.0;
+            trees[b.layer]->Update(&b);
+            b.y += 12.0;
+            trees[b.layer]->Update(&b);
+        }
+        ret.update += nsSince(start, blocks.size() * 2) / c_rounds;
+    }
+
+    return ret;
+}
+
+static BenchResult_t benchGrid(std::vector<BenchBlock_t> &blocks, int numLayers,
+                               const std::vector<BenchRegion_t> &phys,
+                               const std::vector<BenchRegion_t> &screens)
+{
+    BenchResult_t ret;
+    std::unique_ptr<BlockGrid> grid;
+    std::vector<int> ids;
+    std::vector<void*> out;
+
+    for(int r = 0; r < c_rounds; r++)
+    {
+        grid.reset(new BlockGrid());
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        for(size_t i = 0; i < blocks.size(); i++)
+        {
+            const auto &b = blocks[i];
+            grid->insert((int)i, b.layer, b.x, b.y, b.w, b.h);
+        }
+        ret.insert += nsSince(start, blocks.size()) / c_rounds;
+
+        auto query = [&](const BenchRegion_t &q)
+        {
+            out.clear();
+            for(int l = 0; l < numLayers; l++)
+            {
+                ids.clear();
+                grid->query(l, q.left, q.top, q.right, q.bottom, ids);
+                for(int i : ids)
+                    out.push_back(&blocks[i]);
+            }
+            std::sort(out.begin(), out.end());
+            return out.size();
+        };
+
+        size_t found = 0;
+
+        start = SDL_GetPerformanceCounter();
+        for(const auto &q : phys)
+            found += query(q);
+        ret.physQuery += nsSince(start, phys.size()) / c_rounds;
+
+        start = SDL_GetPerformanceCounter();
+        for(const auto &q : screens)
+            found += query(q);
+        ret.screenQuery += nsSince(start, screens.size()) / c_rounds;
+
+        ret.found = found;
+
+        start = SDL_GetPerformanceCounter();
+        for(size_t i = 0; i < blocks.size(); i++)
+        {
+            auto &b = blocks[i];
+            b.y -= 12.0;
+            grid->insert((int)i, b.layer, b.x, b.y, b.w, b.h);
+            b.y += 12.0;
+            grid->insert((int)i, b.layer, b.x, b.y, b.w, b.h);
+        }
+        ret.update += nsSince(start, blocks.size() * 2) / c_rounds;
+    }
+
+    return ret;
+}
+
+static bool loadBlocks(const std::string &path, std::vector<BenchBlock_t> &blocks, int &numLayers)
+{
+    LevelData lvl;
+
+    if(!FileFormats::OpenLevelFile(path, lvl))
+        return false;
+
+    std::unordered_map<std::string, int> layers;
+    for(const auto &l : lvl.layers)
+        layers.emplace(l.name, (int)layers.size());
+
+    // the last one is for the blocks of unknown layers
+    numLayers = (int)layers.size() + 1;
+
+    blocks.clear();
+    blocks.reserve(lvl.blocks.size());
+
+    for(const auto &b : lvl.blocks)
+    {
+        BenchBlock_t o;
+        o.x = double(b.x);
+        o.y = double(b.y);
+        o.w = double(b.w);
+        o.h = double(b.h);
+
+        auto l = layers.find(b.layer);
+        o.layer = (l != layers.end()) ? l->second : numLayers - 1;
+
+        blocks.push_back(o);
+    }
+
+    return true;
+}
+
+int run(const std::string &levelsDir)
+{
+    DirMan dir(levelsDir);
+    std::vector<std::string> files;
+
+    if(!dir.exists() || !dir.getListOfFiles(files, {".lvl", ".lvlx"}))
+    {
+        fprintf(stderr, "Error: Can't read the levels directory %s\n", levelsDir.c_str());
+        return 2;
+    }
+
+    std::sort(files.begin(), files.end());
+
+    printf("%-32s %7s %-9s %10s %10s %10s %10s\n",
+           "level", "blocks", "index", "insert", "update", "phys", "screen");
+
+    BenchResult_t totalTree, totalGrid;
+    int ret = 0;
+
+    for(const std::string &f : files)
+    {
+        std::vector<BenchBlock_t> blocks;
+        int numLayers = 0;
+
+        if(!loadBlocks(dir.absolutePath() + "/" + f, blocks, numLayers))
+        {
+            fprintf(stderr, "Warning: Can't load the level %s\n", f.c_str());
+            continue;
+        }
+
+        if(blocks.empty())
+            continue;
+
+        // a physics query at every block and a screen query at every 16th one
+        std::vector<BenchRegion_t> phys, screens;
+        for(size_t i = 0; i < blocks.size(); i++)
+        {
+            const auto &b = blocks[i];
+            phys.push_back({b.x - c_physMargin, b.y - c_physMargin,
+                            b.x + b.w + c_physMargin, b.y + b.h + c_physMargin});
+
+            if(i % 16 == 0)
+                screens.push_back({b.x - c_screenW / 2, b.y - c_screenH / 2,
+                                   b.x + c_screenW / 2, b.y + c_screenH / 2});
+        }
+
+        BenchResult_t t = benchQuadtree(blocks, numLayers, phys, screens);
+        BenchResult_t g = benchGrid(blocks, numLayers, phys, screens);
+
+        printf("%-32.32s %7d %-9s %8.1fns %8.1fns %8.1fns %8.1fns\n",
+               f.c_str(), (int)blocks.size(), "quadtree", t.insert, t.update, t.physQuery, t.screenQuery);
+        printf("%-32.32s %7d %-9s %8.1fns %8.1fns %8.1fns %8.1fns\n",
+               "", (int)blocks.size(), "grid", g.insert, g.update, g.physQuery, g.screenQuery);
+
+        if(t.found != g.found)
+        {
+            fprintf(stderr, "Error: %s: the quadtree has found %d blocks, but the grid has found %d\n",
+                    f.c_str(), (int)t.found, (int)g.found);
+            ret = 1;
+        }
+
+        totalTree.insert += t.insert;
+        totalTree.update += t.update;
+        totalTree.physQuery += t.physQuery;
+        totalTree.screenQuery += t.screenQuery;
+        totalGrid.insert += g.insert;
+        totalGrid.update += g.update;
+        totalGrid.physQuery += g.physQuery;
+        totalGrid.screenQuery += g.screenQuery;
+    }
+
+    printf("%-32s %7s %-9s %8.1fns %8.1fns %8.1fns %8.1fns\n",
+           "TOTAL", "", "quadtree", totalTree.insert, totalTree.update, totalTree.physQuery, totalTree.screenQuery);
+    printf("%-32s %7s %-9s %8.1fns %8.1fns %8.1fns %8.1fns\n",
+           "", "", "grid", totalGrid.insert, totalGrid.update, totalGrid.physQuery, totalGrid.screenQuery);
+    fflush(stdout);
+
+    return ret;
+}
+
+} // namespace BlockIndexBench
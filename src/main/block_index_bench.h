@@ -0,0 +1,42 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module measures the insert, update and query costs of the block
+// indices (the loose quadtree and the flat grid) on the blocks of real levels
+
+#pragma once
+#ifndef BLOCK_INDEX_BENCH_H
+#define BLOCK_INDEX_BENCH_H
+
+#include <string>
+
+namespace BlockIndexBench
+{
+
+/*!
+ * \brief Run the benchmark on every level file of the directory and print the results
+ * \param levelsDir Directory with *.lvl and *.lvlx files (for example, test/levels)
+ * \return 0 on success, 1 if the indices have returned different results, 2 on failure to start
+ */
+int run(const std::string &levelsDir);
+
+} // namespace BlockIndexBench
+
+#endif // BLOCK_INDEX_BENCH_H
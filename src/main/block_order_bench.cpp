@@ -0,0 +1,226 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_timer.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "block_order_bench.h"
+#include "globals.h"
+#include "sorting.h"
+#include "layers.h"
+
+
+namespace BlockOrderBench
+{
+
+//! Rounds to average the time over
+static const int c_rounds = 8;
+//! Height of the synthetic level in blocks
+static const int c_columnHeight = 20;
+//! Every such block gets converted, as the bricks and coins of a P-Switch level
+static const int c_convertEvery = 10;
+
+struct BenchLevel_t
+{
+    std::vector<Block_t> blocks;
+    //! Slots of the blocks to remove, in the order of the P-Switch loop
+    std::vector<int> removed;
+    //! Blocks to append in place of the converted coins
+    std::vector<Block_t> added;
+};
+
+/*!
+ * \brief Make the synthetic level
+ * \param lvl Level to fill
+ * \param numBlocks Count of blocks
+ * \param stacked Put the converted coins over the existing blocks, so some blocks get the equal X and Y
+ */
+static void makeLevel(BenchLevel_t &lvl, int numBlocks, bool stacked)
+{
+    lvl.blocks.resize(numBlocks);
+
+    // columns of blocks, already in the X/Y order as the level load gets them
+    for(int i = 0; i < numBlocks; i++)
+    {
+        Block_t &b = lvl.blocks[i];
+        b.Type = 1;
+        // the original index, to tell the blocks of the same location apart
+        b.DefaultSpecial = i + 1;
+        b.Layer = LAYER_DEFAULT;
+        b.Location.X = double(i / c_columnHeight) * 32.0;
+        b.Location.Y = double(i % c_columnHeight) * 32.0;
+        b.Location.Width = 32.0;
+        b.Location.Height = 32.0;
+    }
+
+    int columns = (numBlocks + c_columnHeight - 1) / c_columnHeight;
+
+    for(int i = numBlocks; i >= 1; i--)
+    {
+        if(i % c_convertEvery != 0)
+            continue;
+
+        int k = (int)lvl.added.size();
+        lvl.removed.push_back(i);
+
+        Block_t b = lvl.blocks[0];
+        b.Type = 4;
+        b.DefaultSpecial = numBlocks + k + 1;
+
+        // scattered over the level, 7919 is a prime, so every row gets every column once
+        b.Location.X = double((k * 7919) % columns) * 32.0;
+        if(stacked)
+            b.Location.Y = double(k % c_columnHeight) * 32.0;
+        else
+            b.Location.Y = double(c_columnHeight + k / columns) * 32.0;
+
+        lvl.added.push_back(b);
+    }
+}
+
+// put the level into the block array and convert the blocks as the PSwitch() does
+static void applyLevel(const BenchLevel_t &lvl, bool touch)
+{
+    Block_t blankBlock;
+
+    numBlock = (int)lvl.blocks.size();
+    for(int A = 1; A <= numBlock; A++)
+        Block[A] = lvl.blocks[A - 1];
+    syncLayersTrees_AllBlocks();
+
+    for(const Block_t &b : lvl.added)
+    {
+        numBlock++;
+        Block[numBlock] = b;
+        syncLayersTrees_Block(numBlock);
+        if(touch)
+            blockOrderTouch(numBlock);
+    }
+
+    for(int A : lvl.removed)
+    {
+        Block[A] = Block[numBlock];
+        Block[numBlock] = blankBlock;
+        numBlock--;
+        syncLayersTrees_Block(A);
+        syncLayersTrees_Block(numBlock + 1);
+        if(touch)
+            blockOrderTouch(A);
+    }
+}
+
+// the sequence the PSwitch() has used before the blockOrderFinish()
+static void fullSort()
+{
+    int A, B;
+
+    qSortBlocksX(1, numBlock);
+    B = 1;
+
+    for(A = 2; A <= numBlock; A++)
+    {
+        if(Block[A].Location.X > Block[B].Location.X)
+        {
+            qSortBlocksY(B, A - 1);
+            B = A;
+        }
+    }
+
+    qSortBlocksY(B, A - 1);
+    FindSBlocks();
+    FindBlocks();
+    syncLayersTrees_AllBlocks();
+}
+
+static double secondsSince(uint64_t start)
+{
+    return double(SDL_GetPerformanceCounter() - start) / double(SDL_GetPerformanceFrequency());
+}
+
+// the blocks of the same location differ by the order only, so compare the identities
+static void saveOrder(std::vector<int> &out)
+{
+    out.clear();
+    for(int A = 1; A <= numBlock; A++)
+    {
+        out.push_back(Block[A].Type);
+        out.push_back(Block[A].Layer);
+        out.push_back(Block[A].DefaultSpecial);
+    }
+}
+
+int run(unsigned int numBlocks)
+{
+    if(numBlocks < (unsigned int)c_convertEvery || numBlocks > (unsigned int)maxBlocks)
+    {
+        fprintf(stderr, "Error: The count of blocks must be in the %d...%d range\n", c_convertEvery, maxBlocks);
+        return 2;
+    }
+
+    numLayers = 1;
+
+    printf("%7s %-9s %9s %12s %12s %8s\n", "blocks", "level", "converted", "full sort", "merge", "speedup");
+
+    int ret = 0;
+
+    for(int stacked = 0; stacked < 2; stacked++)
+    {
+        BenchLevel_t lvl;
+        makeLevel(lvl, (int)numBlocks, stacked != 0);
+
+        double full = 0.0, merge = 0.0;
+        std::vector<int> fullOrder, mergeOrder;
+
+        for(int r = 0; r < c_rounds; r++)
+        {
+            applyLevel(lvl, false);
+            uint64_t start = SDL_GetPerformanceCounter();
+            fullSort();
+            full += secondsSince(start) / c_rounds;
+            saveOrder(fullOrder);
+
+            applyLevel(lvl, true);
+            start = SDL_GetPerformanceCounter();
+            blockOrderFinish();
+            merge += secondsSince(start) / c_rounds;
+            saveOrder(mergeOrder);
+        }
+
+        // the stacked level falls back to the full sort
+        printf("%7u %-9s %9d %10.3fms %10.3fms %7.1fx\n",
+               numBlocks, stacked ? "stacked" : "scattered", (int)lvl.removed.size(),
+               full * 1000.0, merge * 1000.0, merge > 0.0 ? full / merge : 0.0);
+
+        if(fullOrder != mergeOrder)
+        {
+            fprintf(stderr, "Error: The merge has produced another block order than the full sort at the %s level\n",
+                    stacked ? "stacked" : "scattered");
+            ret = 1;
+        }
+    }
+
+    fflush(stdout);
+
+    return ret;
+}
+
+} // namespace BlockOrderBench
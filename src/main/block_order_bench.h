@@ -0,0 +1,42 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module measures the cost of restoring the block order after a P-Switch
+// on a synthetic level: the full re-sort against the incremental merge
+
+#pragma once
+#ifndef BLOCK_ORDER_BENCH_H
+#define BLOCK_ORDER_BENCH_H
+
+namespace BlockOrderBench
+{
+
+/*!
+ * \brief Convert every 10th block of the synthetic level the way the P-Switch does, restore the order and print the time
+ *
+ * Runs twice: with the coins scattered over the free space, and with the coins stacked over the blocks.
+ * \param numBlocks Count of blocks at the level
+ * \return 0 on success, 1 if the full sort and the merge have produced different orders, 2 on failure to start
+ */
+int run(unsigned int numBlocks);
+
+} // namespace BlockOrderBench
+
+#endif // BLOCK_ORDER_BENCH_H
@@ -0,0 +1,641 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <SDL2/SDL_cpuinfo.h>
+#ifndef PGE_NO_THREADING
+#   include <SDL2/SDL_thread.h>
+#   include <SDL2/SDL_mutex.h>
+#endif
+
+#include <DirManager/dirman.h>
+#include <Logger/logger.h>
+#include <Utils/files.h>
+#include <PGE_File_Formats/file_formats.h>
+
+#include "episode_catalog.h"
+
+/*
+ * Layout of the catalog file, numbers are in the native byte order:
+ *
+ * char[8]   magic "XTEPCAT\0"
+ * uint32    version of the catalog
+ * uint32    count of directories
+ * directory[count]:
+ *     uint8     kind (0 - worlds, 1 - levels)
+ *     string    path of the directory
+ *     int64     modification time of the directory, in nanoseconds
+ *     uint32    count of files
+ *     file[count]:
+ *         string    file name
+ *         int64     modification time, in nanoseconds
+ *         int64     size
+ *         uint8     1 if the header is valid
+ *         string    title
+ *         uint8     blocked characters, one bit per character
+ *         int32     format
+ *         int32     format version
+ *
+ * Strings are stored as the uint32 length followed by the characters.
+ */
+
+namespace EpisodeCatalog
+{
+
+//! Change it every time the set of the header fields or their parsing changes
+static const uint32_t s_version = 2;
+
+static const char s_magic[8] = {'X', 'T', 'E', 'P', 'C', 'A', 'T', '\0'};
+
+//! Limit of the threads reading the changed headers
+static const int s_maxWorkers = 8;
+
+enum Kind_t
+{
+    KIND_WORLD = 0,
+    KIND_LEVEL,
+    KIND_COUNT
+};
+
+struct Dir_t
+{
+    //! Modification time of the directory when its files were listed
+    int64_t mtime = 0;
+    //! Files in the listing order
+    std::vector<Header_t> files;
+};
+
+struct LevelStars_t
+{
+    int64_t mtime = 0;
+    int64_t size = 0;
+    bool valid = false;
+    int stars = 0;
+};
+
+static std::string s_path;
+static std::unordered_map<std::string, Dir_t> s_dirs[KIND_COUNT];
+//! Star counts of the levels entered by warps and world map, kept for the whole run
+static std::unordered_map<std::string, LevelStars_t> s_levelStars;
+
+#ifndef PGE_NO_THREADING
+static SDL_mutex *s_mutex = nullptr;
+#endif
+
+
+static inline void s_lock()
+{
+#ifndef PGE_NO_THREADING
+    if(s_mutex)
+        SDL_LockMutex(s_mutex);
+#endif
+}
+
+static inline void s_unlock()
+{
+#ifndef PGE_NO_THREADING
+    if(s_mutex)
+        SDL_UnlockMutex(s_mutex);
+#endif
+}
+
+
+template<class T>
+static inline void s_put(std::vector<unsigned char> &out, const T &v)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+static inline void s_putStr(std::vector<unsigned char> &out, const std::string &s)
+{
+    s_put(out, uint32_t(s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+struct Reader_t
+{
+    const std::vector<unsigned char> &data;
+    size_t pos = 0;
+    bool ok = true;
+
+    explicit Reader_t(const std::vector<unsigned char> &d) : data(d) {}
+
+    template<class T>
+    T get()
+    {
+        T v = T();
+        if(!ok || data.size() - pos < sizeof(T))
+        {
+            ok = false;
+            return v;
+        }
+
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+
+    std::string getStr()
+    {
+        uint32_t len = get<uint32_t>();
+        if(!ok || data.size() - pos < len)
+        {
+            ok = false;
+            return std::string();
+        }
+
+        std::string s(reinterpret_cast<const char *>(data.data() + pos), len);
+        pos += len;
+        return s;
+    }
+};
+
+static void s_load()
+{
+    FILE *f = Files::utf8_fopen(s_path.c_str(), "rb");
+    if(!f)
+        return;
+
+    std::vector<unsigned char> data;
+    unsigned char buf[4096];
+    size_t got;
+
+    while((got = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + got);
+
+    fclose(f);
+
+    if(data.size() < sizeof(s_magic) || std::memcmp(data.data(), s_magic, sizeof(s_magic)) != 0)
+    {
+        pLogWarning("The episode catalog %s is invalid, rebuilding it", s_path.c_str());
+        return;
+    }
+
+    Reader_t r(data);
+    r.pos = sizeof(s_magic);
+
+    if(r.get<uint32_t>() != s_version)
+        return; // made by another version, rebuilding it
+
+    uint32_t dirs = r.get<uint32_t>();
+
+    for(uint32_t i = 0; i < dirs && r.ok; i++)
+    {
+        uint8_t kind = r.get<uint8_t>();
+        std::string path = r.getStr();
+
+        Dir_t d;
+        d.mtime = r.get<int64_t>();
+
+        uint32_t files = r.get<uint32_t>();
+        for(uint32_t j = 0; j < files && r.ok; j++)
+        {
+            Header_t h;
+            h.file = r.getStr();
+            h.mtime = r.get<int64_t>();
+            h.size = r.get<int64_t>();
+            h.valid = r.get<uint8_t>() != 0;
+            h.title = r.getStr();
+
+            uint8_t noChar = r.get<uint8_t>();
+            for(int c = 0; c < 5; c++)
+                h.noCharacter[c] = (noChar >> c) & 1;
+
+            h.format = r.get<int32_t>();
+            h.formatVersion = r.get<int32_t>();
+            d.files.push_back(std::move(h));
+        }
+
+        if(r.ok && kind < KIND_COUNT)
+            s_dirs[kind][path] = std::move(d);
+    }
+
+    if(!r.ok)
+    {
+        pLogWarning("The episode catalog %s is truncated, rebuilding it", s_path.c_str());
+        for(auto &k : s_dirs)
+            k.clear();
+    }
+}
+
+static void s_save()
+{
+    if(s_path.empty())
+        return;
+
+    std::vector<unsigned char> out;
+    out.insert(out.end(), s_magic, s_magic + sizeof(s_magic));
+    s_put(out, s_version);
+
+    uint32_t dirs = 0;
+    for(const auto &k : s_dirs)
+        dirs += uint32_t(k.size());
+    s_put(out, dirs);
+
+    for(int kind = 0; kind < KIND_COUNT; kind++)
+    {
+        for(const auto &d : s_dirs[kind])
+        {
+            s_put(out, uint8_t(kind));
+            s_putStr(out, d.first);
+            s_put(out, d.second.mtime);
+            s_put(out, uint32_t(d.second.files.size()));
+
+            for(const Header_t &h : d.second.files)
+            {
+                uint8_t noChar = 0;
+                for(int c = 0; c < 5; c++)
+                    noChar |= uint8_t(h.noCharacter[c] ? (1 << c) : 0);
+
+                s_putStr(out, h.file);
+                s_put(out, h.mtime);
+                s_put(out, h.size);
+                s_put(out, uint8_t(h.valid ? 1 : 0));
+                s_putStr(out, h.title);
+                s_put(out, noChar);
+                s_put(out, int32_t(h.format));
+                s_put(out, int32_t(h.formatVersion));
+            }
+        }
+    }
+
+    DirMan::mkAbsPath(Files::dirname(s_path));
+
+    // write the new catalog aside to never leave the broken one
+    std::string tmpPath = s_path + ".tmp";
+    FILE *f = Files::utf8_fopen(tmpPath.c_str(), "wb");
+    if(!f)
+    {
+        pLogWarning("Can't write the episode catalog %s", tmpPath.c_str());
+        return;
+    }
+
+    bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok &= fclose(f) == 0;
+
+    if(!ok || !Files::moveFile(s_path, tmpPath, true))
+    {
+        pLogWarning("Can't write the episode catalog %s", s_path.c_str());
+        Files::deleteFile(tmpPath);
+    }
+}
+
+static void s_readHeader(Kind_t kind, const std::string &path, Header_t &h)
+{
+    h.valid = false;
+    h.title.clear();
+
+    if(kind == KIND_WORLD)
+    {
+        WorldData head;
+        if(!FileFormats::OpenWorldFileHeader(path, head))
+            return;
+
+        h.title = head.EpisodeTitle;
+        head.charactersToS64();
+        h.noCharacter[0] = head.nocharacter1;
+        h.noCharacter[1] = head.nocharacter2;
+        h.noCharacter[2] = head.nocharacter3;
+        h.noCharacter[3] = head.nocharacter4;
+        h.noCharacter[4] = head.nocharacter5;
+        h.format = head.meta.RecentFormat;
+        h.formatVersion = int(head.meta.RecentFormatVersion);
+    }
+    else
+    {
+        LevelData head;
+        if(!FileFormats::OpenLevelFileHeader(path, head))
+            return;
+
+        h.title = head.LevelName;
+        h.format = head.meta.RecentFormat;
+        h.formatVersion = int(head.meta.RecentFormatVersion);
+    }
+
+    h.valid = true;
+}
+
+
+struct Job_t
+{
+    Header_t *header;
+    std::string path;
+    //! Progress step this file belongs to
+    size_t step;
+};
+
+struct Work_t
+{
+    Kind_t kind = KIND_WORLD;
+    std::vector<Job_t> jobs;
+    //! Files left to read for every progress step
+    std::vector<SDL_atomic_t> stepLeft;
+    SDL_atomic_t next;
+    SDL_atomic_t *progress = nullptr;
+};
+
+static int s_worker(void *data)
+{
+    Work_t &w = *reinterpret_cast<Work_t *>(data);
+
+    while(true)
+    {
+        int i = SDL_AtomicAdd(&w.next, 1);
+        if(i >= (int)w.jobs.size())
+            break;
+
+        Job_t &j = w.jobs[i];
+        s_readHeader(w.kind, j.path, *j.header);
+
+        if(SDL_AtomicAdd(&w.stepLeft[j.step], -1) == 1 && w.progress)
+            SDL_AtomicAdd(w.progress, 1);
+    }
+
+    return 0;
+}
+
+static void s_runJobs(Work_t &w)
+{
+    SDL_AtomicSet(&w.next, 0);
+
+    if(w.jobs.empty())
+        return;
+
+#ifndef PGE_NO_THREADING
+    int threads = std::min(std::min(SDL_GetCPUCount(), s_maxWorkers), (int)w.jobs.size());
+    std::vector<SDL_Thread *> workers;
+
+    // the calling thread is the first worker
+    for(int i = 1; i < threads; i++)
+    {
+        SDL_Thread *t = SDL_CreateThread(s_worker, "EpisodeCatalog", &w);
+        if(t)
+            workers.push_back(t);
+    }
+
+    s_worker(&w);
+
+    for(SDL_Thread *t : workers)
+        SDL_WaitThread(t, nullptr);
+#else
+    s_worker(&w);
+#endif
+}
+
+//! Is the directory one of the scanned ones of the root: the root itself or its direct sub-directory?
+static bool s_isRootDir(const std::string &dir, const std::string &root)
+{
+    if(dir.size() < root.size() || dir.compare(0, root.size(), root) != 0)
+        return false;
+
+    if(dir.size() == root.size())
+        return true;
+
+    // another root nested into this one keeps its directories deeper
+    return dir.find('/', root.size()) == dir.size() - 1;
+}
+
+/*!
+ * \brief Bring the listed directories up to date and collect their valid files
+ * \param kind Kind of the files
+ * \param root Root the directories are taken from, the forgotten directories of it are removed
+ * \param dirs Directories to scan
+ * \param suffixes Suffixes of the files to take
+ * \param stepPerFile Count the progress per file instead of per directory
+ */
+static void s_scan(Kind_t kind, const std::string &root, const std::vector<std::string> &dirs,
+                   const std::vector<std::string> &suffixes, bool stepPerFile,
+                   std::vector<Item_t> &out, SDL_atomic_t *progress)
+{
+    auto &known = s_dirs[kind];
+    bool changed = false;
+
+    Work_t work;
+    work.kind = kind;
+    work.progress = progress;
+
+    std::vector<int> stepJobs;
+    // scanned directories with their paths, the missing ones are skipped
+    std::vector<std::pair<const std::string *, Dir_t *>> found;
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> names;
+
+    for(const std::string &dirPath : dirs)
+    {
+        int64_t dirTime = 0;
+        if(!Files::fileInfo(dirPath, &dirTime, nullptr))
+        {
+            // the directory is still counted by the caller's progress maximum
+            if(!stepPerFile && progress)
+                SDL_AtomicAdd(progress, 1);
+            continue;
+        }
+
+        seen.insert(dirPath);
+
+        auto it = known.find(dirPath);
+        bool relist = (it == known.end() || it->second.mtime != dirTime);
+        Dir_t &d = known[dirPath];
+        found.push_back({&dirPath, &d});
+
+        if(relist)
+        {
+            // adding, removing or renaming files changes the directory time, the old headers are kept by names
+            std::unordered_map<std::string, size_t> oldFiles;
+            for(size_t i = 0; i < d.files.size(); i++)
+                oldFiles[d.files[i].file] = i;
+
+            DirMan(dirPath).getListOfFiles(names, suffixes);
+
+            std::vector<Header_t> files;
+            files.reserve(names.size());
+
+            for(const std::string &name : names)
+            {
+                auto old = oldFiles.find(name);
+                if(old != oldFiles.end())
+                    files.push_back(std::move(d.files[old->second]));
+                else
+                {
+                    Header_t h;
+                    h.file = name;
+                    h.size = -1; // never read
+                    files.push_back(std::move(h));
+                }
+            }
+
+            d.files = std::move(files);
+            d.mtime = dirTime;
+            changed = true;
+        }
+
+        if(!stepPerFile)
+            stepJobs.push_back(0);
+
+        for(Header_t &h : d.files)
+        {
+            if(stepPerFile)
+                stepJobs.push_back(0);
+
+            int64_t mtime = 0, size = 0;
+            if(!Files::fileInfo(dirPath + h.file, &mtime, &size))
+            {
+                if(h.valid || h.size != -1)
+                    changed = true;
+                h.valid = false;
+                h.mtime = 0;
+                h.size = -1;
+                continue;
+            }
+
+            if(mtime == h.mtime && size == h.size)
+                continue;
+
+            h.mtime = mtime;
+            h.size = size;
+            stepJobs.back()++;
+            work.jobs.push_back({&h, dirPath + h.file, stepJobs.size() - 1});
+            changed = true;
+        }
+    }
+
+    work.stepLeft.resize(stepJobs.size());
+    for(size_t i = 0; i < stepJobs.size(); i++)
+    {
+        SDL_AtomicSet(&work.stepLeft[i], stepJobs[i]);
+        if(stepJobs[i] == 0 && progress)
+            SDL_AtomicAdd(progress, 1);
+    }
+
+    if(!work.jobs.empty())
+        pLogDebug("Episode catalog: reading %d changed headers of %s", (int)work.jobs.size(), root.c_str());
+
+    s_runJobs(work);
+
+    // forget the removed directories of this root
+    for(auto it = known.begin(); it != known.end();)
+    {
+        if(s_isRootDir(it->first, root) && !seen.count(it->first))
+        {
+            it = known.erase(it);
+            changed = true;
+        }
+        else
+            ++it;
+    }
+
+    for(const auto &f : found)
+    {
+        for(const Header_t &h : f.second->files)
+        {
+            if(!h.valid)
+                continue;
+
+            Item_t item;
+            item.dir = *f.first;
+            item.header = h;
+            out.push_back(std::move(item));
+        }
+    }
+
+    if(changed)
+        s_save();
+}
+
+void init(const std::string &path)
+{
+#ifndef PGE_NO_THREADING
+    if(!s_mutex)
+        s_mutex = SDL_CreateMutex();
+#endif
+
+    s_lock();
+
+    s_path = path;
+    for(auto &k : s_dirs)
+        k.clear();
+
+    s_load();
+
+    s_unlock();
+}
+
+void scanWorlds(const std::string &root, std::vector<Item_t> &out, SDL_atomic_t *progress)
+{
+    std::vector<std::string> folders;
+    DirMan(root).getListOfFolders(folders);
+
+    std::vector<std::string> dirs;
+    dirs.reserve(folders.size());
+    for(const std::string &f : folders)
+        dirs.push_back(root + f + "/");
+
+    s_lock();
+    s_scan(KIND_WORLD, root, dirs, {".wld", ".wldx"}, false, out, progress);
+    s_unlock();
+}
+
+void scanLevels(const std::string &root, std::vector<Item_t> &out, SDL_atomic_t *progress)
+{
+    s_lock();
+    s_scan(KIND_LEVEL, root, {root}, {".lvl", ".lvlx"}, true, out, progress);
+    s_unlock();
+}
+
+bool levelStars(const std::string &path, int &stars)
+{
+    int64_t mtime = 0, size = 0;
+    if(!Files::fileInfo(path, &mtime, &size))
+        return false;
+
+    s_lock();
+    auto it = s_levelStars.find(path);
+    if(it != s_levelStars.end() && it->second.mtime == mtime && it->second.size == size)
+    {
+        LevelStars_t e = it->second;
+        s_unlock();
+        stars = e.stars;
+        return e.valid;
+    }
+    s_unlock();
+
+    LevelStars_t e;
+    e.mtime = mtime;
+    e.size = size;
+
+    LevelData head;
+    e.valid = FileFormats::OpenLevelFileHeader(path, head);
+    e.stars = e.valid ? head.stars : 0;
+
+    s_lock();
+    s_levelStars[path] = e;
+    s_unlock();
+
+    stars = e.stars;
+    return e.valid;
+}
+
+} // namespace EpisodeCatalog
@@ -0,0 +1,95 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module remembers the headers of the installed episodes and battle
+// levels, so the menu re-reads only the files that were changed since
+
+#pragma once
+#ifndef EPISODE_CATALOG_H
+#define EPISODE_CATALOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <SDL2/SDL_atomic.h>
+
+namespace EpisodeCatalog
+{
+
+//! Header fields of the world or level file
+struct Header_t
+{
+    //! File name at its directory
+    std::string file;
+    //! Modification time and size of the file when it was parsed
+    int64_t mtime = 0;
+    int64_t size = 0;
+    //! The header was read successfully
+    bool valid = false;
+    //! Episode title or level name
+    std::string title;
+    //! Blocked characters of the world (nocharacter1...nocharacter5)
+    bool noCharacter[5] = {};
+    //! Format of the file (meta.RecentFormat and meta.RecentFormatVersion)
+    int format = 0;
+    int formatVersion = 0;
+};
+
+struct Item_t
+{
+    //! Directory of the file, ends with a slash
+    std::string dir;
+    Header_t header;
+};
+
+/*!
+ * \brief Read the catalog file
+ * \param path Path to the catalog file, written back after every scan that found changes
+ */
+void init(const std::string &path);
+
+/*!
+ * \brief Find the worlds of every episode folder of the root
+ * \param root Directory of the episode folders, ends with a slash
+ * \param out List to append the valid worlds to
+ * \param progress Counter to increase by one for every episode folder done (or nullptr)
+ */
+void scanWorlds(const std::string &root, std::vector<Item_t> &out, SDL_atomic_t *progress);
+
+/*!
+ * \brief Find the levels at the root directory
+ * \param root Directory of the levels, ends with a slash
+ * \param out List to append the valid levels to
+ * \param progress Counter to increase by one for every level file done (or nullptr)
+ */
+void scanLevels(const std::string &root, std::vector<Item_t> &out, SDL_atomic_t *progress);
+
+/*!
+ * \brief Get the stars count from the level header, the header is read again only if the file was changed
+ * \param path Full path to the level file
+ * \param stars Count of the stars of the level
+ * \return true if the header has been read
+ */
+bool levelStars(const std::string &path, int &stars);
+
+} // namespace EpisodeCatalog
+
+#endif // EPISODE_CATALOG_H
@@ -27,6 +27,7 @@
 #include "../config.h"
 #include "../compat.h"
 #include "../frame_timer.h"
+#include "../frame_profiler.h"
 #include "../game_main.h"
 #include "../sound.h"
 #include "../controls.h"
@@ -119,6 +120,8 @@ void CheckActive();//in game_main.cpp
 
 void GameLoop()
 {
+    FrameProfiler::frameBegin();
+
     lunaLoop();
 
     if(!Controls::Update())
@@ -205,23 +208,38 @@ void GameLoop()
             UpdateEditor();
 
         ClearTriggeredEvents();
+        g_stats.resetPhysics();
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_LAYERS);
         UpdateLayers(); // layers before/after npcs
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_NPCS);
         UpdateNPCs();
+        FrameProfiler::stageEnd();
 
         if(LevelMacro == LEVELMACRO_KEYHOLE_EXIT)
             return; // stop on key exit
 
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_BLOCKS);
         UpdateBlocks();
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_EFFECTS);
         UpdateEffects();
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_PLAYER);
         UpdatePlayer();
+        FrameProfiler::stageEnd();
         speedRun_tick();
         if(LivingPlayers() || BattleMode)
+        {
+            FrameProfiler::stageBegin(FrameProfiler::STAGE_GRAPHICS);
             UpdateGraphics();
+        }
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_SOUND);
         UpdateSound();
+        FrameProfiler::stageBegin(FrameProfiler::STAGE_EVENTS);
         UpdateEvents();
 //        If MagicHand = True Then UpdateEditor
 
         updateScreenFaders();
+        // the pause menu runs its own loop
+        FrameProfiler::frameEnd();
 
         // Pause game and CaptainN logic
         if(LevelMacro == LEVELMACRO_OFF && CheckLiving() > 0)
@@ -0,0 +1,518 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <deque>
+#include <type_traits>
+
+#include <SDL2/SDL_stdinc.h>
+
+#include "../globals.h"
+#include "../layers.h"
+#include "../compat.h"
+#include "../rand.h"
+#include "../npc/npc_active.h"
+#include "../npc/npc_hot.h"
+#include "trees.h"
+#include "game_snapshot.h"
+
+
+//! Count of the array elements per shared chunk
+static const long c_chunkSize = 64;
+//! Max count of the snapshots kept at the history
+static const size_t c_historySize = 32;
+
+
+//! Types that may be copied as raw bytes
+template<class T>
+struct SnapshotPlain : std::is_trivially_copyable<T> {};
+
+#ifndef RANGE_ARR_USE_HEAP
+// the only non-trivial member is the inline RangeArrI array which is safe to copy as bytes
+template<>
+struct SnapshotPlain<NPC_t> : std::true_type {};
+#endif
+
+
+template<class T, bool plain = SnapshotPlain<T>::value>
+struct SnapshotRange_t;
+
+//! Raw copy of the array range, unchanged chunks are shared with the previous snapshot
+template<class T>
+struct SnapshotRange_t<T, true>
+{
+    typedef std::vector<uint8_t> Chunk;
+
+    long count = 0;
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+    size_t ownBytes = 0;
+
+    void capture(const T *src, long n, const SnapshotRange_t *prev)
+    {
+        count = n > 0 ? n : 0;
+        ownBytes = 0;
+        chunks.resize((count + c_chunkSize - 1) / c_chunkSize);
+
+        for(size_t c = 0; c < chunks.size(); c++)
+        {
+            const uint8_t *from = reinterpret_cast<const uint8_t*>(src + c * c_chunkSize);
+            long len = SDL_min(c_chunkSize, count - long(c) * c_chunkSize);
+            size_t bytes = len * sizeof(T);
+
+            if(prev && c < prev->chunks.size() && prev->chunks[c]->size() == bytes &&
+               SDL_memcmp(prev->chunks[c]->data(), from, bytes) == 0)
+            {
+                chunks[c] = prev->chunks[c];
+                continue;
+            }
+
+            chunks[c] = std::make_shared<const Chunk>(from, from + bytes);
+            ownBytes += bytes;
+        }
+    }
+
+    void restore(T *dst) const
+    {
+        uint8_t *to = reinterpret_cast<uint8_t*>(dst);
+
+        for(const auto &c : chunks)
+        {
+            SDL_memcpy(to, c->data(), c->size());
+            to += c->size();
+        }
+    }
+};
+
+//! Copy of the array range for the types that own memory
+template<class T>
+struct SnapshotRange_t<T, false>
+{
+    long count = 0;
+    std::vector<T> items;
+    size_t ownBytes = 0;
+
+    void capture(const T *src, long n, const SnapshotRange_t *)
+    {
+        count = n > 0 ? n : 0;
+        items.assign(src, src + count);
+        ownBytes = count * sizeof(T);
+    }
+
+    void restore(T *dst) const
+    {
+        for(long i = 0; i < count; i++)
+            dst[i] = items[i];
+    }
+};
+
+
+struct GameSnapshot_t
+{
+    int64_t frame = 0;
+    //! Bytes of the chunks not shared with the previous snapshot
+    size_t ownBytes = 0;
+
+    RandomState_t random;
+    Compatibility_t compat;
+
+    // counters
+    int numNPCs = 0;
+    int numBlock = 0;
+    int numBackground = 0;
+    int numLocked = 0;
+    int numEffects = 0;
+    int numPlayers = 0;
+    int numWarps = 0;
+    int numWater = 0;
+    int numLayers = 0;
+    int numStars = 0;
+    int newEventNum = 0;
+    int iBlocks = 0;
+    int sBlockNum = 0;
+    int MidBackground = 0;
+    int LastBackground = 0;
+    bool BlocksSorted = false;
+
+    // gameplay state
+    int Score = 0;
+    int Coins = 0;
+    float Lives = 0.0f;
+    int LevelBeatCode = 0;
+    int LevelMacro = 0;
+    int LevelMacroCounter = 0;
+    bool EndLevel = false;
+    int PSwitchTime = 0;
+    int PSwitchStop = 0;
+    int PSwitchPlayer = 0;
+    int BeltDirection = 0;
+    bool FreezeNPCs = false;
+    bool CoinMode = false;
+    int StopHit = 0;
+    int SingleCoop = 0;
+    int ScreenType = 0;
+    int DScreenType = 0;
+    bool qScreen = false;
+    bool ForcedControls = false;
+    Controls_t ForcedControl;
+    int BattleWinner = 0;
+    int BattleIntro = 0;
+    int BattleOutro = 0;
+    std::string Checkpoint;
+    std::vector<Checkpoint_t> CheckpointsList;
+    float LevelChop[maxSections + 1];
+
+    // objects
+    SnapshotRange_t<NPC_t> npcs;
+    SnapshotRange_t<Block_t> blocks;
+    SnapshotRange_t<Background_t> bgos;
+    SnapshotRange_t<Effect_t> effects;
+    SnapshotRange_t<Player_t> players;
+    SnapshotRange_t<Warp_t> warps;
+    SnapshotRange_t<Water_t> waters;
+    SnapshotRange_t<Layer_t> layers;
+    SnapshotRange_t<Star_t> stars;
+
+    // events and sorting
+    SnapshotRange_t<eventindex_t> newEvent;
+    SnapshotRange_t<int> newEventDelay;
+    SnapshotRange_t<int> firstBlock;
+    SnapshotRange_t<int> lastBlock;
+    SnapshotRange_t<int> iBlock;
+    SnapshotRange_t<int> sBlockArray;
+
+    // sections and screens
+    SnapshotRange_t<Location_t> level;
+    SnapshotRange_t<bool> levelWrap;
+    SnapshotRange_t<bool> levelVWrap;
+    SnapshotRange_t<bool> offScreenExit;
+    SnapshotRange_t<bool> noTurnBack;
+    SnapshotRange_t<bool> underWater;
+    SnapshotRange_t<int> bgMusic;
+    SnapshotRange_t<int> background2;
+    SnapshotRange_t<long> bgColor;
+    SnapshotRange_t<float> autoX;
+    SnapshotRange_t<float> autoY;
+    SnapshotRange_t<vScreen_t> vScreens;
+    SnapshotRange_t<vScreen_t> qScreenLocs;
+    SnapshotRange_t<double> vScreenXs;
+    SnapshotRange_t<double> vScreenYs;
+    SnapshotRange_t<double> qScreenXs;
+    SnapshotRange_t<double> qScreenYs;
+
+    // misc
+    SnapshotRange_t<bool> blockSwitch;
+    SnapshotRange_t<bool> powerUpUnlock;
+    SnapshotRange_t<int> owedMount;
+    SnapshotRange_t<int> owedMountType;
+    SnapshotRange_t<int> battleLives;
+    SnapshotRange_t<int> specialFrame;
+    SnapshotRange_t<float> specialFrameCount;
+    SnapshotRange_t<int> blockFrame;
+    SnapshotRange_t<int> blockFrame2;
+    SnapshotRange_t<int> coinFrame;
+    SnapshotRange_t<int> coinFrame2;
+    SnapshotRange_t<int> backgroundFrame;
+    SnapshotRange_t<int> backgroundFrameCount;
+};
+
+
+namespace GameSnapshot
+{
+
+static std::deque<std::shared_ptr<GameSnapshot_t>> s_history;
+
+
+// keeps the range list short: captures the range and takes the same range of the previous snapshot
+#define SNAP_RANGE(field, first, count) \
+    s.field.capture(&(first), (count), previous ? &previous->field : nullptr); \
+    s.ownBytes += s.field.ownBytes
+
+std::shared_ptr<GameSnapshot_t> capture(int64_t frame, const GameSnapshot_t *previous)
+{
+    std::shared_ptr<GameSnapshot_t> ret = std::make_shared<GameSnapshot_t>();
+    GameSnapshot_t &s = *ret;
+
+    s.frame = frame;
+
+    saveRandomState(s.random);
+    s.compat = g_compatibility;
+
+    s.numNPCs = numNPCs;
+    s.numBlock = numBlock;
+    s.numBackground = numBackground;
+    s.numLocked = numLocked;
+    s.numEffects = numEffects;
+    s.numPlayers = numPlayers;
+    s.numWarps = numWarps;
+    s.numWater = numWater;
+    s.numLayers = numLayers;
+    s.numStars = numStars;
+    s.newEventNum = newEventNum;
+    s.iBlocks = iBlocks;
+    s.sBlockNum = sBlockNum;
+    s.MidBackground = MidBackground;
+    s.LastBackground = LastBackground;
+    s.BlocksSorted = BlocksSorted;
+
+    s.Score = Score;
+    s.Coins = Coins;
+    s.Lives = Lives;
+    s.LevelBeatCode = LevelBeatCode;
+    s.LevelMacro = LevelMacro;
+    s.LevelMacroCounter = LevelMacroCounter;
+    s.EndLevel = EndLevel;
+    s.PSwitchTime = PSwitchTime;
+    s.PSwitchStop = PSwitchStop;
+    s.PSwitchPlayer = PSwitchPlayer;
+    s.BeltDirection = BeltDirection;
+    s.FreezeNPCs = FreezeNPCs;
+    s.CoinMode = CoinMode;
+    s.StopHit = StopHit;
+    s.SingleCoop = SingleCoop;
+    s.ScreenType = ScreenType;
+    s.DScreenType = DScreenType;
+    s.qScreen = qScreen;
+    s.ForcedControls = ForcedControls;
+    s.ForcedControl = ForcedControl;
+    s.BattleWinner = BattleWinner;
+    s.BattleIntro = BattleIntro;
+    s.BattleOutro = BattleOutro;
+    s.Checkpoint = Checkpoint;
+    s.CheckpointsList = CheckpointsList;
+    SDL_memcpy(s.LevelChop, LevelChop, sizeof(LevelChop));
+
+    // the temporary NPCs at the negative indices are included
+    SNAP_RANGE(npcs, NPC[-128], numNPCs + 129);
+    SNAP_RANGE(blocks, Block[0], numBlock + 1);
+    SNAP_RANGE(bgos, Background[1], numBackground + numLocked);
+    SNAP_RANGE(effects, Effect[1], numEffects);
+    SNAP_RANGE(players, Player[0], numPlayers + 1);
+    SNAP_RANGE(warps, Warp[1], numWarps);
+    SNAP_RANGE(waters, Water[0], numWater + 1);
+    SNAP_RANGE(layers, Layer[0], numLayers + 1);
+    SNAP_RANGE(stars, Star[1], numStars);
+
+    SNAP_RANGE(newEvent, NewEvent[1], newEventNum);
+    SNAP_RANGE(newEventDelay, newEventDelay[1], newEventNum);
+    SNAP_RANGE(firstBlock, FirstBlock[-FLBlocks], 2 * FLBlocks + 1);
+    SNAP_RANGE(lastBlock, LastBlock[-FLBlocks], 2 * FLBlocks + 1);
+    SNAP_RANGE(iBlock, iBlock[0], iBlocks + 1);
+    SNAP_RANGE(sBlockArray, sBlockArray[1], sBlockNum);
+
+    SNAP_RANGE(level, level[0], maxSections + 1);
+    SNAP_RANGE(levelWrap, LevelWrap[0], maxSections + 1);
+    SNAP_RANGE(levelVWrap, LevelVWrap[0], maxSections + 1);
+    SNAP_RANGE(offScreenExit, OffScreenExit[0], maxSections + 1);
+    SNAP_RANGE(noTurnBack, NoTurnBack[0], maxSections + 1);
+    SNAP_RANGE(underWater, UnderWater[0], maxSections + 1);
+    SNAP_RANGE(bgMusic, bgMusic[0], maxSections + 1);
+    SNAP_RANGE(background2, Background2[0], maxSections + 1);
+    SNAP_RANGE(bgColor, bgColor[0], maxSections + 1);
+    SNAP_RANGE(autoX, AutoX[0], maxSections + 1);
+    SNAP_RANGE(autoY, AutoY[0], maxSections + 1);
+    SNAP_RANGE(vScreens, vScreen[0], 3);
+    SNAP_RANGE(qScreenLocs, qScreenLoc[0], 3);
+    SNAP_RANGE(vScreenXs, vScreenX[0], maxPlayers + 1);
+    SNAP_RANGE(vScreenYs, vScreenY[0], maxPlayers + 1);
+    SNAP_RANGE(qScreenXs, qScreenX[0], maxPlayers + 1);
+    SNAP_RANGE(qScreenYs, qScreenY[0], maxPlayers + 1);
+
+    SNAP_RANGE(blockSwitch, BlockSwitch[1], 4);
+    SNAP_RANGE(powerUpUnlock, PowerUpUnlock[2], 6);
+    SNAP_RANGE(owedMount, OwedMount[0], maxPlayers + 1);
+    SNAP_RANGE(owedMountType, OwedMountType[0], maxPlayers + 1);
+    SNAP_RANGE(battleLives, BattleLives[1], maxPlayers);
+    SNAP_RANGE(specialFrame, SpecialFrame[0], 101);
+    SNAP_RANGE(specialFrameCount, SpecialFrameCount[0], 101);
+    SNAP_RANGE(blockFrame, BlockFrame[1], maxBlockType);
+    SNAP_RANGE(blockFrame2, BlockFrame2[1], maxBlockType);
+    SNAP_RANGE(coinFrame, CoinFrame[1], 10);
+    SNAP_RANGE(coinFrame2, CoinFrame2[1], 10);
+    SNAP_RANGE(backgroundFrame, BackgroundFrame[1], maxBackgroundType);
+    SNAP_RANGE(backgroundFrameCount, BackgroundFrameCount[1], maxBackgroundType);
+
+    return ret;
+}
+
+#undef SNAP_RANGE
+
+void restore(const GameSnapshot_t &s)
+{
+    loadRandomState(s.random);
+    g_compatibility = s.compat;
+
+    numNPCs = s.numNPCs;
+    npcActiveInvalidate();
+    numBlock = s.numBlock;
+    numBackground = s.numBackground;
+    numLocked = s.numLocked;
+    numEffects = s.numEffects;
+    numPlayers = s.numPlayers;
+    numWarps = s.numWarps;
+    numWater = s.numWater;
+    numLayers = s.numLayers;
+    numStars = s.numStars;
+    newEventNum = s.newEventNum;
+    iBlocks = s.iBlocks;
+    sBlockNum = s.sBlockNum;
+    MidBackground = s.MidBackground;
+    LastBackground = s.LastBackground;
+    BlocksSorted = s.BlocksSorted;
+
+    Score = s.Score;
+    Coins = s.Coins;
+    Lives = s.Lives;
+    LevelBeatCode = s.LevelBeatCode;
+    LevelMacro = s.LevelMacro;
+    LevelMacroCounter = s.LevelMacroCounter;
+    EndLevel = s.EndLevel;
+    PSwitchTime = s.PSwitchTime;
+    PSwitchStop = s.PSwitchStop;
+    PSwitchPlayer = s.PSwitchPlayer;
+    BeltDirection = s.BeltDirection;
+    FreezeNPCs = s.FreezeNPCs;
+    CoinMode = s.CoinMode;
+    StopHit = s.StopHit;
+    SingleCoop = s.SingleCoop;
+    ScreenType = s.ScreenType;
+    DScreenType = s.DScreenType;
+    qScreen = s.qScreen;
+    ForcedControls = s.ForcedControls;
+    ForcedControl = s.ForcedControl;
+    BattleWinner = s.BattleWinner;
+    BattleIntro = s.BattleIntro;
+    BattleOutro = s.BattleOutro;
+    Checkpoint = s.Checkpoint;
+    CheckpointsList = s.CheckpointsList;
+    SDL_memcpy(LevelChop, s.LevelChop, sizeof(LevelChop));
+
+    s.npcs.restore(&NPC[-128]);
+    s.blocks.restore(&Block[0]);
+    s.bgos.restore(&Background[1]);
+    s.effects.restore(&Effect[1]);
+    s.players.restore(&Player[0]);
+    s.warps.restore(&Warp[1]);
+    s.waters.restore(&Water[0]);
+    s.layers.restore(&Layer[0]);
+    s.stars.restore(&Star[1]);
+
+    s.newEvent.restore(&NewEvent[1]);
+    s.newEventDelay.restore(&newEventDelay[1]);
+    s.firstBlock.restore(&FirstBlock[-FLBlocks]);
+    s.lastBlock.restore(&LastBlock[-FLBlocks]);
+    s.iBlock.restore(&iBlock[0]);
+    s.sBlockArray.restore(&sBlockArray[1]);
+
+    s.level.restore(&level[0]);
+    s.levelWrap.restore(&LevelWrap[0]);
+    s.levelVWrap.restore(&LevelVWrap[0]);
+    s.offScreenExit.restore(&OffScreenExit[0]);
+    s.noTurnBack.restore(&NoTurnBack[0]);
+    s.underWater.restore(&UnderWater[0]);
+    s.bgMusic.restore(&bgMusic[0]);
+    s.background2.restore(&Background2[0]);
+    s.bgColor.restore(&bgColor[0]);
+    s.autoX.restore(&AutoX[0]);
+    s.autoY.restore(&AutoY[0]);
+    s.vScreens.restore(&vScreen[0]);
+    s.qScreenLocs.restore(&qScreenLoc[0]);
+    s.vScreenXs.restore(&vScreenX[0]);
+    s.vScreenYs.restore(&vScreenY[0]);
+    s.qScreenXs.restore(&qScreenX[0]);
+    s.qScreenYs.restore(&qScreenY[0]);
+
+    s.blockSwitch.restore(&BlockSwitch[1]);
+    s.powerUpUnlock.restore(&PowerUpUnlock[2]);
+    s.owedMount.restore(&OwedMount[0]);
+    s.owedMountType.restore(&OwedMountType[0]);
+    s.battleLives.restore(&BattleLives[1]);
+    s.specialFrame.restore(&SpecialFrame[0]);
+    s.specialFrameCount.restore(&SpecialFrameCount[0]);
+    s.blockFrame.restore(&BlockFrame[1]);
+    s.blockFrame2.restore(&BlockFrame2[1]);
+    s.coinFrame.restore(&CoinFrame[1]);
+    s.coinFrame2.restore(&CoinFrame2[1]);
+    s.backgroundFrame.restore(&BackgroundFrame[1]);
+    s.backgroundFrameCount.restore(&BackgroundFrameCount[1]);
+
+    // the derived indices are pointing to the slots of the restored arrays,
+    // and the layers above the restored numLayers were not restored at all
+    syncLayersTrees_AllBlocks();
+    syncLayers_AllNPCs();
+    syncLayers_AllBGOs();
+    syncLayers_AllWarps();
+    syncLayers_AllWaters();
+    treeNPCClear();
+    treeNPCSyncAll();
+    npcHotSyncAll();
+}
+
+int64_t frame(const GameSnapshot_t &snapshot)
+{
+    return snapshot.frame;
+}
+
+size_t memoryUsage(const GameSnapshot_t &snapshot)
+{
+    return sizeof(GameSnapshot_t) + snapshot.ownBytes;
+}
+
+
+void historyPush(int64_t frame)
+{
+    const GameSnapshot_t *prev = s_history.empty() ? nullptr : s_history.back().get();
+
+    s_history.push_back(capture(frame, prev));
+
+    if(s_history.size() > c_historySize)
+        s_history.pop_front();
+}
+
+const GameSnapshot_t *historyFind(int64_t frame)
+{
+    for(auto it = s_history.rbegin(); it != s_history.rend(); ++it)
+    {
+        if((*it)->frame <= frame)
+            return it->get();
+    }
+
+    return nullptr;
+}
+
+int64_t historyRewind(int64_t frame)
+{
+    const GameSnapshot_t *s = historyFind(frame);
+    if(!s)
+        return -1;
+
+    while(s_history.back().get() != s)
+        s_history.pop_back();
+
+    restore(*s);
+
+    return s->frame;
+}
+
+void historyClear()
+{
+    s_history.clear();
+}
+
+} // namespace GameSnapshot
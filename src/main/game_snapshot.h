@@ -0,0 +1,91 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module captures the complete state of the running level simulation
+// into memory and restores it later (rewinding, replay seeking, divergence bisecting)
+
+#pragma once
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+struct GameSnapshot_t;
+
+namespace GameSnapshot
+{
+
+/*!
+ * \brief Capture the state of the running level
+ * \param frame Number of the frame the state belongs to
+ * \param previous Earlier snapshot to share the unchanged parts with, may be null
+ * \return New snapshot
+ *
+ * The arrays are stored in fixed-size chunks, every chunk that didn't change since
+ * the previous snapshot is shared instead of copied, so consecutive snapshots only
+ * take the memory of the changed parts.
+ */
+std::shared_ptr<GameSnapshot_t> capture(int64_t frame, const GameSnapshot_t *previous = nullptr);
+
+/*!
+ * \brief Restore the level state saved at the snapshot
+ * \param snapshot Snapshot taken at the same level
+ */
+void restore(const GameSnapshot_t &snapshot);
+
+//! Frame number the snapshot has been taken at
+int64_t frame(const GameSnapshot_t &snapshot);
+
+//! Memory owned by the snapshot itself, excluding the chunks shared with the other snapshots
+size_t memoryUsage(const GameSnapshot_t &snapshot);
+
+
+/*!
+ * \brief Capture the state into the history of the recent snapshots
+ * \param frame Number of the current frame, must be greater than of the previous pushed one
+ *
+ * The oldest snapshot gets dropped when the history is full.
+ */
+void historyPush(int64_t frame);
+
+/*!
+ * \brief Find the newest snapshot of the history taken at or before the frame
+ * \param frame Wanted frame number
+ * \return Snapshot or null if there is no suitable one
+ */
+const GameSnapshot_t *historyFind(int64_t frame);
+
+/*!
+ * \brief Restore the newest snapshot of the history taken at or before the frame
+ * \param frame Wanted frame number
+ * \return Frame number of the restored snapshot, -1 if there is no suitable one
+ *
+ * Snapshots newer than the restored one get dropped.
+ */
+int64_t historyRewind(int64_t frame);
+
+//! Drop all snapshots of the history
+void historyClear();
+
+} // namespace GameSnapshot
+
+#endif // GAME_SNAPSHOT_H
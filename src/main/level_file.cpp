@@ -33,6 +33,8 @@
 #include "../npc_id.h"
 #include "level_file.h"
 #include "trees.h"
+#include "episode_catalog.h"
+#include "../npc/npc_active.h"
 #include "record.h"
 #include "npc_special_data.h"
 
@@ -170,6 +172,7 @@ bool OpenLevelData(LevelData &lvl, const std::string FilePath)
     numBackground = 0;
     numLocked = 0;
     numNPCs = 0;
+    npcActiveInvalidate();
     numWarps = 0;
 
     numLayers = 0;
@@ -998,6 +1001,7 @@ void ClearLevel()
     for(A = -128; A <= maxNPCs; A++)
         NPC[A] = blankNPC;
     numNPCs = 0;
+    npcActiveInvalidate();
 
     for(A = 1; A <= maxBlocks; A++)
         Block[A] = blankBlock;
@@ -1073,7 +1077,9 @@ void FindStars()
 //    int A = 0;
 //    int B = 0;
 //    std::string newInput;
-    LevelData head;
+    StarCounts_t collected;
+    bool counted = false;
+    int stars = 0;
 
     for(int A = 1; A <= numWarps; A++)
     {
@@ -1088,16 +1094,17 @@ void FindStars()
 
             if(!fullPath.empty())
             {
-                if(FileFormats::OpenLevelFileHeader(fullPath, head))
+                // the header is read only once per run unless the level file gets changed
+                if(EpisodeCatalog::levelStars(fullPath, stars))
                 {
-                    warp.maxStars = head.stars;
-                    warp.curStars = 0;
-
-                    for(int B = 1; B <= numStars; B++)
+                    if(!counted)
                     {
-                        if(SDL_strcasecmp(Star[B].level.c_str(), GetS(warp.level).c_str()) == 0)
-                            warp.curStars++;
+                        CountCollectedStars(collected);
+                        counted = true;
                     }
+
+                    warp.maxStars = stars;
+                    warp.curStars = CollectedStarsOf(collected, GetS(warp.level));
                 }
             }
 
@@ -1105,6 +1112,30 @@ void FindStars()
     }
 }
 
+static std::string s_starKey(const std::string &levelFile)
+{
+    // the same case folding as of SDL_strcasecmp()
+    std::string key = levelFile;
+    for(char &c : key)
+        c = (char)SDL_tolower((unsigned char)c);
+    return key;
+}
+
+void CountCollectedStars(StarCounts_t &counts)
+{
+    counts.clear();
+    counts.reserve(numStars);
+
+    for(int B = 1; B <= numStars; B++)
+        counts[s_starKey(Star[B].level)]++;
+}
+
+int CollectedStarsOf(const StarCounts_t &counts, const std::string &levelFile)
+{
+    auto it = counts.find(s_starKey(levelFile));
+    return it != counts.end() ? it->second : 0;
+}
+
 // Is there any unsupported content for this format in the level?
 bool CanConvertLevel(int format, std::string* reasons)
 {
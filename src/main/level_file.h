@@ -24,6 +24,7 @@
 #define LEVEL_FILE_H
 
 #include <string>
+#include <unordered_map>
 #include <PGE_File_Formats/lvl_filedata.h>
 
 struct Background_t;
@@ -41,6 +42,15 @@ void ClearLevel();
 //! checks for stars in warps the lead to another level
 void FindStars();
 
+//! Collected stars counted by the lower-cased level file name
+typedef std::unordered_map<std::string, int> StarCounts_t;
+
+//! Count the collected stars (Star[]) of every level
+void CountCollectedStars(StarCounts_t &counts);
+
+//! Collected stars of the level, the file name is compared case-insensitively
+int CollectedStarsOf(const StarCounts_t &counts, const std::string &levelFile);
+
 //! NEW: routines to check if it is possible to convert to legacy file formats and to remove all non-legacy content
 bool CanConvertLevel(int format, std::string* reasons);
 void ConvertLevel(int format);
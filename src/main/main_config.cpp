@@ -118,6 +118,13 @@ void OpenConfig_preSetup()
         config.read("frame-skip", g_videoSettings.enableFrameSkip, true);
         config.read("show-fps", g_videoSettings.showFrameRate, false);
         config.read("scale-down-all-textures", g_videoSettings.scaleDownAllTextures, false);
+        config.read("texture-cache", g_videoSettings.textureCache, true);
+        config.read("texture-cache-size", g_videoSettings.textureCacheSize, 256);
+        if(g_videoSettings.textureCacheSize < 1)
+            g_videoSettings.textureCacheSize = 1;
+        config.read("texture-memory-budget", g_videoSettings.textureMemoryBudget, 0);
+        if(g_videoSettings.textureMemoryBudget < 0)
+            g_videoSettings.textureMemoryBudget = 0;
         config.endGroup();
 
         config.beginGroup("sound");
@@ -183,10 +190,17 @@ void OpenConfig()
             {"show-all", 2}
         };
 
+        const IniProcessing::StrEnumMap recordFormat =
+        {
+            {"text", Config_t::RECORD_FORMAT_TEXT},
+            {"binary", Config_t::RECORD_FORMAT_BINARY}
+        };
+
         config.beginGroup("main");
         config.read("release", FileRelease, curRelease);
         config.read("full-screen", resBool, false);
         config.read("record-gameplay", g_config.RecordGameplayData, false);
+        config.readEnum("record-gameplay-format", g_config.RecordGameplayFormat, (int)Config_t::RECORD_FORMAT_BINARY, recordFormat);
         config.read("use-native-osk", g_config.use_native_osk, false);
         config.read("new-editor", g_config.enable_editor, false);
         config.read("enable-editor", g_config.enable_editor, g_config.enable_editor);
@@ -214,6 +228,7 @@ void OpenConfig()
         config.read("enter-cheats-menu-item", g_config.enter_cheats_menu_item, false);
         config.read("world-map-fast-move", g_config.worldMapFastMove, false);
         config.read("editor-pause-on-death", g_config.editor_pause_on_death, true);
+        config.read("physics-block-trees", g_config.PhysicsUseBlockTrees, true);
         config.endGroup();
 
         config.beginGroup("effects");
@@ -255,6 +270,14 @@ void SaveConfig()
     config.setValue("full-screen", resChanged);
 #endif
     config.setValue("record-gameplay", g_config.RecordGameplayData);
+    {
+        std::unordered_map<int, std::string> recordFormat =
+        {
+            {Config_t::RECORD_FORMAT_TEXT, "text"},
+            {Config_t::RECORD_FORMAT_BINARY, "binary"}
+        };
+        config.setValue("record-gameplay-format", recordFormat[g_config.RecordGameplayFormat]);
+    }
     config.setValue("use-native-osk", g_config.use_native_osk);
     config.setValue("enable-editor", g_config.enable_editor);
     config.setValue("editor-edge-scroll", g_config.editor_edge_scroll);
@@ -297,6 +320,9 @@ void SaveConfig()
         config.setValue("frame-skip", g_videoSettings.enableFrameSkip);
         config.setValue("show-fps", g_videoSettings.showFrameRate);
         config.setValue("scale-down-all-textures", g_videoSettings.scaleDownAllTextures);
+        config.setValue("texture-cache", g_videoSettings.textureCache);
+        config.setValue("texture-cache-size", g_videoSettings.textureCacheSize);
+        config.setValue("texture-memory-budget", g_videoSettings.textureMemoryBudget);
         config.setValue("display-controllers", g_drawController);
         config.setValue("battery-status", batteryStatus[g_videoSettings.batteryStatus]);
         config.setValue("osk-fill-screen", g_config.osk_fill_screen);
@@ -349,6 +375,7 @@ void SaveConfig()
     config.setValue("enter-cheats-menu-item", g_config.enter_cheats_menu_item);
     config.setValue("world-map-fast-move", g_config.worldMapFastMove);
     config.setValue("editor-pause-on-death", g_config.editor_pause_on_death);
+    config.setValue("physics-block-trees", g_config.PhysicsUseBlockTrees);
     config.endGroup();
 
     config.beginGroup("speedrun");
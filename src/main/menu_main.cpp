@@ -30,6 +30,7 @@
 
 #include "menu_main.h"
 #include "game_info.h"
+#include "episode_catalog.h"
 #include "../gfx.h"
 #include "screen_connect.h"
 #include "menu_controls.h"
@@ -235,59 +236,50 @@ void FindWorlds()
     }
 #endif
 
+#ifndef PGE_NO_THREADING
+    SDL_atomic_t *progress = &loadingProgrss;
+#else
+    SDL_atomic_t *progress = nullptr;
+#endif
+
+    std::vector<EpisodeCatalog::Item_t> found;
+
     for(const auto &worldsRoot : worldRoots)
     {
-        DirMan episodes(worldsRoot.path);
-
-        std::vector<std::string> dirs;
-        std::vector<std::string> files;
-        episodes.getListOfFolders(dirs);
-        WorldData head;
+        // only the changed world files are read again, the rest comes from the catalog
+        found.clear();
+        EpisodeCatalog::scanWorlds(worldsRoot.path, found, progress);
 
-        for(auto &dir : dirs)
+        for(const auto &item : found)
         {
-            std::string epDir = worldsRoot.path + dir + "/";
-            DirMan episode(epDir);
-            episode.getListOfFiles(files, {".wld", ".wldx"});
+            const EpisodeCatalog::Header_t &head = item.header;
 
-            for(std::string &fName : files)
-            {
-                std::string wPath = epDir + fName;
-                if(FileFormats::OpenWorldFileHeader(wPath, head))
-                {
-                    SelectWorld_t w;
-                    w.WorldName = head.EpisodeTitle;
-                    head.charactersToS64();
-                    w.WorldPath = epDir;
-                    w.WorldFile = fName;
-                    if(w.WorldName.empty())
-                        w.WorldName = fName;
-
-                    w.blockChar[1] = head.nocharacter1;
-                    w.blockChar[2] = head.nocharacter2;
-
-                    if(head.meta.RecentFormat != LevelData::SMBX64 || head.meta.RecentFormatVersion >= 30 || !compatModern)
-                    {
-                        w.blockChar[3] = head.nocharacter3;
-                        w.blockChar[4] = head.nocharacter4;
-                        w.blockChar[5] = head.nocharacter5;
-                    }
-                    else
-                    {
-                        w.blockChar[3] = true;
-                        w.blockChar[4] = true;
-                        w.blockChar[5] = true;
-                    }
+            SelectWorld_t w;
+            w.WorldName = head.title;
+            w.WorldPath = item.dir;
+            w.WorldFile = head.file;
+            if(w.WorldName.empty())
+                w.WorldName = head.file;
 
-                    SelectWorld.push_back(w);
-                    if(worldsRoot.editable)
-                        SelectWorldEditable.push_back(w);
-                }
+            w.blockChar[1] = head.noCharacter[0];
+            w.blockChar[2] = head.noCharacter[1];
+
+            if(head.format != LevelData::SMBX64 || head.formatVersion >= 30 || !compatModern)
+            {
+                w.blockChar[3] = head.noCharacter[2];
+                w.blockChar[4] = head.noCharacter[3];
+                w.blockChar[5] = head.noCharacter[4];
+            }
+            else
+            {
+                w.blockChar[3] = true;
+                w.blockChar[4] = true;
+                w.blockChar[5] = true;
             }
 
-#ifndef PGE_NO_THREADING
-            SDL_AtomicAdd(&loadingProgrss, 1);
-#endif
+            SelectWorld.push_back(w);
+            if(worldsRoot.editable)
+                SelectWorldEditable.push_back(w);
         }
     }
 
@@ -338,7 +330,6 @@ void FindLevels()
     NumSelectBattle = 1;
     SelectBattle.emplace_back(SelectWorld_t()); // "random level" entry
     SelectBattle[1].WorldName = "Random Level";
-    LevelData head;
 
 #ifndef PGE_NO_THREADING
     SDL_AtomicSet(&loadingProgrss, 0);
@@ -353,27 +344,28 @@ void FindLevels()
     }
 #endif
 
+#ifndef PGE_NO_THREADING
+    SDL_atomic_t *progress = &loadingProgrss;
+#else
+    SDL_atomic_t *progress = nullptr;
+#endif
+
+    std::vector<EpisodeCatalog::Item_t> found;
+
     for(const auto &battleRoot : battleRoots)
     {
-        std::vector<std::string> files;
-        DirMan battleLvls(battleRoot);
-        battleLvls.getListOfFiles(files, {".lvl", ".lvlx"});
-        for(std::string &fName : files)
+        found.clear();
+        EpisodeCatalog::scanLevels(battleRoot, found, progress);
+
+        for(const auto &item : found)
         {
-            std::string wPath = battleRoot + fName;
-            if(FileFormats::OpenLevelFileHeader(wPath, head))
-            {
-                SelectWorld_t w;
-                w.WorldPath = battleRoot;
-                w.WorldFile = fName;
-                w.WorldName = head.LevelName;
-                if(w.WorldName.empty())
-                    w.WorldName = fName;
-                SelectBattle.push_back(w);
-            }
-#ifndef PGE_NO_THREADING
-            SDL_AtomicAdd(&loadingProgrss, 1);
-#endif
+            SelectWorld_t w;
+            w.WorldPath = item.dir;
+            w.WorldFile = item.header.file;
+            w.WorldName = item.header.title;
+            if(w.WorldName.empty())
+                w.WorldName = item.header.file;
+            SelectBattle.push_back(w);
         }
     }
 
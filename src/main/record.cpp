@@ -37,11 +37,14 @@
 #include "../compat.h"
 #include "../config.h"
 #include "record.h"
+#include "game_snapshot.h"
 #include "speedrunner.h"
 #include "game_main.h"
 
 #include <SDL2/SDL.h>
 #include <chrono>
+#include <vector>
+#include <algorithm>
 #include <fmt_time_ne.h>
 #include <fmt_format_ne.h>
 
@@ -114,6 +117,108 @@ static std::string replayLevelFilePath;
 
 static const int c_recordVersion = 2;
 
+//! Leading signature of the binary recording
+static const char c_binaryMagic[4] = {'T', 'X', 'R', 'B'};
+//! Trailing signature of the binary recording's seek index
+static const char c_indexMagic[4] = {'T', 'X', 'R', 'I'};
+//! Frames between the seek points of the binary recording (matches the NPCs records)
+static const int64_t c_seekInterval = 900;
+
+// order of keys at the recordings
+static bool Controls_t::* const c_controlKeys[] =
+{
+    &Controls_t::Up, &Controls_t::Down, &Controls_t::Left, &Controls_t::Right, &Controls_t::Start,
+    &Controls_t::Drop, &Controls_t::Jump, &Controls_t::Run, &Controls_t::AltJump, &Controls_t::AltRun
+};
+static const char c_controlKeyNames[] = "UDLRSIABXY";
+static const int c_controlKeysCount = 10;
+
+
+struct HeaderStar_t
+{
+    std::string level;
+    int section = 0;
+};
+
+struct HeaderPlayer_t
+{
+    int character = 0;
+    int state = 0;
+    int mountType = 0;
+    int heldBonus = 0;
+};
+
+//! Initial state of the recorded gameplay
+struct Header_t
+{
+    int recordVersion = 0;
+    std::string version;
+    int compatLevel = 0;
+    std::string levelPath;
+    std::string md5;
+    int seed = 0;
+    bool checkpoint = false;
+    bool hasMultipoints = false;
+    std::vector<int> multipoints;
+    int startWarp = 0;
+    int returnWarp = 0;
+    int lives = 0;
+    int coins = 0;
+    int score = 0;
+    std::vector<HeaderStar_t> stars;
+    std::vector<HeaderPlayer_t> players;
+};
+
+struct StatusRecord_t
+{
+    int ticks = 0;
+    long randCalls = 0;
+    int score = 0;
+    int numNPCs = 0;
+    int numActiveNPCs = 0;
+    int renderedNPCs = 0;
+    int renderedBlocks = 0;
+    int renderedBGOs = 0;
+    //! Count of players with the valid position below
+    int numPlayers = 0;
+    double px[maxPlayers];
+    double py[maxPlayers];
+};
+
+struct NPCRecord_t
+{
+    //! The record is damaged and shouldn't be compared
+    bool invalid = false;
+    int type = 0;
+    bool active = false;
+    double direction = 0.0;
+    double x = 0.0;
+    double y = 0.0;
+    double w = 0.0;
+    double h = 0.0;
+    double special[7] = {};
+};
+
+//! Position to resume the replay of the binary recording from
+struct SeekPoint_t
+{
+    int64_t frame = 0;
+    //! Frame of the last record before the seek point, the following one is relative to it
+    int64_t prevFrame = 0;
+    int64_t offset = 0;
+    std::vector<uint16_t> controls;
+};
+
+//! State of the written recording
+struct RecordOut_t
+{
+    FILE *f = nullptr;
+    bool binary = false;
+    //! Frame of the last written record
+    int64_t lastFrame = 0;
+    std::vector<SeekPoint_t> index;
+};
+
 // private
 
 static bool         in_level = false;
@@ -124,165 +229,511 @@ static int64_t      next_record_frame = 0;
 static uint32_t     last_status_tick = 0;
 static Controls_t   last_controls[maxPlayers];
 
+static ReplayStatus last_replay_status = ReplayStatus::None;
+static int64_t      first_diverged_frame = -1;
+static uint64_t     replay_start_counter = 0;
+
+static RecordOut_t  record_out;
+
+static bool         replay_binary = false;
+static bool         replay_index_loaded = false;
+static std::vector<SeekPoint_t> replay_index;
+//! Where the records of the binary replay end, -1 if there is no index
+static int64_t      replay_records_end = -1;
+//! Frame to rewind the replay at once (0 if none), the game state snapshots are kept at the seek points until then
+static int64_t      replay_rewind_at = 0;
+
 
-static void write_header()
+/*-----------------------------------------------------------------------*
+ *                        Binary primitives                              *
+ *-----------------------------------------------------------------------*/
+
+// unsigned LEB128
+static void bin_put_uint(FILE *f, uint64_t v)
 {
-    // write all necessary state variables!
-    fprintf(record_file, "Header\r\n");
-    fprintf(record_file, "RecordVersion %d\r\n", c_recordVersion); // Version of record file
-    fprintf(record_file, "Version %s\r\n", LONG_VERSION); // game version / commit
-    fprintf(record_file, "CompatLevel %d\r\n", CompatGetLevel()); // compatibility mode
+    do
+    {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        if(v)
+            b |= 0x80;
+        fputc(b, f);
+    } while(v);
+}
+
+static uint64_t bin_get_uint(FILE *f)
+{
+    uint64_t v = 0;
+
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        int b = fgetc(f);
+        if(b == EOF)
+            return 0;
+
+        v |= uint64_t(b & 0x7F) << shift;
+
+        if(!(b & 0x80))
+            break;
+    }
+
+    return v;
+}
+
+// zig-zag encoded to keep the small negative values short
+static void bin_put_int(FILE *f, int64_t v)
+{
+    bin_put_uint(f, (uint64_t(v) << 1) ^ uint64_t(v >> 63));
+}
+
+static int64_t bin_get_int(FILE *f)
+{
+    uint64_t u = bin_get_uint(f);
+    return int64_t(u >> 1) ^ -int64_t(u & 1);
+}
+
+static void bin_put_u64le(FILE *f, uint64_t u)
+{
+    for(int i = 0; i < 8; i++)
+        fputc((u >> (i * 8)) & 0xFF, f);
+}
+
+static uint64_t bin_get_u64le(FILE *f)
+{
+    uint64_t u = 0;
+
+    for(int i = 0; i < 8; i++)
+    {
+        int b = fgetc(f);
+        if(b == EOF)
+            return 0;
+        u |= uint64_t(b) << (i * 8);
+    }
+
+    return u;
+}
+
+// bit-exact, unlike the text format
+static void bin_put_double(FILE *f, double d)
+{
+    uint64_t u;
+    SDL_memcpy(&u, &d, sizeof(u));
+    bin_put_u64le(f, u);
+}
+
+static double bin_get_double(FILE *f)
+{
+    uint64_t u = bin_get_u64le(f);
+    double d;
+    SDL_memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+static void bin_put_string(FILE *f, const std::string &s)
+{
+    bin_put_uint(f, s.size());
+    fwrite(s.data(), 1, s.size(), f);
+}
+
+static std::string bin_get_string(FILE *f)
+{
+    uint64_t len = bin_get_uint(f);
+    if(len > 4096)
+        return std::string();
+
+    std::string s(len, '\0');
+    if(len && fread(&s[0], 1, len, f) != len)
+        return std::string();
+
+    return s;
+}
+
+static bool check_binary_magic(FILE *f)
+{
+    char magic[4];
+    rewind(f);
+    bool ret = fread(magic, 1, 4, f) == 4 && !SDL_memcmp(magic, c_binaryMagic, 4);
+    if(!ret)
+        rewind(f);
+    return ret;
+}
+
+static uint16_t controls_to_mask(const Controls_t &keys)
+{
+    uint16_t mask = 0;
+
+    for(int k = 0; k < c_controlKeysCount; k++)
+    {
+        if(keys.*c_controlKeys[k])
+            mask |= (1 << k);
+    }
+
+    return mask;
+}
+
+static Controls_t controls_from_mask(uint16_t mask)
+{
+    Controls_t keys;
+
+    for(int k = 0; k < c_controlKeysCount; k++)
+        keys.*c_controlKeys[k] = (mask & (1 << k));
+
+    return keys;
+}
+
+//! Put the frame and the type of the next binary record
+static void bin_begin_record(RecordOut_t &out, int64_t frame, char type)
+{
+    bin_put_uint(out.f, uint64_t(frame - out.lastFrame));
+    fputc(type, out.f);
+    out.lastFrame = frame;
+}
+
+
+/*-----------------------------------------------------------------------*
+ *                              Header                                   *
+ *-----------------------------------------------------------------------*/
+
+static void capture_header(Header_t &h)
+{
+    h.recordVersion = c_recordVersion;
+    h.version = LONG_VERSION;
+    h.compatLevel = CompatGetLevel();
+
     if(FullFileName.compare(0, AppPath.size(), AppPath) == 0)
-        fprintf(record_file, "%s\r\n", FullFileName.c_str()+AppPath.size()); // level that was played
+        h.levelPath = FullFileName.substr(AppPath.size());
     else
-        fprintf(record_file, "%s\r\n", FullFileName.c_str()); // level that was played
+        h.levelPath = FullFileName;
 
-    std::string md5sum = md5::file_to_hashGC(FullFileName);
-    fprintf(record_file, "SumMD5 %s\r\n", md5sum.c_str()); // level that was played
-    fprintf(record_file, "Seed %d\r\n", readSeed());
-    fprintf(record_file, "Checkpoint %d\r\n", (Checkpoint == FullFileName) ? 1 : 0);
+    h.md5 = md5::file_to_hashGC(FullFileName);
+    h.seed = readSeed();
+    h.checkpoint = (Checkpoint == FullFileName);
+    h.hasMultipoints = g_compatibility.enable_multipoints && h.checkpoint;
+    h.multipoints.clear();
 
-    if(g_compatibility.enable_multipoints && Checkpoint == FullFileName)
+    if(h.hasMultipoints)
     {
-        fprintf(record_file, "Multipoints %d: ", (int)CheckpointsList.size());
-
         for(const Checkpoint_t& cp : CheckpointsList)
-            fprintf(record_file, "%d,", cp.id);
-
-        fprintf(record_file, "\r\n");
+            h.multipoints.push_back(cp.id);
     }
 
-    fprintf(record_file, "StartWarp %d\r\n", StartWarp);
-    fprintf(record_file, "ReturnWarp %d\r\n", ReturnWarp);
-    fprintf(record_file, "Lives %d\r\n", (int)Lives);
-    fprintf(record_file, "Coins %d\r\n", Coins);
-    fprintf(record_file, "Score %d\r\n", Score);
-    fprintf(record_file, "Stars %d\r\n", numStars);
+    h.startWarp = StartWarp;
+    h.returnWarp = ReturnWarp;
+    h.lives = (int)Lives;
+    h.coins = Coins;
+    h.score = Score;
 
+    h.stars.resize(numStars);
     for(int A = 1; A <= numStars; A++)
     {
-        fprintf(record_file, "Star\r\n");
-        fprintf(record_file, "%s\r\n", Star[A].level.c_str());
-        fprintf(record_file, "Section %d\r\n", Star[A].Section);
+        h.stars[A - 1].level = Star[A].level;
+        h.stars[A - 1].section = Star[A].Section;
     }
 
-    fprintf(record_file, "Players %d\r\n", numPlayers);
-
+    h.players.resize(numPlayers);
     for(int A = 1; A <= numPlayers; A++)
     {
-        fprintf(record_file,
+        HeaderPlayer_t &p = h.players[A - 1];
+        p.character = Player[A].Character;
+        p.state = Player[A].State;
+        p.mountType = Player[A].MountType;
+        p.heldBonus = Player[A].HeldBonus;
+    }
+}
+
+static void write_header(RecordOut_t &out, const Header_t &h)
+{
+    FILE *f = out.f;
+
+    if(out.binary)
+    {
+        fwrite(c_binaryMagic, 1, 4, f);
+        bin_put_uint(f, h.recordVersion);
+        bin_put_string(f, h.version);
+        bin_put_int(f, h.compatLevel);
+        bin_put_string(f, h.levelPath);
+        bin_put_string(f, h.md5);
+        bin_put_int(f, h.seed);
+        fputc(h.checkpoint ? 1 : 0, f);
+        fputc(h.hasMultipoints ? 1 : 0, f);
+
+        if(h.hasMultipoints)
+        {
+            bin_put_uint(f, h.multipoints.size());
+            for(int id : h.multipoints)
+                bin_put_int(f, id);
+        }
+
+        bin_put_int(f, h.startWarp);
+        bin_put_int(f, h.returnWarp);
+        bin_put_int(f, h.lives);
+        bin_put_int(f, h.coins);
+        bin_put_int(f, h.score);
+
+        bin_put_uint(f, h.stars.size());
+        for(const HeaderStar_t &s : h.stars)
+        {
+            bin_put_string(f, s.level);
+            bin_put_int(f, s.section);
+        }
+
+        bin_put_uint(f, h.players.size());
+        for(const HeaderPlayer_t &p : h.players)
+        {
+            bin_put_int(f, p.character);
+            bin_put_int(f, p.state);
+            bin_put_int(f, p.mountType);
+            bin_put_int(f, p.heldBonus);
+        }
+
+        out.lastFrame = 0;
+        return;
+    }
+
+    // write all necessary state variables!
+    fprintf(f, "Header\r\n");
+    fprintf(f, "RecordVersion %d\r\n", h.recordVersion); // Version of record file
+    fprintf(f, "Version %s\r\n", h.version.c_str()); // game version / commit
+    fprintf(f, "CompatLevel %d\r\n", h.compatLevel); // compatibility mode
+    fprintf(f, "%s\r\n", h.levelPath.c_str()); // level that was played
+    fprintf(f, "SumMD5 %s\r\n", h.md5.c_str()); // level that was played
+    fprintf(f, "Seed %d\r\n", h.seed);
+    fprintf(f, "Checkpoint %d\r\n", h.checkpoint ? 1 : 0);
+
+    if(h.hasMultipoints)
+    {
+        fprintf(f, "Multipoints %d: ", (int)h.multipoints.size());
+
+        for(int id : h.multipoints)
+            fprintf(f, "%d,", id);
+
+        fprintf(f, "\r\n");
+    }
+
+    fprintf(f, "StartWarp %d\r\n", h.startWarp);
+    fprintf(f, "ReturnWarp %d\r\n", h.returnWarp);
+    fprintf(f, "Lives %d\r\n", h.lives);
+    fprintf(f, "Coins %d\r\n", h.coins);
+    fprintf(f, "Score %d\r\n", h.score);
+    fprintf(f, "Stars %d\r\n", (int)h.stars.size());
+
+    for(const HeaderStar_t &s : h.stars)
+    {
+        fprintf(f, "Star\r\n");
+        fprintf(f, "%s\r\n", s.level.c_str());
+        fprintf(f, "Section %d\r\n", s.section);
+    }
+
+    fprintf(f, "Players %d\r\n", (int)h.players.size());
+
+    for(const HeaderPlayer_t &p : h.players)
+    {
+        fprintf(f,
                 "Player\r\n"
                 "Char %d\r\n"
                 "State %d\r\n"
                 "MountType %d\r\n"
                 "HeldBonus %d\r\n",
-                Player[A].Character, Player[A].State, Player[A].MountType, Player[A].HeldBonus);
+                p.character, p.state, p.mountType, p.heldBonus);
     }
 }
 
-// FIXME: Implement the error returning and on-failure abortation with leading abortation of record replaying startup
-
-static void read_header()
+static bool read_header_bin(FILE *f, Header_t &h)
 {
-    rewind(replay_file); // fseek(replay_file, 0, SEEK_SET);
+    h.recordVersion = (int)bin_get_uint(f);
+    h.version = bin_get_string(f);
+    h.compatLevel = (int)bin_get_int(f);
+    h.levelPath = bin_get_string(f);
+    h.md5 = bin_get_string(f);
+    h.seed = (int)bin_get_int(f);
+    h.checkpoint = fgetc(f) == 1;
+    h.hasMultipoints = fgetc(f) == 1;
+    h.multipoints.clear();
+
+    if(h.hasMultipoints)
+    {
+        uint64_t n = bin_get_uint(f);
+        for(uint64_t i = 0; i < n && !feof(f); i++)
+            h.multipoints.push_back((int)bin_get_int(f));
+    }
+
+    h.startWarp = (int)bin_get_int(f);
+    h.returnWarp = (int)bin_get_int(f);
+    h.lives = (int)bin_get_int(f);
+    h.coins = (int)bin_get_int(f);
+    h.score = (int)bin_get_int(f);
 
+    uint64_t stars = bin_get_uint(f);
+    h.stars.clear();
+    for(uint64_t i = 0; i < stars && !feof(f); i++)
+    {
+        HeaderStar_t s;
+        s.level = bin_get_string(f);
+        s.section = (int)bin_get_int(f);
+        h.stars.push_back(s);
+    }
+
+    uint64_t players = bin_get_uint(f);
+    h.players.clear();
+    for(uint64_t i = 0; i < players && i < (uint64_t)maxPlayers && !feof(f); i++)
+    {
+        HeaderPlayer_t p;
+        p.character = (int)bin_get_int(f);
+        p.state = (int)bin_get_int(f);
+        p.mountType = (int)bin_get_int(f);
+        p.heldBonus = (int)bin_get_int(f);
+        h.players.push_back(p);
+    }
+
+    return !feof(f) && !ferror(f);
+}
+
+// the compatibility level is applied while reading because it decides whether the multipoints are present
+static void read_header_text(FILE *f, Header_t &h)
+{
     // buffer is a 1024-character buffer used for reading strings, shared with the record_init() function.
     char buffer[1024];
     char md5hash[1024];
-    std::string thisHash;
 
     // n is an integer for some implicit conversions
-    int n;
-    // Version of record file
-    int recordVersion = 0;
+    int n = 0;
 
     // read all necessary state variables!
-    fgets(buffer, 1024, replay_file); // "Header"
-    fscanf(replay_file, "RecordVersion %d\r\n", &recordVersion);
+    fgets(buffer, 1024, f); // "Header"
+    fscanf(f, "RecordVersion %d\r\n", &h.recordVersion);
 
-    if(recordVersion < 2)
-        pLogCritical("Record file is invalid! (version below than minimally supported: %d)", recordVersion);
+    fgets(buffer, 1024, f); // game version / commit
+    clipNewLine(buffer, 1024);
+    h.version = buffer;
 
-    fgets(buffer, 1024, replay_file); // game version / commit
-    fscanf(replay_file, "CompatLevel %d\r\n", &n); // compatibility mode
+    fscanf(f, "CompatLevel %d\r\n", &h.compatLevel); // compatibility mode
+    CompatSetEnforcedLevel(h.compatLevel);
 
-    CompatSetEnforcedLevel(n);
+    fgets(buffer, 1024, f); // level that was played
+    clipNewLine(buffer, 1024); // clip the newline :(
+    h.levelPath = buffer;
 
-    if(CompatGetLevel() < COMPAT_SMBX2)
-        pLogWarning("compatibility mode is not a long-term support version. Do not expect identical results.");
+    SDL_memset(md5hash, 0, sizeof(md5hash));
+    fscanf(f, "SumMD5 %s\r\n", md5hash); // File's hash
+    h.md5 = md5hash;
 
-    fgets(buffer, 1024, replay_file); // level that was played
+    fscanf(f, "Seed %d\r\n", &h.seed); // random seed
 
-    clipNewLine(buffer, 1024); // clip the newline :(
+    fscanf(f, "Checkpoint %d\r\n", &n); // is there a checkpoint?
+    h.checkpoint = (n != 0);
+
+    h.hasMultipoints = g_compatibility.enable_multipoints && h.checkpoint;
+    h.multipoints.clear();
+
+    if(h.hasMultipoints)
+    {
+        fscanf(f, "Multipoints %d: ", &n);
+        h.multipoints.resize(n);
+
+        for(int i = 0; i < n; i++)
+            fscanf(f, "%d,", &h.multipoints[i]);
+
+        fscanf(f, "\r\n");
+    }
+
+    fscanf(f, "StartWarp %d\r\n", &h.startWarp);
+    fscanf(f, "ReturnWarp %d\r\n", &h.returnWarp);
+    fscanf(f, "Lives %d\r\n", &h.lives);
+    fscanf(f, "Coins %d\r\n", &h.coins);
+    fscanf(f, "Score %d\r\n", &h.score);
+
+    n = 0;
+    fscanf(f, "Stars %d\r\n", &n);
+    h.stars.resize(n);
+
+    for(HeaderStar_t &s : h.stars)
+    {
+        fgets(buffer, 1024, f); // "Star"
+        fgets(buffer, 1024, f); // level
+        clipNewLine(buffer, 1024); // clip the newline :(
+        s.level = buffer;
+        fscanf(f, "Section %d\r\n", &s.section);
+    }
+
+    n = 0;
+    fscanf(f, "Players %d\r\n", &n);
+    if(n > maxPlayers)
+        n = maxPlayers;
+    h.players.resize(n);
+
+    for(HeaderPlayer_t &p : h.players)
+    {
+        fscanf(f,
+               "Player\r\n"
+               "Char %d\r\n"
+               "State %d\r\n"
+               "MountType %d\r\n"
+               "HeldBonus %d\r\n",
+            &p.character, &p.state, &p.mountType, &p.heldBonus);
+    }
+}
+
+static void apply_header(const Header_t &h)
+{
+    if(h.recordVersion < 2)
+        pLogCritical("Record file is invalid! (version below than minimally supported: %d)", h.recordVersion);
+
+    CompatSetEnforcedLevel(h.compatLevel);
+
+    if(CompatGetLevel() < COMPAT_SMBX2)
+        pLogWarning("compatibility mode is not a long-term support version. Do not expect identical results.");
 
     // now SET the filename
-    FullFileName = replayLevelFilePath.empty() ? buffer : replayLevelFilePath;
+    FullFileName = replayLevelFilePath.empty() ? h.levelPath : replayLevelFilePath;
     // if(SDL_strcasecmp(buffer, FilefNameFull.c_str()))
     //     pLogWarning("FileName does not match.");
 
     pLogDebug("Attempt to load level file %s for the replay", FullFileName.c_str());
 
-    thisHash = md5::file_to_hashGC(FullFileName);
+    std::string thisHash = md5::file_to_hashGC(FullFileName);
     if(thisHash.empty())
         pLogCritical("Failed to retrieve the MD5 hash for %s file (probably, it doesn't exist)", FullFileName.c_str());
 
-    SDL_memset(md5hash, 0, sizeof(md5hash));
-    fscanf(replay_file, "SumMD5 %s\r\n", md5hash); // File's hash
-    pLogDebug("Replay file (loaded %s, expected %s)", thisHash.c_str(), md5hash);
-    int hashCmp = thisHash.compare(md5hash);
+    pLogDebug("Replay file (loaded %s, expected %s)", thisHash.c_str(), h.md5.c_str());
+    int hashCmp = thisHash.compare(h.md5);
     if(hashCmp != 0)
         pLogCritical("Loaded level file is not matched to expected (check sum missmatch %d)", hashCmp);
 
-    fscanf(replay_file, "Seed %d\r\n", &n); // random seed
-    seedRandom(n);
+    seedRandom(h.seed);
 
-    fscanf(replay_file, "Checkpoint %d\r\n", &n); // is there a checkpoint?
+    Checkpoint = h.checkpoint ? FullFileName : std::string();
 
-    Checkpoint = n ? FullFileName : std::string();
-
-    if(g_compatibility.enable_multipoints && Checkpoint == FullFileName)
+    if(h.hasMultipoints)
     {
         CheckpointsList.clear();
-        fscanf(replay_file, "Multipoints %d: ", &n);
-        CheckpointsList.resize(n);
+        CheckpointsList.resize(h.multipoints.size());
 
-        for(int i = 0; i < n; i++)
-            fscanf(replay_file, "%d,", &CheckpointsList[i].id);
-
-        fscanf(replay_file, "\r\n");
+        for(size_t i = 0; i < h.multipoints.size(); i++)
+            CheckpointsList[i].id = h.multipoints[i];
     }
 
-    fscanf(replay_file, "StartWarp %d\r\n", &StartWarp);
-    fscanf(replay_file, "ReturnWarp %d\r\n", &ReturnWarp);
-    fscanf(replay_file, "Lives %d\r\n", &n);
-    Lives = n;
-    fscanf(replay_file, "Coins %d\r\n", &Coins);
-    fscanf(replay_file, "Score %d\r\n", &Score);
-    fscanf(replay_file, "Stars %d\r\n", &numStars);
+    StartWarp = h.startWarp;
+    ReturnWarp = h.returnWarp;
+    Lives = h.lives;
+    Coins = h.coins;
+    Score = h.score;
+    numStars = (int)h.stars.size();
 
     for(int A = 1; A <= numStars; A++)
     {
-        fgets(buffer, 1024, replay_file); // "Star"
-        fgets(buffer, 1024, replay_file); // level
-
-        for(int i = 0; i < 1024; i++)
-            if(buffer[i] == '\r') buffer[i] = '\0'; // clip the newline :(
-
-        Star[A].level = buffer;
-        fscanf(replay_file, "Section %d\r\n", &Star[A].Section);
+        Star[A].level = h.stars[A - 1].level;
+        Star[A].Section = h.stars[A - 1].section;
     }
 
-    fscanf(replay_file, "Players %d\r\n", &numPlayers);
+    numPlayers = (int)h.players.size();
 
     for(int A = 1; A <= numPlayers; A++)
     {
-        fscanf(replay_file,
-               "Player\r\n"
-               "Char %d\r\n"
-               "State %d\r\n"
-               "MountType %d\r\n"
-               "HeldBonus %d\r\n",
-            &Player[A].Character, &Player[A].State, &Player[A].MountType, &Player[A].HeldBonus);
+        const HeaderPlayer_t &p = h.players[A - 1];
+        Player[A].Character = p.character;
+        Player[A].State = p.state;
+        Player[A].MountType = p.mountType;
+        Player[A].HeldBonus = p.heldBonus;
     }
 
     Cheater = true; // important to avoid losing player save data in replay mode.
@@ -292,16 +743,58 @@ static void read_header()
     FrameSkip = false;
 }
 
-static void write_end()
+// FIXME: Implement the error returning and on-failure abortation with leading abortation of record replaying startup
+
+static void read_header()
 {
-    fprintf(record_file, " %" PRId64 " \r\nEnd\r\nLevelBeatCode %d\r\n", frame_no+1, LevelBeatCode);
+    Header_t h;
+
+    replay_binary = check_binary_magic(replay_file);
+
+    if(replay_binary)
+    {
+        if(!read_header_bin(replay_file, h))
+            pLogCritical("Record file is invalid! (damaged binary header)");
+    }
+    else
+        read_header_text(replay_file, h);
+
+    apply_header(h);
+}
+
+
+/*-----------------------------------------------------------------------*
+ *                              Records                                  *
+ *-----------------------------------------------------------------------*/
+
+static void write_end(RecordOut_t &out, int64_t frame, int levelBeatCode)
+{
+    if(out.binary)
+    {
+        bin_begin_record(out, frame, 'E');
+        bin_put_int(out.f, levelBeatCode);
+        return;
+    }
+
+    fprintf(out.f, " %" PRId64 " \r\nEnd\r\nLevelBeatCode %d\r\n", frame, levelBeatCode);
 }
 
 static void read_end()
 {
-    int b;
+    int b = 0;
+
+    if(replay_binary)
+    {
+        if(fgetc(replay_file) == 'E')
+            b = (int)bin_get_int(replay_file);
 
-    if(fscanf(replay_file, "End\r\nLevelBeatCode %d\r\n", &b) != 1)
+        if(feof(replay_file))
+        {
+            pLogWarning("old gameplay file diverged (invalid end header).");
+            diverged_major = true;
+        }
+    }
+    else if(fscanf(replay_file, "End\r\nLevelBeatCode %d\r\n", &b) != 1)
     {
         pLogWarning("old gameplay file diverged (invalid end header).");
         diverged_major = true;
@@ -320,172 +813,283 @@ static void read_end()
     }
 }
 
-static void write_control()
+//! Verdict of the replayed run, code is the ReplayStatus
+static void write_verdict(RecordOut_t &out, ReplayStatus status)
 {
-    for(int i = 0; i < numPlayers; i++)
+    if(out.binary)
     {
-        const Controls_t& keys = Player[i+1].Controls;
+        bin_begin_record(out, out.lastFrame, 'V');
+        fputc((int)status, out.f);
+        return;
+    }
 
-        if(!last_controls[i].Up && keys.Up)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dU\r\n", frame_no, i+1);
-        else if(last_controls[i].Up && !keys.Up)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dU\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Down && keys.Down)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dD\r\n", frame_no, i+1);
-        else if(last_controls[i].Down && !keys.Down)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dD\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Left && keys.Left)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dL\r\n", frame_no, i+1);
-        else if(last_controls[i].Left && !keys.Left)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dL\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Right && keys.Right)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dR\r\n", frame_no, i+1);
-        else if(last_controls[i].Right && !keys.Right)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dR\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Start && keys.Start)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dS\r\n", frame_no, i+1);
-        else if(last_controls[i].Start && !keys.Start)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dS\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Drop && keys.Drop)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dI\r\n", frame_no, i+1);
-        else if(last_controls[i].Drop && !keys.Drop)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dI\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Jump && keys.Jump)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dA\r\n", frame_no, i+1);
-        else if(last_controls[i].Jump && !keys.Jump)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dA\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Run && keys.Run)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dB\r\n", frame_no, i+1);
-        else if(last_controls[i].Run && !keys.Run)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dB\r\n", frame_no, i+1);
-
-        if(!last_controls[i].AltJump && keys.AltJump)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dX\r\n", frame_no, i+1);
-        else if(last_controls[i].AltJump && !keys.AltJump)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dX\r\n", frame_no, i+1);
-
-        if(!last_controls[i].AltRun && keys.AltRun)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dY\r\n", frame_no, i+1);
-        else if(last_controls[i].AltRun && !keys.AltRun)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dY\r\n", frame_no, i+1);
+    if(status == ReplayStatus::Passed)
+        fprintf(out.f, "DID NOT diverge from old run.\r\n");
+    else if(status == ReplayStatus::DivergedMinor)
+        fprintf(out.f, "MINOR divergence from old run.\r\n");
+    else
+        fprintf(out.f, "DIVERGED from old run.\r\n");
+}
 
-        last_controls[i] = keys;
+static void write_index(RecordOut_t &out)
+{
+    int64_t index_offset = (int64_t)ftell(out.f);
+
+    bin_put_uint(out.f, out.index.size());
+
+    for(const SeekPoint_t &p : out.index)
+    {
+        bin_put_uint(out.f, p.frame);
+        bin_put_uint(out.f, p.prevFrame);
+        bin_put_uint(out.f, p.offset);
+        bin_put_uint(out.f, p.controls.size());
+
+        for(uint16_t c : p.controls)
+            bin_put_uint(out.f, c);
     }
 
-    fflush(record_file);
+    bin_put_u64le(out.f, (uint64_t)index_offset);
+    fwrite(c_indexMagic, 1, 4, out.f);
 }
 
-static void read_control()
+static void load_replay_index()
 {
-    int p;
-    char mode, key;
+    replay_index_loaded = true;
+    replay_index.clear();
+    replay_records_end = -1;
+
+    long pos = ftell(replay_file);
+    char magic[4];
 
-    if(fscanf(replay_file, "C%c%d%c\r\n", &mode, &p, &key) != 3)
+    if(fseek(replay_file, -12, SEEK_END) == 0)
+    {
+        int64_t index_offset = (int64_t)bin_get_u64le(replay_file);
+
+        if(fread(magic, 1, 4, replay_file) == 4 && !SDL_memcmp(magic, c_indexMagic, 4)
+           && fseek(replay_file, (long)index_offset, SEEK_SET) == 0)
+        {
+            replay_records_end = index_offset;
+
+            uint64_t count = bin_get_uint(replay_file);
+            for(uint64_t i = 0; i < count && !feof(replay_file); i++)
+            {
+                SeekPoint_t p;
+                p.frame = (int64_t)bin_get_uint(replay_file);
+                p.prevFrame = (int64_t)bin_get_uint(replay_file);
+                p.offset = (int64_t)bin_get_uint(replay_file);
+                p.controls.resize(bin_get_uint(replay_file) % (maxPlayers + 1));
+
+                for(uint16_t &c : p.controls)
+                    c = (uint16_t)bin_get_uint(replay_file);
+
+                replay_index.push_back(std::move(p));
+            }
+
+            if(feof(replay_file))
+                replay_index.clear();
+        }
+    }
+
+    clearerr(replay_file);
+    fseek(replay_file, pos, SEEK_SET);
+}
+
+//! Finish and close the written recording
+static void close_record_out()
+{
+    if(record_out.binary)
+        write_index(record_out);
+
+    fclose(record_out.f);
+    record_out = RecordOut_t();
+}
+
+//! Write changes of the player's keys
+static void write_controls(RecordOut_t &out, int64_t frame, int p, const Controls_t &prev, const Controls_t &keys)
+{
+    uint16_t changed = controls_to_mask(prev) ^ controls_to_mask(keys);
+
+    if(!changed)
         return;
 
-    bool set = (mode != '-');
-
-    if(key == 'U')
-        last_controls[p-1].Up = set;
-    else if(key == 'D')
-        last_controls[p-1].Down = set;
-    else if(key == 'L')
-        last_controls[p-1].Left = set;
-    else if(key == 'R')
-        last_controls[p-1].Right = set;
-    else if(key == 'S')
-        last_controls[p-1].Start = set;
-    else if(key == 'I')
-        last_controls[p-1].Drop = set;
-    else if(key == 'A')
-        last_controls[p-1].Jump = set;
-    else if(key == 'B')
-        last_controls[p-1].Run = set;
-    else if(key == 'X')
-        last_controls[p-1].AltJump = set;
-    else if(key == 'Y')
-        last_controls[p-1].AltRun = set;
+    if(out.binary)
+    {
+        bin_begin_record(out, frame, 'C');
+        bin_put_uint(out.f, p);
+        bin_put_uint(out.f, changed);
+        return;
+    }
 
-    // replicate the controls changes in the new recording
-    if(record_file)
+    for(int k = 0; k < c_controlKeysCount; k++)
     {
-        fprintf(record_file, " %" PRId64 "\r\nC%c%d%c\r\n", frame_no, mode, p, key);
+        if(changed & (1 << k))
+            fprintf(out.f, " %" PRId64 "\r\nC%c%d%c\r\n", frame, (keys.*c_controlKeys[k]) ? '+' : '-', p, c_controlKeyNames[k]);
     }
 }
 
-static void write_status()
+static void write_control()
 {
-    if(frame_no == 0)
+    for(int i = 0; i < numPlayers; i++)
     {
-        g_stats.renderedNPCs = 0;
-        g_stats.renderedBlocks = 0;
-        g_stats.renderedSzBlocks = 0;
-        g_stats.renderedBGOs = 0;
+        const Controls_t& keys = Player[i+1].Controls;
+        write_controls(record_out, frame_no, i+1, last_controls[i], keys);
+        last_controls[i] = keys;
+    }
+
+    // the binary recording gets flushed with the status records
+    if(!record_out.binary)
+        fflush(record_file);
+}
+
+static void read_control()
+{
+    int p;
+    Controls_t keys;
+
+    if(replay_binary)
+    {
+        fgetc(replay_file); // 'C'
+        p = (int)bin_get_uint(replay_file);
+        uint16_t changed = (uint16_t)bin_get_uint(replay_file);
+
+        if(feof(replay_file) || p < 1 || p > maxPlayers)
+            return;
+
+        keys = controls_from_mask(controls_to_mask(last_controls[p-1]) ^ changed);
     }
+    else
+    {
+        char mode, key;
+
+        if(fscanf(replay_file, "C%c%d%c\r\n", &mode, &p, &key) != 3 || p < 1 || p > maxPlayers)
+            return;
+
+        keys = last_controls[p-1];
+
+        const char *k = SDL_strchr(c_controlKeyNames, key);
+        if(k && key)
+            keys.*c_controlKeys[k - c_controlKeyNames] = (mode != '-');
+    }
+
+    // replicate the controls changes in the new recording
+    if(record_file)
+        write_controls(record_out, frame_no, p, last_controls[p-1], keys);
+
+    last_controls[p-1] = keys;
+}
 
-    fprintf(record_file, " %" PRId64 " \r\nStatus\r\n", frame_no);
+static void capture_status(StatusRecord_t &st)
+{
     uint32_t status_tick = SDL_GetTicks();
-    fprintf(record_file, "Ticks %d\r\n", SDL_GetTicks() - last_status_tick);
+    st.ticks = status_tick - last_status_tick;
     last_status_tick = status_tick;
-    fprintf(record_file, "randCalls %ld\r\n", random_ncalls());
-    fprintf(record_file, "Score %d\r\n", Score);
-    fprintf(record_file, "numNPCs %d\r\n", numNPCs);
+    st.randCalls = random_ncalls();
+    st.score = Score;
+    st.numNPCs = numNPCs;
 
-    int numActiveNPCs = 0;
+    st.numActiveNPCs = 0;
     if(frame_no != 0)
     {
         for(int i = 1; i <= numNPCs; i++)
         {
             if(NPC[i].Active)
-                numActiveNPCs ++;
+                st.numActiveNPCs ++;
         }
     }
 
-    fprintf(record_file, "numActiveNPCs %d\r\n", numActiveNPCs);
-    fprintf(record_file, "numRenderNPCs %d\r\nnumRenderBlocks %d\r\nnumRenderBGOs %d\r\n",
-        g_stats.renderedNPCs, g_stats.renderedBlocks + g_stats.renderedSzBlocks, g_stats.renderedBGOs);
+    st.renderedNPCs = g_stats.renderedNPCs;
+    st.renderedBlocks = g_stats.renderedBlocks + g_stats.renderedSzBlocks;
+    st.renderedBGOs = g_stats.renderedBGOs;
 
+    st.numPlayers = numPlayers;
     for(int i = 1; i <= numPlayers; i++)
     {
-        fprintf(record_file, "p%dx %lf\r\np%dy %lf\r\n",
-            i, Player[i].Location.X, i, Player[i].Location.Y);
+        st.px[i-1] = Player[i].Location.X;
+        st.py[i-1] = Player[i].Location.Y;
     }
+}
+
+static void write_status(RecordOut_t &out, int64_t frame, const StatusRecord_t &st)
+{
+    FILE *f = out.f;
+
+    if(out.binary)
+    {
+        bin_begin_record(out, frame, 'S');
+        bin_put_int(f, st.ticks);
+        bin_put_int(f, st.randCalls);
+        bin_put_int(f, st.score);
+        bin_put_int(f, st.numNPCs);
+        bin_put_int(f, st.numActiveNPCs);
+        bin_put_int(f, st.renderedNPCs);
+        bin_put_int(f, st.renderedBlocks);
+        bin_put_int(f, st.renderedBGOs);
+
+        for(int i = 0; i < st.numPlayers; i++)
+        {
+            bin_put_double(f, st.px[i]);
+            bin_put_double(f, st.py[i]);
+        }
 
-    fflush(record_file);
+        return;
+    }
+
+    fprintf(f, " %" PRId64 " \r\nStatus\r\n", frame);
+    fprintf(f, "Ticks %d\r\n", st.ticks);
+    fprintf(f, "randCalls %ld\r\n", st.randCalls);
+    fprintf(f, "Score %d\r\n", st.score);
+    fprintf(f, "numNPCs %d\r\n", st.numNPCs);
+    fprintf(f, "numActiveNPCs %d\r\n", st.numActiveNPCs);
+    fprintf(f, "numRenderNPCs %d\r\nnumRenderBlocks %d\r\nnumRenderBGOs %d\r\n",
+        st.renderedNPCs, st.renderedBlocks, st.renderedBGOs);
+
+    for(int i = 1; i <= st.numPlayers; i++)
+    {
+        fprintf(f, "p%dx %lf\r\np%dy %lf\r\n",
+            i, st.px[i-1], i, st.py[i-1]);
+    }
 }
 
-static void read_status()
+static bool read_status_bin(FILE *f, int players, StatusRecord_t &st)
 {
-    if(frame_no == 0)
+    fgetc(f); // 'S'
+    st.ticks = (int)bin_get_int(f);
+    st.randCalls = (long)bin_get_int(f);
+    st.score = (int)bin_get_int(f);
+    st.numNPCs = (int)bin_get_int(f);
+    st.numActiveNPCs = (int)bin_get_int(f);
+    st.renderedNPCs = (int)bin_get_int(f);
+    st.renderedBlocks = (int)bin_get_int(f);
+    st.renderedBGOs = (int)bin_get_int(f);
+
+    st.numPlayers = 0;
+    for(int i = 0; i < players && i < maxPlayers; i++)
     {
-        g_stats.renderedNPCs = 0;
-        g_stats.renderedBlocks = 0;
-        g_stats.renderedSzBlocks = 0;
-        g_stats.renderedBGOs = 0;
+        st.px[i] = bin_get_double(f);
+        st.py[i] = bin_get_double(f);
+
+        if(feof(f))
+            break;
+
+        st.numPlayers++;
     }
 
-    int o_ticks, o_Score, o_numNPCs, o_numActiveNPCs, o_renderedNPCs, o_renderedBlocks, o_renderedBGOs;
-    long o_randCalls;
+    return !feof(f);
+}
 
+static bool read_status_text(FILE *f, int players, StatusRecord_t &st)
+{
     int success = 0;
 
-    fscanf(replay_file, "Status\r\n%n", &success);
+    fscanf(f, "Status\r\n%n", &success);
 
     if(!success)
     {
         pLogWarning("old gameplay file diverged (invalid status header) at frame %" PRId64 ".", frame_no);
-        diverged_major = true;
-        return;
+        return false;
     }
 
-    if(fscanf(replay_file,
+    if(fscanf(f,
               "Ticks %d\r\n"
               "randCalls %ld\r\n"
               "Score %d\r\n"
@@ -494,16 +1098,86 @@ static void read_status()
               "numRenderNPCs %d\r\n"
               "numRenderBlocks %d\r\n"
               "numRenderBGOs %d\r\n",
-        &o_ticks, &o_randCalls, &o_Score, &o_numNPCs, &o_numActiveNPCs, &o_renderedNPCs, &o_renderedBlocks, &o_renderedBGOs) != 8)
+        &st.ticks, &st.randCalls, &st.score, &st.numNPCs, &st.numActiveNPCs, &st.renderedNPCs, &st.renderedBlocks, &st.renderedBGOs) != 8)
     {
         pLogWarning("old gameplay file diverged (invalid status info) at frame %" PRId64 ".", frame_no);
+        return false;
+    }
+
+    st.numPlayers = 0;
+    for(int i = 0; i < players && i < maxPlayers; i++)
+    {
+        if(fscanf(f, "p%dx %lf\r\np%dy %lf\r\n", &success, &st.px[i], &success, &st.py[i]) != 4)
+            break;
+
+        st.numPlayers++;
+    }
+
+    return true;
+}
+
+static void check_status_players(const StatusRecord_t &st)
+{
+    for(int i = 1; i <= numPlayers; i++)
+    {
+        if(i > st.numPlayers)
+        {
+            pLogWarning("old gameplay file diverged (invalid player %d info) at frame %" PRId64 ".", i, frame_no);
+            diverged_major = true;
+            break;
+        }
+
+        double px = st.px[i-1], py = st.py[i-1];
+
+        // quite non-strict because in a true divergence situation, it will get continually worse
+        if(SDL_fabs(px - Player[i].Location.X) > 0.01 ||
+           SDL_fabs(py - Player[i].Location.Y) > 0.01)
+        {
+            pLogWarning("player %d position diverged (old x=%f new x=%f, old y=%f new y=%f) at frame %" PRId64 ".",
+                        i,
+                        px, Player[i].Location.X,
+                        py, Player[i].Location.Y, frame_no);
+            diverged_minor = true;
+            if(SDL_fabs(px - Player[i].Location.X) > 1 ||
+               SDL_fabs(py - Player[i].Location.Y) > 1)
+            {
+                pLogWarning("  this is a major divergence.");
+                diverged_major = true;
+            }
+        }
+    }
+}
+
+static void read_status()
+{
+    if(frame_no == 0)
+    {
+        g_stats.renderedNPCs = 0;
+        g_stats.renderedBlocks = 0;
+        g_stats.renderedSzBlocks = 0;
+        g_stats.renderedBGOs = 0;
+    }
+
+    StatusRecord_t st;
+
+    if(replay_binary)
+    {
+        if(!read_status_bin(replay_file, numPlayers, st))
+        {
+            pLogWarning("old gameplay file diverged (invalid status info) at frame %" PRId64 ".", frame_no);
+            diverged_major = true;
+            return;
+        }
+    }
+    else if(!read_status_text(replay_file, numPlayers, st))
+    {
         diverged_major = true;
         return;
     }
 
-    if(o_randCalls != random_ncalls())
+    if(st.randCalls != random_ncalls())
     {
-        pLogWarning("randCalls diverged (old: %d, new: %ld) at frame %" PRId64 ".", o_randCalls, random_ncalls(), frame_no);
+        pLogWarning("randCalls diverged (old: %ld, new: %ld) at frame %" PRId64 ".", st.randCalls, random_ncalls(), frame_no);
         diverged_minor = true;
 #ifdef DEBUG_RANDOM_CALLS
         for(int i = 0; i < g_random_calls.size(); i++)
@@ -514,221 +1188,359 @@ static void read_status()
     g_random_calls.clear();
 #endif
 
-    if(o_Score != Score)
+    if(st.score != Score)
     {
-        pLogWarning("score diverged (old: %d, new: %d) at frame %" PRId64 ".", o_Score, Score, frame_no);
+        pLogWarning("score diverged (old: %d, new: %d) at frame %" PRId64 ".", st.score, Score, frame_no);
         diverged_major = true;
     }
 
-    if(o_numNPCs != numNPCs)
-    {
-        pLogWarning("numNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_numNPCs, numNPCs, frame_no);
-        diverged_major = true;
-    }
+    if(st.numNPCs != numNPCs)
+    {
+        pLogWarning("numNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", st.numNPCs, numNPCs, frame_no);
+        diverged_major = true;
+    }
+
+    int numActiveNPCs = 0;
+    if(frame_no != 0)
+    {
+        for(int i = 1; i <= numNPCs; i++)
+        {
+            if(NPC[i].Active)
+                numActiveNPCs ++;
+        }
+    }
+
+    if(st.numActiveNPCs != numActiveNPCs)
+    {
+        pLogWarning("numActiveNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", st.numActiveNPCs, numActiveNPCs, frame_no);
+        diverged_minor = true;
+    }
+
+    // nothing gets drawn in the headless mode
+    if(headlessMode)
+    {
+        check_status_players(st);
+        return;
+    }
+
+    if(st.renderedNPCs != g_stats.renderedNPCs)
+    {
+        pLogWarning("renderedNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", st.renderedNPCs, g_stats.renderedNPCs, frame_no);
+        diverged_minor = true;
+    }
+
+    if(st.renderedBlocks != g_stats.renderedBlocks + g_stats.renderedSzBlocks)
+    {
+        pLogWarning("renderedBlocks diverged (old: %d, new: %d) at frame %" PRId64 ".", st.renderedBlocks, g_stats.renderedBlocks + g_stats.renderedSzBlocks, frame_no);
+        diverged_minor = true;
+    }
+
+    if(st.renderedBGOs != g_stats.renderedBGOs)
+    {
+        pLogWarning("renderedBGOs diverged (old: %d, new: %d) at frame %" PRId64 ".", st.renderedBGOs, g_stats.renderedBGOs, frame_no);
+        diverged_minor = true;
+    }
+
+    check_status_players(st);
+}
+
+static void capture_NPCs(std::vector<NPCRecord_t> &npcs)
+{
+    npcs.resize(numNPCs);
+
+    for(int i = 1; i <= numNPCs; i++)
+    {
+        const NPC_t& n = NPC[i];
+        NPCRecord_t &r = npcs[i-1];
+        r.type = n.Type;
+        r.active = n.Active;
+        r.direction = n.Direction;
+        r.x = n.Location.X;
+        r.y = n.Location.Y;
+        r.w = n.Location.Width;
+        r.h = n.Location.Height;
+        r.special[0] = n.Special;
+        r.special[1] = n.Special2;
+        r.special[2] = n.Special3;
+        r.special[3] = n.Special4;
+        r.special[4] = n.Special5;
+        r.special[5] = n.Special6;
+        r.special[6] = n.Special7;
+    }
+}
+
+static void write_NPCs(RecordOut_t &out, int64_t frame, const std::vector<NPCRecord_t> &npcs)
+{
+    FILE *f = out.f;
+
+    if(out.binary)
+    {
+        bin_begin_record(out, frame, 'N');
+        bin_put_uint(f, npcs.size());
+
+        for(const NPCRecord_t &n : npcs)
+        {
+            // the direction is almost always -1, 0 or +1, the specials are mostly zero
+            uint8_t flags = n.active ? 1 : 0;
+
+            if(n.direction == -1.0)
+                flags |= 2;
+            else if(n.direction == 1.0)
+                flags |= 4;
+            else if(n.direction != 0.0)
+                flags |= 8;
+
+            uint8_t specials = 0;
+            for(int s = 0; s < 7; s++)
+            {
+                if(n.special[s] != 0.0)
+                    specials |= (1 << s);
+            }
+
+            bin_put_int(f, n.type);
+            fputc(flags, f);
+            if(flags & 8)
+                bin_put_double(f, n.direction);
+
+            bin_put_double(f, n.x);
+            bin_put_double(f, n.y);
+            bin_put_double(f, n.w);
+            bin_put_double(f, n.h);
+
+            fputc(specials, f);
+            for(int s = 0; s < 7; s++)
+            {
+                if(specials & (1 << s))
+                    bin_put_double(f, n.special[s]);
+            }
+        }
+
+        return;
+    }
+
+    fprintf(f, " %" PRId64 " \r\nNPCs\r\nnumNPCs %d\r\n", frame, (int)npcs.size());
+    for(size_t i = 0; i < npcs.size(); i++)
+    {
+        const NPCRecord_t& n = npcs[i];
+        fprintf(f, "NPC %d\r\n", (int)i + 1);
+        fprintf(f, "Type %d\r\n", n.type);
+        fprintf(f, "Active %d\r\n", n.active);
+        fprintf(f, "Dir %lf\r\n", n.direction);
+        fprintf(f, "XYWH %lf %lf %lf %lf\r\n", n.x, n.y, n.w, n.h);
+        fprintf(f, "S %lf %lf %lf %lf %lf %lf %lf\r\n",
+                n.special[0], n.special[1], n.special[2], n.special[3], n.special[4], n.special[5], n.special[6]);
+    }
+}
+
+static bool read_NPCs_bin(FILE *f, std::vector<NPCRecord_t> &npcs)
+{
+    fgetc(f); // 'N'
+
+    uint64_t count = bin_get_uint(f);
+    if(count > (uint64_t)maxNPCs)
+        return false;
+
+    npcs.resize(count);
+
+    for(NPCRecord_t &n : npcs)
+    {
+        n.type = (int)bin_get_int(f);
+
+        int flags = fgetc(f);
+        n.active = (flags & 1);
+
+        if(flags & 8)
+            n.direction = bin_get_double(f);
+        else if(flags & 2)
+            n.direction = -1.0;
+        else if(flags & 4)
+            n.direction = 1.0;
+        else
+            n.direction = 0.0;
+
+        n.x = bin_get_double(f);
+        n.y = bin_get_double(f);
+        n.w = bin_get_double(f);
+        n.h = bin_get_double(f);
+
+        int specials = fgetc(f);
+        for(int s = 0; s < 7; s++)
+            n.special[s] = (specials & (1 << s)) ? bin_get_double(f) : 0.0;
+
+        if(feof(f))
+            return false;
+    }
+
+    return true;
+}
+
+static bool read_NPCs_text(FILE *f, std::vector<NPCRecord_t> &npcs)
+{
+    int success = 0;
+
+    fscanf(f, "NPCs\r\n%n", &success);
+
+    int o_numNPCs = 0;
 
-    int numActiveNPCs = 0;
-    if(frame_no != 0)
+    if(!success || fscanf(f, "numNPCs %d\r\n", &o_numNPCs) != 1 || o_numNPCs < 0 || o_numNPCs > maxNPCs)
     {
-        for(int i = 1; i <= numNPCs; i++)
-        {
-            if(NPC[i].Active)
-                numActiveNPCs ++;
-        }
+        pLogWarning("old gameplay file diverged (invalid NPC header) at frame %" PRId64 ".", frame_no);
+        return false;
     }
 
-    if(o_numActiveNPCs != numActiveNPCs)
-    {
-        pLogWarning("numActiveNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_numActiveNPCs, numActiveNPCs, frame_no);
-        diverged_minor = true;
-    }
+    npcs.resize(o_numNPCs);
 
-    if(o_renderedNPCs != g_stats.renderedNPCs)
+    for(int i = 1; i <= o_numNPCs; i++)
     {
-        pLogWarning("renderedNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedNPCs, g_stats.renderedNPCs, frame_no);
-        diverged_minor = true;
-    }
+        NPCRecord_t &r = npcs[i-1];
+        int N, A;
+        double *S = r.special;
+        bool invalid = false;
+
+        invalid |= (fscanf(f,
+                           "NPC %d\r\n"
+                           "Type %d\r\n"
+                           "Active %d\r\n",
+                           &N, &r.type, &A) != 3);
+        invalid |= fscanf(f,
+                          "Dir %lf\r\n"
+                          "XYWH %lf %lf %lf %lf\r\n"
+                          "S %lf %lf %lf %lf %lf %lf",
+                          &r.direction, &r.x, &r.y, &r.w, &r.h, &S[0], &S[1], &S[2], &S[3], &S[4], &S[5]) != 11;
+
+        if(invalid)
+        {
+            pLogWarning("old gameplay file diverged (invalid NPC %d data) at frame %" PRId64 ".", i, frame_no);
+            diverged_major = true;
 
-    if(o_renderedBlocks != g_stats.renderedBlocks + g_stats.renderedSzBlocks)
-    {
-        pLogWarning("renderedBlocks diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedNPCs, g_stats.renderedNPCs + g_stats.renderedSzBlocks, frame_no);
-        diverged_minor = true;
-    }
+            for(int j = i; j <= o_numNPCs; j++)
+                npcs[j-1].invalid = true;
 
-    if(o_renderedBGOs != g_stats.renderedBGOs)
-    {
-        pLogWarning("renderedBGOs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedBGOs, g_stats.renderedBGOs, frame_no);
-        diverged_minor = true;
-    }
+            return true;
+        }
 
-    for(int i = 1; i <= numPlayers; i++)
-    {
-        double px, py;
+        r.active = A;
 
-        if(fscanf(replay_file, "p%dx %lf\r\np%dy %lf\r\n", &success, &px, &success, &py) != 4)
+        // either '\r' (no S7) or ' ' (S7)
+        if(fgetc(f) == ' ')
         {
-            pLogWarning("old gameplay file diverged (invalid player %d info) at frame %" PRId64 ".", i, frame_no);
-            diverged_major = true;
-            break;
+            fscanf(f, "%lf\r\n", &S[6]);
+        }
+        else
+        {
+            S[6] = 0;
+            fgetc(f); // '\n'
         }
 
-        // quite non-strict because in a true divergence situation, it will get continually worse
-        if(SDL_fabs(px - Player[i].Location.X) > 0.01 ||
-           SDL_fabs(py - Player[i].Location.Y) > 0.01)
+        if(N != i)
         {
-            pLogWarning("player %d position diverged (old x=%f new x=%f, old y=%f new y=%f) at frame %" PRId64 ".",
-                        i,
-                        px, Player[i].Location.X,
-                        py, Player[i].Location.Y, frame_no);
-            diverged_minor = true;
-            if(SDL_fabs(px - Player[i].Location.X) > 1 ||
-               SDL_fabs(py - Player[i].Location.Y) > 1)
-            {
-                pLogWarning("  this is a major divergence.");
-                diverged_major = true;
-            }
+            pLogWarning("old gameplay file diverged (NPC %d index listed as %d) at frame %" PRId64 ".", i, N, frame_no);
+            diverged_major = true;
+            r.invalid = true;
         }
     }
-}
 
-static void write_NPCs()
-{
-    fprintf(record_file, " %" PRId64 " \r\nNPCs\r\nnumNPCs %d\r\n", frame_no, numNPCs);
-    for(int i = 1; i <= numNPCs; i++)
-    {
-        const NPC_t& n = NPC[i];
-        fprintf(record_file, "NPC %d\r\n", i);
-        fprintf(record_file, "Type %d\r\n", n.Type);
-        fprintf(record_file, "Active %d\r\n", n.Active);
-        fprintf(record_file, "Dir %lf\r\n", n.Direction);
-        fprintf(record_file, "XYWH %lf %lf %lf %lf\r\n", n.Location.X, n.Location.Y, n.Location.Width, n.Location.Height);
-        fprintf(record_file, "S %lf %lf %lf %lf %lf %lf %lf\r\n", n.Special, n.Special2, n.Special3, n.Special4, n.Special5, n.Special6, n.Special7);
-    }
+    return true;
 }
 
 static void read_NPCs()
 {
-    int success = 0;
-
-    fscanf(replay_file, "NPCs\r\n%n", &success);
+    std::vector<NPCRecord_t> npcs;
 
-    // will only possibly be used in the cases where it is initialized by fscanf
-    int o_numNPCs;
-
-    if(!success || fscanf(replay_file, "numNPCs %d\r\n", &o_numNPCs) != 1)
-        success = 0;
-    else if(o_numNPCs != numNPCs)
+    if(replay_binary)
+    {
+        if(!read_NPCs_bin(replay_file, npcs))
+        {
+            pLogWarning("old gameplay file diverged (invalid NPC header) at frame %" PRId64 ".", frame_no);
+            diverged_major = true;
+            return;
+        }
+    }
+    else if(!read_NPCs_text(replay_file, npcs))
     {
-        pLogWarning("numNPCs diverged (old %d, new %d) at frame %" PRId64 ".", o_numNPCs, numNPCs, frame_no);
         diverged_major = true;
+        return;
     }
 
-    if(success)
+    if((int)npcs.size() != numNPCs)
     {
-        for(int i = 1; i <= o_numNPCs; i++)
-        {
-            int N, T, A;
-            double D, X, Y, W, H, S1, S2, S3, S4, S5, S6, S7;
-            bool invalid = false;
-
-            invalid |= (fscanf(replay_file,
-                               "NPC %d\r\n"
-                               "Type %d\r\n"
-                               "Active %d\r\n",
-                               &N, &T, &A) != 3);
-            invalid |= fscanf(replay_file,
-                              "Dir %lf\r\n"
-                              "XYWH %lf %lf %lf %lf\r\n"
-                              "S %lf %lf %lf %lf %lf %lf",
-                              &D, &X, &Y, &W, &H, &S1, &S2, &S3, &S4, &S5, &S6) != 11;
-
-            if(invalid)
-            {
-                pLogWarning("old gameplay file diverged (invalid NPC %d data) at frame %" PRId64 ".", i, frame_no);
-                diverged_major = true;
-                return;
-            }
+        pLogWarning("numNPCs diverged (old %d, new %d) at frame %" PRId64 ".", (int)npcs.size(), numNPCs, frame_no);
+        diverged_major = true;
+    }
 
-            // either '\r' (no S7) or ' ' (S7)
-            if(fgetc(replay_file) == ' ')
-            {
-                fscanf(replay_file, "%lf\r\n", &S7);
-            }
-            else
-            {
-                S7 = 0;
-                fgetc(replay_file); // '\n'
-            }
+    for(int i = 1; i <= (int)npcs.size() && i <= numNPCs; i++)
+    {
+        const NPCRecord_t &o = npcs[i-1];
+        const NPC_t& n = NPC[i];
 
-            if(N != i)
-            {
-                pLogWarning("old gameplay file diverged (NPC %d index listed as %d) at frame %" PRId64 ".", i, N, frame_no);
-                diverged_major = true;
-                continue;
-            }
+        if(o.invalid)
+            continue;
 
-            if(i > numNPCs)
-                continue;
+        if(o.type != n.Type)
+        {
+            pLogWarning("NPC[%d].Type diverged (old %d, new %d) at frame %" PRId64 ".", i, o.type, n.Type, frame_no);
+            diverged_major = true;
+        }
 
-            const NPC_t& n = NPC[i];
+        if(o.active != n.Active)
+        {
+            pLogWarning("NPC[%d].Active diverged (old %d, new %d; type %d) at frame %" PRId64 ".", i, o.active, n.Active, n.Type, frame_no);
+            diverged_minor = true;
+        }
 
-            if(T != n.Type)
-            {
-                pLogWarning("NPC[%d].Type diverged (old %d, new %d) at frame %" PRId64 ".", i, T, n.Type, frame_no);
-                diverged_major = true;
-            }
+        if(!fEqual((float)o.direction, n.Direction))
+        {
+            pLogWarning("NPC[%d].Direction diverged (old %f, new %f; type %d) at frame %" PRId64 ".", i, o.direction, n.Direction, n.Type, frame_no);
+            diverged_minor = true;
+        }
 
-            if((bool)A != n.Active)
-            {
-                pLogWarning("NPC[%d].Active diverged (old %d, new %d; type %d) at frame %" PRId64 ".", i, A, n.Active, n.Type, frame_no);
-                diverged_minor = true;
-            }
+        if(SDL_fabs(o.x - n.Location.X) > 0.01 ||
+           SDL_fabs(o.y - n.Location.Y) > 0.01 ||
+           SDL_fabs(o.w - n.Location.Width) > 0.01 ||
+           SDL_fabs(o.h - n.Location.Height) > 0.01)
+        {
+            pLogWarning("NPC[%d].Location diverged (old %lf %lf %lf %lf, new %lf %lf %lf %lf; type %d) at frame %" PRId64 ".", i,
+                o.x, o.y, o.w, o.h, n.Location.X, n.Location.Y, n.Location.Width, n.Location.Height, n.Type, frame_no);
+            diverged_minor = true;
+        }
 
-            if(!fEqual((float)D, n.Direction))
-            {
-                pLogWarning("NPC[%d].Direction diverged (old %f, new %f; type %d) at frame %" PRId64 ".", i, D, n.Direction, n.Type, frame_no);
-                diverged_minor = true;
-            }
+        double sNew[] = {n.Special, n.Special2, n.Special3, n.Special4, n.Special5, n.Special6, n.Special7};
 
-            if(SDL_fabs(X - n.Location.X) > 0.01 ||
-               SDL_fabs(Y - n.Location.Y) > 0.01 ||
-               SDL_fabs(W - n.Location.Width) > 0.01 ||
-               SDL_fabs(H - n.Location.Height) > 0.01)
+        for(int s = 0; s < 7; ++s)
+        {
+            if(!fEqual(o.special[s], sNew[s]))
             {
-                pLogWarning("NPC[%d].Location diverged (old %lf %lf %lf %lf, new %lf %lf %lf %lf; type %d) at frame %" PRId64 ".", i,
-                    X, Y, W, H, n.Location.X, n.Location.Y, n.Location.Width, n.Location.Height, n.Type, frame_no);
+                pLogWarning("NPC[%d].Special%d diverged (old %f => new %f; type %d) at frame %" PRId64 ".",
+                            i, s + 1, o.special[s], sNew[s], n.Type, frame_no);
                 diverged_minor = true;
             }
-
-            double sOld[] = {S1, S2, S3, S4, S5, S6, S7};
-            double sNew[] = {n.Special, n.Special2, n.Special3, n.Special4, n.Special5, n.Special6, n.Special7};
-
-            for(int s = 0; s < 7; ++s)
-            {
-                if(!fEqual(sOld[s], sNew[s]))
-                {
-                    pLogWarning("NPC[%d].Special%d diverged (old %f => new %f; type %d) at frame %" PRId64 ".",
-                                i, s + 1, sOld[s], sNew[s], n.Type, frame_no);
-                    diverged_minor = true;
-                }
-            }
-
-//            if(S1 != n.Special || S2 != n.Special2 || S3 != n.Special3 || S4 != n.Special4 || S5 != n.Special5 || S6 != n.Special6 || S7 != n.Special7)
-//            {
-//                pLogWarning("NPC[%d].Special* diverged (old %f %f %f %f %f %f %f, new %f %f %f %f %f %f %f; type %d) at frame %" PRId64 ".", i,
-//                    S1, S2, S3, S4, S5, S6, S7, n.Special, n.Special2, n.Special3, n.Special4, n.Special5, n.Special6, n.Special7, n.Type, frame_no);
-//                diverged_minor = true;
-//            }
         }
     }
+}
 
-    if(!success)
+//! Read the frame of the next replayed record
+static bool read_next_frame()
+{
+    if(feof(replay_file))
+        return false;
+
+    if(replay_binary)
     {
-        pLogWarning("old gameplay file diverged (invalid NPC header) at frame %" PRId64 ".", frame_no);
-        diverged_major = true;
-        return;
+        if(replay_records_end >= 0 && (int64_t)ftell(replay_file) >= replay_records_end)
+            return false;
+
+        next_record_frame += (int64_t)bin_get_uint(replay_file);
+        return !feof(replay_file);
     }
+
+    return fscanf(replay_file, "%" PRId64 "\r\n", &next_record_frame) == 1;
 }
 
+
+/*-----------------------------------------------------------------------*
+ *                           Public API                                  *
+ *-----------------------------------------------------------------------*/
+
 void InitRecording()
 {
     if(LevelEditor || GameMenu || GameOutro)
@@ -738,10 +1550,13 @@ void InitRecording()
         return;
 
     in_level = true;
+    GameSnapshot::historyClear();
     diverged_major = false;
     diverged_minor = false;
     frame_no = 0;
     next_record_frame = -1;
+    first_diverged_frame = -1;
+    replay_start_counter = SDL_GetPerformanceCounter();
     last_status_tick = SDL_GetTicks();
     g_stats.renderedNPCs = 0;
     g_stats.renderedBlocks = 0;
@@ -749,8 +1564,14 @@ void InitRecording()
 
     std::string filename = makeRecordPrefix();
 
-    if(!record_file)
+    // the headless replay only validates the run, don't spend the time for writing a new one
+    if(!record_file && !headlessMode)
+    {
         record_file = Files::utf8_fopen(filename.c_str(), "wb");
+        record_out = RecordOut_t();
+        record_out.f = record_file;
+        record_out.binary = (g_config.RecordGameplayFormat == Config_t::RECORD_FORMAT_BINARY);
+    }
 
     // start of gameplay data
     seedRandom(iRand(32767));
@@ -758,7 +1579,14 @@ void InitRecording()
     if(replay_file)
     {
         read_header();
-        if(!fscanf(replay_file, "%" PRId64 "\r\n", &next_record_frame))
+
+        if(replay_binary)
+        {
+            load_replay_index();
+            next_record_frame = 0;
+        }
+
+        if(!read_next_frame())
         {
             pLogWarning("Replayed recording file has prematurely ended.");
             diverged_major = true;
@@ -767,7 +1595,11 @@ void InitRecording()
     }
 
     if(record_file)
-        write_header();
+    {
+        Header_t h;
+        capture_header(h);
+        write_header(record_out, h);
+    }
 
     for(int i = 0; i < numPlayers; i++)
         last_controls[i] = Controls_t();
@@ -785,11 +1617,257 @@ void LoadReplay(const std::string &recording_path, const std::string &level_path
     if(!replay_file)
     {
         replay_file = Files::utf8_fopen(recording_path.c_str(), "rb");
+        replay_index_loaded = false;
         if(replay_file)
             read_header();
     }
 }
 
+std::string ReplayLevelPath(const std::string &recording_path)
+{
+    FILE *f = Files::utf8_fopen(recording_path.c_str(), "rb");
+    if(!f)
+        return std::string();
+
+    std::string ret;
+
+    if(check_binary_magic(f))
+    {
+        bin_get_uint(f); // record version
+        bin_get_string(f); // game version
+        bin_get_int(f); // compatibility level
+        ret = bin_get_string(f);
+    }
+    else
+    {
+        // "Header", "RecordVersion", "Version", "CompatLevel", then the level path
+        char buffer[1024];
+        bool ok = true;
+
+        for(int i = 0; i < 5 && ok; i++)
+            ok = (fgets(buffer, sizeof(buffer), f) != nullptr);
+
+        if(ok)
+        {
+            clipNewLine(buffer, sizeof(buffer));
+            ret = buffer;
+        }
+    }
+
+    fclose(f);
+
+    return ret;
+}
+
+bool ExportReplayText(const std::string &recording_path, const std::string &text_path)
+{
+    FILE *in = Files::utf8_fopen(recording_path.c_str(), "rb");
+    if(!in)
+    {
+        pLogWarning("Can't open the recording %s", recording_path.c_str());
+        return false;
+    }
+
+    if(!check_binary_magic(in))
+    {
+        pLogWarning("The recording %s is not in the binary format", recording_path.c_str());
+        fclose(in);
+        return false;
+    }
+
+    Header_t h;
+    if(!read_header_bin(in, h))
+    {
+        pLogWarning("The recording %s has a damaged header", recording_path.c_str());
+        fclose(in);
+        return false;
+    }
+
+    // find where the records end
+    int64_t records_end = -1;
+    long start = ftell(in);
+    char magic[4];
+
+    if(fseek(in, -12, SEEK_END) == 0)
+    {
+        int64_t index_offset = (int64_t)bin_get_u64le(in);
+        if(fread(magic, 1, 4, in) == 4 && !SDL_memcmp(magic, c_indexMagic, 4))
+            records_end = index_offset;
+    }
+
+    clearerr(in);
+    fseek(in, start, SEEK_SET);
+
+    RecordOut_t out;
+    out.f = Files::utf8_fopen(text_path.c_str(), "wb");
+    if(!out.f)
+    {
+        pLogWarning("Can't write the text recording %s", text_path.c_str());
+        fclose(in);
+        return false;
+    }
+
+    write_header(out, h);
+
+    const int players = (int)h.players.size();
+    std::vector<Controls_t> controls(players);
+    std::vector<NPCRecord_t> npcs;
+    StatusRecord_t st;
+    int64_t frame = 0;
+    bool ok = true;
+
+    while(ok)
+    {
+        if(records_end >= 0 && (int64_t)ftell(in) >= records_end)
+            break;
+
+        frame += (int64_t)bin_get_uint(in);
+
+        int type = fgetc(in);
+        if(type == EOF)
+            break;
+
+        ungetc(type, in);
+
+        if(type == 'C')
+        {
+            fgetc(in);
+            int p = (int)bin_get_uint(in);
+            uint16_t changed = (uint16_t)bin_get_uint(in);
+
+            if(p < 1 || p > players)
+            {
+                ok = false;
+                break;
+            }
+
+            Controls_t keys = controls_from_mask(controls_to_mask(controls[p-1]) ^ changed);
+            write_controls(out, frame, p, controls[p-1], keys);
+            controls[p-1] = keys;
+        }
+        else if(type == 'S')
+        {
+            ok = read_status_bin(in, players, st);
+            if(ok)
+                write_status(out, frame, st);
+        }
+        else if(type == 'N')
+        {
+            ok = read_NPCs_bin(in, npcs);
+            if(ok)
+                write_NPCs(out, frame, npcs);
+        }
+        else if(type == 'E')
+        {
+            fgetc(in);
+            write_end(out, frame, (int)bin_get_int(in));
+        }
+        else if(type == 'V')
+        {
+            fgetc(in);
+            write_verdict(out, (ReplayStatus)fgetc(in));
+            break;
+        }
+        else
+            ok = false;
+
+        if(feof(in))
+            ok = false;
+    }
+
+    fclose(out.f);
+    fclose(in);
+
+    if(!ok)
+        pLogWarning("The recording %s is damaged or incomplete, exported until frame %" PRId64, recording_path.c_str(), frame);
+
+    return true;
+}
+
+bool SeekReplay(int64_t frame)
+{
+    if(!replay_file || !replay_binary || record_file)
+        return false;
+
+    if(!replay_index_loaded)
+        load_replay_index();
+
+    // the last seek point at or before the frame
+    auto it = std::upper_bound(replay_index.begin(), replay_index.end(), frame,
+        [](int64_t f, const SeekPoint_t &p) { return f < p.frame; });
+
+    if(it == replay_index.begin())
+        return false;
+
+    const SeekPoint_t &p = *(it - 1);
+
+    clearerr(replay_file);
+    if(fseek(replay_file, (long)p.offset, SEEK_SET) != 0)
+        return false;
+
+    for(int i = 0; i < numPlayers; i++)
+        last_controls[i] = (i < (int)p.controls.size()) ? controls_from_mask(p.controls[i]) : Controls_t();
+
+    frame_no = p.frame;
+    next_record_frame = p.prevFrame;
+
+    return read_next_frame();
+}
+
+int64_t ReplayFrame()
+{
+    return frame_no;
+}
+
+void SetReplayRewindAt(int64_t frame)
+{
+    replay_rewind_at = frame > 0 ? frame : 0;
+
+    if(!replay_rewind_at)
+        GameSnapshot::historyClear();
+}
+
+bool RewindReplay(int64_t frame)
+{
+    if(!replay_file || !replay_binary || record_file)
+        return false;
+
+    const GameSnapshot_t *snapshot = GameSnapshot::historyFind(frame);
+    if(!snapshot)
+        return false;
+
+    int64_t target = GameSnapshot::frame(*snapshot);
+
+    if(!SeekReplay(target) || frame_no != target)
+        return false;
+
+    GameSnapshot::historyRewind(target);
+
+    return true;
+}
+
+ReplayStatus LastReplayStatus()
+{
+    return last_replay_status;
+}
+
+static void print_replay_summary()
+{
+    double seconds = double(SDL_GetPerformanceCounter() - replay_start_counter) / double(SDL_GetPerformanceFrequency());
+    const char *status = "passed";
+
+    if(last_replay_status == ReplayStatus::DivergedMajor)
+        status = "diverged";
+    else if(last_replay_status == ReplayStatus::DivergedMinor)
+        status = "diverged-minor";
+
+    // single line, parsed by the batch replay runner
+    printf("REPLAY-SUMMARY status=%s frames=%" PRId64 " first-divergence=%" PRId64 " time=%.3f fps=%.1f\n",
+           status, frame_no, first_diverged_frame, seconds,
+           seconds > 0.0 ? double(frame_no) / seconds : 0.0);
+    fflush(stdout);
+}
+
 void EndRecording()
 {
     if(!record_file && !replay_file)
@@ -798,45 +1876,56 @@ void EndRecording()
     in_level = false;
 
     if(record_file)
-        write_end();
+        write_end(record_out, frame_no+1, LevelBeatCode);
 
     if(replay_file)
     {
         read_end();
 
+        if((diverged_minor || diverged_major) && first_diverged_frame < 0)
+            first_diverged_frame = frame_no;
+
+        if(!diverged_minor)
+            last_replay_status = ReplayStatus::Passed;
+        else if(!diverged_major)
+            last_replay_status = ReplayStatus::DivergedMinor;
+        else
+            last_replay_status = ReplayStatus::DivergedMajor;
+
+        if(headlessMode)
+            print_replay_summary();
+
         if(!diverged_minor)
         {
             pLogDebug("CONGRATULATIONS! Your build's run did not diverge from the old run.");
             printf("CONGRATULATIONS! Your build's run did not diverge from the old run.\n");
-
-            if(record_file)
-                fprintf(record_file, "DID NOT diverge from old run.\r\n");
         }
         else if(!diverged_major)
         {
             pLogDebug("Your build's run only had MINOR divergence from the old run.");
             printf("Your build's run only had MINOR divergence from the old run.\n");
-
-            if(record_file)
-                fprintf(record_file, "MINOR divergence from old run.\r\n");
         }
         else
         {
             pLogWarning("I'm sorry, but your build's run DIVERGED from the old run.");
             printf("I'm sorry, but your build's run DIVERGED from the old run.\n");
-            if(record_file)
-                fprintf(record_file, "DIVERGED from old run.\r\n");
         }
 
+        if(record_file)
+            write_verdict(record_out, last_replay_status);
+
         fclose(replay_file);
         replay_file = nullptr;
+        replay_index.clear();
+        replay_index_loaded = false;
+        GameSnapshot::historyClear();
 
         GameIsActive = false;
     }
 
     if(record_file)
     {
-        fclose(record_file);
+        close_record_out();
         record_file = nullptr;
     }
 }
@@ -848,6 +1937,24 @@ void Sync()
 
     if(replay_file)
     {
+        // the state at the seek points allows to rewind the replay without re-simulating it from the start
+        if(replay_rewind_at > 0 && replay_binary && !record_file && !(frame_no % c_seekInterval))
+            GameSnapshot::historyPush(frame_no);
+
+        if(replay_rewind_at > 0 && frame_no == replay_rewind_at)
+        {
+            int64_t from = frame_no;
+            replay_rewind_at = 0;
+
+            // the rest of the replay gets compared again from the restored state
+            if(RewindReplay(from - 1))
+                pLogDebug("Replay: rewound from frame %" PRId64 " to frame %" PRId64, from, frame_no);
+            else
+                pLogWarning("Replay: failed to rewind at frame %" PRId64 ", the recording is not binary or has no seek index", from);
+
+            GameSnapshot::historyClear();
+        }
+
         while(next_record_frame == frame_no && replay_file)
         {
             int type = fgetc(replay_file);
@@ -869,7 +1976,7 @@ void Sync()
                 return;
             }
 
-            if(feof(replay_file) || fscanf(replay_file, "%" PRId64 "\r\n", &next_record_frame) != 1)
+            if(!read_next_frame())
             {
                 pLogWarning("Replayed recording file has prematurely ended.");
                 diverged_major = true;
@@ -878,19 +1985,52 @@ void Sync()
             }
         }
 
+        if((diverged_minor || diverged_major) && first_diverged_frame < 0)
+            first_diverged_frame = frame_no;
+
         for(int i = 0; i < numPlayers; i++)
             Player[i+1].Controls = last_controls[i];
     }
 
     if(record_file)
     {
+        if(record_out.binary && !(frame_no % c_seekInterval))
+        {
+            SeekPoint_t p;
+            p.frame = frame_no;
+            p.prevFrame = record_out.lastFrame;
+            p.offset = (int64_t)ftell(record_file);
+
+            for(int i = 0; i < numPlayers; i++)
+                p.controls.push_back(controls_to_mask(last_controls[i]));
+
+            record_out.index.push_back(std::move(p));
+        }
+
         write_control();
 
         if(!(frame_no % 60))
-            write_status();
+        {
+            if(frame_no == 0)
+            {
+                g_stats.renderedNPCs = 0;
+                g_stats.renderedBlocks = 0;
+                g_stats.renderedSzBlocks = 0;
+                g_stats.renderedBGOs = 0;
+            }
+
+            StatusRecord_t st;
+            capture_status(st);
+            write_status(record_out, frame_no, st);
+            fflush(record_file);
+        }
 
         if(!(frame_no % 900))
-            write_NPCs();
+        {
+            std::vector<NPCRecord_t> npcs;
+            capture_NPCs(npcs);
+            write_NPCs(record_out, frame_no, npcs);
+        }
     }
 
     frame_no++;
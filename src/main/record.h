@@ -26,6 +26,8 @@
 #define RECORD_H
 
 #include <string>
+#include <cstdint>
+#include <cstdio>
 
 namespace Record
 {
@@ -34,8 +36,70 @@ namespace Record
 extern FILE* record_file;
 extern FILE* replay_file;
 
+//! Outcome of the last replayed recording
+enum class ReplayStatus
+{
+    None = 0,
+    Passed,
+    DivergedMinor,
+    DivergedMajor
+};
+
 void LoadReplay(const std::string &recording_path, const std::string &level_path);
 
+/*!
+ * \brief Get the outcome of the last finished replay
+ * \return Result of the comparison between the replayed and the original run
+ */
+ReplayStatus LastReplayStatus();
+
+/*!
+ * \brief Get the path of the level played at the recording
+ * \param recording_path Path to the text or binary recording
+ * \return Level path as stored at the header, empty string on failure
+ */
+std::string ReplayLevelPath(const std::string &recording_path);
+
+/*!
+ * \brief Convert the binary recording into the text one
+ * \param recording_path Path to the binary recording
+ * \param text_path Path to write the text recording into
+ * \return true if the text recording has been written
+ */
+bool ExportReplayText(const std::string &recording_path, const std::string &text_path);
+
+/*!
+ * \brief Move the replayed binary recording to the nearest seek point at or before the frame
+ * \param frame Wanted frame number
+ * \return true on success, false for text recordings, recordings without the index, and when the replay is re-recorded
+ *
+ * Only the recording itself gets repositioned, the caller has to restore the game state
+ * of the reached frame (its number is returned by ReplayFrame()) before the next Sync().
+ */
+bool SeekReplay(int64_t frame);
+
+/*!
+ * \brief Rewind the replay once when it reaches the frame, to check that the restored game state replays the same
+ * \param frame Frame to rewind at, the replay continues from the nearest seek point before it, 0 to never rewind
+ *
+ * The game state snapshots are taken at the seek points only while the rewind is pending,
+ * off by default (the validation runs don't need them)
+ */
+void SetReplayRewindAt(int64_t frame);
+
+/*!
+ * \brief Rewind the replayed binary recording together with the game state
+ * \param frame Wanted frame number
+ * \return true on success, false if there is no snapshot at or before the frame (see SetReplayRewindAt())
+ *
+ * The game state is restored from the snapshots taken at the seek points while replaying,
+ * the replay continues from the nearest one at or before the frame (see ReplayFrame()).
+ */
+bool RewindReplay(int64_t frame);
+
+//! Number of the frame to be processed by the next Sync()
+int64_t ReplayFrame();
+
 void InitRecording();
 
 void Sync();
@@ -0,0 +1,382 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <SDL2/SDL_stdinc.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_timer.h>
+
+#include <cstdio>
+#include <cinttypes>
+#include <vector>
+#include <algorithm>
+
+#include <DirManager/dirman.h>
+#include <Utils/files.h>
+#include <fmt_format_ne.h>
+
+#include "replay_batch.h"
+#include "record.h"
+
+
+#ifdef _WIN32
+#   define popen _popen
+#   define pclose _pclose
+#   define NULL_DEVICE "NUL"
+#else
+#   include <sys/wait.h>
+#   define NULL_DEVICE "/dev/null"
+#endif
+
+
+namespace ReplayBatch
+{
+
+//! Result of a single replay process
+struct Run_t
+{
+    std::string status = "failed";
+    int64_t     frames = 0;
+    int64_t     firstDivergence = -1;
+    double      simTime = 0.0;
+    double      fps = 0.0;
+    int         exitCode = -1;
+
+    bool sameAs(const Run_t &o) const
+    {
+        return status == o.status && frames == o.frames && firstDivergence == o.firstDivergence;
+    }
+};
+
+struct Job_t
+{
+    std::string record;
+    std::string level;
+
+    // filled by the worker
+    Run_t       run;
+    //! Run with the compareArgs
+    Run_t       compared;
+    double      wallTime = 0.0;
+    //! The compared run has ended differently than the plain one
+    bool        comparedDiffers = false;
+};
+
+struct Pool_t
+{
+    const ReplayBatchSetup_t *setup = nullptr;
+    std::vector<Job_t> jobs;
+    //! Index of the next job to take, every idle worker takes the next one
+    SDL_atomic_t next;
+    SDL_atomic_t done;
+};
+
+
+static std::string quoteArg(const std::string &arg)
+{
+    std::string ret = "\"";
+
+    for(char c : arg)
+    {
+#ifndef _WIN32
+        if(c == '"' || c == '\\' || c == '$' || c == '`')
+            ret.push_back('\\');
+#endif
+        ret.push_back(c);
+    }
+
+    ret.push_back('"');
+    return ret;
+}
+
+static std::string jsonString(const std::string &str)
+{
+    std::string ret = "\"";
+
+    for(char c : str)
+    {
+        switch(c)
+        {
+        case '"':
+            ret += "\\\"";
+            break;
+        case '\\':
+            ret += "\\\\";
+            break;
+        case '\n':
+            ret += "\\n";
+            break;
+        case '\r':
+            ret += "\\r";
+            break;
+        case '\t':
+            ret += "\\t";
+            break;
+        default:
+            if((unsigned char)c < 0x20)
+                ret += fmt::sprintf_ne("\\u%04x", (int)c);
+            else
+                ret.push_back(c);
+            break;
+        }
+    }
+
+    ret.push_back('"');
+    return ret;
+}
+
+//! Take the level path from the recording header to find it at the levels directory
+static std::string findReplayLevel(const std::string &record, const std::string &levelsDir)
+{
+    if(levelsDir.empty())
+        return std::string();
+
+    std::string level = Record::ReplayLevelPath(record);
+    if(level.empty())
+        return std::string();
+
+    std::replace(level.begin(), level.end(), '\\', '/');
+    std::string candidate = levelsDir + "/" + Files::basename(level);
+
+    return Files::fileExists(candidate) ? candidate : std::string();
+}
+
+static void runReplay(const ReplayBatchSetup_t &setup, const Job_t &job, const std::string &extraArgs, Run_t &run)
+{
+    std::string cmd = quoteArg(setup.executable) + " --headless" + extraArgs;
+
+    if(!setup.assetsRoot.empty())
+        cmd += " --assets-root " + quoteArg(setup.assetsRoot);
+
+    if(!setup.userDirectory.empty())
+        cmd += " --user-directory " + quoteArg(setup.userDirectory);
+
+    cmd += " " + quoteArg(job.record);
+
+    if(!job.level.empty())
+        cmd += " " + quoteArg(job.level);
+
+    cmd += " 2>" NULL_DEVICE;
+
+#ifdef _WIN32
+    cmd = "\"" + cmd + "\""; // cmd.exe strips the outer quotes
+#endif
+
+    FILE *p = popen(cmd.c_str(), "r");
+    if(!p)
+        return;
+
+    char line[1024];
+    char status[64];
+
+    while(fgets(line, sizeof(line), p))
+    {
+        if(SDL_strncmp(line, "REPLAY-SUMMARY ", 15) != 0)
+            continue;
+
+        if(sscanf(line, "REPLAY-SUMMARY status=%63s frames=%" SCNd64 " first-divergence=%" SCNd64 " time=%lf fps=%lf",
+                  status, &run.frames, &run.firstDivergence, &run.simTime, &run.fps) == 5)
+        {
+            run.status = status;
+        }
+    }
+
+    run.exitCode = pclose(p);
+#ifndef _WIN32
+    if(run.exitCode != -1)
+        run.exitCode = WEXITSTATUS(run.exitCode);
+#endif
+}
+
+static void runJob(const ReplayBatchSetup_t &setup, Job_t &job)
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    runReplay(setup, job, std::string(), job.run);
+
+    // the compared options must never change the simulation, both runs must end the same
+    if(!setup.compareArgs.empty())
+    {
+        runReplay(setup, job, setup.compareArgs, job.compared);
+        job.comparedDiffers = !job.run.sameAs(job.compared);
+    }
+
+    job.wallTime = double(SDL_GetPerformanceCounter() - start) / double(SDL_GetPerformanceFrequency());
+}
+
+static int workerThread(void *self)
+{
+    Pool_t *pool = reinterpret_cast<Pool_t*>(self);
+    const int total = (int)pool->jobs.size();
+
+    do
+    {
+        int i = SDL_AtomicAdd(&pool->next, 1);
+        if(i >= total)
+            break;
+
+        Job_t &job = pool->jobs[i];
+        runJob(*pool->setup, job);
+
+        int done = SDL_AtomicAdd(&pool->done, 1) + 1;
+        fprintf(stderr, "[%d/%d] %s: %s%s (%.2f s)\n", done, total,
+                Files::basename(job.record).c_str(), job.run.status.c_str(),
+                job.comparedDiffers ? ", compared run differs" : "", job.wallTime);
+        fflush(stderr);
+    } while(true);
+
+    return 0;
+}
+
+static void writeSummary(FILE *out, const Pool_t &pool, int jobs, double wallTime)
+{
+    int passed = 0, diverged = 0, failed = 0, comparedDiffers = 0;
+
+    for(const Job_t &j : pool.jobs)
+    {
+        if(j.run.status == "passed")
+            passed++;
+        else if(j.run.status == "failed")
+            failed++;
+        else
+            diverged++;
+
+        if(j.comparedDiffers)
+            comparedDiffers++;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"jobs\": %d,\n", jobs);
+    fprintf(out, "  \"total\": %d,\n", (int)pool.jobs.size());
+    fprintf(out, "  \"passed\": %d,\n", passed);
+    fprintf(out, "  \"diverged\": %d,\n", diverged);
+    fprintf(out, "  \"failed\": %d,\n", failed);
+    if(!pool.setup->compareArgs.empty())
+        fprintf(out, "  \"compared_differs\": %d,\n", comparedDiffers);
+    fprintf(out, "  \"time\": %.3f,\n", wallTime);
+    fprintf(out, "  \"replays\": [");
+
+    for(size_t i = 0; i < pool.jobs.size(); i++)
+    {
+        const Job_t &j = pool.jobs[i];
+        fprintf(out, "%s\n    {\"file\": %s, \"level\": %s, \"status\": %s, "
+                     "\"frames\": %" PRId64 ", \"first_divergence\": %" PRId64 ", "
+                     "\"sim_time\": %.3f, \"fps\": %.1f, \"wall_time\": %.3f, \"exit_code\": %d",
+                i ? "," : "",
+                jsonString(j.record).c_str(), jsonString(j.level).c_str(), jsonString(j.run.status).c_str(),
+                j.run.frames, j.run.firstDivergence,
+                j.run.simTime, j.run.fps, j.wallTime, j.run.exitCode);
+
+        if(!pool.setup->compareArgs.empty())
+        {
+            fprintf(out, ", \"compared_status\": %s, \"compared_frames\": %" PRId64 ", \"compared_first_divergence\": %" PRId64 ", "
+                         "\"compared_differs\": %s",
+                    jsonString(j.compared.status).c_str(), j.compared.frames, j.compared.firstDivergence,
+                    j.comparedDiffers ? "true" : "false");
+        }
+
+        fprintf(out, "}");
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+}
+
+int run(const ReplayBatchSetup_t &setup)
+{
+    Pool_t pool;
+    pool.setup = &setup;
+    SDL_AtomicSet(&pool.next, 0);
+    SDL_AtomicSet(&pool.done, 0);
+
+    DirMan recDir(setup.recordsDir);
+    std::vector<std::string> files;
+
+    if(!recDir.exists() || !recDir.getListOfFiles(files, {".rec"}))
+    {
+        fprintf(stderr, "Error: Can't read the replays directory %s\n", setup.recordsDir.c_str());
+        return 2;
+    }
+
+    // stable order of the summary regardless of the file system
+    std::sort(files.begin(), files.end());
+
+    for(const std::string &f : files)
+    {
+        Job_t job;
+        job.record = recDir.absolutePath() + "/" + f;
+        job.level = findReplayLevel(job.record, setup.levelsDir);
+        pool.jobs.push_back(job);
+    }
+
+    int jobs = setup.jobs > 0 ? setup.jobs : SDL_GetCPUCount();
+    if(jobs < 1)
+        jobs = 1;
+    if(jobs > (int)pool.jobs.size())
+        jobs = (int)pool.jobs.size();
+
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    std::vector<SDL_Thread*> workers;
+
+    for(int i = 0; i < jobs; i++)
+    {
+        SDL_Thread *t = SDL_CreateThread(workerThread, "ReplayWorker", &pool);
+        if(t)
+            workers.push_back(t);
+    }
+
+    // run in this thread if no threads could be started
+    if(workers.empty() && !pool.jobs.empty())
+        workerThread(&pool);
+
+    for(SDL_Thread *t : workers)
+        SDL_WaitThread(t, nullptr);
+
+    double wallTime = double(SDL_GetPerformanceCounter() - start) / double(SDL_GetPerformanceFrequency());
+
+    FILE *out = stdout;
+    if(!setup.summaryPath.empty())
+    {
+        out = Files::utf8_fopen(setup.summaryPath.c_str(), "wb");
+        if(!out)
+        {
+            fprintf(stderr, "Error: Can't write the summary file %s\n", setup.summaryPath.c_str());
+            out = stdout;
+        }
+    }
+
+    writeSummary(out, pool, jobs, wallTime);
+
+    if(out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+
+    for(const Job_t &j : pool.jobs)
+    {
+        if(j.run.status != "passed" || j.comparedDiffers)
+            return 3;
+    }
+
+    return 0;
+}
+
+} // namespace ReplayBatch
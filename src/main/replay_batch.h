@@ -0,0 +1,62 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module validates a whole directory of gameplay recordings by running
+// every replay in its own headless game process, many of them at once
+
+#pragma once
+#ifndef REPLAY_BATCH_H
+#define REPLAY_BATCH_H
+
+#include <string>
+
+struct ReplayBatchSetup_t
+{
+    //! Path to the game executable to spawn for every replay
+    std::string executable;
+    //! Directory with *.rec files to validate
+    std::string recordsDir;
+    //! Optional directory to look up the replayed levels at (by the file name)
+    std::string levelsDir;
+    //! Custom assets root to pass into the spawned processes
+    std::string assetsRoot;
+    //! Custom user directory to pass into the spawned processes
+    std::string userDirectory;
+    //! Path to write the JSON summary into, standard output if empty
+    std::string summaryPath;
+    //! Count of replays to run simultaneously, 0 to use all CPU cores
+    int jobs = 0;
+    //! Arguments of the second run of every replay to compare with the first one, no second run if empty
+    std::string compareArgs;
+};
+
+namespace ReplayBatch
+{
+
+/*!
+ * \brief Run all replays of the given directory and write the summary
+ * \param setup Batch setup
+ * \return 0 if every replay passed, 3 if there were any divergences (or the compared runs did differ), 2 on failure to start
+ */
+int run(const ReplayBatchSetup_t &setup);
+
+} // namespace ReplayBatch
+
+#endif // REPLAY_BATCH_H
@@ -20,13 +20,21 @@
 
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include "trees.h"
 #include "layers.h"
+#include "config.h"
+#include "frame_timer.h"
 #include "QuadTree/LooseQuadtree.h"
+#include "block_grid.h"
 
 std::vector<void*> treeresult_vec[MAX_TREEQUERY_DEPTH] = {std::vector<void*>(400), std::vector<void*>(400), std::vector<void*>(50), std::vector<void*>(50)};
 ptrdiff_t cur_treeresult_vec = 0;
 
+std::vector<int> treenpc_result_vec[MAX_TREEQUERY_DEPTH] = {std::vector<int>(), std::vector<int>(), std::vector<int>(), std::vector<int>()};
+ptrdiff_t cur_treenpc_result_vec = 0;
+int treenpc_indexed = 0;
+
 template<class ItemT>
 class Tree_Extractor
 {
@@ -68,7 +76,15 @@ static std::unique_ptr<Tree_private<Scene_t>> s_worldSceneTree;
 static std::unique_ptr<Tree_private<WorldPath_t>> s_worldPathTree;
 static std::unique_ptr<Tree_private<WorldLevel_t>> s_worldLevelTree;
 static std::unique_ptr<Tree_private<WorldMusic_t>> s_worldMusicTree;
+#ifdef THEXTECH_BLOCK_FLAT_GRID
+//! All block layers at once, items are block indices
+static BlockGrid s_levelBlockGrid;
+static std::vector<int> s_gridResult;
+#else
 static std::unique_ptr<Tree_private<Block_t>> s_levelBlockTrees[maxLayers+2];
+//! The tree every block is currently listed at, -1 if none
+static RangeArrI<int, 0, maxBlocks, -1> s_levelBlockTreeOf;
+#endif
 
 template<class Q>
 void clearTree(Q &tree)
@@ -91,13 +107,21 @@ void treeWorldCleanAll()
 
 void treeLevelCleanBlockLayers()
 {
+#ifdef THEXTECH_BLOCK_FLAT_GRID
+    s_levelBlockGrid.clear();
+#else
     for(int i = 0; i < maxLayers+2; i++)
         clearTree(s_levelBlockTrees[i]);
+
+    for(int i = 0; i <= maxBlocks; i++)
+        s_levelBlockTreeOf[i] = -1;
+#endif
 }
 
 void treeLevelCleanAll()
 {
     treeLevelCleanBlockLayers();
+    treeNPCClear();
 }
 
 template<class Obj, class Arr>
@@ -369,11 +393,54 @@ TreeResult_Sentinel<WorldMusic_t> treeWorldMusicQuery(const Location_t &loc,
 
 /* ================= Level blocks ================= */
 
+#ifdef THEXTECH_BLOCK_FLAT_GRID
+
+void treeBlockAddLayer(int layer, Block_t *obj)
+{
+    if(layer < 0)
+        layer = maxLayers + 1;
+
+    const Location_t &loc = obj->LocationInLayer;
+    s_levelBlockGrid.insert((int)(obj - &Block[0]), layer, loc.X, loc.Y, loc.Width, loc.Height);
+}
+
+void treeBlockUpdateLayer(int layer, Block_t *obj)
+{
+    if(s_levelBlockGrid.contains((int)(obj - &Block[0])))
+        treeBlockAddLayer(layer, obj);
+}
+
+void treeBlockRemoveLayer(int /*layer*/, Block_t *obj)
+{
+    // the grid knows the layer of every block
+    s_levelBlockGrid.remove((int)(obj - &Block[0]));
+}
+
+void treeBlockSwapLayers(int layer_1, int layer_2)
+{
+    if(layer_1 < 0)
+        layer_1 = maxLayers + 1;
+    if(layer_2 < 0)
+        layer_2 = maxLayers + 1;
+
+    s_levelBlockGrid.swapLayers(layer_1, layer_2);
+}
+
+#else // THEXTECH_BLOCK_FLAT_GRID
+
 void treeBlockAddLayer(int layer, Block_t *obj)
 {
     if(layer < 0)
         layer = maxLayers + 1;
+
+    int &listed = s_levelBlockTreeOf[obj - &Block[0]];
+
+    // a block may only be at one tree, move it from the previous one
+    if(listed >= 0 && listed != layer)
+        treeRemove(s_levelBlockTrees[listed], obj);
+
     treeInsert(s_levelBlockTrees[layer], obj);
+    listed = layer;
 }
 
 void treeBlockUpdateLayer(int layer, Block_t *obj)
@@ -387,9 +454,37 @@ void treeBlockRemoveLayer(int layer, Block_t *obj)
 {
     if(layer < 0)
         layer = maxLayers + 1;
+
+    int &listed = s_levelBlockTreeOf[obj - &Block[0]];
+
+    // the block array is shuffled in place, so the block may be listed at another tree
+    if(listed >= 0 && listed != layer)
+        treeRemove(s_levelBlockTrees[listed], obj);
+
     treeRemove(s_levelBlockTrees[layer], obj);
+    listed = -1;
 }
 
+void treeBlockSwapLayers(int layer_1, int layer_2)
+{
+    if(layer_1 < 0)
+        layer_1 = maxLayers + 1;
+    if(layer_2 < 0)
+        layer_2 = maxLayers + 1;
+
+    std::swap(s_levelBlockTrees[layer_1], s_levelBlockTrees[layer_2]);
+
+    for(int i = 0; i <= maxBlocks; i++)
+    {
+        if(s_levelBlockTreeOf[i] == layer_1)
+            s_levelBlockTreeOf[i] = layer_2;
+        else if(s_levelBlockTreeOf[i] == layer_2)
+            s_levelBlockTreeOf[i] = layer_1;
+    }
+}
+
+#endif // THEXTECH_BLOCK_FLAT_GRID
+
 TreeResult_Sentinel<Block_t> treeBlockQuery(double Left, double Top, double Right, double Bottom,
                          int sort_mode,
                          double margin)
@@ -401,7 +496,7 @@ TreeResult_Sentinel<Block_t> treeBlockQuery(double Left, double Top, double Righ
         // skip empty layers except the tempBlock layer
         if(layer > numLayers && layer != maxLayers + 1)
         {
-            layer = maxLayers + 1;
+            layer = maxLayers; // the next one is the tempBlock layer
             continue;
         }
 
@@ -413,6 +508,22 @@ TreeResult_Sentinel<Block_t> treeBlockQuery(double Left, double Top, double Righ
             OffsetX = Layer[layer].OffsetX;
             OffsetY = Layer[layer].OffsetY;
         }
+#ifdef THEXTECH_BLOCK_FLAT_GRID
+        // finds the same blocks as the quadtree, but in another order, only the sorted results are identical
+        if(s_levelBlockGrid.layerSize(layer) == 0)
+            continue;
+
+        s_gridResult.clear();
+        s_levelBlockGrid.query(layer,
+                               Left - OffsetX - margin - s_gridSize,
+                               Top - OffsetY - margin - s_gridSize,
+                               Right - OffsetX + margin + s_gridSize,
+                               Bottom - OffsetY + margin + s_gridSize,
+                               s_gridResult);
+
+        for(int i : s_gridResult)
+            result.i_vec->push_back(&Block[i]);
+#else
         std::unique_ptr<Tree_private<Block_t>>& p = s_levelBlockTrees[layer];
         if(!p.get())
             continue;
@@ -428,6 +539,7 @@ TreeResult_Sentinel<Block_t> treeBlockQuery(double Left, double Top, double Righ
                 result.i_vec->push_back(item);
             q.Next();
         }
+#endif
     }
 
     if(sort_mode == SORTMODE_LOC)
@@ -470,6 +582,248 @@ TreeResult_Sentinel<Block_t> treeBlockQuery(const Location_t &loc,
                    loc.Y + loc.Height, sort_mode, margin);
 }
 
+TreeResult_Sentinel<Block_t> treeBlockQueryPhys(const Location_t &loc, int sort_mode)
+{
+    if(!g_config.PhysicsUseBlockTrees)
+    {
+        TreeResult_Sentinel<Block_t> result;
+
+        int64_t fBlock, lBlock;
+        blockTileGet(loc, fBlock, lBlock);
+
+        for(int64_t B = fBlock; B <= lBlock; B++)
+            result.i_vec->push_back(&Block[B]);
+
+        g_stats.physScannedBlocks += (int)result.i_vec->size();
+
+        return result;
+    }
+
+    // the margin keeps the one-column slack of the legacy blockTileGet() ranges
+    TreeResult_Sentinel<Block_t> result = treeBlockQuery(loc, sort_mode, 32.0);
+
+    // tree entries of indices above the numBlock are stale, and the blocks added since
+    // the last FindBlocks() were out of every FirstBlock/LastBlock range (the widest one is the last column)
+    Block_t *last = &Block[SDL_min((int64_t)numBlock, (int64_t)LastBlock[FLBlocks])];
+    auto &vec = *result.i_vec;
+    vec.erase(std::remove_if(vec.begin(), vec.end(),
+        [last](void *b) {
+            return (Block_t*)b > last;
+        }), vec.end());
+
+    g_stats.physScannedBlocks += (int)vec.size();
+
+    return result;
+}
+
+/* ================= Level NPCs ================= */
+// a uniform grid hashed into a fixed count of buckets, NPCs are moving
+// every frame, so it's cheaper to re-bucket them than to rebalance a tree
+
+static const double s_npcCellSize = 64.0;
+static const int    s_npcBucketsBits = 12;
+static const int    s_npcBuckets = 1 << s_npcBucketsBits;
+//! NPCs spanning more cells than this are kept at the separate list that is always returned
+static const int    s_npcMaxCells = 8;
+
+struct NPCHashEntry_t
+{
+    bool listed = false;
+    bool large = false;
+    int x1 = 0;
+    int y1 = 0;
+    int x2 = 0;
+    int y2 = 0;
+};
+
+static std::vector<int> s_npcBucket[s_npcBuckets];
+static std::vector<int> s_npcLarge;
+static NPCHashEntry_t s_npcEntry[maxNPCs + 1];
+//! Return every indexed NPC from the queries (the reference to compare the hash results with)
+static bool s_npcLinearScan = false;
+
+static inline int s_npcCell(double c)
+{
+    return (int)std::floor(c / s_npcCellSize);
+}
+
+static inline std::vector<int> &s_npcBucketAt(int x, int y)
+{
+    return s_npcBucket[(unsigned(x) * 73856093u ^ unsigned(y) * 19349663u) & (s_npcBuckets - 1)];
+}
+
+static void s_npcErase(std::vector<int> &vec, int A)
+{
+    auto i = std::find(vec.begin(), vec.end(), A);
+    if(i != vec.end())
+    {
+        *i = vec.back();
+        vec.pop_back();
+    }
+}
+
+static void s_npcUnlist(int A)
+{
+    NPCHashEntry_t &e = s_npcEntry[A];
+
+    if(!e.listed)
+        return;
+
+    if(e.large)
+        s_npcErase(s_npcLarge, A);
+    else
+    {
+        for(int y = e.y1; y <= e.y2; y++)
+        {
+            for(int x = e.x1; x <= e.x2; x++)
+                s_npcErase(s_npcBucketAt(x, y), A);
+        }
+    }
+
+    e.listed = false;
+}
+
+static void s_npcList(int A)
+{
+    NPCHashEntry_t &e = s_npcEntry[A];
+    const Location_t &loc = NPC[A].Location;
+
+    int x1 = s_npcCell(loc.X);
+    int y1 = s_npcCell(loc.Y);
+    int x2 = s_npcCell(loc.X + loc.Width);
+    int y2 = s_npcCell(loc.Y + loc.Height);
+
+    // NaN or infinite locations are falling into the large list too
+    bool large = !(loc.Width >= 0 && loc.Height >= 0 && loc.Width < s_npcCellSize * s_npcMaxCells
+                    && loc.Height < s_npcCellSize * s_npcMaxCells
+                    && std::isfinite(loc.X) && std::isfinite(loc.Y));
+
+    if(e.listed && e.large == large && (large || (e.x1 == x1 && e.y1 == y1 && e.x2 == x2 && e.y2 == y2)))
+        return; // still at the same cells
+
+    s_npcUnlist(A);
+
+    e.large = large;
+    e.x1 = x1;
+    e.y1 = y1;
+    e.x2 = x2;
+    e.y2 = y2;
+
+    if(large)
+        s_npcLarge.push_back(A);
+    else
+    {
+        for(int y = y1; y <= y2; y++)
+        {
+            for(int x = x1; x <= x2; x++)
+                s_npcBucketAt(x, y).push_back(A);
+        }
+    }
+
+    e.listed = true;
+}
+
+void treeNPCUpdate(int A)
+{
+    if(A < 1 || A > treenpc_indexed)
+        return; // will be listed by the next sync, queries are returning it anyway
+
+    s_npcList(A);
+}
+
+void treeNPCMove(int from, int to)
+{
+    treeNPCUpdate(to);
+
+    if(from < 1 || from > treenpc_indexed)
+        return;
+
+    s_npcUnlist(from);
+
+    // the freed last slot may be taken by a new NPC, it must be returned by the queries then
+    if(from == treenpc_indexed)
+        treenpc_indexed--;
+}
+
+void treeNPCSetLinearScan(bool linear)
+{
+    s_npcLinearScan = linear;
+}
+
+void treeNPCSyncAll()
+{
+    int n = numNPCs > maxNPCs ? maxNPCs : numNPCs;
+
+    for(int A = 1; A <= n; A++)
+        s_npcList(A);
+
+    for(int A = n + 1; A <= treenpc_indexed; A++)
+        s_npcUnlist(A);
+
+    treenpc_indexed = n;
+}
+
+void treeNPCClear()
+{
+    for(auto &b : s_npcBucket)
+        b.clear();
+
+    s_npcLarge.clear();
+
+    for(auto &e : s_npcEntry)
+        e.listed = false;
+
+    treenpc_indexed = 0;
+}
+
+TreeNPCResult_Sentinel treeNPCQuery(double Left, double Top, double Right, double Bottom,
+                                    double margin)
+{
+    TreeNPCResult_Sentinel result;
+    std::vector<int> &out = *result.i_vec;
+
+    int x1 = s_npcCell(Left - margin);
+    int y1 = s_npcCell(Top - margin);
+    int x2 = s_npcCell(Right + margin);
+    int y2 = s_npcCell(Bottom + margin);
+
+    if(s_npcLinearScan
+       || !(std::isfinite(Left) && std::isfinite(Top) && std::isfinite(Right) && std::isfinite(Bottom))
+       || (int64_t)(x2 - x1 + 1) * (y2 - y1 + 1) > treenpc_indexed)
+    {
+        // scanning the cells is more expensive than taking everything
+        for(int A = 1; A <= treenpc_indexed; A++)
+            out.push_back(A);
+
+        return result;
+    }
+
+    for(int y = y1; y <= y2; y++)
+    {
+        for(int x = x1; x <= x2; x++)
+        {
+            const auto &b = s_npcBucketAt(x, y);
+            out.insert(out.end(), b.begin(), b.end());
+        }
+    }
+
+    out.insert(out.end(), s_npcLarge.begin(), s_npcLarge.end());
+
+    // keep the original loop order, NPCs may be listed at several cells
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+
+    return result;
+}
+
+TreeNPCResult_Sentinel treeNPCQuery(const Location_t &loc, double margin)
+{
+    return treeNPCQuery(loc.X,
+                   loc.Y,
+                   loc.X + loc.Width,
+                   loc.Y + loc.Height, margin);
+}
+
 /* ================= Tile block search ================= */
 // the old ones, still good for now
 
@@ -34,6 +34,8 @@ enum SortMode
     SORTMODE_ID = 1,
     SORTMODE_LOC = 2,
     SORTMODE_Z = 2,
+    //! The order of the legacy FirstBlock/LastBlock scans (ascending index)
+    SORTMODE_COMPAT = SORTMODE_ID,
 };
 
 template<class ItemT>
@@ -120,6 +122,102 @@ public:
     }
 };
 
+extern std::vector<int> treenpc_result_vec[MAX_TREEQUERY_DEPTH];
+extern ptrdiff_t cur_treenpc_result_vec;
+extern int treenpc_indexed;
+
+/*!
+ * \brief Indices of NPCs that may intersect the queried area, in the ascending order
+ *
+ * The candidates are followed by every NPC added after the last treeNPCSyncAll() call
+ * (including the ones added while iterating), and the iteration stops at the current
+ * numNPCs, the same way as the original `for(B = 1; B <= numNPCs; B++)` loops do.
+ * Candidates are not guaranteed to intersect, the loop body must check it.
+ */
+class TreeNPCResult_Sentinel
+{
+public:
+    struct it
+    {
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = int;
+        using pointer           = const int*;
+        using reference         = int;
+
+        const std::vector<int> *vec = nullptr;
+        size_t pos = 0;
+        int tail = 0;
+
+        bool done() const
+        {
+            if(pos < vec->size())
+                return (*vec)[pos] > numNPCs;
+            return tail > numNPCs;
+        }
+
+        reference operator*() const { return pos < vec->size() ? (*vec)[pos] : tail; }
+
+        // Prefix increment
+        it& operator++()
+        {
+            if(pos < vec->size())
+                pos++;
+            else
+                tail++;
+            return *this;
+        }
+
+        // the end is dynamic because numNPCs may change while iterating
+        friend bool operator!= (const it& a, const it& b) { return !(a.done() && b.vec == nullptr); };
+        friend bool operator== (const it& a, const it& b) { return !(a != b); };
+    };
+
+    std::vector<int>* i_vec = nullptr;
+    int tail_begin = 1;
+
+    TreeNPCResult_Sentinel()
+    {
+        SDL_assert(cur_treenpc_result_vec >= 0); // invalid state
+        SDL_assert_release(cur_treenpc_result_vec < MAX_TREEQUERY_DEPTH); // insufficient sentinels: move recursive calls out of sentinel scope
+        i_vec = &treenpc_result_vec[cur_treenpc_result_vec];
+        i_vec->clear();
+        cur_treenpc_result_vec ++;
+        tail_begin = treenpc_indexed + 1;
+    }
+
+    TreeNPCResult_Sentinel(const TreeNPCResult_Sentinel& other) = delete;
+
+    TreeNPCResult_Sentinel(TreeNPCResult_Sentinel&& other)
+    {
+        i_vec = other.i_vec;
+        tail_begin = other.tail_begin;
+        other.i_vec = nullptr;
+    }
+
+    it begin() const
+    {
+        SDL_assert(i_vec); // invalid use of discarded sentinel
+        it ret;
+        ret.vec = i_vec;
+        ret.tail = tail_begin;
+        return ret;
+    }
+
+    it end() const
+    {
+        return it();
+    }
+
+    ~TreeNPCResult_Sentinel()
+    {
+        if(!i_vec)
+            return;
+        cur_treenpc_result_vec --;
+        SDL_assert(cur_treenpc_result_vec == i_vec - &treenpc_result_vec[0]); // scopes have been switched
+    }
+};
+
 extern void treeWorldCleanAll();
 extern void treeLevelCleanBlockLayers();
 extern void treeLevelCleanAll();
@@ -169,6 +267,28 @@ extern void treeBlockUpdateLayer(int layer, Block_t *obj);
 extern TreeResult_Sentinel<Block_t> treeBlockQuery(double Left, double Top, double Right, double Bottom,
                                int sort_mode, double margin = 16.0);
 extern TreeResult_Sentinel<Block_t> treeBlockQuery(const Location_t &loc, int sort_mode, double margin = 16.0);
+//! Swap the block trees of two layers together with the layers themselves
+extern void treeBlockSwapLayers(int layer_1, int layer_2);
+/*!
+ * \brief Find the blocks to check the physics collision with, counted at g_stats.physScannedBlocks
+ *
+ * Returns only blocks up to the numBlock, temporary NPC blocks are never included.
+ * If the block trees are disabled at the config, returns the legacy blockTileGet() range.
+ */
+extern TreeResult_Sentinel<Block_t> treeBlockQueryPhys(const Location_t &loc, int sort_mode = SORTMODE_COMPAT);
+
+//! Update the NPC position at the spatial hash (ignored for NPCs added after the last sync)
+extern void treeNPCUpdate(int A);
+//! Follows the `NPC[to] = NPC[from]` slot move, the `from` slot is being freed
+extern void treeNPCMove(int from, int to);
+//! Make the queries return all NPCs, as the original loops did (to validate the hash by the replays)
+extern void treeNPCSetLinearScan(bool linear);
+//! Update all NPCs at the spatial hash and start to index the ones added since the last sync
+extern void treeNPCSyncAll();
+extern void treeNPCClear();
+extern TreeNPCResult_Sentinel treeNPCQuery(double Left, double Top, double Right, double Bottom,
+                               double margin = 32.0);
+extern TreeNPCResult_Sentinel treeNPCQuery(const Location_t &loc, double margin = 32.0);
 
 extern void blockTileGet(const Location_t &loc, int64_t &fBlock, int64_t &lBlock);
 extern void blockTileGet(double x, double w, int64_t &fBlock, int64_t &lBlock);
@@ -30,6 +30,7 @@
 #include "../main/trees.h"
 #include "level_file.h"
 #include "world_file.h"
+#include "episode_catalog.h"
 
 #include <Utils/strings.h>
 #include <Utils/files.h>
@@ -468,7 +469,9 @@ void ClearWorld(bool quick)
 
 void FindWldStars()
 {
-    LevelData head;
+    StarCounts_t collected;
+    CountCollectedStars(collected);
+    int stars = 0;
 
     for(int A = 1; A <= numWorldLevels; A++)
     {
@@ -483,16 +486,10 @@ void FindWldStars()
 
             if(!fullPath.empty())
             {
-                if(FileFormats::OpenLevelFileHeader(fullPath, head))
+                if(EpisodeCatalog::levelStars(fullPath, stars))
                 {
-                    l.maxStars = head.stars;
-                    l.curStars = 0;
-
-                    for(int B = 1; B <= numStars; B++)
-                    {
-                        if(SDL_strcasecmp(Star[B].level.c_str(), l.FileName.c_str()) == 0)
-                            l.curStars++;
-                    }
+                    l.maxStars = stars;
+                    l.curStars = CollectedStarsOf(collected, l.FileName);
                 }
             }
 
@@ -32,6 +32,8 @@
 #include "controls.h"
 #include "config.h"
 #include "main/trees.h"
+#include "npc/npc_active.h"
+#include "npc/npc_hot.h"
 #include "core/events.h"
 #include "npc_id.h"
 #include "layers.h"
@@ -53,6 +55,7 @@ void CheckSectionNPC(int A)
         if(NPC[A].TimeLeft < 10)
             NPC[A].TimeLeft = 10;
         NPC[A].Section = Player[NPC[A].HoldingPlayer].Section;
+        npcActiveSectionChanged(A);
     }
 
     if(NPC[A].Location.X >= level[B].X)
@@ -64,6 +67,7 @@ void CheckSectionNPC(int A)
                 if(NPC[A].Location.Y + NPC[A].Location.Height <= level[B].Height)
                 {
                     NPC[A].Section = B;
+                    npcActiveSectionChanged(A);
                     return;
                 }
             }
@@ -80,6 +84,7 @@ void CheckSectionNPC(int A)
                     if(NPC[A].Location.Y + NPC[A].Location.Height <= level[B].Height)
                     {
                         NPC[A].Section = B;
+                        npcActiveSectionChanged(A);
                         return;
                     }
                 }
@@ -105,7 +110,10 @@ void Deactivate(int A)
             NPC[A].Quicksand = 0;
             NPC[A].NoLavaSplash = false;
             NPC[A].Active = false;
+            npcActiveRemove(A);
             NPC[A].Location = NPC[A].DefaultLocation;
+            treeNPCUpdate(A);
+            npcHotUpdate(A);
             NPC[A].Direction = NPC[A].DefaultDirection;
             NPC[A].Stuck = NPC[A].DefaultStuck;
             NPC[A].TimeLeft = 0;
@@ -627,7 +635,7 @@ void NPCSpecial(int A)
             tempLocation.Height = 1;
             tempBool = false;
 
-            for(int i = 1; i <= numNPCs; i++)
+            for(int i : npcActiveQuery())
             {
                 auto &n = NPC[i];
                 if(n.Active && !n.Hidden && NPCIsAVine[n.Type] && CheckCollision(tempLocation, n.Location))
@@ -3038,7 +3046,7 @@ void SpecialNPC(int A)
         NPC[A].Location.SpeedY += (playerVCenter - NPC[A].Location.Y + NPC[A].Location.Height / 2.0) * 0.004;
 
 
-        for(B = 1; B <= numNPCs; B++)
+        for(int B : npcActiveQuery())
         {
             if(NPC[B].Active)
             {
@@ -3065,7 +3073,7 @@ void SpecialNPC(int A)
                 NPC[A].Killed = 9;
                 Player[NPC[A].Special5].FrameCount = 115;
                 PlaySound(SFX_Grab2);
-                for(B = 1; B <= numNPCs; B++)
+                for(int B : npcActiveQuery())
                 {
                     if(NPC[B].Active)
                     {
@@ -4565,6 +4573,11 @@ void SpecialNPC(int A)
                 tempNPC = NPC[A];
                 NPC[A] = NPC[numNPCs];
                 NPC[numNPCs] = tempNPC;
+                npcActiveAdd(A);
+                treeNPCUpdate(A);
+                treeNPCUpdate(numNPCs);
+                npcHotUpdate(A);
+                npcHotUpdate(numNPCs);
                 PlaySound(SFX_HammerToss);
 
                 syncLayers_NPC(A);
@@ -5164,7 +5177,7 @@ void SpecialNPC(int A)
             {
                 if(fEqual((float)NPC[A].Location.SpeedY, Physics.NPCGravity))
                 {
-                    for(B = 1; B <= numNPCs; B++)
+                    for(int B : npcActiveSectionQuery(NPC[A].Section))
                     {
                         if(NPC[B].Active && NPC[B].Section == NPC[A].Section && !NPC[B].Hidden && NPC[B].HoldingPlayer == 0)
                         {
@@ -0,0 +1,201 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "../globals.h"
+#include "../sorted_int_set.hpp"
+#include "npc_active.h"
+
+static SortedIntSet s_active;
+static SortedIntSet s_sectionActive[maxSections + 1];
+//! Section list that keeps the NPC plus one, zero for unlisted, s_noSection for out of range sections
+static int s_listedAt[maxNPCs + 1] = {};
+static const int s_noSection = maxSections + 2;
+//! Slots up to this are covered by the list, the later ones are returned by every query
+static int s_synced = 0;
+//! Scratch list of NPCs to unlist or move between sections
+static std::vector<int> s_changed;
+
+static inline int s_sectionSlot(const NPC_t &npc)
+{
+    return (npc.Section >= 0 && npc.Section <= maxSections) ? npc.Section + 1 : s_noSection;
+}
+
+static void s_unlist(int A)
+{
+    int at = s_listedAt[A];
+    if(at == 0)
+        return;
+
+    if(at != s_noSection)
+        s_sectionActive[at - 1].erase(A);
+
+    s_active.erase(A);
+    s_listedAt[A] = 0;
+}
+
+static void s_list(int A)
+{
+    int at = s_sectionSlot(NPC[A]);
+    int old = s_listedAt[A];
+    if(old == at)
+        return;
+
+    if(old == 0)
+        s_active.insert(A);
+    else if(old != s_noSection)
+        s_sectionActive[old - 1].erase(A);
+
+    if(at != s_noSection)
+        s_sectionActive[at - 1].insert(A);
+
+    s_listedAt[A] = at;
+}
+
+void npcActiveSyncNew()
+{
+    int n = numNPCs > maxNPCs ? maxNPCs : numNPCs;
+
+    // NPCs deactivated or moved to another section without a hook, only the listed ones are checked
+    s_changed.clear();
+    for(int A : s_active)
+    {
+        if(!NPC[A].Active || s_listedAt[A] != s_sectionSlot(NPC[A]))
+            s_changed.push_back(A);
+    }
+
+    for(int A : s_changed)
+    {
+        if(NPC[A].Active)
+            s_list(A);
+        else
+            s_unlist(A);
+    }
+
+    for(int A = n + 1; A <= s_synced; A++)
+        s_unlist(A);
+
+    for(int A = s_synced + 1; A <= n; A++)
+    {
+        if(NPC[A].Active)
+            s_list(A);
+        else
+            s_unlist(A);
+    }
+
+    s_synced = n;
+}
+
+void npcActiveInvalidate()
+{
+    for(int A : s_active)
+        s_listedAt[A] = 0;
+
+    s_active.clear();
+
+    for(int S = 0; S <= maxSections; S++)
+        s_sectionActive[S].clear();
+
+    s_synced = 0;
+}
+
+void npcActiveAdd(int A)
+{
+    if(A < 1 || A > s_synced)
+        return; // returned by the queries anyway, listed by the next sync
+
+    s_list(A);
+}
+
+void npcActiveRemove(int A)
+{
+    if(A < 1 || A > s_synced)
+        return;
+
+    s_unlist(A);
+}
+
+void npcActiveSectionChanged(int A)
+{
+    if(A < 1 || A > s_synced || s_listedAt[A] == 0)
+        return;
+
+    s_list(A);
+}
+
+void npcActiveMove(int from, int to)
+{
+    if(from < 1 || from > maxNPCs || to < 1 || to > maxNPCs)
+        return;
+
+    // the "from" slot is unknown if it's after the list, so keep the "to" as possibly active
+    bool keep = from > s_synced || s_listedAt[from] != 0;
+
+    s_unlist(from);
+
+    if(to <= s_synced)
+    {
+        if(keep)
+            s_list(to);
+        else
+            s_unlist(to);
+    }
+
+    // new NPCs are taking the freed slots, they must be at the tail of queries
+    if(s_synced >= from)
+        s_synced = from - 1;
+}
+
+int npcActiveCount()
+{
+    int tail = numNPCs - s_synced;
+    return (int)s_active.size() + (tail > 0 ? tail : 0);
+}
+
+int npcActiveSectionCount(int S)
+{
+    if(S < 0 || S > maxSections)
+        return 0;
+
+    return (int)s_sectionActive[S].size();
+}
+
+TreeNPCResult_Sentinel npcActiveQuery()
+{
+    TreeNPCResult_Sentinel result;
+
+    result.i_vec->assign(s_active.begin(), s_active.end());
+    result.tail_begin = s_synced + 1;
+
+    return result;
+}
+
+TreeNPCResult_Sentinel npcActiveSectionQuery(int S)
+{
+    TreeNPCResult_Sentinel result;
+
+    if(S >= 0 && S <= maxSections)
+        result.i_vec->assign(s_sectionActive[S].begin(), s_sectionActive[S].end());
+
+    result.tail_begin = s_synced + 1;
+
+    return result;
+}
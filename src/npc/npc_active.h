@@ -0,0 +1,74 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module keeps the list of the active NPCs, so the logic scans that
+// are looking for the active NPCs only don't walk all the dormant ones
+
+#pragma once
+#ifndef NPC_ACTIVE_H
+#define NPC_ACTIVE_H
+
+#include "../main/trees.h"
+
+/*!
+ * \brief List the NPCs spawned since the last call
+ *
+ * Called by UpdateNPCs once the activation pass is done. Only the slots
+ * after the covered range are scanned, the earlier ones are kept by the
+ * activation sites (npcActiveAdd) and by Deactivate (npcActiveRemove).
+ * The listed NPCs that got inactive or changed their section without a hook
+ * are fixed here too, this walks the list only.
+ */
+void npcActiveSyncNew();
+
+//! Drop the list after the NPC array got rebuilt (level load, sorting, snapshot restore), the next npcActiveSyncNew() lists all NPCs
+void npcActiveInvalidate();
+
+//! Add the NPC that got activated
+void npcActiveAdd(int A);
+
+//! Remove the NPC that got deactivated
+void npcActiveRemove(int A);
+
+//! Move the listed NPC to the list of its new section
+void npcActiveSectionChanged(int A);
+
+//! Follow the NPC[to] = NPC[from] slot compaction, the "from" slot gets freed
+void npcActiveMove(int from, int to);
+
+//! Count of NPCs at the list plus the not yet covered slots
+int npcActiveCount();
+
+//! Count of the listed active NPCs of the section
+int npcActiveSectionCount(int S);
+
+/*!
+ * \brief Indices of NPCs that may be active, in the ascending order
+ *
+ * Works the same way as treeNPCQuery(): the listed NPCs are followed by
+ * every NPC spawned after the last npcActiveSyncNew() call, and the iteration
+ * stops at the current numNPCs. The loop body must still check NPC[B].Active.
+ */
+TreeNPCResult_Sentinel npcActiveQuery();
+
+//! Same as npcActiveQuery(), but lists the NPCs of the given section only, the loop body must still check NPC[B].Section
+TreeNPCResult_Sentinel npcActiveSectionQuery(int S);
+
+#endif // NPC_ACTIVE_H
@@ -29,14 +29,28 @@
 #include "../graphics.h"
 #include "../npc_id.h"
 #include "../layers.h"
+#include "../main/trees.h"
+#include "npc_hot.h"
 
 #include <Logger/logger.h>
 
+//! Updates the NPC at the spatial hash and at the hot copy on any return, hits are resizing, moving and transforming NPCs
+struct NPCHitTreeUpdate_t
+{
+    int A;
+    ~NPCHitTreeUpdate_t()
+    {
+        treeNPCUpdate(A);
+        npcHotUpdate(A);
+    }
+};
+
 void NPCHit(int A, int B, int C)
 {
     NPC_t tempNPC;
     Location_t tempLocation;
     NPC_t oldNPC = NPC[A];
+    NPCHitTreeUpdate_t treeUpdate{A};
 
     // if(B == 1 && C != 0)
     //     Controls::Rumble(C, 50, .25);
@@ -0,0 +1,66 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "npc_hot.h"
+
+NPCHotData_t g_npcHot;
+
+static inline void s_copyRow(int to, const NPC_t &n)
+{
+    NPCHotData_t &h = g_npcHot;
+
+    h.x[to] = n.Location.X;
+    h.y[to] = n.Location.Y;
+    h.w[to] = n.Location.Width;
+    h.h[to] = n.Location.Height;
+    h.type[to] = n.Type;
+    h.effect[to] = n.Effect;
+    h.flags[to] = (n.Hidden ? NPC_HOT_HIDDEN : 0) | (n.Generator ? NPC_HOT_GENERATOR : 0);
+}
+
+void npcHotSyncAll()
+{
+    for(int A = 1; A <= numNPCs; A++)
+        s_copyRow(A, NPC[A]);
+}
+
+void npcHotUpdate(int A)
+{
+    if(A < 1 || A > maxNPCs)
+        return;
+
+    s_copyRow(A, NPC[A]);
+}
+
+void npcHotMove(int from, int to)
+{
+    if(from < 1 || from > maxNPCs || to < 1 || to > maxNPCs)
+        return;
+
+    NPCHotData_t &h = g_npcHot;
+
+    h.x[to] = h.x[from];
+    h.y[to] = h.y[from];
+    h.w[to] = h.w[from];
+    h.h[to] = h.h[from];
+    h.type[to] = h.type[from];
+    h.effect[to] = h.effect[from];
+    h.flags[to] = h.flags[from];
+}
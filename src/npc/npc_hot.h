@@ -0,0 +1,89 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module keeps a compact copy of the NPC fields read by the culling
+// scans, so these scans don't pull the whole NPC_t into the cache
+
+#pragma once
+#ifndef NPC_HOT_H
+#define NPC_HOT_H
+
+#include <cstdint>
+
+#include "../globals.h"
+
+enum NPCHotFlags
+{
+    NPC_HOT_HIDDEN    = 0x01,
+    NPC_HOT_GENERATOR = 0x02,
+};
+
+/*!
+ * \brief Structure-of-arrays copy of the NPC fields used by the visibility scans
+ *
+ * Indices are the same as of the NPC array. Rows are refreshed where the NPCs
+ * change: at the end of their UpdateNPCs pass, on hits, spawns (syncLayers_NPC),
+ * layer show/hide and player carrying, and follow the slot compaction of KillNPC.
+ * The whole copy is rebuilt only on level load, sorting and snapshot restore.
+ */
+struct NPCHotData_t
+{
+    double x[maxNPCs + 1];
+    double y[maxNPCs + 1];
+    double w[maxNPCs + 1];
+    double h[maxNPCs + 1];
+    int type[maxNPCs + 1];
+    int effect[maxNPCs + 1];
+    //! Combination of NPCHotFlags
+    uint8_t flags[maxNPCs + 1];
+};
+
+extern NPCHotData_t g_npcHot;
+
+//! Copy the hot fields of all NPCs (1..numNPCs), after the level load and the NPC array reorders
+void npcHotSyncAll();
+
+//! Copy the hot fields of one NPC
+void npcHotUpdate(int A);
+
+//! Move the hot fields from one slot to another, follows the NPC[to] = NPC[from] copy
+void npcHotMove(int from, int to);
+
+//! Same as vScreenCollision(Z, NPC[A].Location), but reads the copy
+inline bool npcHotCollision(int Z, int A)
+{
+    if(Z == 0)
+        return true;
+
+    const double left = -vScreenX[Z];
+    const double top = -vScreenY[Z];
+    const NPCHotData_t &n = g_npcHot;
+
+    return left <= n.x[A] + n.w[A] && left + vScreen[Z].Width >= n.x[A] &&
+           top <= n.y[A] + n.h[A] && top + vScreen[Z].Height >= n.y[A];
+}
+
+//! NPC is visible at the screen: vScreenCollision() and not hidden
+inline bool npcHotOnScreen(int Z, int A)
+{
+    return !(g_npcHot.flags[A] & NPC_HOT_HIDDEN) && npcHotCollision(Z, A);
+}
+
+#endif // NPC_HOT_H
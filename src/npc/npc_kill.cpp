@@ -28,6 +28,9 @@
 #include "../main/speedrunner.h"
 #include "../compat.h"
 #include "../controls.h"
+#include "npc_hot.h"
+#include "npc_active.h"
+#include "../main/trees.h"
 #include "../layers.h"
 
 void KillNPC(int A, int B)
@@ -1559,6 +1562,9 @@ void KillNPC(int A, int B)
 
         NPC[A] = NPC[numNPCs];
         NPC[numNPCs] = blankNPC;
+        npcHotMove(numNPCs, A);
+        npcActiveMove(numNPCs, A);
+        treeNPCMove(numNPCs, A);
         numNPCs--;
         syncLayers_NPC(A);
         syncLayers_NPC(numNPCs + 1);
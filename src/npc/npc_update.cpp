@@ -30,7 +30,10 @@
 #include "../sorting.h"
 #include "../compat.h"
 #include "../config.h"
+#include "../frame_timer.h"
 #include "../main/trees.h"
+#include "npc_active.h"
+#include "npc_hot.h"
 #include "../npc_id.h"
 #include "../layers.h"
 
@@ -38,6 +41,8 @@
 
 static RangeArr<int, 0, maxNPCs> newAct;
 // Why this array is here? to don't reallocate it every call of UpdateNPCs()
+//! Blocks to check at the NPC block collision pass
+static std::vector<int> s_bCheckList;
 
 void UpdateNPCs()
 {
@@ -162,6 +167,8 @@ void UpdateNPCs()
                 if(g_compatibility.fix_FreezeNPCs_no_reset)
                     NPC[A].TimeLeft = -1;
             }
+            // the main loop below doesn't run, the layers may have moved the NPC
+            npcHotUpdate(A);
             if(NPC[A].Killed > 0)
             {
                 if(NPC[A].Location.SpeedX == 0.0)
@@ -202,7 +209,8 @@ void UpdateNPCs()
         }
     }
 
-
+    // NPCs are moved by layers and by players since the last frame
+    treeNPCSyncAll();
 
     for(A = 1; A <= numNPCs; A++)
     {
@@ -240,7 +248,7 @@ void UpdateNPCs()
                     if(NPC[A].GeneratorTime >= NPC[A].GeneratorTimeMax * 6.5f)
                     {
                         tempBool = false;
-                        for(B = 1; B <= numNPCs; B++)
+                        for(int B : treeNPCQuery(NPC[A].Location))
                         {
                             if(B != A && NPC[B].Active && NPC[B].Type != 57)
                             {
@@ -403,6 +411,7 @@ void UpdateNPCs()
             {
                 NPC[A].TimeLeft = 100;
                 NPC[A].Active = true;
+                npcActiveAdd(A);
                 NPC[A].JustActivated = 0;
             }
         }
@@ -429,7 +438,7 @@ void UpdateNPCs()
                 tempLocation.Width += 64;
                 tempLocation.Height += 64;
 
-                for(B = 1; B <= numNPCs; B++)
+                for(int B : treeNPCQuery(tempLocation))
                 {
                     if(!NPC[B].Active && B != A && NPC[B].Reset[1] && NPC[B].Reset[2])
                     {
@@ -442,6 +451,7 @@ void UpdateNPCs()
                             NPC[B].TimeLeft = NPC[A].TimeLeft;
                             NPC[B].JustActivated = 1;
                             NPC[B].Section = NPC[A].Section;
+                            npcActiveAdd(B);
                             if(B < A)
                             {
                                 if(NPC[B].TriggerActivate != EVENT_NONE)
@@ -470,7 +480,7 @@ void UpdateNPCs()
                         tempLocation.X -= 32;
                         tempLocation.Width += 64;
                         tempLocation.Height += 64;
-                        for(B = 1; B <= numNPCs; B++)
+                        for(int B : treeNPCQuery(tempLocation))
                         {
                             if(!NPC[B].Active &&
                               (!NPC[B].Hidden || !g_compatibility.fix_npc_activation_event_loop_bug) &&
@@ -485,6 +495,7 @@ void UpdateNPCs()
                                     NPC[B].TimeLeft = NPC[newAct[C]].TimeLeft;
                                     NPC[B].JustActivated = 1;
                                     NPC[B].Section = NPC[newAct[C]].Section;
+                                    npcActiveAdd(B);
                                     if(B < A)
                                     {
                                         if(NPC[B].TriggerActivate != EVENT_NONE)
@@ -530,6 +541,7 @@ void UpdateNPCs()
         if(NPC[A].Type == 60 || NPC[A].Type == 62 || NPC[A].Type == 64 || NPC[A].Type == 66)
         {
             NPC[A].Active = true;
+            npcActiveAdd(A);
             NPC[A].TimeLeft = 100;
         }
 
@@ -626,12 +638,13 @@ void UpdateNPCs()
             numTempBlock++;
         }
     }
-    // don't need to sync yet since its layer is LAYER_NONE,
-    //   but will want to sync once we use the quadtree
-    // for(A = numBlock + 1 - numTempBlock; A <= numBlock; A++)
-    // {
-    //     syncLayersTrees_Block(A);
-    // }
+    // the activation is done, list the NPCs spawned since the last frame
+    npcActiveSyncNew();
+    g_stats.activeNPCs = npcActiveCount();
+    g_stats.activeSectionNPCs = npcActiveSectionCount(Player[1].Section);
+
+    // temp blocks are not synced into the block trees: they follow their NPCs every frame,
+    //   and every scan that needs them takes the [numBlock + 1 - numTempBlock, numBlock] range
     if(numTempBlock > 1)
         qSortBlocksX(numBlock + 1 - numTempBlock, numBlock);
     for(A = numBlock + 1 - numTempBlock; A <= numBlock; A++)
@@ -1072,7 +1085,7 @@ void UpdateNPCs()
                              NPC[A].Type == 49 || NPC[A].Type == 134 || (NPC[A].Type >= 154 && NPC[A].Type <= 157) ||
                              NPC[A].Type == 31 || NPC[A].Type == 240 || NPC[A].Type == 278 || NPC[A].Type == 279 || NPC[A].Type == 292))
                         {
-                            for(B = 1; B <= numNPCs; B++)
+                            for(int B : treeNPCQuery(NPC[A].Location))
                             {
                                 if(B != A && NPC[B].Active &&
                                    (NPC[B].HoldingPlayer == 0 || (BattleMode && NPC[B].HoldingPlayer != NPC[A].HoldingPlayer)) &&
@@ -2030,19 +2043,27 @@ void UpdateNPCs()
                         {
                             for(bCheck = 1; bCheck <= 2; bCheck++)
                             {
+                                // the blocks are found at the trees, temp blocks are scanned as is
+                                s_bCheckList.clear();
+
                                 if(bCheck == 1)
                                 {
                                     // fBlock = FirstBlock[(int)SDL_floor(NPC[A].Location.X / 32) - 1];
                                     // lBlock = LastBlock[(int)SDL_floor((NPC[A].Location.X + NPC[A].Location.Width) / 32.0) + 1];
-                                    blockTileGet(NPC[A].Location, fBlock, lBlock);
+                                    for(Block_t *block : treeBlockQueryPhys(NPC[A].Location))
+                                    {
+                                        int i = (int)(block - &Block[0]);
+                                        if(i <= numBlock - numTempBlock)
+                                            s_bCheckList.push_back(i);
+                                    }
                                 }
                                 else
                                 {
-                                    fBlock = numBlock + 1 - numTempBlock;
-                                    lBlock = numBlock;
+                                    for(int i = numBlock + 1 - numTempBlock; i <= numBlock; i++)
+                                        s_bCheckList.push_back(i);
                                 }
 
-                                for(B = (int)fBlock; B <= lBlock; B++)
+                                for(int B : s_bCheckList)
                                 {
                                     // If Not .Block = B And Not .tempBlock = B And Not (.Projectile = True And Block(B).noProjClipping = True) And BlockNoClipping(Block(B).Type) = False And Block(B).Hidden = False And Block(B).Hidden = False Then
 
@@ -3176,7 +3197,7 @@ void UpdateNPCs()
 
                             if(!(NPC[A].Type >= 79 && NPC[A].Type <= 83) && !NPC[A].Inert)
                             {
-                                for(int C = 1; C <= numNPCs; C++)
+                                for(int C : npcActiveQuery())
                                 {
                                     if(A != C && NPC[C].Active && !NPC[C].Projectile)
                                     {
@@ -3234,6 +3255,8 @@ void UpdateNPCs()
                         }
 
                         // NPC Collision
+                        treeNPCUpdate(A);
+                        npcHotUpdate(A);
 
                         if(!NPC[A].Inert && NPC[A].Type != 159 && NPC[A].Type != 22 && NPC[A].Type != 26 &&
                                 !(NPC[A].Type == 30 && !NPC[A].Projectile) && NPC[A].Type != 32 && NPC[A].Type != 35 &&
@@ -3259,7 +3282,7 @@ void UpdateNPCs()
                                 NPC[A].Type != 282 && NPC[A].Type != 288 && NPC[A].Type != 289)
                             {
 
-                                for(B = 1; B <= numNPCs; B++)
+                                for(int B : treeNPCQuery(NPC[A].Location))
                                 {
                                     if(NPC[B].Active)
                                     {
@@ -3431,6 +3454,9 @@ void UpdateNPCs()
                                                                                             }
                                                                                         }
                                                                                     }
+                                                                                    // the pushed NPC is not at its listed cells anymore
+                                                                                    treeNPCUpdate(B);
+                                                                                    npcHotUpdate(B);
                                                                                 }
                                                                                 else if(NPC[A].Type == 78)
                                                                                     NPCHit(B, 8, A);
@@ -4955,7 +4981,7 @@ void UpdateNPCs()
             {
                 tempBool = false;
 
-                for(B = 1; B <= numNPCs; B++)
+                for(int B : treeNPCQuery(NPC[A].Location))
                 {
                     if(NPC[B].Type == 208)
                     {
@@ -5195,14 +5221,16 @@ void UpdateNPCs()
             }
         }
 
+        // the NPC may have been moved after its collision pass (held, warping, riding, etc.)
+        treeNPCUpdate(A);
+        // refresh the row while the NPC is still in the cache, the graphics pass reads it next
+        npcHotUpdate(A);
     }
 
     numBlock -= numTempBlock; // clean up the temp npc blocks
-    // again, don't need this until the block quadtree
-    // for(int i = numBlock + 1; i <= numBlock + numTempBlock; i++)
-    // {
-    //     syncLayersTrees_Block(i);
-    // }
+    // drop the tree entries of real blocks that were synced into the temp block slots this frame
+    for(int i = numBlock + 1; i <= numBlock + numTempBlock; i++)
+        treeBlockRemoveLayer(-1, &Block[i]);
     for(A = numNPCs; A >= 1; A--) // KILL THE NPCS <><><><><><><><><><><><><><><><><><><><><><><><><><><><><><
     {
         if(NPC[A].Killed > 0)
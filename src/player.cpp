@@ -41,6 +41,8 @@
 #include "main/level_file.h"
 #include "main/game_globals.h"
 #include "main/trees.h"
+#include "npc/npc_active.h"
+#include "npc/npc_hot.h"
 #include "main/menu_main.h"
 #include "core/render.h"
 #include "core/events.h"
@@ -2209,8 +2211,6 @@ void TailSwipe(const int plr, bool boo, bool Stab, int StabDir)
     int A = 0;
     long long B = 0;
     int C = 0;
-    int64_t fBlock = 0;
-    int64_t lBlock = 0;
 
     if(Stab)
     {
@@ -2279,10 +2279,10 @@ void TailSwipe(const int plr, bool boo, bool Stab, int StabDir)
     {
         // fBlock = FirstBlock[(tailLoc.X / 32) - 1];
         // lBlock = LastBlock[((tailLoc.X + tailLoc.Width) / 32.0) + 1];
-        blockTileGet(tailLoc, fBlock, lBlock);
 
-        for(A = (int)fBlock; A <= lBlock; A++)
+        for(Block_t *block : treeBlockQueryPhys(tailLoc))
         {
+            A = (int)(block - &Block[0]);
             if(!BlockIsSizable[Block[A].Type] && !Block[A].Hidden && (Block[A].Type != 293 || Stab) && !Block[A].Invis && !BlockNoClipping[Block[A].Type])
             {
                 if(CheckCollision(tailLoc, Block[A].Location))
@@ -2354,8 +2354,11 @@ void TailSwipe(const int plr, bool boo, bool Stab, int StabDir)
         }
     }
 
-    for(int numNPCsMax5 = numNPCs, A = 1; A <= numNPCsMax5; A++)
+    int numNPCsMax5 = numNPCs;
+    for(int A : npcActiveQuery())
     {
+        if(A > numNPCsMax5)
+            break;
         if(NPC[A].Active && NPC[A].Effect == 0 && !(NPCIsAnExit[NPC[A].Type] || (NPCIsACoin[NPC[A].Type] && !Stab)) &&
             NPC[A].CantHurtPlayer != plr && !(p.StandingOnNPC == A && p.ShellSurf))
         {
@@ -2691,6 +2694,7 @@ void YoshiSpit(const int A)
             NPC[p.YoshiNPC].Frame = EditorNPCFrame(NPC[p.YoshiNPC].Type, NPC[p.YoshiNPC].Direction);
             NPC[p.YoshiNPC].Active = true;
             NPC[p.YoshiNPC].Section = p.Section;
+            npcActiveAdd(p.YoshiNPC);
             NPC[p.YoshiNPC].TimeLeft = 100;
             NPC[p.YoshiNPC].Effect = 0;
             NPC[p.YoshiNPC].Effect2 = 0;
@@ -2766,8 +2770,11 @@ void YoshiPound(const int A, int mount, bool BreakBlocks)
         tempLocation.Height = 32;
         tempLocation.Y = p.Location.Y + p.Location.Height - 16;
 
-        for(int numNPCsMax7 = numNPCs, B = 1; B <= numNPCsMax7; B++)
+        int numNPCsMax7 = numNPCs;
+        for(int B : npcActiveQuery())
         {
+            if(B > numNPCsMax7)
+                break;
             if(!NPC[B].Hidden && NPC[B].Active && NPC[B].Effect == 0)
             {
                 tempLocation2 = NPC[B].Location;
@@ -3038,8 +3045,6 @@ void SwapCoop()
 void PlayerPush(const int A, int HitSpot)
 {
     Location_t tempLocation;
-    int64_t fBlock = 0;
-    int64_t lBlock = 0;
 
     if(ShadowMode)
         return;
@@ -3048,10 +3053,10 @@ void PlayerPush(const int A, int HitSpot)
 
     // fBlock = FirstBlock[(p.Location.X / 32) - 1];
     // lBlock = LastBlock[((p.Location.X + p.Location.Width) / 32.0) + 1];
-    blockTileGet(p.Location, fBlock, lBlock);
 
-    for(int B = int(fBlock); B <= lBlock; B++)
+    for(Block_t *block : treeBlockQueryPhys(p.Location))
     {
+        int B = (int)(block - &Block[0]);
         auto &b = Block[B];
 
         if(b.Hidden || BlockIsSizable[b.Type])
@@ -3803,6 +3808,7 @@ void ClownCar()
                                         NPC[C].Location.X = NPC[B].Location.X - NPC[C].Location.Width;
                                     NPC[C].Location.Y = NPC[B].Location.Y;
                                     NPC[C].TimeLeft = 100;
+                                    npcHotUpdate(C);
                                     break;
                                 }
                             }
@@ -3832,6 +3838,8 @@ void ClownCar()
                     }
                     else
                         NPC[B].Location.SpeedX = 0;
+
+                    npcHotUpdate(B);
                 }
             }
         }
@@ -4038,8 +4046,11 @@ void PowerUps(const int A)
 
     if(p.State == 6 && p.Character == 4 && p.Controls.Run && p.RunRelease)
     {
-        for(int numNPCsMax11 = numNPCs, B = 1; B <= numNPCsMax11; B++)
+        int numNPCsMax11 = numNPCs;
+        for(int B : npcActiveQuery())
         {
+            if(B > numNPCsMax11)
+                break;
             if(NPC[B].Active)
             {
                 if(NPC[B].Type == 292)
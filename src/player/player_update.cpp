@@ -35,6 +35,8 @@
 #include "../game_main.h"
 #include "../compat.h"
 #include "../main/trees.h"
+#include "../npc/npc_active.h"
+#include "../npc/npc_hot.h"
 #include "../main/game_globals.h"
 #include "../frame_timer.h"
 #include "../graphics.h"
@@ -52,8 +54,6 @@ void UpdatePlayer()
     float D = 0;
 //    Controls_t blankControls;
     float speedVar = 0; // adjusts the players speed by percentages
-    int64_t fBlock = 0; // for collision detection optimizations
-    int64_t lBlock = 0;
     double tempSpeed = 0;
     int HitSpot = 0;
     // the hitspot is used for collision detection to find out where to put the player after it collides with a block
@@ -497,10 +497,10 @@ void UpdatePlayer()
                         tempLocation.X += 64 - tempLocation.Width / 2.0;
                         // fBlock = FirstBlock[(tempLocation.X / 32) - 1];
                         // lBlock = LastBlock[((tempLocation.X + tempLocation.Width) / 32.0) + 1];
-                        blockTileGet(tempLocation, fBlock, lBlock);
 
-                        for(B = (int)fBlock; B <= lBlock; B++)
+                        for(Block_t *block : treeBlockQueryPhys(tempLocation))
                         {
+                            B = (int)(block - &Block[0]);
                             if(!Block[B].Invis && !BlockIsSizable[Block[B].Type] && !BlockOnlyHitspot1[Block[B].Type] &&
                                !BlockNoClipping[Block[B].Type] && !Block[B].Hidden)
                             {
@@ -512,8 +512,11 @@ void UpdatePlayer()
                             }
                         }
 
-                        for(int numNPCsMax2 = numNPCs, B = 1; B <= numNPCsMax2; B++)
+                        int numNPCsMax2 = numNPCs;
+                        for(int B : npcActiveQuery())
                         {
+                            if(B > numNPCsMax2)
+                                break;
                             if(NPCIsABlock[NPC[B].Type] && !NPCStandsOnPlayer[NPC[B].Type] && NPC[B].Active && NPC[B].Type != 56)
                             {
                                 if(CheckCollision(tempLocation, NPC[B].Location))
@@ -968,8 +971,11 @@ void UpdatePlayer()
                         Player[A].FairyTime -= 1;
                     if(Player[A].FairyTime != -1 && Player[A].FairyTime < 20 && Player[A].Character == 5)
                     {
-                        for(int numNPCsMax4 = numNPCs, Bi = 1; Bi <= numNPCsMax4; Bi++)
+                        int numNPCsMax4 = numNPCs;
+                        for(int Bi : npcActiveQuery())
                         {
+                            if(Bi > numNPCsMax4)
+                                break;
                             if(NPC[Bi].Active && !NPC[Bi].Hidden && NPCIsAVine[NPC[Bi].Type])
                             {
                                 tempLocation = NPC[Bi].Location;
@@ -2152,10 +2158,10 @@ void UpdatePlayer()
                 // block collision optimization
                 // fBlock = FirstBlock[(Player[A].Location.X / 32) - 1];
                 // lBlock = LastBlock[((Player[A].Location.X + Player[A].Location.Width) / 32.0) + 1];
-                blockTileGet(Player[A].Location, fBlock, lBlock);
 
-                for(B = (int)fBlock; B <= lBlock; B++)
+                for(Block_t *block : treeBlockQueryPhys(Player[A].Location))
                 {
+                    B = (int)(block - &Block[0]);
 
                     // checks to see if a collision happened
                     if(Player[A].Location.X + Player[A].Location.Width >= Block[B].Location.X)
@@ -2682,10 +2688,10 @@ void UpdatePlayer()
                                                 tempBool = false;
                                                 // fBlock = FirstBlock[(tempLocation.X / 32) - 1];
                                                 // lBlock = LastBlock[((tempLocation.X + tempLocation.Width) / 32.0) + 1];
-                                                blockTileGet(tempLocation, fBlock, lBlock);
 
-                                                for(auto C = fBlock; C <= lBlock; C++)
+                                                for(Block_t *block : treeBlockQueryPhys(tempLocation))
                                                 {
+                                                    int C = (int)(block - &Block[0]);
                                                     if(CheckCollision(tempLocation, Block[C].Location) && !Block[C].Hidden)
                                                     {
                                                         if(BlockSlope[Block[C].Type] == 0)
@@ -3906,10 +3912,10 @@ void UpdatePlayer()
 
                                                     // fBlock = FirstBlock[(Player[A].Location.X / 32) - 1];
                                                     // lBlock = LastBlock[((Player[A].Location.X + Player[A].Location.Width) / 32.0) + 1];
-                                                    blockTileGet(Player[A].Location, fBlock, lBlock);
 
-                                                    for(auto C = fBlock; C <= lBlock; C++)
+                                                    for(Block_t *block : treeBlockQueryPhys(Player[A].Location))
                                                     {
+                                                        int C = (int)(block - &Block[0]);
                                                         if(CheckCollision(Player[A].Location, Block[C].Location) &&
                                                            !Block[C].Hidden && !BlockIsSizable[Block[C].Type] &&
                                                            !BlockOnlyHitspot1[Block[C].Type])
@@ -4437,6 +4443,11 @@ void UpdatePlayer()
 //        else
 //            Player[A].DuckRelease = true;
         Player[A].DuckRelease = !Player[A].Controls.Down;
+
+        // the NPCs carried by the player have followed it
+        npcHotUpdate(Player[A].HoldingNPC);
+        npcHotUpdate(Player[A].StandingOnNPC);
+        npcHotUpdate(Player[A].YoshiNPC);
     }
 
     // int C = 0;
@@ -19,6 +19,7 @@
  */
 
 #include <cstdlib>
+#include <SDL2/SDL_stdinc.h>
 
 #include <pcg/pcg_random.hpp>
 
@@ -58,6 +59,27 @@ long random_ncalls()
     return g_random_n_calls;
 }
 
+void saveRandomState(RandomState_t &state)
+{
+    static_assert(sizeof(pcg32) <= sizeof(state.engine), "RandomState_t::engine is too small");
+
+    SDL_memcpy(state.engine, &g_random_engine, sizeof(pcg32));
+    SDL_memcpy(state.engine_isolated, &g_random_engine_isolated, sizeof(pcg32));
+    state.ncalls = g_random_n_calls;
+    state.seed = last_seed;
+}
+
+void loadRandomState(const RandomState_t &state)
+{
+    SDL_memcpy(&g_random_engine, state.engine, sizeof(pcg32));
+    SDL_memcpy(&g_random_engine_isolated, state.engine_isolated, sizeof(pcg32));
+    g_random_n_calls = state.ncalls;
+    last_seed = state.seed;
+#ifdef DEBUG_RANDOM_CALLS
+    g_random_calls.clear();
+#endif
+}
+
 // Also note that many VB6 calls use dRand * x
 // and then assign the result to an Integer.
 // The result is NOT iRand(x) but rather vb6Round(dRand()*x),
@@ -49,6 +49,27 @@ extern int readSeed();
  */
 extern long random_ncalls();
 
+//! Complete state of the random number generators
+struct RandomState_t
+{
+    unsigned char engine[32];
+    unsigned char engine_isolated[32];
+    long ncalls;
+    int seed;
+};
+
+/**
+ * @brief Saves the state of the random number generators (used by the game state snapshots)
+ * @param state Destination state
+ */
+extern void saveRandomState(RandomState_t &state);
+
+/**
+ * @brief Restores the random number generators from the state saved before
+ * @param state Source state
+ */
+extern void loadRandomState(const RandomState_t &state);
+
 /**
  * @brief Random number generator in double format, between 0.0 to 1.0 (exclusive)
  * @return random double value
@@ -0,0 +1,135 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef SORTED_INT_SET_HPP
+#define SORTED_INT_SET_HPP
+
+#include <vector>
+#include <algorithm>
+
+/*!
+ * \brief Set of object indices kept as a sorted contiguous array
+ *
+ * Iterates in the ascending order as the std::set<int> does, but without
+ * the node hopping. Indices are mostly added at the end (new objects get
+ * the last index), so the insertion is usually just an append.
+ *
+ * Like for any vector, the iterators are invalidated by insert() and erase().
+ */
+class SortedIntSet
+{
+    std::vector<int> m_items;
+
+public:
+    typedef std::vector<int>::const_iterator const_iterator;
+
+    const_iterator begin() const
+    {
+        return m_items.begin();
+    }
+
+    const_iterator end() const
+    {
+        return m_items.end();
+    }
+
+    bool empty() const
+    {
+        return m_items.empty();
+    }
+
+    size_t size() const
+    {
+        return m_items.size();
+    }
+
+    void clear()
+    {
+        m_items.clear();
+    }
+
+    void reserve(size_t count)
+    {
+        m_items.reserve(count);
+    }
+
+    bool contains(int value) const
+    {
+        return std::binary_search(m_items.begin(), m_items.end(), value);
+    }
+
+    size_t count(int value) const
+    {
+        return contains(value) ? 1 : 0;
+    }
+
+    void insert(int value)
+    {
+        if(m_items.empty() || m_items.back() < value)
+        {
+            m_items.push_back(value);
+            return;
+        }
+
+        auto i = std::lower_bound(m_items.begin(), m_items.end(), value);
+        if(*i != value)
+            m_items.insert(i, value);
+    }
+
+    void erase(int value)
+    {
+        if(m_items.empty() || value > m_items.back())
+            return;
+
+        auto i = std::lower_bound(m_items.begin(), m_items.end(), value);
+        if(i != m_items.end() && *i == value)
+            m_items.erase(i);
+    }
+
+    //! Remove all values not less than the given one
+    void eraseFrom(int value)
+    {
+        if(m_items.empty() || value > m_items.back())
+            return;
+
+        m_items.erase(std::lower_bound(m_items.begin(), m_items.end(), value), m_items.end());
+    }
+
+    /*!
+     * \brief Append the value without the order check, for the batched updates
+     *
+     * Call finishAppend() when done to restore the order.
+     */
+    void append(int value)
+    {
+        m_items.push_back(value);
+    }
+
+    //! Restore the order and uniqueness after a series of append() calls
+    void finishAppend()
+    {
+        if(!std::is_sorted(m_items.begin(), m_items.end()))
+            std::sort(m_items.begin(), m_items.end());
+        m_items.erase(std::unique(m_items.begin(), m_items.end()), m_items.end());
+    }
+};
+
+#endif // SORTED_INT_SET_HPP
@@ -18,8 +18,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <vector>
+#include <algorithm>
+
 #include "globals.h"
 #include "sorting.h"
+#include "layers.h"
+#include "sorted_int_set.hpp"
+#include "npc/npc_active.h"
+#include "npc/npc_hot.h"
+
+//! Slots marked by the blockOrderTouch()
+static SortedIntSet s_blockOrderTouched;
+//! Touched blocks taken out of the array while merging
+static std::vector<Block_t> s_blockOrderMoved;
+//! Locations of the untouched blocks, to find the equal keys
+static std::vector<Location_t> s_blockOrderKept;
 
 void qSortBlocksY(int min, int max)
 {
@@ -366,6 +380,8 @@ void NPCSort()
     int B = 0;
     NPC_t tempNPC;
 
+    npcActiveInvalidate();
+
     for(A = 1; A <= numNPCs; A++)
     {
         if(NPCIsACoin[NPC[A].Type])
@@ -382,6 +398,8 @@ void NPCSort()
             }
         }
     }
+
+    npcHotSyncAll();
 }
 
 void FindSBlocks()
@@ -452,6 +470,7 @@ void qSortNPCsY(int min, int max)
     int hi = 0;
     int lo = 0;
     int i = 0;
+    npcActiveInvalidate();
     if(min >= max)
         return;
     i = floor((max + min) / 2.0);
@@ -567,3 +586,140 @@ void qSortTempBlocksX(int min, int max)
     qSortBlocksX(min, lo - 1);
     qSortBlocksX(lo + 1, max);
 }
+
+void blockOrderTouch(int A)
+{
+    s_blockOrderTouched.append(A);
+}
+
+// the order of the qSortBlocksX() with the columns sorted by the qSortBlocksY()
+static inline bool s_blockOrderLess(const Location_t &a, const Location_t &b)
+{
+    return a.X < b.X || (a.X == b.X && a.Y < b.Y);
+}
+
+static void s_blockOrderFullSort()
+{
+    int A, B;
+
+    qSortBlocksX(1, numBlock);
+    B = 1;
+
+    for(A = 2; A <= numBlock; A++)
+    {
+        if(Block[A].Location.X > Block[B].Location.X)
+        {
+            qSortBlocksY(B, A - 1);
+            B = A;
+        }
+    }
+
+    qSortBlocksY(B, A - 1);
+    FindSBlocks();
+    FindBlocks();
+    syncLayersTrees_AllBlocks();
+}
+
+void blockOrderFinish()
+{
+    s_blockOrderTouched.finishAppend();
+
+    auto &moved = s_blockOrderMoved;
+    auto &keptKeys = s_blockOrderKept;
+    moved.clear();
+    keptKeys.clear();
+
+    // the merge gives the same order as the quicksort only if all keys are different:
+    //   the quicksort places the blocks of equal keys by their previous slots, so it
+    //   has to run on the untouched array whenever the order isn't unique
+    auto t = s_blockOrderTouched.begin();
+    int first = numBlock + 1;
+    bool unique = true;
+
+    for(int A = 1; A <= numBlock && unique; A++)
+    {
+        while(t != s_blockOrderTouched.end() && *t < A)
+            ++t;
+
+        if(t != s_blockOrderTouched.end() && *t == A)
+        {
+            if(first > A)
+                first = A;
+            moved.push_back(Block[A]);
+            continue;
+        }
+
+        // also catches the untouched blocks out of the order, for example after the layer movement
+        if(!keptKeys.empty() && !s_blockOrderLess(keptKeys.back(), Block[A].Location))
+            unique = false;
+
+        keptKeys.push_back(Block[A].Location);
+    }
+
+    if(unique)
+    {
+        std::stable_sort(moved.begin(), moved.end(),
+            [](const Block_t &a, const Block_t &b)
+            {
+                return s_blockOrderLess(a.Location, b.Location);
+            });
+
+        for(size_t i = 0; i < moved.size() && unique; i++)
+        {
+            const Location_t &loc = moved[i].Location;
+
+            if(i > 0 && !s_blockOrderLess(moved[i - 1].Location, loc))
+                unique = false;
+
+            auto k = std::lower_bound(keptKeys.begin(), keptKeys.end(), loc, s_blockOrderLess);
+            if(k != keptKeys.end() && !s_blockOrderLess(loc, *k))
+                unique = false;
+        }
+    }
+
+    if(!unique)
+    {
+        s_blockOrderTouched.clear();
+        s_blockOrderFullSort();
+        return;
+    }
+
+    // pack the untouched blocks to the array begin
+    t = s_blockOrderTouched.begin();
+    int kept = first - 1;
+
+    for(int A = first; A <= numBlock; A++)
+    {
+        while(t != s_blockOrderTouched.end() && *t < A)
+            ++t;
+
+        if(t != s_blockOrderTouched.end() && *t == A)
+            continue;
+
+        Block[++kept] = Block[A];
+    }
+
+    s_blockOrderTouched.clear();
+
+    // merge from the end, every block gets moved once
+    int A = kept;
+    int W = numBlock;
+    int B = (int)moved.size() - 1;
+
+    while(B >= 0)
+    {
+        if(A >= 1 && s_blockOrderLess(moved[B].Location, Block[A].Location))
+            Block[W--] = Block[A--];
+        else
+            Block[W--] = moved[B--];
+    }
+
+    if(first > W + 1)
+        first = W + 1;
+
+    FindSBlocks();
+    FindBlocks();
+
+    if(first <= numBlock)
+        syncLayersTrees_BlocksFrom(first);
+}
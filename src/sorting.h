@@ -59,5 +59,23 @@ void UpdateBackgrounds();
 // Public Sub qSortTempBlocksX(min As Integer, max As Integer)
 void qSortTempBlocksX(int min, int max);
 
+/*!
+ * \brief Mark the block slot as changed: a block was appended there, moved there from another slot, or moved by location
+ *
+ * The touched blocks get their places at the X/Y order by blockOrderFinish(),
+ * the rest of the blocks are expected to keep their order.
+ */
+void blockOrderTouch(int A);
+/*!
+ * \brief Restore the X/Y order of the blocks after the blockOrderTouch() calls
+ *
+ * Does the same as the qSortBlocksX(), qSortBlocksY() by the columns, FindSBlocks(), FindBlocks()
+ * and syncLayersTrees_AllBlocks() sequence, but merges the touched blocks into the untouched ones,
+ * and resyncs the block trees from the first moved slot only. Falls back to the full sort
+ * if the untouched blocks are out of order (for example, after the layer movement), or if
+ * any two blocks have the same X and Y: the quicksort order of such blocks depends on their slots.
+ */
+void blockOrderFinish();
+
 
 #endif // SORTING_H
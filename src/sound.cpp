@@ -21,6 +21,9 @@
 #include <SDL2/SDL_timer.h>
 #include <SDL2/SDL_atomic.h>
 #include <SDL2/SDL_mixer_ext.h>
+#ifndef PGE_NO_THREADING
+#include <SDL2/SDL_thread.h>
+#endif
 
 #include "globals.h"
 #include "global_dirs.h"
@@ -30,6 +33,7 @@
 #include "pge_delay.h"
 
 #include "sound.h"
+#include "main/asset_pack.h"
 
 #ifdef THEXTECH_ENABLE_AUDIO_FX
 #include "sound/fx/reverb.h"
@@ -40,6 +44,7 @@
 #include <IniProcessor/ini_processing.h>
 #include <Utils/files.h>
 #include <Utils/strings.h>
+#include <vector>
 #include <unordered_map>
 #include <fmt_format_ne.h>
 
@@ -133,6 +138,16 @@ struct Music_t
     int yoshiModeTrack = -1;
 };
 
+//! Which sound effects are kept when too many ones are played at once
+enum SfxPriority
+{
+    //! Frequent sounds of the bursts (coins, hits, bubbles)
+    SFX_PRIORITY_LOW = 0,
+    SFX_PRIORITY_NORMAL,
+    //! Never dropped and may take the channel of a less important sound
+    SFX_PRIORITY_HIGH
+};
+
 struct SFX_t
 {
     std::string path;
@@ -144,10 +159,19 @@ struct SFX_t
     bool isSilentOrig = false;
     int volume = 128;
     int channel = -1;
+    int priority = SFX_PRIORITY_NORMAL;
+
+    inline bool isLoaded() const
+    {
+        return chunk || isSilent;
+    }
 };
 
 static std::unordered_map<std::string, Music_t> music;
-static std::unordered_map<std::string, SFX_t>   sound;
+//! Sound effects by their number, the 0 is unused
+static std::vector<SFX_t> s_sfx;
+//! Names of the sound effects for the ini files and the scripts
+static std::unordered_map<std::string, int> s_sfxAliases;
 
 //! Sounds played by scripts
 static SDL_atomic_t                                extSfxBusy;
@@ -155,8 +179,43 @@ static std::unordered_map<std::string, Mix_Chunk*> extSfx;
 static std::unordered_map<int, std::string>        extSfxPlaying;
 static void extSfxStopCallback(int channel);
 
+static void s_musicPrefetchClear();
+
 static const int maxSfxChannels = 91;
 
+//! Most sound effects started during one game tick, the rest of not important ones is dropped
+static const int c_sfxMaxStartsPerTick = 8;
+static int s_sfxStartsThisTick = 0;
+//! Sound effect started at the channel and its priority, to find the channel to take over
+static Mix_Chunk *s_channelChunk[maxSfxChannels] = {};
+static int s_channelPriority[maxSfxChannels] = {};
+
+static const std::unordered_map<int, int> s_sfxDefaultPriority =
+{
+    {SFX_BlockHit, SFX_PRIORITY_LOW}, {SFX_ShellHit, SFX_PRIORITY_LOW},
+    {SFX_Skid, SFX_PRIORITY_LOW}, {SFX_Coin, SFX_PRIORITY_LOW},
+    {SFX_Lava, SFX_PRIORITY_LOW}, {SFX_Fireball, SFX_PRIORITY_LOW},
+    {SFX_Bullet, SFX_PRIORITY_LOW}, {SFX_SonicRing, SFX_PRIORITY_LOW},
+    {SFX_WartBubbles, SFX_PRIORITY_LOW}, {SFX_Climbing, SFX_PRIORITY_LOW},
+    {SFX_Swim, SFX_PRIORITY_LOW}, {SFX_Saw, SFX_PRIORITY_LOW},
+    {SFX_ZeldaGrass, SFX_PRIORITY_LOW}, {SFX_Bubble, SFX_PRIORITY_LOW},
+    {SFX_Iceball, SFX_PRIORITY_LOW},
+
+    {SFX_PlayerShrink, SFX_PRIORITY_HIGH}, {SFX_PlayerGrow, SFX_PRIORITY_HIGH},
+    {SFX_PlayerDied, SFX_PRIORITY_HIGH}, {SFX_1up, SFX_PRIORITY_HIGH},
+    {SFX_CardRouletteClear, SFX_PRIORITY_HIGH}, {SFX_BossBeat, SFX_PRIORITY_HIGH},
+    {SFX_DungeonClear, SFX_PRIORITY_HIGH}, {SFX_NewPath, SFX_PRIORITY_HIGH},
+    {SFX_LevelSelect, SFX_PRIORITY_HIGH}, {SFX_Do, SFX_PRIORITY_HIGH},
+    {SFX_Pause, SFX_PRIORITY_HIGH}, {SFX_Key, SFX_PRIORITY_HIGH},
+    {SFX_PSwitch, SFX_PRIORITY_HIGH}, {SFX_CrystalBallExit, SFX_PRIORITY_HIGH},
+    {SFX_BirdoBeat, SFX_PRIORITY_HIGH}, {SFX_BowserKilled, SFX_PRIORITY_HIGH},
+    {SFX_GameBeat, SFX_PRIORITY_HIGH}, {SFX_Message, SFX_PRIORITY_HIGH},
+    {SFX_GotStar, SFX_PRIORITY_HIGH}, {SFX_PlayerDied2, SFX_PRIORITY_HIGH},
+    {SFX_Checkpoint, SFX_PRIORITY_HIGH}, {SFX_TapeExit, SFX_PRIORITY_HIGH},
+    {SFX_WartKilled, SFX_PRIORITY_HIGH}, {SFX_SMKilled, SFX_PRIORITY_HIGH},
+    {SFX_ZeldaDied, SFX_PRIORITY_HIGH}, {SFX_PSwitchTimeout, SFX_PRIORITY_HIGH}
+};
+
 int CustomWorldMusicId()
 {
     return g_customWldMusicId;
@@ -232,19 +291,22 @@ void QuitMixerX()
         return;
 
     UnloadExtSounds();
+    s_musicPrefetchClear();
 
     noSound = true;
     if(g_curMusic)
         Mix_FreeMusic(g_curMusic);
     g_curMusic = nullptr;
 
-    for(auto & it : sound)
+    for(auto &s : s_sfx)
     {
-        auto &s = it.second;
         if(s.chunk)
             Mix_FreeChunk(s.chunk);
+        if(s.chunkOrig)
+            Mix_FreeChunk(s.chunkOrig);
     }
-    sound.clear();
+    s_sfx.clear();
+    s_sfxAliases.clear();
     music.clear();
     Mix_CloseAudio();
     Mix_Quit();
@@ -300,9 +362,20 @@ static void RestoreSfx(SFX_t &u)
     }
 }
 
+//! Load the sound effect from the asset pack if it's there, or from the file
+static Mix_Chunk *s_loadChunk(const std::string &path)
+{
+    const AssetPack::Entry_t *packed = AssetPack::find(path);
+
+    if(packed)
+        return Mix_LoadWAV_RW(SDL_RWFromConstMem(packed->data, (int)packed->size), 1);
+
+    return Mix_LoadWAV(path.c_str());
+}
+
 static void AddSfx(SoundScope root,
                    IniProcessing &ini,
-                   const std::string &alias,
+                   int id,
                    const std::string &group,
                    bool isCustom = false)
 {
@@ -316,11 +389,9 @@ static void AddSfx(SoundScope root,
     {
         if(isCustom)
         {
-            auto s = sound.find(alias);
-
-            if(s != sound.end())
+            if(id < (int)s_sfx.size() && s_sfx[id].isLoaded())
             {
-                auto &m = s->second;
+                auto &m = s_sfx[id];
 
                 std::string newPath;
                 if(root == SoundScope::global)
@@ -341,7 +412,7 @@ static void AddSfx(SoundScope root,
                 m.customPath = newPath;
 
                 if(!isSilent)
-                    m.chunk = Mix_LoadWAV((newPath).c_str());
+                    m.chunk = s_loadChunk(newPath);
 
                 if(m.chunk || isSilent)
                 {
@@ -376,9 +447,9 @@ static void AddSfx(SoundScope root,
                 m.path = g_dirCustom.resolveFileCaseAbs(f);
 
             m.isSilent = isSilent;
-            pLogDebug("Adding SFX [%s] '%s'", alias.c_str(), isSilent ? "<silence>" : m.path.c_str());
+            pLogDebug("Adding SFX [sound%d] '%s'", id, isSilent ? "<silence>" : m.path.c_str());
             if(!isSilent)
-                m.chunk = Mix_LoadWAV(m.path.c_str());
+                m.chunk = s_loadChunk(m.path);
 
             if(m.chunk || isSilent)
             {
@@ -386,7 +457,16 @@ static void AddSfx(SoundScope root,
                 ini.read("single-channel", isSingleChannel, false);
                 if(isSingleChannel)
                     m.channel = g_reservedChannels++;
-                sound.insert({alias, m});
+
+                auto p = s_sfxDefaultPriority.find(id);
+                if(p != s_sfxDefaultPriority.end())
+                    m.priority = p->second;
+                ini.read("priority", m.priority, m.priority);
+
+                if(id >= (int)s_sfx.size())
+                    s_sfx.resize(id + 1);
+                s_sfx[id] = m;
+                s_sfxAliases.insert({fmt::format_ne("sound{0}", id), id});
             }
             else
             {
@@ -463,6 +543,299 @@ static void processPathArgs(std::string &path,
     path = p[0] + "|" + p[1];
 }
 
+//! Count of the music files opened in advance
+static const int c_musicPrefetchSlots = 2;
+
+struct MusicPrefetch_t
+{
+    //! Path with arguments as passed to the Mix_LoadMUS()
+    std::string path;
+    Mix_Music *music = nullptr;
+#ifndef PGE_NO_THREADING
+    SDL_Thread *thread = nullptr;
+#endif
+    SDL_atomic_t done;
+    //! Time of the opening in milliseconds
+    Uint32 loadTime = 0;
+};
+
+static MusicPrefetch_t s_musicPrefetch[c_musicPrefetchSlots];
+
+//! Level music start waiting for its prefetch to finish, the current music keeps playing until then
+static bool s_musicWaitPrefetch = false;
+static int  s_musicWaitA = 0;
+static int  s_musicWaitFadeInMs = 0;
+
+//! Sections of the players at the latest check, the music gets prefetched when they change
+static std::vector<int> s_musicPrefetchSections;
+
+#ifndef PGE_NO_THREADING
+static int s_musicPrefetchThread(void *data)
+{
+    auto *slot = reinterpret_cast<MusicPrefetch_t *>(data);
+
+    Uint32 start = SDL_GetTicks();
+    slot->music = Mix_LoadMUS(slot->path.c_str());
+    slot->loadTime = SDL_GetTicks() - start;
+
+    SDL_AtomicSet(&slot->done, 1);
+
+    return 0;
+}
+#endif
+
+static void s_musicPrefetchFree(MusicPrefetch_t &slot)
+{
+#ifndef PGE_NO_THREADING
+    if(slot.thread)
+    {
+        SDL_WaitThread(slot.thread, nullptr);
+        slot.thread = nullptr;
+    }
+#endif
+
+    if(slot.music)
+        Mix_FreeMusic(slot.music);
+
+    slot.music = nullptr;
+    slot.path.clear();
+    SDL_AtomicSet(&slot.done, 0);
+}
+
+/*!
+ * \brief Can the music be opened outside of the main thread
+ * \param path Path with arguments as passed to the Mix_LoadMUS()
+ *
+ * The MIDI synthesizers (Timidity, etc.) and the game music emulators are
+ * sharing the global state between the opened songs, only the streamed formats
+ * are safe to open while the other music is playing.
+ */
+static bool s_musicPrefetchSafe(const std::string &path)
+{
+    static const char *const safeExts[] =
+    {
+        ".ogg", ".oga", ".opus", ".mp3", ".flac", ".wav", ".aif", ".aiff", ".voc"
+    };
+
+    std::string file = path.substr(0, path.find('|'));
+    size_t dot = file.find_last_of("./\\");
+
+    if(dot == std::string::npos || file[dot] != '.')
+        return false;
+
+    std::string ext = file.substr(dot);
+    for(char &c : ext)
+        c = (char)SDL_tolower(c);
+
+    for(const char *e : safeExts)
+    {
+        if(ext == e)
+            return true;
+    }
+
+    return false;
+}
+
+static MusicPrefetch_t *s_musicPrefetchFind(const std::string &path)
+{
+    for(auto &slot : s_musicPrefetch)
+    {
+        if(!slot.path.empty() && slot.path == path)
+            return &slot;
+    }
+
+    return nullptr;
+}
+
+//! Start opening the music at the background
+static void s_musicPrefetchStart(const std::string &path)
+{
+#ifndef PGE_NO_THREADING
+    if(path.empty() || !s_musicPrefetchSafe(path) || s_musicPrefetchFind(path))
+        return;
+
+    MusicPrefetch_t *free = nullptr;
+
+    for(auto &slot : s_musicPrefetch)
+    {
+        if(slot.path.empty())
+        {
+            free = &slot;
+            break;
+        }
+
+        if(!free && SDL_AtomicGet(&slot.done) == 1)
+            free = &slot; // replace the unused one
+    }
+
+    if(!free)
+        return; // all slots are busy by the opening
+
+    s_musicPrefetchFree(*free);
+
+    free->path = path;
+    free->thread = SDL_CreateThread(s_musicPrefetchThread, "MusicPrefetch", free);
+
+    if(!free->thread)
+    {
+        pLogWarning("Can't start the music prefetch thread: %s", SDL_GetError());
+        free->path.clear();
+        return;
+    }
+
+    D_pLogDebug("Prefetching the music [%s]", path.c_str());
+#else
+    (void)path;
+#endif
+}
+
+//! Is the music being opened at the background right now
+static bool s_musicPrefetchBusy(const std::string &path)
+{
+    MusicPrefetch_t *slot = s_musicPrefetchFind(path);
+    return slot && SDL_AtomicGet(&slot->done) == 0;
+}
+
+/*!
+ * \brief Open the music, takes the prefetched one if available
+ * \param path Path with arguments to open
+ * \return Opened music or nullptr on error
+ */
+static Mix_Music *s_openMusic(const std::string &path)
+{
+    MusicPrefetch_t *slot = s_musicPrefetchFind(path);
+
+    if(slot)
+    {
+#ifndef PGE_NO_THREADING
+        SDL_WaitThread(slot->thread, nullptr);
+        slot->thread = nullptr;
+#endif
+        Mix_Music *ret = slot->music;
+        pLogDebug("Music [%s] has been prefetched, opened in %u ms", path.c_str(), slot->loadTime);
+
+        slot->music = nullptr;
+        s_musicPrefetchFree(*slot);
+
+        if(ret)
+            return ret;
+    }
+
+    Uint32 start = SDL_GetTicks();
+    Mix_Music *ret = Mix_LoadMUS(path.c_str());
+    pLogDebug("Music [%s] opened in %u ms", path.c_str(), SDL_GetTicks() - start);
+
+    return ret;
+}
+
+//! Path of the music at the section as it's opened by the StartMusic()
+static std::string s_sectionMusicPath(int section)
+{
+    std::string p;
+    int mus = bgMusic[section];
+
+    if(mus == g_customLvlMusicId)
+    {
+        if(CustomMusic[section].empty())
+            return p;
+
+        p = FileNamePath + CustomMusic[section];
+        int yoshiTrack = -1;
+        processPathArgs(p, FileNamePath, FileName + "/", &yoshiTrack);
+    }
+    else
+    {
+        auto m = music.find(fmt::format_ne("music{0}", mus));
+        if(m == music.end())
+            return p;
+
+        p = m->second.path;
+        processPathArgs(p, FileNamePath + "/", FileName + "/");
+    }
+
+    return p;
+}
+
+static inline bool s_sectionHasPoint(int section, double x, double y)
+{
+    const Location_t &s = level[section];
+    return x >= s.X && x <= s.Width && y >= s.Y && y <= s.Height;
+}
+
+//! Prefetch the music of the sections reachable from the given one by the warps
+static void s_musicPrefetchNear(int section)
+{
+    std::string curPath = s_sectionMusicPath(section);
+
+    for(int i = 1; i <= numWarps; ++i)
+    {
+        const Warp_t &w = Warp[i];
+
+        if(w.LevelEnt || w.MapWarp || w.LevelWarp > 0)
+            continue;
+
+        const Location_t *to = nullptr;
+
+        if(s_sectionHasPoint(section, w.Entrance.X, w.Entrance.Y))
+            to = &w.Exit;
+        else if(w.twoWay && s_sectionHasPoint(section, w.Exit.X, w.Exit.Y))
+            to = &w.Entrance;
+
+        if(!to)
+            continue;
+
+        for(int B = 0; B <= numSections; ++B)
+        {
+            if(B == section || !s_sectionHasPoint(B, to->X, to->Y))
+                continue;
+
+            std::string p = s_sectionMusicPath(B);
+            if(!p.empty() && p != curPath)
+                s_musicPrefetchStart(p);
+
+            break;
+        }
+    }
+}
+
+//! Prefetch the music for the next sections when any player changes the section
+static void s_musicPrefetchUpdate()
+{
+    if(LevelSelect || GameMenu || GameOutro || numPlayers <= 0)
+        return;
+
+    if(s_musicWaitPrefetch && !s_musicPrefetchBusy(s_sectionMusicPath(s_musicWaitA)))
+    {
+        s_musicWaitPrefetch = false;
+        StartMusic(s_musicWaitA, s_musicWaitFadeInMs);
+    }
+
+    if((int)s_musicPrefetchSections.size() != numPlayers)
+        s_musicPrefetchSections.assign(numPlayers, -1);
+
+    for(int i = 1; i <= numPlayers; ++i)
+    {
+        int section = Player[i].Section;
+        if(s_musicPrefetchSections[i - 1] == section)
+            continue;
+
+        s_musicPrefetchSections[i - 1] = section;
+        if(section >= 0 && section <= numSections)
+            s_musicPrefetchNear(section);
+    }
+}
+
+//! Close all prefetched music, when the level gets changed
+static void s_musicPrefetchClear()
+{
+    for(auto &slot : s_musicPrefetch)
+        s_musicPrefetchFree(slot);
+
+    s_musicPrefetchSections.clear();
+    s_musicWaitPrefetch = false;
+}
+
+
 void PlayMusic(const std::string &Alias, int fadeInMs)
 {
     if(noSound)
@@ -481,7 +854,7 @@ void PlayMusic(const std::string &Alias, int fadeInMs)
         auto &m = mus->second;
         std::string p = m.path;
         processPathArgs(p, FileNamePath + "/", FileName + "/");
-        g_curMusic = Mix_LoadMUS(p.c_str());
+        g_curMusic = s_openMusic(p);
 
         if(!g_curMusic)
             pLogWarning("Music '%s' opening error: %s", m.path.c_str(), Mix_GetError());
@@ -507,23 +880,76 @@ void PlayMusic(const std::string &Alias, int fadeInMs)
         pLogWarning("Unknown music alias '%s'", Alias.c_str());
 }
 
-void PlaySfx(const std::string &Alias, int loops, int volume)
+//! Find the channel playing a less important sound effect than the given priority
+static int s_findChannelToTake(int priority)
 {
-    auto sfx = sound.find(Alias);
-    if(sfx != sound.end())
+    int found = -1;
+    int foundPriority = priority;
+
+    for(int c = g_reservedChannels; c < maxSfxChannels; ++c)
     {
-        auto &s = sfx->second;
-        if(!s.isSilent)
-            Mix_PlayChannelVol(s.channel, s.chunk, loops, volume);
+        // Skip channels played by the scripts
+        if(!s_channelChunk[c] || Mix_GetChunk(c) != s_channelChunk[c] || !Mix_Playing(c))
+            continue;
+
+        if(s_channelPriority[c] < foundPriority)
+        {
+            found = c;
+            foundPriority = s_channelPriority[c];
+            if(foundPriority == SFX_PRIORITY_LOW)
+                break;
+        }
     }
+
+    return found;
+}
+
+static void s_playSfx(const SFX_t &s, int loops, int volume)
+{
+    if(s.isSilent || !s.chunk)
+        return;
+
+    // Too many sounds at once: keep the mix and the channels for the important ones
+    if(s_sfxStartsThisTick >= c_sfxMaxStartsPerTick && s.priority < SFX_PRIORITY_HIGH)
+        return;
+
+    int ch = Mix_PlayChannelVol(s.channel, s.chunk, loops, volume);
+
+    if(ch < 0 && s.channel < 0) // All channels are busy
+    {
+        int taken = s_findChannelToTake(s.priority);
+        if(taken >= 0)
+        {
+            Mix_HaltChannel(taken);
+            ch = Mix_PlayChannelVol(taken, s.chunk, loops, volume);
+        }
+    }
+
+    if(ch < 0)
+        return;
+
+    s_sfxStartsThisTick++;
+
+    if(ch < maxSfxChannels)
+    {
+        s_channelChunk[ch] = s.chunk;
+        s_channelPriority[ch] = s.priority;
+    }
+}
+
+void PlaySfx(const std::string &Alias, int loops, int volume)
+{
+    auto sfx = s_sfxAliases.find(Alias);
+    if(sfx != s_sfxAliases.end())
+        s_playSfx(s_sfx[sfx->second], loops, volume);
 }
 
 void StopSfx(const std::string &Alias)
 {
-    auto sfx = sound.find(Alias);
-    if(sfx != sound.end())
+    auto sfx = s_sfxAliases.find(Alias);
+    if(sfx != s_sfxAliases.end())
     {
-        auto &s = sfx->second;
+        auto &s = s_sfx[sfx->second];
         if(!s.isSilent)
             Mix_HaltChannel(s.channel);
     }
@@ -577,6 +1003,7 @@ void StartMusic(int A, int fadeInMs)
     }
 
     D_pLogDebug("Start music A=%d", A);
+    s_musicWaitPrefetch = false;
 
     if(noSound)
     {
@@ -598,7 +1025,7 @@ void StartMusic(int A, int fadeInMs)
                 Mix_FreeMusic(g_curMusic);
             std::string p = FileNamePath + "/" + curWorldMusicFile;
             processPathArgs(p, FileNamePath + "/", FileName + "/");
-            g_curMusic = Mix_LoadMUS(p.c_str());
+            g_curMusic = s_openMusic(p);
             s_musicHasYoshiMode = false;
             s_musicYoshiTrackNumber = -1;
             Mix_VolumeMusicStream(g_curMusic, 64);
@@ -630,6 +1057,18 @@ void StartMusic(int A, int fadeInMs)
     }
     else if(PSwitchTime == 0 && PSwitchStop == 0) // level music
     {
+        if(A >= 0 && A <= maxSections && s_musicPrefetchBusy(s_sectionMusicPath(A)))
+        {
+            // Keep the current music until the new one gets opened at the background,
+            // but report the new one already, so the section changes are compared with it
+            curMusic = bgMusic[A];
+            s_musicWaitA = A;
+            s_musicWaitFadeInMs = fadeInMs;
+            s_musicWaitPrefetch = true;
+            D_pLogDebug("Music start A=%d waits for the prefetch", A);
+            return;
+        }
+
         StopMusic();
         curMusic = bgMusic[A];
         std::string mus = fmt::format_ne("music{0}", curMusic);
@@ -641,7 +1080,7 @@ void StartMusic(int A, int fadeInMs)
             std::string p = FileNamePath + CustomMusic[A];
             s_musicYoshiTrackNumber = -1;
             processPathArgs(p, FileNamePath, FileName + "/", &s_musicYoshiTrackNumber);
-            g_curMusic = Mix_LoadMUS(p.c_str());
+            g_curMusic = s_openMusic(p);
             if(!g_curMusic)
                 pLogWarning("Failed to open the music [%s]: ", p.c_str(), Mix_GetError());
             else
@@ -674,6 +1113,8 @@ void StartMusic(int A, int fadeInMs)
 
 void StopMusic()
 {
+    s_musicWaitPrefetch = false;
+
     if(!musicPlaying || noSound)
         return;
 
@@ -836,9 +1277,8 @@ static void loadCustomSfxIni(SoundScope root, const std::string &path)
     IniProcessing sounds(path);
     for(unsigned int i = 1; i <= g_totalSounds; ++i)
     {
-        std::string alias = fmt::format_ne("sound{0}", i);
         std::string group = fmt::format_ne("sound-{0}", i);
-        AddSfx(root, sounds, alias, group, true);
+        AddSfx(root, sounds, int(i), group, true);
     }
 
 #ifdef THEXTECH_ENABLE_AUDIO_FX
@@ -876,11 +1316,8 @@ static void loadCustomSfxIni(SoundScope root, const std::string &path)
 
 static void restoreDefaultSfx()
 {
-    for(auto &s : sound)
-    {
-        auto &u = s.second;
-        RestoreSfx(u);
-    }
+    for(auto &s : s_sfx)
+        RestoreSfx(s);
 
 #ifdef THEXTECH_ENABLE_AUDIO_FX
     s_effectsList.clear();
@@ -951,11 +1388,11 @@ void InitSound()
         playerHammerSFX = SFX_Fireball;
 
     UpdateLoad();
+    s_sfx.reserve(g_totalSounds + 1);
     for(unsigned int i = 1; i <= g_totalSounds; ++i)
     {
-        std::string alias = fmt::format_ne("sound{0}", i);
         std::string group = fmt::format_ne("sound-{0}", i);
-        AddSfx(SoundScope::global, sounds, alias, group);
+        AddSfx(SoundScope::global, sounds, int(i), group);
     }
     UpdateLoad();
     Mix_ReserveChannels(g_reservedChannels);
@@ -1048,8 +1485,8 @@ void PlaySound(int A, int loops, int volume)
 
     if(SoundPause[A] == 0) // if the sound wasn't just played
     {
-        std::string alias = fmt::format_ne("sound{0}", A);
-        PlaySfx(alias, loops, volume);
+        if(A > 0 && A < (int)s_sfx.size())
+            s_playSfx(s_sfx[A], loops, volume);
         s_resetSoundDelay(A);
     }
 }
@@ -1058,8 +1495,8 @@ void PlaySoundMenu(int A, int loops)
 {
     if(SoundPause[A] == 0) // if the sound wasn't just played
     {
-        std::string alias = fmt::format_ne("sound{0}", A);
-        PlaySfx(alias, loops);
+        if(A > 0 && A < (int)s_sfx.size())
+            s_playSfx(s_sfx[A], loops, 128);
         s_resetSoundDelay(A);
     }
 }
@@ -1077,6 +1514,9 @@ void UpdateSound()
 {
     if(noSound)
         return;
+
+    s_sfxStartsThisTick = 0;
+    s_musicPrefetchUpdate();
     For(A, 1, numSounds)
     {
         if(SoundPause[A] > 0)
@@ -1092,6 +1532,8 @@ void LoadCustomSound()
     if(GameMenu || GameOutro)
         return; // Don't load custom music in menu mode
 
+    s_musicPrefetchClear();
+
     // To avoid bugs like custom local sounds was transferred into another level, it's need to clean-up old one if that was
     if(g_customMusicInDataFolder)
     {
@@ -1135,6 +1577,7 @@ void UnloadCustomSound()
 {
     if(noSound)
         return;
+    s_musicPrefetchClear();
     loadMusicIni(SoundScope::global, musicIni, true);
     restoreDefaultSfx();
     g_customMusicInDataFolder = false;
@@ -0,0 +1,111 @@
+/*
+ * SIMD kernels selection of the sound effects
+ *
+ * Copyright (c) 2022-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "fx_simd.h"
+#include "fx_simd.hpp"
+
+
+static bool s_cpuHasSSE2()
+{
+#if !defined(FX_SIMD_HAS_SSE2)
+    return false;
+#elif defined(__x86_64__) || defined(_M_X64)
+    return true; // Always present at x86_64
+#elif defined(__GNUC__)
+    return __builtin_cpu_supports("sse2");
+#else
+    return true; // The build targets the SSE2 already
+#endif
+}
+
+static bool s_cpuHasNEON()
+{
+#if defined(FX_SIMD_HAS_NEON)
+    return true; // Always present at AArch64, and required by the ARMv7 build with NEON
+#else
+    return false;
+#endif
+}
+
+static int s_backend = -1;
+
+
+bool fxSimdIsAvailable(FxSimdBackend backend)
+{
+    switch(backend)
+    {
+    case FX_SIMD_SCALAR:
+        return true;
+    case FX_SIMD_SSE2:
+        return s_cpuHasSSE2();
+    case FX_SIMD_NEON:
+        return s_cpuHasNEON();
+    default:
+        return false;
+    }
+}
+
+FxSimdBackend fxSimdBestBackend()
+{
+    if(fxSimdIsAvailable(FX_SIMD_NEON))
+        return FX_SIMD_NEON;
+
+    if(fxSimdIsAvailable(FX_SIMD_SSE2))
+        return FX_SIMD_SSE2;
+
+    return FX_SIMD_SCALAR;
+}
+
+FxSimdBackend fxSimdBackend()
+{
+    if(s_backend < 0)
+        s_backend = fxSimdBestBackend();
+
+    return (FxSimdBackend)s_backend;
+}
+
+bool fxSimdSetBackend(FxSimdBackend backend)
+{
+    if(!fxSimdIsAvailable(backend))
+        return false;
+
+    s_backend = backend;
+    return true;
+}
+
+const char *fxSimdBackendName(FxSimdBackend backend)
+{
+    switch(backend)
+    {
+    case FX_SIMD_SCALAR:
+        return "scalar";
+    case FX_SIMD_SSE2:
+        return "SSE2";
+    case FX_SIMD_NEON:
+        return "NEON";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * SIMD kernels selection of the sound effects
+ *
+ * Copyright (c) 2022-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FX_SIMD_H
+#define FX_SIMD_H
+
+enum FxSimdBackend
+{
+    FX_SIMD_SCALAR = 0,
+    FX_SIMD_SSE2,
+    FX_SIMD_NEON,
+    FX_SIMD_COUNT
+};
+
+// Is the backend built in and supported by this CPU
+extern bool fxSimdIsAvailable(FxSimdBackend backend);
+// The fastest available backend
+extern FxSimdBackend fxSimdBestBackend();
+
+// Backend used by the effects being initialized, the best one by default
+extern FxSimdBackend fxSimdBackend();
+// Force the backend for the next initialized effects, returns false if unavailable
+extern bool fxSimdSetBackend(FxSimdBackend backend);
+
+extern const char *fxSimdBackendName(FxSimdBackend backend);
+
+#endif // FX_SIMD_H
@@ -0,0 +1,261 @@
+/*
+ * 4-lane float vectors for the sound effects kernels
+ *
+ * Copyright (c) 2022-2022 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FX_SIMD_HPP
+#define FX_SIMD_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include "fx_format.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define FX_SIMD_HAS_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#   define FX_SIMD_HAS_NEON
+#   include <arm_neon.h>
+#endif
+
+// Float format of the CPU, the effects read and write it directly
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#   define FX_AUDIO_F32SYS AUDIO_F32MSB
+#else
+#   define FX_AUDIO_F32SYS AUDIO_F32LSB
+#endif
+
+/*
+ * Every backend provides the same set of the static functions over the
+ * vector of 4 floats, so the kernels are written once as templates.
+ * Loads and stores are unaligned.
+ */
+
+struct FxSimdScalar
+{
+    struct V
+    {
+        float f[4];
+    };
+
+    static inline V load(const float *p)
+    {
+        V r;
+        r.f[0] = p[0]; r.f[1] = p[1]; r.f[2] = p[2]; r.f[3] = p[3];
+        return r;
+    }
+
+    static inline void store(float *p, const V &a)
+    {
+        p[0] = a.f[0]; p[1] = a.f[1]; p[2] = a.f[2]; p[3] = a.f[3];
+    }
+
+    static inline V set(float a, float b, float c, float d)
+    {
+        V r;
+        r.f[0] = a; r.f[1] = b; r.f[2] = c; r.f[3] = d;
+        return r;
+    }
+
+    static inline V splat(float a)
+    {
+        return set(a, a, a, a);
+    }
+
+    static inline V add(const V &a, const V &b)
+    {
+        return set(a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3]);
+    }
+
+    static inline V sub(const V &a, const V &b)
+    {
+        return set(a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3]);
+    }
+
+    static inline V mul(const V &a, const V &b)
+    {
+        return set(a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3]);
+    }
+
+    static inline float flush(float a)
+    {
+        uint32_t i;
+        memcpy(&i, &a, sizeof(i));
+        return (i & 0x7f800000) == 0 ? 0.0f : a;
+    }
+
+    //! Replace the denormals (and zeros) by zeros
+    static inline V flush(const V &a)
+    {
+        return set(flush(a.f[0]), flush(a.f[1]), flush(a.f[2]), flush(a.f[3]));
+    }
+
+    //! [a1, a2, a3, b0], pushes the first lane of b into the history kept at a
+    static inline V shift(const V &a, const V &b)
+    {
+        return set(a.f[1], a.f[2], a.f[3], b.f[0]);
+    }
+
+    //! Sums of the lanes of two vectors at once
+    static inline void hsum2(const V &a, const V &b, float &sa, float &sb)
+    {
+        sa = (a.f[0] + a.f[2]) + (a.f[1] + a.f[3]);
+        sb = (b.f[0] + b.f[2]) + (b.f[1] + b.f[3]);
+    }
+};
+
+#ifdef FX_SIMD_HAS_SSE2
+struct FxSimdSSE2
+{
+    typedef __m128 V;
+
+    static inline V load(const float *p)
+    {
+        return _mm_loadu_ps(p);
+    }
+
+    static inline void store(float *p, const V &a)
+    {
+        _mm_storeu_ps(p, a);
+    }
+
+    static inline V set(float a, float b, float c, float d)
+    {
+        return _mm_setr_ps(a, b, c, d);
+    }
+
+    static inline V splat(float a)
+    {
+        return _mm_set1_ps(a);
+    }
+
+    static inline V add(const V &a, const V &b)
+    {
+        return _mm_add_ps(a, b);
+    }
+
+    static inline V sub(const V &a, const V &b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+
+    static inline V mul(const V &a, const V &b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+
+    static inline V flush(const V &a)
+    {
+        const __m128i exp = _mm_set1_epi32(0x7f800000);
+        __m128i zero = _mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(a), exp), _mm_setzero_si128());
+        return _mm_andnot_ps(_mm_castsi128_ps(zero), a);
+    }
+
+    static inline V shift(const V &a, const V &b)
+    {
+        // [a3, a3, b0, b0]
+        __m128 t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 3, 3));
+        return _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 2, 1));
+    }
+
+    static inline void hsum2(const V &a, const V &b, float &sa, float &sb)
+    {
+        // [a0 + a2, b0 + b2, a1 + a3, b1 + b3]
+        __m128 s = _mm_add_ps(_mm_unpacklo_ps(a, b), _mm_unpackhi_ps(a, b));
+        // [a0 + a2 + a1 + a3, b0 + b2 + b1 + b3, ...]
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        sa = _mm_cvtss_f32(s);
+        sb = _mm_cvtss_f32(_mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+};
+#endif // FX_SIMD_HAS_SSE2
+
+#ifdef FX_SIMD_HAS_NEON
+struct FxSimdNEON
+{
+    typedef float32x4_t V;
+
+    static inline V load(const float *p)
+    {
+        return vld1q_f32(p);
+    }
+
+    static inline void store(float *p, const V &a)
+    {
+        vst1q_f32(p, a);
+    }
+
+    static inline V set(float a, float b, float c, float d)
+    {
+        const float f[4] = {a, b, c, d};
+        return vld1q_f32(f);
+    }
+
+    static inline V splat(float a)
+    {
+        return vdupq_n_f32(a);
+    }
+
+    static inline V add(const V &a, const V &b)
+    {
+        return vaddq_f32(a, b);
+    }
+
+    static inline V sub(const V &a, const V &b)
+    {
+        return vsubq_f32(a, b);
+    }
+
+    static inline V mul(const V &a, const V &b)
+    {
+        // Not the vmlaq_f32, to keep the same rounding as other backends
+        return vmulq_f32(a, b);
+    }
+
+    static inline V flush(const V &a)
+    {
+        uint32x4_t i = vreinterpretq_u32_f32(a);
+        uint32x4_t zero = vceqq_u32(vandq_u32(i, vdupq_n_u32(0x7f800000)), vdupq_n_u32(0));
+        return vreinterpretq_f32_u32(vbicq_u32(i, zero));
+    }
+
+    static inline V shift(const V &a, const V &b)
+    {
+        return vextq_f32(a, b, 1);
+    }
+
+    static inline void hsum2(const V &a, const V &b, float &sa, float &sb)
+    {
+        // [a0 + a2, a1 + a3] and [b0 + b2, b1 + b3]
+        float32x2_t pa = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+        float32x2_t pb = vadd_f32(vget_low_f32(b), vget_high_f32(b));
+        float32x2_t s = vpadd_f32(pa, pb);
+        sa = vget_lane_f32(s, 0);
+        sb = vget_lane_f32(s, 1);
+    }
+};
+#endif // FX_SIMD_HAS_NEON
+
+#endif // FX_SIMD_HPP
@@ -25,9 +25,12 @@
 #include <vector>
 #include <deque>
 #include <cmath>
+#include <cstring>
 #include <tgmath.h>
 #include "reverb.h"
 #include "fx_common.hpp"
+#include "fx_simd.h"
+#include "fx_simd.hpp"
 
 
 // Code was taken from FreeVerb: https://github.com/sinshu/freeverb (Public Domain)
@@ -84,82 +87,45 @@ const int allpasstuningL4   = 225;
 const int allpasstuningR4   = 225 + stereospread;
 
 
-static inline void undenormalise(float &sample)
+// All combs of a channel get the same input, so they run at the lanes of the
+// 4-float vectors: [0] = L1-L4, [1] = L5-L8, [2] = R1-R4, [3] = R5-R8.
+// Every group keeps its lanes interleaved at one ring buffer with the common
+// write position, and every lane reads the sample written its delay ago.
+const int numcombgroups     = (numcombs * 2) / 4;
+const int combtunings[numcombgroups][4] =
 {
-    uint32_t i = *reinterpret_cast<uint32_t*>(&sample);
-    if((i & 0x7f800000) == 0)
-        sample = 0.0f;
-}
+    {combtuningL1, combtuningL2, combtuningL3, combtuningL4},
+    {combtuningL5, combtuningL6, combtuningL7, combtuningL8},
+    {combtuningR1, combtuningR2, combtuningR3, combtuningR4},
+    {combtuningR5, combtuningR6, combtuningR7, combtuningR8}
+};
+
+// Samples processed at once by the combs before passing them to the allpasses
+const int blocksize         = 256;
 
 
-class comb
+class combgroup
 {
 public:
-    comb()
+    void setbuffer(const int *delays, int ringsize)
     {
-        filterstore = 0;
-        bufidx = 0;
-    }
-
-    void setbuffer(float* buf, int size)
-    {
-        buffer = buf;
-        bufsize = size;
-    }
-
-    // Big to inline - but crucial for speed
-    inline float process(float input)
-    {
-        float output;
-
-        output = buffer[bufidx];
-        undenormalise(output);
-
-        filterstore = (output * damp2) + (filterstore * damp1);
-        undenormalise(filterstore);
-
-        buffer[bufidx] = input + (filterstore * feedback);
-
-        if(++bufidx >= bufsize) bufidx = 0;
-
-        return output;
+        ring.resize(static_cast<size_t>(ringsize) * 4);
+        for(int i = 0; i < 4; i++)
+        {
+            delay[i] = delays[i];
+            filterstore[i] = 0.f;
+        }
     }
 
     void mute()
     {
-        for(int i = 0; i < bufsize; i++)
-            buffer[i] = 0;
-    }
-
-    void setdamp(float val)
-    {
-        damp1 = val;
-        damp2 = 1 - val;
+        for(size_t i = 0; i < ring.size(); i++)
+            ring[i] = 0;
     }
 
-    float getdamp()
-    {
-        return damp1;
-    }
-
-    void setfeedback(float val)
-    {
-        feedback = val;
-    }
-
-    float getfeedback()
-    {
-        return feedback;
-    }
-
-private:
-    float   feedback = 0.f;
-    float   filterstore = 0.f;
-    float   damp1 = 0.f;
-    float   damp2 = 0.f;
-    float*  buffer = nullptr;
-    int     bufsize = 0;
-    int     bufidx = 0;
+    std::vector<float>  ring;
+    int                 delay[4] = {1, 1, 1, 1};
+    float               filterstore[4] = {0.f, 0.f, 0.f, 0.f};
 };
 
 
@@ -177,22 +143,48 @@ public:
         bufsize = size;
     }
 
-    // Big to inline - but crucial for speed
-    inline float process(float input)
+    /*
+     * Every sample reads the buffer cell written bufsize samples ago, so the
+     * samples up to the buffer wrap are independent and go by vectors.
+     */
+    template<class S>
+    inline void processblock(float* io, int numsamples)
     {
-        float output;
-        float bufout;
+        typedef typename S::V V;
+        const V fb = S::splat(feedback);
+
+        while(numsamples > 0)
+        {
+            int run = bufsize - bufidx;
+            if(run > numsamples)
+                run = numsamples;
+
+            float* buf = buffer + bufidx;
+            int i = 0;
 
-        bufout = buffer[bufidx];
-        undenormalise(bufout);
+            for(; i + 4 <= run; i += 4)
+            {
+                V input = S::load(io + i);
+                V bufout = S::flush(S::load(buf + i));
+                S::store(buf + i, S::add(input, S::mul(bufout, fb)));
+                S::store(io + i, S::sub(bufout, input));
+            }
 
-        output = -input + bufout;
-        buffer[bufidx] = input + (bufout * feedback);
+            for(; i < run; i++)
+            {
+                float input = io[i];
+                float bufout = FxSimdScalar::flush(buf[i]);
+                buf[i] = input + (bufout * feedback);
+                io[i] = bufout - input;
+            }
 
-        if(++bufidx >= bufsize)
-            bufidx = 0;
+            bufidx += run;
+            if(bufidx >= bufsize)
+                bufidx = 0;
 
-        return output;
+            io += run;
+            numsamples -= run;
+        }
     }
 
     void mute()
@@ -227,23 +219,31 @@ public:
     void setSampleRate(int rate)
     {
         rateScale = rate / 44100.0;
+
         // Prepare buffers
-        bufcombL1.resize(static_cast<size_t>(combtuningL1 * rateScale));
-        bufcombR1.resize(static_cast<size_t>(combtuningR1 * rateScale));
-        bufcombL2.resize(static_cast<size_t>(combtuningL2 * rateScale));
-        bufcombR2.resize(static_cast<size_t>(combtuningR2 * rateScale));
-        bufcombL3.resize(static_cast<size_t>(combtuningL3 * rateScale));
-        bufcombR3.resize(static_cast<size_t>(combtuningR3 * rateScale));
-        bufcombL4.resize(static_cast<size_t>(combtuningL4 * rateScale));
-        bufcombR4.resize(static_cast<size_t>(combtuningR4 * rateScale));
-        bufcombL5.resize(static_cast<size_t>(combtuningL5 * rateScale));
-        bufcombR5.resize(static_cast<size_t>(combtuningR5 * rateScale));
-        bufcombL6.resize(static_cast<size_t>(combtuningL6 * rateScale));
-        bufcombR6.resize(static_cast<size_t>(combtuningR6 * rateScale));
-        bufcombL7.resize(static_cast<size_t>(combtuningL7 * rateScale));
-        bufcombR7.resize(static_cast<size_t>(combtuningR7 * rateScale));
-        bufcombL8.resize(static_cast<size_t>(combtuningL8 * rateScale));
-        bufcombR8.resize(static_cast<size_t>(combtuningR8 * rateScale));
+        int delays[numcombgroups][4];
+        int maxdelay = 1;
+
+        for(int g = 0; g < numcombgroups; g++)
+        {
+            for(int i = 0; i < 4; i++)
+            {
+                delays[g][i] = static_cast<int>(combtunings[g][i] * rateScale);
+                if(delays[g][i] < 1)
+                    delays[g][i] = 1;
+                if(delays[g][i] > maxdelay)
+                    maxdelay = delays[g][i];
+            }
+        }
+
+        combringsize = 1;
+        while(combringsize < maxdelay)
+            combringsize <<= 1;
+        combpos = 0;
+
+        for(int g = 0; g < numcombgroups; g++)
+            combs[g].setbuffer(delays[g], combringsize);
+
         bufallpassL1.resize(static_cast<size_t>(allpasstuningL1 * rateScale));
         bufallpassR1.resize(static_cast<size_t>(allpasstuningR1 * rateScale));
         bufallpassL2.resize(static_cast<size_t>(allpasstuningL2 * rateScale));
@@ -254,22 +254,6 @@ public:
         bufallpassR4.resize(static_cast<size_t>(allpasstuningR4 * rateScale));
 
         // Tie the components to their buffers
-        combL[0].setbuffer(bufcombL1.data(), static_cast<int>(bufcombL1.size()));
-        combR[0].setbuffer(bufcombR1.data(), static_cast<int>(bufcombR1.size()));
-        combL[1].setbuffer(bufcombL2.data(), static_cast<int>(bufcombL2.size()));
-        combR[1].setbuffer(bufcombR2.data(), static_cast<int>(bufcombR2.size()));
-        combL[2].setbuffer(bufcombL3.data(), static_cast<int>(bufcombL3.size()));
-        combR[2].setbuffer(bufcombR3.data(), static_cast<int>(bufcombR3.size()));
-        combL[3].setbuffer(bufcombL4.data(), static_cast<int>(bufcombL4.size()));
-        combR[3].setbuffer(bufcombR4.data(), static_cast<int>(bufcombR4.size()));
-        combL[4].setbuffer(bufcombL5.data(), static_cast<int>(bufcombL5.size()));
-        combR[4].setbuffer(bufcombR5.data(), static_cast<int>(bufcombR5.size()));
-        combL[5].setbuffer(bufcombL6.data(), static_cast<int>(bufcombL6.size()));
-        combR[5].setbuffer(bufcombR6.data(), static_cast<int>(bufcombR6.size()));
-        combL[6].setbuffer(bufcombL7.data(), static_cast<int>(bufcombL7.size()));
-        combR[6].setbuffer(bufcombR7.data(), static_cast<int>(bufcombR7.size()));
-        combL[7].setbuffer(bufcombL8.data(), static_cast<int>(bufcombL8.size()));
-        combR[7].setbuffer(bufcombR8.data(), static_cast<int>(bufcombR8.size()));
         allpassL[0].setbuffer(bufallpassL1.data(), static_cast<int>(bufallpassL1.size()));
         allpassR[0].setbuffer(bufallpassR1.data(), static_cast<int>(bufallpassR1.size()));
         allpassL[1].setbuffer(bufallpassL2.data(), static_cast<int>(bufallpassL2.size()));
@@ -278,6 +262,9 @@ public:
         allpassR[2].setbuffer(bufallpassR3.data(), static_cast<int>(bufallpassR3.size()));
         allpassL[3].setbuffer(bufallpassL4.data(), static_cast<int>(bufallpassL4.size()));
         allpassR[3].setbuffer(bufallpassR4.data(), static_cast<int>(bufallpassR4.size()));
+
+        // Buffer will be full of rubbish - so we MUST mute them
+        mute();
     }
 
     revmodel()
@@ -297,6 +284,7 @@ public:
         setdamp(initialdamp);
         setwidth(initialwidth);
         setmode(initialmode);
+        setbackend(FX_SIMD_SCALAR);
 
         // Buffer will be full of rubbish - so we MUST mute them
         mute();
@@ -307,11 +295,8 @@ public:
         if(getmode() >= freezemode)
             return;
 
-        for(int i = 0; i < numcombs; i++)
-        {
-            combL[i].mute();
-            combR[i].mute();
-        }
+        for(int i = 0; i < numcombgroups; i++)
+            combs[i].mute();
 
         for(int i = 0; i < numallpasses; i++)
         {
@@ -320,77 +305,32 @@ public:
         }
     }
 
-    void processmix(float* inputL, float* inputR, float* outputL, float* outputR, long numsamples, int skip)
+    void setbackend(FxSimdBackend backend)
     {
-        float outL, outR, input;
-
-        while(numsamples-- > 0)
+        switch(backend)
         {
-            outL = outR = 0;
-            input = (*inputL + *inputR) * gain;
-
-            // Accumulate comb filters in parallel
-            for(int i = 0; i < numcombs; i++)
-            {
-                outL += combL[i].process(input);
-                outR += combR[i].process(input);
-            }
-
-            // Feed through allpasses in series
-            for(int i = 0; i < numallpasses; i++)
-            {
-                outL = allpassL[i].process(outL);
-                outR = allpassR[i].process(outR);
-            }
-
-            // Calculate output MIXING with anything already there
-            *outputL += outL * wet1 + outR * wet2 + *inputL * dry;
-            *outputR += outR * wet1 + outL * wet2 + *inputR * dry;
-
-            // Increment sample pointers, allowing for interleave (if any)
-            inputL += skip;
-            inputR += skip;
-            outputL += skip;
-            outputR += skip;
+#ifdef FX_SIMD_HAS_SSE2
+        case FX_SIMD_SSE2:
+            kernel = &revmodel::processreplace<FxSimdSSE2>;
+            break;
+#endif
+#ifdef FX_SIMD_HAS_NEON
+        case FX_SIMD_NEON:
+            kernel = &revmodel::processreplace<FxSimdNEON>;
+            break;
+#endif
+        default:
+            kernel = &revmodel::processreplace<FxSimdScalar>;
+            break;
         }
     }
 
-    void processreplace(float* inputL, float* inputR, float* outputL, float* outputR, long numsamples, int skip)
+    // Calculate output REPLACING anything already there
+    inline void process(const float* inputL, const float* inputR, float* outputL, float* outputR, long numsamples)
     {
-        float outL, outR, input;
-
-        while(numsamples-- > 0)
-        {
-            outL = outR = 0;
-            input = (*inputL + *inputR) * gain;
-
-            // Accumulate comb filters in parallel
-            for(int i = 0; i < numcombs; i++)
-            {
-                outL += combL[i].process(input);
-                outR += combR[i].process(input);
-            }
-
-            // Feed through allpasses in series
-            for(int i = 0; i < numallpasses; i++)
-            {
-                outL = allpassL[i].process(outL);
-                outR = allpassR[i].process(outR);
-            }
-
-            // Calculate output REPLACING anything already there
-            *outputL = outL * wet1 + outR * wet2 + *inputL * dry;
-            *outputR = outR * wet1 + outL * wet2 + *inputR * dry;
-
-            // Increment sample pointers, allowing for interleave (if any)
-            inputL += skip;
-            inputR += skip;
-            outputL += skip;
-            outputR += skip;
-        }
+        (this->*kernel)(inputL, inputR, outputL, outputR, numsamples);
     }
 
-
     // The following get/set functions are not inlined, because
     // speed is never an issue when calling them, and also
     // because as you develop the reverb model, you may
@@ -469,8 +409,6 @@ private:
     {
         // Recalculate internal values after parameter change
 
-        int i;
-
         wet1 = wet * (width / 2 + 0.5f);
         wet2 = wet * ((1 - width) / 2);
 
@@ -487,20 +425,102 @@ private:
             gain = fixedgain;
         }
 
-        for(i = 0; i < numcombs; i++)
-        {
-            combL[i].setfeedback(roomsize1);
-            combR[i].setfeedback(roomsize1);
-        }
+        combfeedback = roomsize1;
+        combdamp1 = damp1;
+        combdamp2 = 1 - damp1;
+    }
 
-        for(i = 0; i < numcombs; i++)
+    template<class S>
+    void processreplace(const float* inputL, const float* inputR, float* outputL, float* outputR, long numsamples)
+    {
+        typedef typename S::V V;
+
+        float outL[blocksize];
+        float outR[blocksize];
+
+        const V feedback = S::splat(combfeedback);
+        const V cdamp1 = S::splat(combdamp1);
+        const V cdamp2 = S::splat(combdamp2);
+        const V vwet1 = S::splat(wet1);
+        const V vwet2 = S::splat(wet2);
+        const V vdry = S::splat(dry);
+        const int mask = combringsize - 1;
+
+        V filterstore[numcombgroups];
+        for(int g = 0; g < numcombgroups; g++)
+            filterstore[g] = S::load(combs[g].filterstore);
+
+        while(numsamples > 0)
         {
-            combL[i].setdamp(damp1);
-            combR[i].setdamp(damp1);
+            int count = numsamples > blocksize ? blocksize : static_cast<int>(numsamples);
+
+            // Accumulate comb filters in parallel
+            for(int n = 0; n < count; n++)
+            {
+                V input = S::splat((inputL[n] + inputR[n]) * gain);
+                V output[numcombgroups];
+
+                for(int g = 0; g < numcombgroups; g++)
+                {
+                    const combgroup &c = combs[g];
+                    float* ring = combs[g].ring.data();
+
+                    output[g] = S::flush(S::set(ring[((combpos - c.delay[0]) & mask) * 4 + 0],
+                                                ring[((combpos - c.delay[1]) & mask) * 4 + 1],
+                                                ring[((combpos - c.delay[2]) & mask) * 4 + 2],
+                                                ring[((combpos - c.delay[3]) & mask) * 4 + 3]));
+
+                    filterstore[g] = S::flush(S::add(S::mul(output[g], cdamp2), S::mul(filterstore[g], cdamp1)));
+
+                    S::store(ring + combpos * 4, S::add(input, S::mul(filterstore[g], feedback)));
+                }
+
+                S::hsum2(S::add(output[0], output[1]), S::add(output[2], output[3]), outL[n], outR[n]);
+                combpos = (combpos + 1) & mask;
+            }
+
+            // Feed through allpasses in series
+            for(int i = 0; i < numallpasses; i++)
+            {
+                allpassL[i].processblock<S>(outL, count);
+                allpassR[i].processblock<S>(outR, count);
+            }
+
+            // Calculate output REPLACING anything already there
+            int n = 0;
+
+            for(; n + 4 <= count; n += 4)
+            {
+                V l = S::load(outL + n);
+                V r = S::load(outR + n);
+                V dryL = S::mul(S::load(inputL + n), vdry);
+                V dryR = S::mul(S::load(inputR + n), vdry);
+                S::store(outputL + n, S::add(S::add(S::mul(l, vwet1), S::mul(r, vwet2)), dryL));
+                S::store(outputR + n, S::add(S::add(S::mul(r, vwet1), S::mul(l, vwet2)), dryR));
+            }
+
+            for(; n < count; n++)
+            {
+                float l = outL[n], r = outR[n];
+                outputL[n] = l * wet1 + r * wet2 + inputL[n] * dry;
+                outputR[n] = r * wet1 + l * wet2 + inputR[n] * dry;
+            }
+
+            inputL += count;
+            inputR += count;
+            outputL += count;
+            outputR += count;
+            numsamples -= count;
         }
+
+        for(int g = 0; g < numcombgroups; g++)
+            S::store(combs[g].filterstore, filterstore[g]);
     }
 
 private:
+    typedef void (revmodel::*kernelfunc)(const float*, const float*, float*, float*, long);
+    kernelfunc kernel = nullptr;
+
     float   gain = 0.0f;
     float   roomsize = 0.0f, roomsize1 = 0.0f;
     float   damp = 0.0f, damp1 = 0.0f;
@@ -509,36 +529,19 @@ private:
     float   width = 0.0f;
     float   mode = 0.0f;
 
-    // The following are all declared inline
-    // to remove the need for dynamic allocation
-    // with its subsequent error-checking messiness
+    // Values shared by all combs
+    float   combfeedback = 0.0f;
+    float   combdamp1 = 0.0f, combdamp2 = 0.0f;
 
     // Comb filters
-    comb    combL[numcombs];
-    comb    combR[numcombs];
+    combgroup   combs[numcombgroups];
+    int         combringsize = 1;
+    int         combpos = 0;
 
     // Allpass filters
     allpass allpassL[numallpasses];
     allpass allpassR[numallpasses];
 
-    // Buffers for the combs
-    std::vector<float>  bufcombL1;
-    std::vector<float>  bufcombR1;
-    std::vector<float>  bufcombL2;
-    std::vector<float>  bufcombR2;
-    std::vector<float>  bufcombL3;
-    std::vector<float>  bufcombR3;
-    std::vector<float>  bufcombL4;
-    std::vector<float>  bufcombR4;
-    std::vector<float>  bufcombL5;
-    std::vector<float>  bufcombR5;
-    std::vector<float>  bufcombL6;
-    std::vector<float>  bufcombR6;
-    std::vector<float>  bufcombL7;
-    std::vector<float>  bufcombR7;
-    std::vector<float>  bufcombL8;
-    std::vector<float>  bufcombR8;
-
     // Buffers for the allpasses
     std::vector<float> bufallpassL1;
     std::vector<float> bufallpassR1;
@@ -587,6 +590,7 @@ struct FxReverb
         {
             auto &c = rev[i / 2];
             c.setSampleRate(sampleRate);
+            c.setbackend(fxSimdBackend());
         }
 
         setSettings(m_setup);
@@ -711,11 +715,18 @@ struct FxReverb
                 outBuffer[i + 1].resize(frames);
         }
 
+        // Native floats are copied as is, without the per-sample conversion calls
+        bool isNative = (format == FX_AUDIO_F32SYS);
+
         for(int i = 0; i < frames; ++i)
         {
             for(int c = 0; c < channels; ++c)
             {
-                inBuffer[c][i] = readSample(in_stream, c);
+                if(isNative)
+                    memcpy(&inBuffer[c][i], in_stream + c * sizeof(float), sizeof(float));
+                else
+                    inBuffer[c][i] = readSample(in_stream, c);
+
                 if(channels % 2 == 1 && c == channels - 1) // Mono to Stereo
                     inBuffer[c + 1][i] = inBuffer[c][i];
             }
@@ -726,8 +737,8 @@ struct FxReverb
         for(int i = 0; i < channels; i += 2)
         {
             auto &c = rev[i / 2];
-            c.processreplace(inBuffer[i].data(), inBuffer[i + 1].data(),
-                             outBuffer[i].data(), outBuffer[i + 1].data(), frames, 1);
+            c.process(inBuffer[i].data(), inBuffer[i + 1].data(),
+                      outBuffer[i].data(), outBuffer[i + 1].data(), frames);
         }
 
         for(int p = 0; p < frames; ++p)
@@ -737,7 +748,13 @@ struct FxReverb
                 if(channels % 2 == 1 && w == channels - 1) // Stereo to Mono
                     outBuffer[w][p] = (outBuffer[w][p] + outBuffer[w + 1][p]) / 2.0f;
 
-                writeSample(&out_stream, outBuffer[w][p]);
+                if(isNative)
+                {
+                    memcpy(out_stream, &outBuffer[w][p], sizeof(float));
+                    out_stream += sizeof(float);
+                }
+                else
+                    writeSample(&out_stream, outBuffer[w][p]);
             }
         }
     }
@@ -26,6 +26,8 @@
 #include <string.h>
 #include "spc_echo.h"
 #include "fx_common.hpp"
+#include "fx_simd.h"
+#include "fx_simd.hpp"
 
 
 #define CLAMP16F( io )\
@@ -75,9 +77,9 @@ struct SpcEcho
     int is_valid = 0;
     float echo_ram[ECHO_BUFFER_SIZE];
 
-    // Echo history keeps most recent 8 samples (twice the size to simplify wrap handling)
-    float echo_hist[ECHO_HIST_SIZE * 2 * MAX_CHANNELS][MAX_CHANNELS];
-    float (*echo_hist_pos)[MAX_CHANNELS] = echo_hist; // &echo_hist [0 to 7]
+    // Echo history keeps most recent 8 samples of every channel, from the oldest to the newest.
+    // While processing, it's kept at two vectors per channel and the new samples get shifted in
+    float echo_hist[MAX_CHANNELS][ECHO_HIST_SIZE];
 
     //! offset from ESA in echo buffer
     int echo_offset = 0;
@@ -108,6 +110,7 @@ struct SpcEcho
     //! $xf rw FFCx - Echo FIR Filter Coefficient (FFC) X
     int8_t reg_fir[8] = {0, 0, 0, 0, 0, 0, 0, 0};
     int8_t reg_fir_resampled[8];
+    float  fir_coeffs[8];
 
     void recomputeFirResampled()
     {
@@ -117,6 +120,7 @@ struct SpcEcho
         {
             double newFactor = y_factor2 + ((y_factor1 - y_factor2) / (0.0 - 7.0)) * (i - 7.0);
             reg_fir_resampled[i] = (int8_t)(reg_fir[i] * (1.0 + ((newFactor - 1.0) / 100.0)));
+            fir_coeffs[i] = (float)reg_fir_resampled[i];
         }
     }
 
@@ -149,6 +153,29 @@ struct SpcEcho
     WriteSampleCB   writeSample = nullptr;
     int             sample_size = 2;
 
+    typedef void (SpcEcho::*ProcessCB)(uint8_t *stream, int len);
+    ProcessCB       processKernel = nullptr;
+
+    void setBackend(FxSimdBackend backend)
+    {
+        switch(backend)
+        {
+#ifdef FX_SIMD_HAS_SSE2
+        case FX_SIMD_SSE2:
+            processKernel = &SpcEcho::processT<FxSimdSSE2>;
+            break;
+#endif
+#ifdef FX_SIMD_HAS_NEON
+        case FX_SIMD_NEON:
+            processKernel = &SpcEcho::processT<FxSimdNEON>;
+            break;
+#endif
+        default:
+            processKernel = &SpcEcho::processT<FxSimdScalar>;
+            break;
+        }
+    }
+
     int init(int i_rate, uint16_t i_format, int i_channels)
     {
         is_valid = 0;
@@ -166,11 +193,13 @@ struct SpcEcho
         memset(echo_ram, 0, sizeof(echo_ram));
         memset(echo_hist, 0, sizeof(echo_hist));
         memset(reg_fir_resampled, 0, sizeof(reg_fir_resampled));
+        memset(fir_coeffs, 0, sizeof(fir_coeffs));
 
         if(!initFormat(readSample, writeSample, sample_size, format))
             return -1;
 
         setDefaultRegs();
+        setBackend(fxSimdBackend());
 
         is_valid = 1;
         return 0;
@@ -181,6 +210,15 @@ struct SpcEcho
 
     void process(uint8_t *stream, int len)
     {
+        if(processKernel)
+            (this->*processKernel)(stream, len);
+    }
+
+    template<class S>
+    void processT(uint8_t *stream, int len)
+    {
+        typedef typename S::V V;
+
         int frames = len / (sample_size * channels);
 
         float main_out[MAX_CHANNELS];
@@ -190,15 +228,22 @@ struct SpcEcho
         int c;
         float ov;
 
-        int f, e_offset;
+        int e_offset;
         float v;
 
         float mvoll[2] = {(float)reg_mvoll, (float)reg_mvolr};
         float evoll[2] = {(float)reg_evoll, (float)reg_evolr};
 
-        float (*echohist_pos)[MAX_CHANNELS];
         float *echo_ptr;
 
+        V hist_lo[MAX_CHANNELS];
+        V hist_hi[MAX_CHANNELS];
+        const V fir_lo = S::load(fir_coeffs);
+        const V fir_hi = S::load(fir_coeffs + 4);
+        const V zero = S::splat(0.0f);
+        // Native floats are read and written as is, without the per-sample conversion calls
+        const bool is_native = (format == FX_AUDIO_F32SYS);
+
         memset(main_out, 0, sizeof(main_out));
         memset(echo_out, 0, sizeof(echo_out));
         memset(echo_in, 0, sizeof(echo_in));
@@ -206,10 +251,24 @@ struct SpcEcho
         if(!is_valid)
             return;
 
+        for(c = 0; c < channels; c++)
+        {
+            hist_lo[c] = S::load(echo_hist[c]);
+            hist_hi[c] = S::load(echo_hist[c] + 4);
+        }
+
         do
         {
             for(c = 0; c < channels; ++c)
-                main_out[c] = readSample(stream, c) * 128;
+            {
+                if(is_native)
+                {
+                    memcpy(&v, stream + c * sizeof(float), sizeof(float));
+                    main_out[c] = v * 128;
+                }
+                else
+                    main_out[c] = readSample(stream, c) * 128;
+            }
 
             if(reg_eon & 1)
             {
@@ -231,22 +290,23 @@ struct SpcEcho
             for(c = 0; c < channels; c++)
                 echo_in[c] = echo_ptr[c];
 
-            echohist_pos = echo_hist_pos;
-            if(++echohist_pos >= &echo_hist[ECHO_HIST_SIZE])
-                echohist_pos = echo_hist;
-            echo_hist_pos = echohist_pos;
-
             /* --------------- FIR filter-------------- */
             for(c = 0; c < channels; c++)
-                echohist_pos[0][c] = echohist_pos[8][c] = echo_in[c];
-
-            for(c = 0; c < channels; ++c)
-                echo_in[c] *= reg_fir_resampled[7];
+            {
+                hist_lo[c] = S::shift(hist_lo[c], hist_hi[c]);
+                hist_hi[c] = S::shift(hist_hi[c], S::splat(echo_in[c]));
+            }
 
-            for(f = 0; f <= 6; ++f)
+            /* 8 taps of the channel are at two vectors, two channels at once */
+            for(c = 0; c < channels; c += 2)
             {
-                for(c = 0; c < channels; ++c)
-                    echo_in[c] += echo_hist_pos[f + 1][c] * reg_fir_resampled[f];
+                V left = S::add(S::mul(hist_lo[c], fir_lo), S::mul(hist_hi[c], fir_hi));
+                V right = zero;
+
+                if(c + 1 < channels)
+                    right = S::add(S::mul(hist_lo[c + 1], fir_lo), S::mul(hist_hi[c + 1], fir_hi));
+
+                S::hsum2(left, right, echo_in[c], echo_in[c + 1]);
             }
             /* ---------------------------------------- */
 
@@ -269,10 +329,23 @@ struct SpcEcho
                 CLAMP16F(ov);
                 if((reg_flg & 0x40))
                     ov = 0;
-                writeSample(&stream, ov);
+
+                if(is_native)
+                {
+                    memcpy(stream, &ov, sizeof(float));
+                    stream += sizeof(float);
+                }
+                else
+                    writeSample(&stream, ov);
             }
         }
         while(--frames);
+
+        for(c = 0; c < channels; c++)
+        {
+            S::store(echo_hist[c], hist_lo[c]);
+            S::store(echo_hist[c] + 4, hist_hi[c]);
+        }
     }
 };
 
@@ -41,6 +41,15 @@ struct PGEColor
 };
 
 struct SDL_Texture;
+struct StdPicture;
+
+/*!
+ * \brief Drop the renderer records that refer to the picture being destroyed
+ *
+ * Called by the destructor for the lazy-loaded pictures having a pending decoding
+ * or a texture only, those are handled by the render thread
+ */
+void StdPictureDestroyed(StdPicture &target);
 
 /**
  * @brief Handler of a graphical texture
@@ -108,6 +117,17 @@ struct StdPicture
         frame_w = 0;
         frame_h = 0;
     }
+
+    StdPicture() = default;
+    StdPicture(const StdPicture &) = default;
+    StdPicture &operator=(const StdPicture &) = default;
+
+    ~StdPicture()
+    {
+        // not every owner deletes the texture (it may be shared by a copy)
+        if(l.lazyLoaded && (l.asyncTicket != 0 || d.hasTexture()))
+            StdPictureDestroyed(*this);
+    }
 };
 
 // This macro allows to get the original texture path when debug build is on,
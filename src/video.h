@@ -27,7 +27,9 @@ enum RenderMode_t
     RENDER_AUTO = -1,
     RENDER_SOFTWARE = 0,
     RENDER_ACCELERATED,
-    RENDER_ACCELERATED_VSYNC
+    RENDER_ACCELERATED_VSYNC,
+    //! Draws nothing, only counts the draw calls (command line only)
+    RENDER_NULL
 };
 
 enum BatteryStatus_t
@@ -57,6 +59,12 @@ extern struct VideoSettings_t
     bool   showFrameRate = false;
     //! 2x scale down all textures to reduce the memory usage
     bool   scaleDownAllTextures = false;
+    //! Keep the decoded textures at the disk to not decode them again by the next runs
+    bool   textureCache = true;
+    //! Size limit of the textures cache in megabytes
+    int    textureCacheSize = 256;
+    //! Memory budget of the lazy-loaded textures in megabytes, 0 is unlimited
+    int    textureMemoryBudget = 0;
 } g_videoSettings; // config.cpp
 
 #endif // VIDEO_H